@@ -3,48 +3,222 @@
 #include "source/Texture.h"
 #include "function/Function.h"
 #include "function/Math.h"
+#include "3D/mesh/ObjParser.h"
+#include "3D/mesh/MeshCache.h"
+#include "3D/mesh/GlbLoader.h"
+#include "3D/mesh/MeshOptimizer.h"
+#include "3D/mesh/MeshSimplifier.h"
+#include "3D/mesh/MeshBounds.h"
 #include "manager/TextureManager.h"
 #include "manager/DrawManager.h"
 #include "manager/DebugUI.h"
 #include "externals/imgui/imgui.h"
 #include "engine/directX/DirectXCommon.h"
+#include "externals/DirectXTex/DirectXTex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <objbase.h>
 
 TextureManager* ObjClass::textureManager_ = nullptr;
 DrawManager* ObjClass::drawManager_ = nullptr;
 DebugUI* ObjClass::ui_ = nullptr;
+JobSystem* ObjClass::jobSystem_ = nullptr;
+AsyncModelLoader* ObjClass::modelLoader_ = nullptr;
+MeshAssetCache* ObjClass::assetCache_ = nullptr;
+std::unordered_map<std::string, std::weak_ptr<const ObjClass::SharedModel>> ObjClass::sharedModels_;
 
 void ObjClass::Initialize(Camera* camera, const std::string& filename) {
 
     this->camera_ = camera;
+    this->filename_ = filename;
 
-    objModel_ = LoadObjFileM("resources/obj", filename);
+    if (loadRequest_) {
+        loadRequest_->Cancel();
+        loadRequest_.reset();
+    }
 
-    textures_.clear();
-    resources_.clear();
+    // 同じファイルのインスタンスがあれば、読み込みも転送もせずにそれを使う
+    std::shared_ptr<const SharedModel> sharedModel = FindSharedModel(MeshAssetCache::MakeKey("resources/obj", filename));
+    if (!sharedModel) {
+        // バイナリキャッシュがあればそれを使う(無ければ解析して書き出す)
+        MeshAssetCache::Handle asset = assetCache_ ? assetCache_->Load("resources/obj", filename, jobSystem_) :
+            MeshAssetCache::LoadUncached("resources/obj", filename, jobSystem_);
+        sharedModel = CreateSharedModel(std::move(asset), nullptr);
+    }
+    isCacheHit_ = sharedModel->asset->isCacheHit;
+    CreateInstance(std::move(sharedModel));
+}
+
+void ObjClass::InitializeAsync(Camera* camera, const std::string& filename, std::function<void(ObjClass&)> onLoaded) {
+
+    // ローダーが無い時と、同じファイルのインスタンスがもうある時は待つものが無い
+    if (!modelLoader_ || FindSharedModel(MeshAssetCache::MakeKey("resources/obj", filename))) {
+        Initialize(camera, filename);
+        if (onLoaded) {
+            onLoaded(*this);
+        }
+        return;
+    }
+
+    this->camera_ = camera;
+    this->filename_ = filename;
+
+    // 前の読み込みは捨て、終わるまでは何も描かない
+    if (loadRequest_) {
+        loadRequest_->Cancel();
+    }
+    ReleaseResources();
+
+    // テクスチャのデコードもワーカーで済ませる(メインスレッドでは転送だけ)
+    auto decodedTextures = std::make_shared<std::unordered_map<std::string, DirectX::ScratchImage>>();
+    loadRequest_ = modelLoader_->Load("resources/obj", filename,
+        [this, decodedTextures, onLoaded = std::move(onLoaded)](AsyncModelLoader::Request& request) {
+            isCacheHit_ = request.IsCacheHit();
+            // 同じファイルを先に頼んだインスタンスが作っていればそれを使う
+            std::shared_ptr<const SharedModel> sharedModel = FindSharedModel(request.GetAsset()->key);
+            if (!sharedModel) {
+                sharedModel = CreateSharedModel(request.GetAsset(), decodedTextures.get());
+            }
+            CreateInstance(std::move(sharedModel));
+            loadRequest_.reset();
+            if (onLoaded) {
+                onLoaded(*this);
+            }
+        },
+        [decodedTextures](const ObjModel& model) {
+            // WICはスレッドごとにCOMの初期化が要る
+            const HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+            // 同じパスは1回だけデコードする
+            for (const ObjMaterial& material : model.materials) {
+                if (!material.textureFilePath.empty() && !decodedTextures->contains(material.textureFilePath)) {
+                    (*decodedTextures)[material.textureFilePath] = DirectXCommon::LoadTexture(material.textureFilePath);
+                }
+            }
+            if (SUCCEEDED(hr)) {
+                CoUninitialize();
+            }
+        });
+}
+
+std::shared_ptr<const ObjClass::SharedModel> ObjClass::FindSharedModel(const std::string& key) {
+    auto it = sharedModels_.find(key);
+    return it != sharedModels_.end() ? it->second.lock() : nullptr;
+}
+
+std::shared_ptr<const ObjClass::SharedModel> ObjClass::CreateSharedModel(MeshAssetCache::Handle asset, std::unordered_map<std::string, DirectX::ScratchImage>* decodedTextures) {
+
+    DirectXCommon* dxCommon = D3D12ResourceUtil::dxCommon_;
+    auto sharedModel = std::make_shared<SharedModel>();
+    const ObjModel& model = asset->model;
+    // 作ったテクスチャのSRV(パスごと)
+    std::unordered_map<std::string, D3D12_GPU_DESCRIPTOR_HANDLE> textureHandles;
+
+    for (size_t i = 0; i < model.meshes.size(); ++i) {
+        const ObjMesh& mesh = model.meshes[i];
+        SharedModel::Mesh& shared = sharedModel->meshes.emplace_back();
 
-    for (const auto& mesh : objModel_.meshes) {
+        // 頂点バッファ(書き換えないので、書いたら閉じる)
+        shared.vertexResource = dxCommon->CreateBufferResource(sizeof(VertexData) * mesh.vertices.size());
+        shared.vertexBufferView.BufferLocation = shared.vertexResource->GetGPUVirtualAddress();
+        shared.vertexBufferView.SizeInBytes = UINT(sizeof(VertexData) * mesh.vertices.size());
+        shared.vertexBufferView.StrideInBytes = sizeof(VertexData);
+
+        VertexData* vertexData = nullptr;
+        shared.vertexResource->Map(0, nullptr, reinterpret_cast<void**>(&vertexData));
+        std::memcpy(vertexData, mesh.vertices.data(), sizeof(VertexData) * mesh.vertices.size());
+        shared.vertexResource->Unmap(0, nullptr);
+
+        // インデックスバッファ(重複を除いた頂点を添字で参照する)
+        // 元の形の後ろに詳細度を続けて入れ、描く時に範囲を選ぶ(頂点バッファは共有)
+        const float extent = (std::max)({ mesh.boundsMax.x - mesh.boundsMin.x, mesh.boundsMax.y - mesh.boundsMin.y, mesh.boundsMax.z - mesh.boundsMin.z });
+        shared.lodRanges.push_back({ 0, static_cast<uint32_t>(mesh.indices.size()), 0.0f });
+        size_t indexCount = mesh.indices.size();
+        for (const ObjMeshLod& lod : mesh.lods) {
+            shared.lodRanges.push_back({ static_cast<uint32_t>(indexCount), static_cast<uint32_t>(lod.indices.size()), lod.error * extent });
+            indexCount += lod.indices.size();
+        }
+
+        shared.indexResource = dxCommon->CreateBufferResource(sizeof(uint32_t) * indexCount);
+        shared.indexBufferView.BufferLocation = shared.indexResource->GetGPUVirtualAddress();
+        shared.indexBufferView.SizeInBytes = UINT(sizeof(uint32_t) * indexCount);
+        shared.indexBufferView.Format = DXGI_FORMAT_R32_UINT;
+
+        uint32_t* indexData = nullptr;
+        shared.indexResource->Map(0, nullptr, reinterpret_cast<void**>(&indexData));
+        std::memcpy(indexData, mesh.indices.data(), sizeof(uint32_t) * mesh.indices.size());
+        for (size_t l = 0; l < mesh.lods.size(); ++l) {
+            std::memcpy(indexData + shared.lodRanges[l + 1].startIndex, mesh.lods[l].indices.data(), sizeof(uint32_t) * mesh.lods[l].indices.size());
+        }
+        shared.indexResource->Unmap(0, nullptr);
+
+        // テクスチャ(同じパスはメッシュをまたいで1つにする)
+        const std::string& textureFilePath = model.GetMaterial(mesh).textureFilePath;
+        if (!textureFilePath.empty()) {
+            auto [it, isInserted] = textureHandles.try_emplace(textureFilePath);
+            if (isInserted) {
+                auto texture = std::make_unique<Texture>();
+                // ワーカーでデコード済みなら転送だけ行う
+                const DirectX::ScratchImage* decoded = nullptr;
+                if (decodedTextures) {
+                    auto found = decodedTextures->find(textureFilePath);
+                    decoded = found != decodedTextures->end() && found->second.GetImageCount() > 0 ? &found->second : nullptr;
+                }
+                if (decoded) {
+                    texture->Initialize(textureFilePath, *decoded);
+                } else {
+                    texture->Initialize(textureFilePath);
+                }
+                it->second = texture->GetTextureSrvHandleGPU();
+                sharedModel->textures.push_back(std::move(texture));
+            }
+            shared.textureHandle = it->second;
+            shared.hasTexture = true;
+        } else {
+            // ダミー（白）テクスチャのSRVハンドルを取得
+            shared.textureHandle = textureManager_->GetWhiteTextureHandle();
+        }
+    }
+
+    sharedModel->asset = std::move(asset);
+
+    // 消えたものの項目を捨ててから登録する
+    std::erase_if(sharedModels_, [](const auto& entry) { return entry.second.expired(); });
+    sharedModels_[sharedModel->asset->key] = sharedModel;
+    return sharedModel;
+}
+
+void ObjClass::CreateInstance(std::shared_ptr<const SharedModel> sharedModel) {
+
+    ReleaseResources();
+    sharedModel_ = std::move(sharedModel);
+    const ObjModel& model = sharedModel_->asset->model;
+
+    for (size_t i = 0; i < model.meshes.size(); ++i) {
+        const ObjMaterial& material = model.GetMaterial(model.meshes[i]);
+        const SharedModel::Mesh& shared = sharedModel_->meshes[i];
 
         auto res = std::make_unique<D3D12ResourceUtil>();
 
-        // 頂点バッファ
-        res->vertexResource_ = res->GetDirectXCommon()->CreateBufferResource(sizeof(VertexData) * mesh.vertices.size());
-        res->vertexBufferView_ = D3D12_VERTEX_BUFFER_VIEW{};
-        res->vertexBufferView_.BufferLocation = res->vertexResource_->GetGPUVirtualAddress();
-        res->vertexBufferView_.SizeInBytes = UINT(sizeof(VertexData) * mesh.vertices.size());
-        res->vertexBufferView_.StrideInBytes = sizeof(VertexData);
+        // 頂点・インデックスバッファは共有のものを指す
+        res->vertexBufferView_ = shared.vertexBufferView;
+        res->indexBufferView_ = shared.indexBufferView;
+        res->textureHandle_ = shared.textureHandle;
 
-        res->vertexResource_->Map(0, nullptr, reinterpret_cast<void**>(&res->vertexData_));
-        res->vertexDataList_ = mesh.vertices;
-        std::memcpy(res->vertexData_, mesh.vertices.data(), sizeof(VertexData) * mesh.vertices.size());
+        visibleRanges_.push_back({ { shared.lodRanges[0].startIndex, shared.lodRanges[0].indexCount } });
+        cullStats_.push_back({});
+        currentLods_.push_back(0);
 
-        // マテリアル
+        // マテリアル(インスタンスごとに書き換えられるよう、共有のモデルから写して持つ)
         res->materialResource_ = res->GetDirectXCommon()->CreateBufferResource(sizeof(Material));
         res->materialResource_->Map(0, nullptr, reinterpret_cast<void**>(&res->materialData_));
-        res->materialData_->color = mesh.material.color;
-        res->materialData_->enableLighting = mesh.material.enableLighting;
-        res->materialData_->hasTexture = true;
+        res->materialData_->color = material.color;
+        res->materialData_->enableLighting = material.enableLighting;
+        res->materialData_->hasTexture = shared.hasTexture;
         res->materialData_->lightingMode = 2;
-        res->materialData_->uvTransform = mesh.material.uvTransform; // すでに行列
+        res->materialData_->uvTransform = material.uvTransform; // すでに行列
         res->materialData_->shininess = 64.0f;
 
         // WVP
@@ -70,17 +244,6 @@ void ObjClass::Initialize(Camera* camera, const std::string& filename) {
             res->transformationMatrix_.WorldInverseTranspose
         };
 
-        // テクスチャ
-        auto tex = std::make_unique<Texture>();
-        if (!mesh.material.textureFilePath.empty()) {
-            tex->Initialize(mesh.material.textureFilePath);
-            res->textureHandle_ = tex->GetTextureSrvHandleGPU();
-        } else if (!res->textureHandle_.ptr) {
-            res->materialData_->hasTexture = false;
-            // ダミー（白）テクスチャのSRVハンドルを取得
-            res->textureHandle_ = textureManager_->GetWhiteTextureHandle();
-        }
-
         // ライト
         res->directionalLightResource_ = res->GetDirectXCommon()->CreateBufferResource(sizeof(DirectionalLight));
         res->directionalLightResource_->Map(0, nullptr, reinterpret_cast<void**>(&res->directionalLightData_));
@@ -93,10 +256,23 @@ void ObjClass::Initialize(Camera* camera, const std::string& filename) {
         res->cameraResource_->Map(0, nullptr, reinterpret_cast<void**>(&res->cameraData_));
         res->cameraData_->worldPosition = camera_->GetTranslate();
 
-        textures_.push_back(std::move(tex));
         resources_.push_back(std::move(res));
     }
 
+    isLoaded_ = true;
+}
+
+void ObjClass::ReleaseResources() {
+    resources_.clear();
+    currentLods_.clear();
+    visibleRanges_.clear();
+    cullStats_.clear();
+    sharedModel_.reset();
+    isLoaded_ = false;
+}
+
+size_t ObjClass::GetSharedModelCount() {
+    return std::count_if(sharedModels_.begin(), sharedModels_.end(), [](const auto& entry) { return !entry.second.expired(); });
 }
 
 void ObjClass::Update(const char* objName) {
@@ -104,10 +280,49 @@ void ObjClass::Update(const char* objName) {
     std::string name = std::string("Obj: ") + objName;
     ImGui::Begin(name.c_str());
 
+    if (!isLoaded_) {
+        ImGui::Text("loading %s ...", filename_.c_str());
+    }
+
+    if (sharedModel_) {
+        // 同じファイルのインスタンスで共有している数(解析・転送は1回だけ)
+        ImGui::Text("shared by %ld instances (%zu models alive)", sharedModel_.use_count(), GetSharedModelCount());
+        if (assetCache_) {
+            const MeshAssetCache::Stats assetStats = assetCache_->GetStats();
+            ImGui::Text("asset cache: %zu alive, %zu loads, %zu shared", assetStats.liveCount, assetStats.loadCount, assetStats.shareCount);
+        }
+    }
+
     for (size_t i = 0; i < resources_.size(); ++i) {
         auto& res = resources_[i];
+        const ObjMesh& mesh = sharedModel_->asset->model.meshes[i];
+        const std::vector<LodRange>& lodRanges = sharedModel_->meshes[i].lodRanges;
         std::string meshLabel = "Mesh[" + std::to_string(i) + "]";
         if (ImGui::TreeNode(meshLabel.c_str())) {
+            // 添字化で減った頂点数とメモリ
+            const size_t cornerCount = mesh.indices.size();
+            const size_t uniqueCount = mesh.vertices.size();
+            const size_t beforeBytes = sizeof(VertexData) * cornerCount;
+            const size_t afterBytes = sizeof(VertexData) * uniqueCount + sizeof(uint32_t) * cornerCount;
+            ImGui::Text("vertices: %zu -> %zu (%.1f%%)", cornerCount, uniqueCount, cornerCount ? 100.0 * uniqueCount / cornerCount : 0.0);
+            ImGui::Text("memory: %.1f KB -> %.1f KB", beforeBytes / 1024.0, afterBytes / 1024.0);
+            const MeshOptimizer::CacheStats cacheStats = MeshOptimizer::AnalyzeVertexCache(mesh.indices, uniqueCount);
+            ImGui::Text("ACMR: %.3f ATVR: %.3f", cacheStats.acmr, cacheStats.atvr);
+            // 詳細度ごとの三角形数とずれ
+            for (size_t l = 0; l < lodRanges.size(); ++l) {
+                ImGui::Text("%sLOD%zu: %u tris error %.4f", l == currentLods_[i] ? "> " : "  ", l, lodRanges[l].indexCount / 3, lodRanges[l].error);
+            }
+            // 包む形(向きを合わせた箱は軸に沿った箱に対する体積の割合)
+            const Vector3 aabbSize = Math::Subtract(mesh.boundsMax, mesh.boundsMin);
+            const Vector3& obbHalf = mesh.orientedBounds.size;
+            const float aabbVolume = aabbSize.x * aabbSize.y * aabbSize.z;
+            ImGui::Text("sphere: r %.3f OBB: %.3f x %.3f x %.3f (%.1f%% of AABB)", mesh.boundingSphere.radius,
+                obbHalf.x * 2.0f, obbHalf.y * 2.0f, obbHalf.z * 2.0f, aabbVolume > 0.0f ? 800.0f * obbHalf.x * obbHalf.y * obbHalf.z / aabbVolume : 100.0f);
+            // 塊ごとの判定
+            const MeshletCulling::CullStats& cullStats = cullStats_[i];
+            ImGui::Text("meshlets: %zu%s", mesh.meshlets.size(), mesh.isClosed ? " (closed)" : "");
+            ImGui::Text("visible %zu frustum %zu backface %zu", cullStats.visibleCount, cullStats.frustumCulledCount, cullStats.backfaceCulledCount);
+            ImGui::Text("draw: %zu tris in %zu ranges", cullStats.visibleIndexCount / 3, visibleRanges_[i].size());
             ui_->DebugTransform(res->transform_);
             ui_->DebugMaterialBy3D(res->materialData_);
             ui_->DebugDirectionalLight(res->directionalLightData_);
@@ -115,10 +330,88 @@ void ObjClass::Update(const char* objName) {
             ImGui::TreePop();
         }
     }
+
+    // 従来の読み込み(istringstream)と高速版で時間と結果を比べる
+    if (ImGui::Button("Measure Load")) {
+        auto start = std::chrono::steady_clock::now();
+        const ObjModel reference = LoadObjFileM("resources/obj", filename_);
+        loadTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        const ObjModel fast = ObjParser::LoadFile("resources/obj", filename_);
+        fastLoadTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        const ObjModel parallel = ObjParser::LoadFileParallel("resources/obj", filename_, jobSystem_);
+        parallelLoadTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        const ObjModel cached = MeshCache::LoadFile("resources/obj", filename_, &isCacheHit_);
+        cacheLoadTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // キャッシュは並べ替え・塊・詳細度の生成が済んでいるので、同じことをしたものと比べる
+        ObjModel optimized = fast;
+        for (ObjMesh& mesh : optimized.meshes) {
+            MeshCache::PrepareMesh(mesh);
+        }
+        isLoadMatched_ = ObjParser::IsSame(reference, fast) && ObjParser::IsSame(fast, parallel) && ObjParser::IsSame(optimized, cached);
+
+        // Assimpでobjを読む時(後処理なし・既定の後処理)と、同じ内容のglb(mesh_benchmark --glb で書ける)をAssimpとGlbLoaderで読む時を比べる
+        start = std::chrono::steady_clock::now();
+        const ObjModel assimpRaw = LoadObjFileAssimpM("resources/obj", filename_, { false, false, false, false });
+        assimpRawLoadTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        const ObjModel assimp = LoadObjFileAssimpM("resources/obj", filename_);
+        assimpLoadTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // 同じ頂点をまとめた効果と、並べ替えた効果
+        assimpRawVertexCount_ = assimpVertexCount_ = 0;
+        assimpRawAcmr_ = assimpAcmr_ = 0.0f;
+        for (const ObjMesh& mesh : assimpRaw.meshes) {
+            assimpRawVertexCount_ += mesh.vertices.size();
+            assimpRawAcmr_ += static_cast<float>(MeshOptimizer::AnalyzeVertexCache(mesh.indices, mesh.vertices.size()).missCount);
+        }
+        size_t assimpTriangleCount = 0;
+        for (const ObjMesh& mesh : assimp.meshes) {
+            assimpVertexCount_ += mesh.vertices.size();
+            assimpAcmr_ += static_cast<float>(MeshOptimizer::AnalyzeVertexCache(mesh.indices, mesh.vertices.size()).missCount);
+            assimpTriangleCount += mesh.indices.size() / 3;
+        }
+        assimpRawAcmr_ /= static_cast<float>((std::max)(assimpTriangleCount, size_t(1)));
+        assimpAcmr_ /= static_cast<float>((std::max)(assimpTriangleCount, size_t(1)));
+
+        const std::string glbFilename = std::filesystem::path(filename_).replace_extension(".glb").string();
+        hasGlb_ = std::filesystem::exists("resources/obj/" + glbFilename);
+        if (hasGlb_) {
+            start = std::chrono::steady_clock::now();
+            LoadObjFileAssimpM("resources/obj", glbFilename);
+            assimpGlbLoadTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            ObjModel glb = GlbLoader::LoadFile("resources/obj", glbFilename, jobSystem_);
+            glbLoadTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            // glbはKa/Ks/Nsを持たないので、マテリアルは同じ番号のobjのものにして形だけ比べる
+            glb.materials = fast.materials;
+            isGlbMatched_ = ObjParser::IsSame(fast, glb);
+        }
+    }
+    ImGui::Text("LoadObjFileM: %.3f ms ObjParser: %.3f ms %s", loadTimeMs_, fastLoadTimeMs_, isLoadMatched_ ? "(same)" : "(DIFFERENT)");
+    ImGui::Text("ObjParser(parallel): %.3f ms", parallelLoadTimeMs_);
+    ImGui::Text("MeshCache: %.3f ms %s", cacheLoadTimeMs_, isCacheHit_ ? "(hit)" : "(miss)");
+    ImGui::Text("LoadObjFileAssimpM(obj): %.3f ms (no post process %.3f ms)", assimpLoadTimeMs_, assimpRawLoadTimeMs_);
+    ImGui::Text("Assimp vertices: %zu -> %zu ACMR: %.3f -> %.3f", assimpRawVertexCount_, assimpVertexCount_, assimpRawAcmr_, assimpAcmr_);
+    if (hasGlb_) {
+        ImGui::Text("LoadObjFileAssimpM(glb): %.3f ms GlbLoader: %.3f ms %s", assimpGlbLoadTimeMs_, glbLoadTimeMs_, isGlbMatched_ ? "(same)" : "(DIFFERENT)");
+    }
+    ImGui::SliderInt("Force LOD", &forcedLod_, -1, static_cast<int>(std::size(MeshSimplifier::kLodRatios)));
+    ImGui::DragFloat("LOD Pixel Error", &lodPixelThreshold_, 0.1f, 0.0f, 32.0f);
+    ImGui::Checkbox("Cluster Culling", &isClusterCullingEnabled_);
     ImGui::End();
 #endif
 
-    for (auto& res : resources_) {
+    for (size_t i = 0; i < resources_.size(); ++i) {
+        auto& res = resources_[i];
         res->transformationMatrix_.world = Math::MakeAffineMatrix(res->transform_.scale, res->transform_.rotate, res->transform_.translate);
         res->transformationMatrix_.WVP = Math::Multiply(res->transformationMatrix_.world, Math::Multiply(camera_->GetViewMatrix(), camera_->GetPerspectiveFovMatrix()));
         // 法線変換用：平行移動を除いた World を使う
@@ -141,11 +434,66 @@ void ObjClass::Update(const char* objName) {
         res->materialData_->uvTransform = Math::MakeAffineMatrix(res->uvTransform_.scale, res->uvTransform_.rotate, res->uvTransform_.translate);
         res->directionalLightData_->direction = Math::Normalize(res->directionalLightData_->direction);
         res->cameraData_->worldPosition = camera_->GetTranslate();
+
+        // 詳細度を選ぶ(ずれが画面上でlodPixelThreshold_ピクセル以下の、最も粗いもの)
+        const std::vector<LodRange>& lodRanges = sharedModel_->meshes[i].lodRanges;
+        if (forcedLod_ >= 0) {
+            currentLods_[i] = (std::min)(static_cast<uint32_t>(forcedLod_), static_cast<uint32_t>(lodRanges.size() - 1));
+            continue;
+        }
+        const ObjMesh& mesh = sharedModel_->asset->model.meshes[i];
+        const Vector3& scale = res->transform_.scale;
+        const float maxScale = (std::max)({ std::fabs(scale.x), std::fabs(scale.y), std::fabs(scale.z) });
+        const Sphere bounds = MeshBounds::TransformSphere(mesh.boundingSphere, res->transformationMatrix_.world);
+        // 包む球の中にカメラが入るほど近ければ元の形
+        const float distance = Math::Length(Math::Subtract(bounds.center, camera_->GetTranslate())) - bounds.radius;
+        currentLods_[i] = 0;
+        if (distance <= 0.0f) {
+            continue;
+        }
+        // 長さ1がこの距離で画面の何ピクセルになるか
+        const float pixelsPerUnit = camera_->GetPerspectiveFovMatrix().m[1][1] * camera_->GetViewportHeight() * 0.5f / distance;
+        for (uint32_t l = 1; l < lodRanges.size(); ++l) {
+            if (lodRanges[l].error * maxScale * pixelsPerUnit <= lodPixelThreshold_) {
+                currentLods_[i] = l;
+            }
+        }
+    }
+
+    // 元の形を描くメッシュは、塊ごとに視錐台の外と裏向きを外して見える範囲だけ描く
+    for (size_t i = 0; i < resources_.size(); ++i) {
+        const ObjMesh& mesh = sharedModel_->asset->model.meshes[i];
+        const LodRange& range = sharedModel_->meshes[i].lodRanges[currentLods_[i]];
+        if (!isClusterCullingEnabled_ || currentLods_[i] != 0 || mesh.meshlets.empty()) {
+            visibleRanges_[i].assign(1, { range.startIndex, range.indexCount });
+            cullStats_[i] = {};
+            cullStats_[i].visibleCount = mesh.meshlets.size();
+            cullStats_[i].visibleIndexCount = range.indexCount;
+            continue;
+        }
+        // 判定はローカル座標で行う(WVPの平面と、ワールド行列の逆で戻したカメラ)
+        const Matrix4x4& world = resources_[i]->transformationMatrix_.world;
+        const MeshletCulling::Frustum frustum = MeshletCulling::MakeFrustum(resources_[i]->transformationMatrix_.WVP);
+        // メッシュ全体が外なら塊を調べない
+        if (MeshletCulling::IsOutside(mesh.boundingSphere, frustum) || MeshletCulling::IsOutside(mesh.orientedBounds, frustum)) {
+            visibleRanges_[i].clear();
+            cullStats_[i] = {};
+            cullStats_[i].frustumCulledCount = mesh.meshlets.size();
+            continue;
+        }
+        const Vector3 cameraPosition = Math::Transform(camera_->GetTranslate(), Math::Inverse(world));
+        // 裏面はパイプラインが描かない(D3D12_CULL_MODE_BACK)ので、閉じていないメッシュでも裏向きの塊は外せる
+        // 負の拡縮で裏返っている時だけは、表裏が逆になるので外さない
+        const Vector3& scale = resources_[i]->transform_.scale;
+        const bool isBackfaceCulling = scale.x * scale.y * scale.z > 0.0f;
+        cullStats_[i] = MeshletCulling::Cull(mesh.meshlets, frustum, cameraPosition, isBackfaceCulling, visibleRanges_[i]);
     }
 }
 
 void ObjClass::Draw() {
-    for (auto& res : resources_) {
-        drawManager_->DrawByVertex(res.get());
+    for (size_t i = 0; i < resources_.size(); ++i) {
+        for (const IndexRange& range : visibleRanges_[i]) {
+            drawManager_->DrawByIndex(resources_[i].get(), range.indexCount, range.startIndex);
+        }
     }
 }
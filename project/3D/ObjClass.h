@@ -4,15 +4,23 @@
 #include <string>
 #include "../camera/Camera.h"
 #include "../source/D3D12ResourceUtil.h"
+#include "../math/IndexRange.h"
+#include "mesh/MeshletCulling.h"
+#include "mesh/AsyncModelLoader.h"
+#include "mesh/MeshAssetCache.h"
 #include <wrl.h>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <unordered_map>
 
 // 前方宣言
 
 class TextureManager;
 class DrawManager;
 class DebugUI;
+class JobSystem;
+namespace DirectX { class ScratchImage; }
 
 //==========================
 // objが配布されているサイト
@@ -24,12 +32,85 @@ class DebugUI;
 class ObjClass {
 protected: //メンバ変数
 
-    ObjModel objModel_;
-
-    std::vector<std::unique_ptr<Texture>> textures_;
-
+    // 詳細度ごとの添字の範囲(インデックスバッファに元の形から粗い順に続けて入れてある)
+    struct LodRange {
+        uint32_t startIndex = 0;
+        uint32_t indexCount = 0;
+        // 元の形からのずれ(ローカル座標の長さ)
+        float error = 0.0f;
+    };
+
+    /// <summary>
+    /// 同じファイルのインスタンスがすべて共有する、CPUとGPUのメッシュのデータ(作った後は書き換えない)
+    /// インスタンスごとの状態(位置・マテリアル・ライト)はresources_の方に持つ
+    /// </summary>
+    struct SharedModel {
+        MeshAssetCache::Handle asset;
+        struct Mesh {
+            Microsoft::WRL::ComPtr<ID3D12Resource> vertexResource;
+            Microsoft::WRL::ComPtr<ID3D12Resource> indexResource;
+            D3D12_VERTEX_BUFFER_VIEW vertexBufferView{};
+            D3D12_INDEX_BUFFER_VIEW indexBufferView{};
+            // テクスチャが無ければ白いテクスチャ
+            D3D12_GPU_DESCRIPTOR_HANDLE textureHandle{};
+            bool hasTexture = false;
+            // 詳細度([0]が元の形)
+            std::vector<LodRange> lodRanges;
+        };
+        std::vector<Mesh> meshes;
+        // テクスチャ(パスごとに1つ。同じテクスチャのマテリアルは同じものを指す)
+        std::vector<std::unique_ptr<Texture>> textures;
+    };
+
+    // 描いているモデル(読み込み中・初期化前はnull)
+    std::shared_ptr<const SharedModel> sharedModel_;
+
+    // 読み込んだファイル名
+    std::string filename_;
+
+    // 読み込みにかかった時間(ms)と、従来の読み込みと結果が一致したか(デバッグ表示用)
+    float loadTimeMs_ = 0.0f;
+    float fastLoadTimeMs_ = 0.0f;
+    float parallelLoadTimeMs_ = 0.0f;
+    float cacheLoadTimeMs_ = 0.0f;
+    bool isLoadMatched_ = true;
+    // Assimpとglbの読み込み(glbはobjの横に同じ名前で置いてある時だけ)
+    float assimpLoadTimeMs_ = 0.0f;
+    float assimpRawLoadTimeMs_ = 0.0f;
+    // Assimpの後処理の前後の頂点数とACMR
+    size_t assimpRawVertexCount_ = 0;
+    size_t assimpVertexCount_ = 0;
+    float assimpRawAcmr_ = 0.0f;
+    float assimpAcmr_ = 0.0f;
+    float assimpGlbLoadTimeMs_ = 0.0f;
+    float glbLoadTimeMs_ = 0.0f;
+    bool hasGlb_ = false;
+    bool isGlbMatched_ = true;
+    // 最後の読み込みでバイナリキャッシュを使えたか
+    bool isCacheHit_ = false;
+
+    // インスタンスごとの定数バッファ(頂点・インデックスバッファとテクスチャはsharedModel_のものを指す)
     std::vector<std::unique_ptr<D3D12ResourceUtil>> resources_;
 
+    // 今描いている詳細度(メッシュごと)
+    std::vector<uint32_t> currentLods_;
+    // 画面上のずれがこのピクセル数以下なら粗い詳細度を使う
+    float lodPixelThreshold_ = 1.0f;
+    // 詳細度を固定する(-1なら画面上の大きさから選ぶ。デバッグ用)
+    int forcedLod_ = -1;
+
+    // 描く添字の範囲(メッシュごと。元の形を描く時は見える塊だけ、それ以外は詳細度の範囲全体)
+    std::vector<std::vector<IndexRange>> visibleRanges_;
+    // 塊ごとの判定の結果(デバッグ表示用)
+    std::vector<MeshletCulling::CullStats> cullStats_;
+    // 塊ごとに見えないものを外すか
+    bool isClusterCullingEnabled_ = true;
+
+    // 非同期で読み込み中のもの(終わるまでは何も描かない)
+    std::shared_ptr<AsyncModelLoader::Request> loadRequest_;
+    // GPUのリソースまで作り終わったか
+    bool isLoaded_ = false;
+
 #pragma region 外部参照
 
     Camera* camera_ = nullptr;
@@ -40,17 +121,59 @@ protected: //メンバ変数
 
     static DebugUI* ui_;
 
+    static JobSystem* jobSystem_;
+
+    static AsyncModelLoader* modelLoader_;
+
+    static MeshAssetCache* assetCache_;
+
 #pragma endregion
 
+    // 生きている共有モデル(MeshAssetCache::MakeKeyのキーごと。メインスレッドだけが触る)
+    static std::unordered_map<std::string, std::weak_ptr<const SharedModel>> sharedModels_;
+
+private: //メンバ関数
+
+    /// <summary>
+    /// 生きている共有モデルを探す。無ければnullptr
+    /// </summary>
+    static std::shared_ptr<const SharedModel> FindSharedModel(const std::string& key);
+
+    /// <summary>
+    /// 読み込んだモデルから頂点・インデックスバッファとテクスチャを作り、共有モデルとして登録する
+    /// decodedTexturesにデコード済みの画像(テクスチャのパスごと)があればそれを使う(無ければここでデコードする)
+    /// </summary>
+    static std::shared_ptr<const SharedModel> CreateSharedModel(MeshAssetCache::Handle asset, std::unordered_map<std::string, DirectX::ScratchImage>* decodedTextures);
+
+    /// <summary>
+    /// 共有モデルを描くための、インスタンスごとのマテリアル・変換・ライト・カメラの定数バッファを作る
+    /// </summary>
+    void CreateInstance(std::shared_ptr<const SharedModel> sharedModel);
+
+    /// <summary>
+    /// 共有モデルとインスタンスごとのリソースを手放す(他に使う者がいなければ共有モデルも消える)
+    /// </summary>
+    void ReleaseResources();
+
 
 public: //メンバ関数
 
-    //デストラクタ
-    ~ObjClass() = default;
+    //デストラクタ(読み込み中なら結果を捨てる)
+    ~ObjClass() { if (loadRequest_) { loadRequest_->Cancel(); } }
 
     //初期化
     void Initialize(Camera* camera, const std::string& filename = "plane.obj");
 
+    /// <summary>
+    /// 読み込みをワーカーに任せて初期化する(すぐ戻る)
+    /// 読み込みとテクスチャのデコードはワーカー、GPUへの転送はAsyncModelLoader::Pollの中で行い、それまでは何も描かない
+    /// 終わったらonLoadedが呼ばれる。ローダーが無ければInitializeと同じく、この中で読み込む
+    /// </summary>
+    void InitializeAsync(Camera* camera, const std::string& filename = "plane.obj", std::function<void(ObjClass&)> onLoaded = nullptr);
+
+    // 読み込みが終わって描ける状態か(位置などのゲッター・セッターもそれまでは使えない)
+    bool IsLoaded() const { return isLoaded_; }
+
     void Update(const char* objName = " ");
 
     void Draw();
@@ -80,6 +203,12 @@ public: //メンバ関数
     static void SetTextureManager(TextureManager* texM) { textureManager_ = texM; }
     static void SetDrawManager(DrawManager* drawM) { drawManager_ = drawM; }
     static void SetDebugUI(DebugUI* ui) { ui_ = ui; }
+    static void SetJobSystem(JobSystem* jobSystem) { jobSystem_ = jobSystem; }
+    static void SetModelLoader(AsyncModelLoader* modelLoader) { modelLoader_ = modelLoader; }
+    static void SetMeshAssetCache(MeshAssetCache* assetCache) { assetCache_ = assetCache; }
+
+    // 生きている共有モデルの数(デバッグ表示用)
+    static size_t GetSharedModelCount();
 
 };
 
@@ -4,10 +4,14 @@
 #include "../externals/imgui/imgui.h"
 
 #include "engine/directX/DirectXCommon.h"
+#include "engine/JobSystem.h"
 
 #include <algorithm>
+#include <chrono>
 
-void ParticleClass::Initialize(const Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>& srvDescriptorHeap, Camera* camera, TextureManager* textureManager, DebugUI* ui, const std::string& textureName) {
+JobSystem* ParticleClass::jobSystem_ = nullptr;
+
+void ParticleClass::Initialize(const Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>& srvDescriptorHeap, Camera* camera, TextureManager* textureManager, DebugUI* ui, const std::string& textureName, const std::string& effectFilePath) {
 
     this->camera_ = camera;
     this->textureManager_ = textureManager;
@@ -16,31 +20,19 @@ void ParticleClass::Initialize(const Microsoft::WRL::ComPtr<ID3D12DescriptorHeap
     useBillbord_ = true;
     isUpdate_ = true;
 
-    randomEngine_.seed(seedGenerator_());
-
     // InstancingようのParticleForGPUリソースを作る
     instancingResource_ = resource_->GetDirectXCommon()->CreateBufferResource(sizeof(ParticleForGPU) * kNumMaxInstance_);
     // 書き込むためのアドレスを取得
     instancingResource_->Map(0, nullptr, reinterpret_cast<void**>(&instancingData_));
 
+    // 描画ごとの行列用リソース
+    viewResource_ = resource_->GetDirectXCommon()->CreateBufferResource(sizeof(ParticleViewForGPU));
+    viewResource_->Map(0, nullptr, reinterpret_cast<void**>(&viewData_));
 
-    // countが3コのemitterを作成しておく
-    emitter_.count = 3;
-    emitter_.frequency = 0.5f; // 0.5秒ごとに発生
-    emitter_.frequencyTime = 0.0f; // 発生頻度用の時刻、0で初期化
-    emitter_.transform.translate = { 0.0f,0.0f,0.0f };
-    emitter_.transform.rotate = { 0.0f,0.0f,0.0f };
-    emitter_.transform.scale = { 1.0f,1.0f,1.0f };
 
-    accelerationField_.acceleration = { 15.0f,0.0f,0.0f };
-    accelerationField_.area.min = { -1.0f,-1.0f,-1.0f };
-    accelerationField_.area.max = { 1.0f,1.0f,1.0f };
-
-    // 単位行列を書きこんでおく
-    particles_.clear();
-    for (uint32_t i = 0; i < kNumMaxInstance_; ++i) {
-        particles_.push_back(MakeNewParticle(randomEngine_, emitter_.transform.translate));
-    }
+    // エフェクトの読み込みと最初のburst分の発生
+    system_.SetJobSystem(jobSystem_);
+    system_.Initialize(effectFilePath, kNumMaxInstance_);
 
     /// カメラの回転を適用する
     billbordMatrix_ = Math::Multiply(backToFrontMatrix_, camera_->GetCameraMatrix());
@@ -48,21 +40,9 @@ void ParticleClass::Initialize(const Microsoft::WRL::ComPtr<ID3D12DescriptorHeap
     billbordMatrix_.m[3][1] = 0.0f;
     billbordMatrix_.m[3][2] = 0.0f;
 
-    for (std::list<Particle>::iterator particleIterator = particles_.begin(); particleIterator != particles_.end(); ++particleIterator) {
-        // 位置と速度を[-1,1]でランダムに初期化
-        Matrix4x4 scaleMatrix = Math::MakeScaleMatrix(particleIterator->transform.scale);
-        Matrix4x4 translateMatrix = Math::MakeTranslateMatrix(particleIterator->transform.translate);
-        Matrix4x4 worldMatrix = Math::MakeIdentity4x4();
-        if (useBillbord_) {
-            worldMatrix = Math::Multiply(Math::Multiply(scaleMatrix, billbordMatrix_), translateMatrix);
-        } else {
-            worldMatrix = Math::MakeAffineMatrix(particleIterator->transform.scale, particleIterator->transform.rotate, particleIterator->transform.translate);
-        }
-        Matrix4x4 worldViewProjectionMatrix = Math::Multiply(worldMatrix, Math::Multiply(camera_->GetViewMatrix(), camera_->GetPerspectiveFovMatrix()));
-        instancingData_[numInstance_].world = worldMatrix;
-        instancingData_[numInstance_].WVP = worldViewProjectionMatrix;
-        instancingData_[numInstance_].color = particleIterator->color;
-    }
+    viewData_->viewProjection = Math::Multiply(camera_->GetViewMatrix(), camera_->GetPerspectiveFovMatrix());
+    viewData_->billboard = billbordMatrix_;
+    system_.GetEffect().Pack(system_.GetParticles(), nullptr, 0, (std::min)(system_.GetParticles().count, static_cast<size_t>(kNumMaxInstance_)), instancingData_);
 
     D3D12_SHADER_RESOURCE_VIEW_DESC instancingDesc{};
     instancingDesc.Format = DXGI_FORMAT_UNKNOWN;
@@ -169,15 +149,24 @@ void ParticleClass::Update(const char* particleName) {
     //ウィンドウを作り出す
     ImGui::Begin(name.c_str());
 
-    if (ImGui::Button("Add Particle")) {
-        particles_.splice(particles_.end(), Emit(emitter_, randomEngine_));
+    if (ImGui::Button("Add Particle") && !system_.GetEmitterManager().GetEmitters().empty()) {
+        Emit(0, system_.GetEmitterManager().GetEmitters()[0].count);
     }
 
     ImGui::Checkbox("update", &isUpdate_);
 
+    bool useSimd = system_.GetUseSimd();
+    if (ImGui::Checkbox("useSimd", &useSimd)) {
+        system_.SetUseSimd(useSimd);
+    }
+    ImGui::SameLine();
+    ImGui::Text(ParticleKernel::IsAvx2Supported() ? "(AVX2)" : "(SSE)");
+
     ImGui::Checkbox("useBillbord", &useBillbord_);
 
-    ImGui::DragFloat3("EmitterTranslate", &emitter_.transform.translate.x, 0.01f, -100.0f, 100.0f);
+    DebugEmitters();
+
+    DebugEffect();
 
     ui_->DebugMaterialBy3D(resource_->materialData_);
 
@@ -185,101 +174,538 @@ void ParticleClass::Update(const char* particleName) {
 
     if (ImGui::CollapsingHeader("InstanceTransform")) {
 
-        uint32_t index = 0;
-
-        for (Particle& particle : particles_) {
+        for (size_t index = 0; index < system_.GetParticles().count; ++index) {
             char buf[16];
-            std::snprintf(buf, sizeof(buf), "%d", index++);
+            std::snprintf(buf, sizeof(buf), "%zu", index);
+            Particle particle = system_.GetParticles().Get(index);
             ui_->TextTransform(particle.transform, buf);
         }
     }
 
+    // 場のグリッド+SIMD版と、場の総当たり+スカラー版を同じ入力で回して結果を比較する
+    if (ImGui::Button("Verify Simd")) {
+        ParticleKernel::IntegrateParams params{};
+        params.deltaTime = ParticleSystem::kDeltaTime_;
+        system_.GetFieldGrid().RebuildIfDirty();
+        ParticleSoA simd = system_.GetParticles();
+        ParticleSoA scalar = simd;
+        system_.GetFieldGrid().Apply(simd, 0, simd.count, ParticleSystem::kDeltaTime_);
+        system_.GetFieldGrid().ApplyBruteForce(scalar, 0, scalar.count, ParticleSystem::kDeltaTime_);
+        ParticleKernel::Integrate(simd, 0, simd.PaddedCount(), params);
+        ParticleKernel::IntegrateScalar(scalar, 0, scalar.PaddedCount(), params);
+        simdMaxDifference_ = ParticleKernel::MaxDifference(simd, scalar);
+    }
+    ImGui::SameLine();
+    ImGui::Text("max diff: %g", simdMaxDifference_);
+
+    DebugAccelerationFields();
+
+    DebugCollision();
+
+    // スレッド数(0は全スレッド)と、1～Nスレッドでの処理時間
+    const int maxThreads = jobSystem_ ? static_cast<int>(jobSystem_->GetThreadCount()) : 1;
+    ImGui::SliderInt("threads", &threadCount_, 0, maxThreads);
+    if (ImGui::Button("Measure Scaling")) {
+        MeasureScaling();
+    }
+    for (size_t i = 0; i < scalingResults_.size(); ++i) {
+        ImGui::Text("%zu thread(s): %.3f ms (x%.2f)", i + 1, scalingResults_[i], scalingResults_[0] / scalingResults_[i]);
+    }
+
+    // 既定のエミッタを固定シードで回し、最後の状態のチェックサムを見る(最適化で挙動が変わっていないかの確認)
+    if (ImGui::Button("Run Benchmark")) {
+        ParticleBenchmark::Settings settings;
+        settings.frameCount = 120;
+        settings.maxThreads = static_cast<uint32_t>(threadCount_);
+        settings.useSimd = system_.GetUseSimd();
+        benchmarkResult_ = ParticleBenchmark::Run(settings, jobSystem_);
+    }
+    ImGui::Text("frame: %.3f ms (max %.3f ms) spawned: %llu peak: %zu memory: %.2f MB", benchmarkResult_.averageFrameMs, benchmarkResult_.maxFrameMs, static_cast<unsigned long long>(benchmarkResult_.spawnedCount), benchmarkResult_.peakAliveCount, benchmarkResult_.memoryBytes / (1024.0 * 1024.0));
+    ImGui::Text("checksum: %016llx", static_cast<unsigned long long>(benchmarkResult_.checksum));
+
+    // インスタンスの転送量と書き込み時間
+    ImGui::Text("instance: %zu bytes x %u = %zu bytes/frame", sizeof(ParticleForGPU), numInstance_, sizeof(ParticleForGPU) * numInstance_);
+    ImGui::Text("spawn: %.3f ms simulate: %.3f ms pack: %.3f ms", system_.GetSpawnTimeMs(), system_.GetSimulateTimeMs(), system_.GetPackTimeMs());
+
+    // カリング
+    bool useCulling = system_.GetUseCulling();
+    if (ImGui::Checkbox("useCulling", &useCulling)) {
+        system_.SetUseCulling(useCulling);
+    }
+    ImGui::SameLine();
+    float minPixelSize = system_.GetMinPixelSize();
+    if (ImGui::DragFloat("minPixelSize", &minPixelSize, 0.01f, 0.0f, 16.0f)) {
+        system_.SetMinPixelSize(minPixelSize);
+    }
+    const ParticleUpdater::CullStats& cullStats = system_.GetCullStats();
+    ImGui::Text("alive: %zu visible: %zu cull: %.3f ms", system_.GetParticles().count, useCulling ? cullStats.visible : system_.GetParticles().count, system_.GetCullTimeMs());
+    ImGui::Text("culled chunk: %zu (%zu chunks) frustum: %zu size: %zu", cullStats.chunkCulled, cullStats.culledChunks, cullStats.frustumCulled, cullStats.sizeCulled);
+
+    // 奥から手前へのソート
+    bool sortByDepth = system_.GetSortByDepth();
+    if (ImGui::Checkbox("sortByDepth", &sortByDepth)) {
+        system_.SetSortByDepth(sortByDepth);
+    }
+    int sortKeyBits = static_cast<int>(system_.GetSortKeyBits());
+    ImGui::SameLine();
+    ImGui::RadioButton("16bit", &sortKeyBits, 16);
+    ImGui::SameLine();
+    ImGui::RadioButton("32bit", &sortKeyBits, 32);
+    system_.SetSortKeyBits(static_cast<uint32_t>(sortKeyBits));
+    ImGui::Text("sort: %.3f ms", system_.GetSortTimeMs());
+    if (ImGui::Button("Measure Sort")) {
+        MeasureSort();
+    }
+    for (const SortBenchmark& result : sortResults_) {
+        ImGui::Text("%7zu: radix16 %.2f ms radix32 %.2f ms std::sort %.2f ms %s", result.count, result.radix16Ms, result.radix32Ms, result.stdSortMs, result.isSorted ? "" : "(NOT SORTED)");
+    }
+
     //入力終了
     ImGui::End();
 
 #endif // _DEBUG
 
-    if (isUpdate_) {
-        emitter_.frequencyTime += kDeltatime_; // 時刻を進める
-        if (emitter_.frequency <= emitter_.frequencyTime) { // 頻度より大きいなら発生
-            particles_.splice(particles_.end(), Emit(emitter_, randomEngine_)); // 発生処理
-            emitter_.frequencyTime -= emitter_.frequency; // 余計に過ぎた時間も加味して頻度計算する
-        }
-    }
-
     /// カメラの回転を適用する
     billbordMatrix_ = Math::Multiply(backToFrontMatrix_, camera_->GetCameraMatrix());
     billbordMatrix_.m[3][0] = 0.0f;
     billbordMatrix_.m[3][1] = 0.0f;
     billbordMatrix_.m[3][2] = 0.0f;
 
-    numInstance_ = 0; // 描画すべきインスタンス数
+    // ViewProjectionとビルボードは描画ごとに1回だけ送り、頂点シェーダで適用する
+    viewData_->viewProjection = Math::Multiply(camera_->GetViewMatrix(), camera_->GetPerspectiveFovMatrix());
+    viewData_->billboard = useBillbord_ ? billbordMatrix_ : Math::MakeIdentity4x4();
+
+    // 発生とシミュレーション(止めている間もEmitした分は出す)
+    numInstance_ = static_cast<uint32_t>(system_.Update(MakeView(), instancingData_, kNumMaxInstance_, isUpdate_, static_cast<uint32_t>(threadCount_))); // 描画すべきインスタンス数
+
+    resource_->materialData_->uvTransform = Math::MakeAffineMatrix(resource_->uvTransform_.scale, resource_->uvTransform_.rotate, resource_->uvTransform_.translate);
+
+}
 
-    for (std::list<Particle>::iterator particleIterator = particles_.begin(); particleIterator != particles_.end();) {
+void ParticleClass::Emit(uint32_t emitterIndex, uint32_t count) {
+    system_.GetEmitterManager().Burst(emitterIndex, count);
+}
 
-        if ((*particleIterator).lifeTime <= (*particleIterator).currentTime) { // 生存時間を過ぎていたら更新せず描画対象にしない
-            particleIterator = particles_.erase(particleIterator); // 生存時間が過ぎたParticleはlistから消す。戻り値が次のイテレーターとなる
-            continue;
+ParticleSystem::View ParticleClass::MakeView() const {
+    ParticleSystem::View view;
+    view.viewMatrix = camera_->GetViewMatrix();
+    view.viewProjection = Math::Multiply(camera_->GetViewMatrix(), camera_->GetPerspectiveFovMatrix());
+    view.viewportHeight = camera_->GetViewportHeight();
+    return view;
+}
+
+void ParticleClass::MeasureScaling() {
+    // 計測用に十分な数のパーティクルを固定シードで作る
+    static const size_t kMeasureParticleCount = 200000;
+    static const uint32_t kMeasureFrames = 30;
+
+    Emitter emitter{};
+    emitter.seed = 12345;
+    ParticleSoA source;
+    source.Resize(kMeasureParticleCount);
+    ParticleEmitterManager::Spawn(emitter, 0, kMeasureParticleCount, source, 0, jobSystem_);
+    std::vector<ParticleForGPU> instances(kMeasureParticleCount);
+
+    const ParticleSystem::View view = MakeView();
+    scalingResults_.clear();
+    const uint32_t maxThreads = jobSystem_ ? jobSystem_->GetThreadCount() : 1;
+    for (uint32_t threads = 1; threads <= maxThreads; ++threads) {
+        ParticleSoA particles = source;
+        ParticleSoA scratch;
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t frame = 0; frame < kMeasureFrames; ++frame) {
+            system_.Simulate(particles, scratch, view, instances.data(), static_cast<uint32_t>(instances.size()), true, threads);
         }
+        const auto end = std::chrono::steady_clock::now();
+        scalingResults_.push_back(std::chrono::duration<float, std::milli>(end - start).count() / kMeasureFrames);
+    }
+}
 
-        if (numInstance_ < kNumMaxInstance_) {
+void ParticleClass::DebugAccelerationFields() {
+#if defined(_DEBUG) || defined(DEVELOPMENT)
+    if (!ImGui::CollapsingHeader("AccelerationFields")) {
+        return;
+    }
 
-            if (Math::IsCollision(accelerationField_.area, (*particleIterator).transform.translate)) {
-                (*particleIterator).velocity += accelerationField_.acceleration * kDeltatime_;
-            }
+    static const char* kTypeNames[] = { "Constant", "Radial", "Vortex", "Drag" };
 
-            if (isUpdate_) {
-                particleIterator->currentTime += kDeltatime_; // 経過時間を足す
-                particleIterator->transform.translate += particleIterator->velocity * kDeltatime_;  // 速度を反映させる
-            }
+    if (ImGui::Button("Add Field")) {
+        AccelerationField field{};
+        field.area.min = { -1.0f,-1.0f,-1.0f };
+        field.area.max = { 1.0f,1.0f,1.0f };
+        system_.GetFieldGrid().AddField(field);
+    }
 
-            float alpha = 1.0f - (particleIterator->currentTime / particleIterator->lifeTime);
-            Matrix4x4 scaleMatrix = Math::MakeScaleMatrix(particleIterator->transform.scale);
-            Matrix4x4 translateMatrix = Math::MakeTranslateMatrix(particleIterator->transform.translate);
-            Matrix4x4 worldMatrix = Math::MakeIdentity4x4();
-            if (useBillbord_) {
-                worldMatrix = Math::Multiply(Math::Multiply(scaleMatrix, billbordMatrix_), translateMatrix);
-            } else {
-                worldMatrix = Math::MakeAffineMatrix(particleIterator->transform.scale, particleIterator->transform.rotate, particleIterator->transform.translate);
+    std::vector<AccelerationField>& fields = system_.GetFieldGrid().GetFields();
+    bool isChanged = false;
+    for (size_t index = 0; index < fields.size(); ++index) {
+        AccelerationField& field = fields[index];
+        ImGui::PushID(static_cast<int>(index));
+        char label[32];
+        std::snprintf(label, sizeof(label), "Field %zu", index);
+        if (ImGui::TreeNode(label)) {
+            int type = static_cast<int>(field.type);
+            if (ImGui::Combo("type", &type, kTypeNames, static_cast<int>(AccelerationFieldType::kCountOfAccelerationFieldType))) {
+                field.type = static_cast<AccelerationFieldType>(type);
+                isChanged = true;
+            }
+            isChanged |= ImGui::DragFloat3("areaMin", &field.area.min.x, 0.01f);
+            isChanged |= ImGui::DragFloat3("areaMax", &field.area.max.x, 0.01f);
+            switch (field.type) {
+            case AccelerationFieldType::kAccelerationFieldConstant:
+                isChanged |= ImGui::DragFloat3("acceleration", &field.acceleration.x, 0.01f);
+                break;
+            case AccelerationFieldType::kAccelerationFieldVortex:
+                if (ImGui::DragFloat3("axis", &field.axis.x, 0.01f)) {
+                    field.axis = Math::Normalize(field.axis);
+                    isChanged = true;
+                }
+                [[fallthrough]];
+            case AccelerationFieldType::kAccelerationFieldRadial:
+                isChanged |= ImGui::DragFloat3("center", &field.center.x, 0.01f);
+                [[fallthrough]];
+            default:
+                isChanged |= ImGui::DragFloat("strength", &field.strength, 0.01f);
+                break;
             }
-            Matrix4x4 worldViewProjectionMatrix = Math::Multiply(worldMatrix, Math::Multiply(camera_->GetViewMatrix(), camera_->GetPerspectiveFovMatrix()));
-            instancingData_[numInstance_].world = worldMatrix;
-            instancingData_[numInstance_].WVP = worldViewProjectionMatrix;
-            instancingData_[numInstance_].color = particleIterator->color;
-            instancingData_[numInstance_].color.w = alpha;
+            if (ImGui::Button("Remove")) {
+                ImGui::TreePop();
+                ImGui::PopID();
+                system_.GetFieldGrid().RemoveField(index);
+                break;
+            }
+            ImGui::TreePop();
+        }
+        ImGui::PopID();
+    }
+    if (isChanged) {
+        system_.GetFieldGrid().MarkDirty();
+    }
+
+    float cellSize = system_.GetFieldGrid().GetCellSize();
+    if (ImGui::DragFloat("cellSize", &cellSize, 0.1f, 0.1f, 100.0f)) {
+        system_.GetFieldGrid().SetCellSize((std::max)(cellSize, 0.1f));
+    }
+    ImGui::Text("fields: %zu cells: %zu global: %zu", fields.size(), system_.GetFieldGrid().GetCellCount(), system_.GetFieldGrid().GetGlobalFieldCount());
 
-            numInstance_++; // 生きているParticleの数を1つカウントする
+    if (ImGui::Button("Measure Field Lookup")) {
+        MeasureFieldLookup();
+    }
+    ImGui::Text("grid: %.3f ms brute force: %.3f ms max diff: %g", fieldGridTimeMs_, fieldBruteForceTimeMs_, fieldMaxDifference_);
+#endif // _DEBUG
+}
 
+void ParticleClass::MeasureFieldLookup() {
+    static const size_t kMeasureParticleCount = 200000;
+
+    // 場の範囲全体に散らばるように位置を決める
+    system_.GetFieldGrid().RebuildIfDirty();
+    Vector3 areaMin = { -1.0f,-1.0f,-1.0f };
+    Vector3 areaMax = { 1.0f,1.0f,1.0f };
+    for (const AccelerationField& field : system_.GetFieldGrid().GetFields()) {
+        areaMin = { (std::min)(areaMin.x, field.area.min.x), (std::min)(areaMin.y, field.area.min.y), (std::min)(areaMin.z, field.area.min.z) };
+        areaMax = { (std::max)(areaMax.x, field.area.max.x), (std::max)(areaMax.y, field.area.max.y), (std::max)(areaMax.z, field.area.max.z) };
+    }
+    Emitter emitter{};
+    emitter.seed = 12345;
+    emitter.shape = EmitterShape::kEmitterShapeBox;
+    emitter.transform.translate = { (areaMin.x + areaMax.x) * 0.5f, (areaMin.y + areaMax.y) * 0.5f, (areaMin.z + areaMax.z) * 0.5f };
+    emitter.shapeSize = { (areaMax.x - areaMin.x) * 0.5f, (areaMax.y - areaMin.y) * 0.5f, (areaMax.z - areaMin.z) * 0.5f };
+    ParticleSoA source;
+    source.Resize(kMeasureParticleCount);
+    ParticleEmitterManager::Spawn(emitter, 0, kMeasureParticleCount, source, 0, jobSystem_);
+
+    ParticleSoA grid = source;
+    auto start = std::chrono::steady_clock::now();
+    system_.GetFieldGrid().Apply(grid, 0, grid.count, ParticleSystem::kDeltaTime_);
+    fieldGridTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    ParticleSoA bruteForce = source;
+    start = std::chrono::steady_clock::now();
+    system_.GetFieldGrid().ApplyBruteForce(bruteForce, 0, bruteForce.count, ParticleSystem::kDeltaTime_);
+    fieldBruteForceTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    fieldMaxDifference_ = ParticleKernel::MaxDifference(grid, bruteForce);
+}
+
+void ParticleClass::DebugEmitters() {
+#if defined(_DEBUG) || defined(DEVELOPMENT)
+    if (!ImGui::CollapsingHeader("Emitters")) {
+        return;
+    }
+
+    static const char* kShapeNames[] = { "Point", "Box", "Sphere" };
+
+    std::vector<Emitter>& emitters = system_.GetEmitterManager().GetEmitters();
+    if (ImGui::Button("Add Emitter")) {
+        selectedEmitterIndex_ = static_cast<int>(system_.GetEmitterManager().AddEmitter(Emitter{}));
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset")) {
+        // 乱数のカウンタを巻き戻すので、同じ操作をすれば同じパーティクルが出る
+        system_.GetParticles().Clear();
+        system_.GetEmitterManager().Reset();
+    }
+    if (emitters.empty()) {
+        return;
+    }
+
+    selectedEmitterIndex_ = std::clamp(selectedEmitterIndex_, 0, static_cast<int>(emitters.size()) - 1);
+    const uint32_t index = static_cast<uint32_t>(selectedEmitterIndex_);
+    if (ImGui::BeginCombo("emitter", system_.GetEmitterManager().GetName(index).c_str())) {
+        for (uint32_t i = 0; i < static_cast<uint32_t>(emitters.size()); ++i) {
+            if (ImGui::Selectable(system_.GetEmitterManager().GetName(i).c_str(), i == index)) {
+                selectedEmitterIndex_ = static_cast<int>(i);
+            }
         }
+        ImGui::EndCombo();
+    }
 
-        ++particleIterator; // 次のイテレーターに進める
+    Emitter& emitter = emitters[index];
+    ImGui::Checkbox("active", &emitter.isActive);
+    ImGui::DragFloat3("EmitterTranslate", &emitter.transform.translate.x, 0.01f, -100.0f, 100.0f);
+    int shape = static_cast<int>(emitter.shape);
+    if (ImGui::Combo("shape", &shape, kShapeNames, static_cast<int>(EmitterShape::kCountOfEmitterShape))) {
+        emitter.shape = static_cast<EmitterShape>(shape);
+    }
+    ImGui::DragFloat3("shapeSize", &emitter.shapeSize.x, 0.01f, 0.0f, 100.0f);
+    int count = static_cast<int>(emitter.count);
+    if (ImGui::DragInt("count", &count, 1.0f, 0, 10000)) {
+        emitter.count = static_cast<uint32_t>((std::max)(count, 0));
+    }
+    ImGui::DragFloat("frequency", &emitter.frequency, 0.01f, 0.0f, 10.0f);
+    ImGui::DragFloatRange2("lifeTime", &emitter.lifeTimeMin, &emitter.lifeTimeMax, 0.01f, 0.0f, 100.0f);
+    ImGui::DragFloat3("velocityMin", &emitter.velocityMin.x, 0.01f);
+    ImGui::DragFloat3("velocityMax", &emitter.velocityMax.x, 0.01f);
+    ImGui::ColorEdit4("colorMin", &emitter.colorMin.x);
+    ImGui::ColorEdit4("colorMax", &emitter.colorMax.x);
+    ImGui::Text("seed: %llu spawned: %llu", static_cast<unsigned long long>(emitter.seed), static_cast<unsigned long long>(emitter.spawnedCount));
+    if (ImGui::Button("Burst")) {
+        Emit(index, emitter.count);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Remove Emitter")) {
+        system_.GetEmitterManager().RemoveEmitter(index);
+        return;
     }
 
-    resource_->materialData_->uvTransform = Math::MakeAffineMatrix(resource_->uvTransform_.scale, resource_->uvTransform_.rotate, resource_->uvTransform_.translate);
+    // 1スレッドと全スレッドで同じパーティクルが出るかを確かめる
+    if (ImGui::Button("Verify Spawn")) {
+        static const size_t kVerifyCount = 100000;
+        ParticleSoA single;
+        ParticleSoA multi;
+        single.Resize(kVerifyCount);
+        multi.Resize(kVerifyCount);
+        ParticleEmitterManager::Spawn(emitter, 0, kVerifyCount, single, 0, jobSystem_, 1);
+        ParticleEmitterManager::Spawn(emitter, 0, kVerifyCount, multi, 0, jobSystem_, 0);
+        spawnMaxDifference_ = ParticleKernel::MaxDifference(single, multi);
+    }
+    ImGui::SameLine();
+    ImGui::Text("max diff: %g", spawnMaxDifference_);
+    ImGui::Text("spawned last frame: %zu", system_.GetEmitterManager().GetLastSpawnCount());
+#endif // _DEBUG
+}
+
+void ParticleClass::DebugEffect() {
+#if defined(_DEBUG) || defined(DEVELOPMENT)
+    if (!ImGui::CollapsingHeader("Effect")) {
+        return;
+    }
+
+    static const char* kModuleNames[] = { "Force", "Drag", "Noise", "ColorOverLife", "SizeOverLife" };
+
+    ImGui::Text("effect: %s", system_.GetEffect().GetName().c_str());
+
+    // 切り替えたらまとめ直す
+    bool isChanged = false;
+    std::vector<ParticleModule>& modules = system_.GetEffect().GetModules();
+    for (size_t index = 0; index < modules.size(); ++index) {
+        ParticleModule& module = modules[index];
+        ImGui::PushID(static_cast<int>(index));
+        isChanged |= ImGui::Checkbox(kModuleNames[static_cast<size_t>(module.type)], &module.isEnabled);
+        switch (module.type) {
+        case ParticleModuleType::kParticleModuleForce:
+            if (module.values.size() >= 3) {
+                isChanged |= ImGui::DragFloat3("force", module.values.data(), 0.01f);
+            }
+            break;
+        case ParticleModuleType::kParticleModuleDrag:
+            if (!module.values.empty()) {
+                isChanged |= ImGui::DragFloat("drag", module.values.data(), 0.01f, 0.0f, 100.0f);
+            }
+            break;
+        case ParticleModuleType::kParticleModuleNoise:
+            if (module.values.size() >= 2) {
+                isChanged |= ImGui::DragFloat2("strength/frequency", module.values.data(), 0.01f, 0.0f, 100.0f);
+            }
+            break;
+        default:
+            ImGui::SameLine();
+            ImGui::Text("(%zu keys)", module.values.size() / (module.type == ParticleModuleType::kParticleModuleColorOverLife ? 5 : 2));
+            break;
+        }
+        ImGui::PopID();
+    }
+    if (isChanged) {
+        system_.GetEffect().Compile();
+    }
 
+    ImGui::Text("modules: %zu -> passes: %u", modules.size(), system_.GetEffect().GetPassCount());
+
+    // 10万個でupdate/書き込みにかかる時間
+    if (ImGui::Button("Measure Effect")) {
+        static const size_t kMeasureCount = 100000;
+        Emitter emitter{};
+        emitter.seed = 12345;
+        ParticleSoA particles;
+        particles.Resize(kMeasureCount);
+        ParticleEmitterManager::Spawn(emitter, 0, kMeasureCount, particles, 0, jobSystem_);
+        std::vector<ParticleForGPU> instances(kMeasureCount);
+
+        auto start = std::chrono::steady_clock::now();
+        system_.GetEffect().Update(particles, 0, kMeasureCount, ParticleSystem::kDeltaTime_);
+        effectUpdateTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        system_.GetEffect().Pack(particles, nullptr, 0, kMeasureCount, instances.data());
+        effectPackTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    ImGui::SameLine();
+    ImGui::Text("update: %.3f ms pack: %.3f ms (100k)", effectUpdateTimeMs_, effectPackTimeMs_);
+#endif // _DEBUG
 }
 
-Particle ParticleClass::MakeNewParticle(std::mt19937& randomEngine, const Vector3& translate) {
-    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
-    std::uniform_real_distribution<float> distColor(0.0f, 1.0f);
-    std::uniform_real_distribution<float> distTime(1.0f, 3.0f);
-    Particle particle;
-    particle.transform.scale = { 1.0f,1.0f,1.0f };
-    particle.transform.rotate = { 0.0f,0.0f,0.0f };
-    Vector3 randomTranslate = { distribution(randomEngine),distribution(randomEngine) ,distribution(randomEngine) };
-    particle.transform.translate = translate + randomTranslate;
-    particle.velocity = { distribution(randomEngine),distribution(randomEngine),distribution(randomEngine) };
-    particle.color = { distColor(randomEngine),distColor(randomEngine),distColor(randomEngine) ,1.0f };
-    particle.lifeTime = distTime(randomEngine);
-    particle.currentTime = 0.0f;
-
-    return particle;
+void ParticleClass::MeasureSort() {
+    static const size_t kMeasureCounts[] = { 100000, 250000, 500000, 1000000 };
+
+    // カメラの前方に広く散らばるように発生させる
+    Emitter emitter{};
+    emitter.seed = 12345;
+    emitter.shape = EmitterShape::kEmitterShapeBox;
+    emitter.shapeSize = { 50.0f,50.0f,50.0f };
+
+    const Matrix4x4 viewMatrix = camera_->GetViewMatrix();
+    sortResults_.clear();
+    for (size_t count : kMeasureCounts) {
+        ParticleSoA particles;
+        particles.Resize(count);
+        ParticleEmitterManager::Spawn(emitter, 0, count, particles, 0, jobSystem_);
+
+        SortBenchmark result;
+        result.count = count;
+
+        ParticleSorter sorter;
+        auto start = std::chrono::steady_clock::now();
+        sorter.Sort(particles, viewMatrix, 16, jobSystem_);
+        result.radix16Ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        result.isSorted = sorter.IsSorted();
+
+        start = std::chrono::steady_clock::now();
+        sorter.Sort(particles, viewMatrix, 32, jobSystem_);
+        result.radix32Ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        result.isSorted = result.isSorted && sorter.IsSorted();
+
+        // 比較用: 深度を求めてstd::sortで並べる
+        start = std::chrono::steady_clock::now();
+        std::vector<std::pair<float, uint32_t>> depths(count);
+        for (size_t i = 0; i < count; ++i) {
+            const float depth = particles.translateX[i] * viewMatrix.m[0][2] + particles.translateY[i] * viewMatrix.m[1][2] + particles.translateZ[i] * viewMatrix.m[2][2] + viewMatrix.m[3][2];
+            depths[i] = { depth, static_cast<uint32_t>(i) };
+        }
+        std::sort(depths.begin(), depths.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+        result.stdSortMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        sortResults_.push_back(result);
+    }
 }
 
-std::list<Particle> ParticleClass::Emit(const Emitter& emitter, std::mt19937& randomEngine) {
-    std::list<Particle> particles;
-    for (uint32_t count = 0; count < emitter.count; ++count) {
-        particles.push_back(MakeNewParticle(randomEngine, emitter.transform.translate));
+void ParticleClass::DebugCollision() {
+#if defined(_DEBUG) || defined(DEVELOPMENT)
+    if (!ImGui::CollapsingHeader("Collision")) {
+        return;
+    }
+
+    static const char* kResponseNames[] = { "Bounce", "Kill" };
+
+    int response = static_cast<int>(system_.GetCollider().GetResponse());
+    if (ImGui::Combo("response", &response, kResponseNames, static_cast<int>(CollisionResponse::kCountOfCollisionResponse))) {
+        system_.GetCollider().SetResponse(static_cast<CollisionResponse>(response));
+    }
+    float restitution = system_.GetCollider().GetRestitution();
+    if (ImGui::SliderFloat("restitution", &restitution, 0.0f, 1.0f)) {
+        system_.GetCollider().SetRestitution(restitution);
+    }
+    float friction = system_.GetCollider().GetFriction();
+    if (ImGui::SliderFloat("friction", &friction, 0.0f, 1.0f)) {
+        system_.GetCollider().SetFriction(friction);
+    }
+
+    // 平面
+    std::vector<Plane>& planes = system_.GetCollider().GetPlanes();
+    if (ImGui::Button("Add Plane")) {
+        planes.push_back({ { 0.0f,1.0f,0.0f }, 0.0f });
+    }
+    for (size_t index = 0; index < planes.size(); ++index) {
+        ImGui::PushID(static_cast<int>(index));
+        if (ImGui::DragFloat3("plane normal", &planes[index].normal.x, 0.01f)) {
+            planes[index].normal = Math::Normalize(planes[index].normal);
+        }
+        ImGui::DragFloat("plane distance", &planes[index].distance, 0.01f);
+        if (ImGui::Button("Remove Plane")) {
+            planes.erase(planes.begin() + index);
+            ImGui::PopID();
+            break;
+        }
+        ImGui::PopID();
+    }
+
+    // 球
+    std::vector<Sphere>& spheres = system_.GetCollider().GetSpheres();
+    if (ImGui::Button("Add Sphere")) {
+        spheres.push_back(Sphere{});
+    }
+    for (size_t index = 0; index < spheres.size(); ++index) {
+        ImGui::PushID(static_cast<int>(planes.size() + index));
+        ImGui::DragFloat3("sphere center", &spheres[index].center.x, 0.01f);
+        ImGui::DragFloat("sphere radius", &spheres[index].radius, 0.01f, 0.0f, 100.0f);
+        if (ImGui::Button("Remove Sphere")) {
+            spheres.erase(spheres.begin() + index);
+            ImGui::PopID();
+            break;
+        }
+        ImGui::PopID();
+    }
+
+    // 高さ格子(確認用に波打った地形を作る)
+    bool useHeightField = system_.GetCollider().GetHeightField() != nullptr;
+    if (ImGui::Checkbox("useHeightField", &useHeightField)) {
+        if (useHeightField) {
+            static const uint32_t kSize = 64;
+            heightField_.origin = { -16.0f,-2.0f,-16.0f };
+            heightField_.cellSize = 0.5f;
+            heightField_.width = kSize;
+            heightField_.depth = kSize;
+            heightField_.heights.resize(kSize * kSize);
+            for (uint32_t z = 0; z < kSize; ++z) {
+                for (uint32_t x = 0; x < kSize; ++x) {
+                    heightField_.heights[z * kSize + x] = 0.5f * std::sin(x * 0.3f) * std::cos(z * 0.3f);
+                }
+            }
+            system_.GetCollider().SetHeightField(&heightField_);
+        } else {
+            system_.GetCollider().SetHeightField(nullptr);
+        }
     }
-    return particles;
-}
\ No newline at end of file
+
+    // SIMD版とスカラー版を同じ入力で回して結果を比較する
+    if (ImGui::Button("Verify Collision")) {
+        ParticleSoA simd = system_.GetParticles();
+        ParticleSoA scalar = system_.GetParticles();
+        system_.GetCollider().Collide(simd, 0, simd.PaddedCount());
+        system_.GetCollider().CollideScalar(scalar, 0, scalar.PaddedCount());
+        collisionMaxDifference_ = ParticleKernel::MaxDifference(simd, scalar);
+    }
+    ImGui::SameLine();
+    ImGui::Text("max diff: %g", collisionMaxDifference_);
+#endif // _DEBUG
+}
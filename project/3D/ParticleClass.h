@@ -5,6 +5,8 @@
 #include "../manager/TextureManager.h"
 #include "../manager/DebugUI.h"
 #include "../math/shape/Particle.h"
+#include "particle/ParticleSystem.h"
+#include "particle/ParticleBenchmark.h"
 #include "../math/shape/ParticleForGPU.h"
 #include "../math/Emitter.h"
 #include "../math/AccelerationField.h"
@@ -13,10 +15,11 @@
 #include <memory>
 #include <cstdint>
 #include <numbers>
-#include <list>
+#include <vector>
 
-#include <random>
 
+// 前方宣言
+class JobSystem;
 
 class ParticleClass {
 private: // メンバ変数
@@ -33,7 +36,13 @@ private: // メンバ変数
 
     D3D12_GPU_DESCRIPTOR_HANDLE instancingSrvHandleGPU_{};
 
-    std::list<Particle> particles_;
+    // 描画ごとのViewProjection/ビルボード行列
+    Microsoft::WRL::ComPtr<ID3D12Resource> viewResource_ = nullptr;
+
+    ParticleViewForGPU* viewData_ = nullptr;
+
+    // シミュレーション本体(GPUのリソースには触らない)
+    ParticleSystem system_;
 
     std::unique_ptr<D3D12ResourceUtilParticle> resource_ = nullptr;
 
@@ -42,15 +51,21 @@ private: // メンバ変数
 
     int selectedTextureIndex_ = 0;
 
-    // デルタタイム
-    static inline const float kDeltatime_ = 1.0f / 60.0f;
+    // 編集中のエミッタ
+    int selectedEmitterIndex_ = 0;
+
+    // スレッド数を変えて発生させた結果の最大誤差
+    float spawnMaxDifference_ = 0.0f;
 
-    std::random_device seedGenerator_;
-    std::mt19937 randomEngine_;
+    // 10万個でエフェクトのupdate/書き込みにかかった時間(ms)
+    float effectUpdateTimeMs_ = 0.0f;
+    float effectPackTimeMs_ = 0.0f;
 
-    Emitter emitter_{};
+    // 確認用の高さ格子
+    HeightField heightField_;
 
-    AccelerationField accelerationField_{};
+    // SIMD版とスカラー版の衝突結果の最大誤差
+    float collisionMaxDifference_ = 0.0f;
 
     // ポインタ参照
 
@@ -64,12 +79,85 @@ private: // メンバ変数
 
     bool isUpdate_ = true;
 
+    // SIMD版とスカラー版の最大誤差(デバッグ表示用)
+    float simdMaxDifference_ = 0.0f;
+
+    // 更新に使うスレッド数(0なら全スレッド)
+    int threadCount_ = 0;
+
+    // スレッド数1～Nそれぞれの1フレームあたりの処理時間(ms)
+    std::vector<float> scalingResults_;
+
+    // 固定シードで回した計測の結果
+    ParticleBenchmark::Result benchmarkResult_{};
+
+    // パーティクル数ごとのソート時間(ms)
+    struct SortBenchmark {
+        size_t count = 0;
+        float radix16Ms = 0.0f;
+        float radix32Ms = 0.0f;
+        float stdSortMs = 0.0f;
+        bool isSorted = false;
+    };
+    std::vector<SortBenchmark> sortResults_;
+
+    // 場の引き方ごとの処理時間(ms)と結果の最大誤差
+    float fieldGridTimeMs_ = 0.0f;
+    float fieldBruteForceTimeMs_ = 0.0f;
+    float fieldMaxDifference_ = 0.0f;
+
+    // ワーカースレッド(nullptrなら呼び出し元だけで処理)
+    static JobSystem* jobSystem_;
+
+private: // メンバ関数
+
+    /// <summary>
+    /// カメラからカリング・ソート用の値を作る
+    /// </summary>
+    ParticleSystem::View MakeView() const;
+
+    /// <summary>
+    /// スレッド数1～Nでの処理時間を計測する
+    /// </summary>
+    void MeasureScaling();
+
+    /// <summary>
+    /// 加速度場の編集UI
+    /// </summary>
+    void DebugAccelerationFields();
+
+    /// <summary>
+    /// 衝突の編集UI
+    /// </summary>
+    void DebugCollision();
+
+    /// <summary>
+    /// グリッドと総当たりで場を評価して処理時間と結果を比較する
+    /// </summary>
+    void MeasureFieldLookup();
+
+    /// <summary>
+    /// エミッタの編集UI
+    /// </summary>
+    void DebugEmitters();
+
+    /// <summary>
+    /// 10万～100万個でのソート時間を計測する
+    /// </summary>
+    void MeasureSort();
+
+    /// <summary>
+    /// エフェクトのモジュールの編集UI
+    /// </summary>
+    void DebugEffect();
+
 public: // メンバ関数
 
     /// <summary>
     /// 初期化
     /// </summary>
-    void Initialize(const Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>& srvDescriptorHeap, Camera* camera, TextureManager* textureManager, DebugUI* ui, const std::string& textureName = "resources/circle.png");
+    /// <param name="effectFilePath">エフェクト定義ファイル(空なら既定のエミッタを1つ作る)</param>
+    void Initialize(const Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>& srvDescriptorHeap, Camera* camera, TextureManager* textureManager, DebugUI* ui, const std::string& textureName = "resources/circle.png", const std::string& effectFilePath = "");
 
     /// <summary>
     /// 更新
@@ -81,13 +169,22 @@ public: // メンバ関数
     /// </summary>
     void Draw();
 
-    Particle MakeNewParticle(std::mt19937& randomEngine, const Vector3& translate);
-
-    std::list<Particle> Emit(const Emitter& emitter, std::mt19937& randomEngine);
+    /// <summary>
+    /// 指定エミッタから次のUpdateでcount個発生させる
+    /// </summary>
+    void Emit(uint32_t emitterIndex, uint32_t count);
 
     //ゲッター
     D3D12ResourceUtilParticle* GetD3D12Resource() { return this->resource_.get(); }
     int32_t GetInstanceCount() const { return this->numInstance_; }
     D3D12_GPU_DESCRIPTOR_HANDLE GetInstancingSrvHandleGPU() const { return instancingSrvHandleGPU_; }
+    ID3D12Resource* GetViewResource() const { return viewResource_.Get(); }
+    ParticleSystem& GetSystem() { return system_; }
+    AccelerationFieldGrid& GetFieldGrid() { return system_.GetFieldGrid(); }
+    ParticleEmitterManager& GetEmitterManager() { return system_.GetEmitterManager(); }
+    ParticleCollider& GetCollider() { return system_.GetCollider(); }
+    ParticleEffect& GetEffect() { return system_.GetEffect(); }
+
+    static void SetJobSystem(JobSystem* jobSystem) { jobSystem_ = jobSystem; }
 };
 
@@ -5,7 +5,8 @@
 #include "engine/directX/DirectXCommon.h"
 #include "camera/Camera.h"
 #include "manager/TextureManager.h"
-#include "function/Function.h" // LoadObjFileM, 型定義
+#include "function/Function.h" // 型定義
+#include "3D/mesh/MeshCache.h"
 #include "function/Math.h"
 #include "math/Transform.h"
 #include "math/Material.h"   // Material
@@ -22,7 +23,7 @@ void Region::Initialize(
     camera_ = camera;
 
     // OBJ 読み込み（単一メッシュ前提）
-    objModel_ = LoadObjFileM("resources/obj", objFilename);
+    objModel_ = MeshCache::LoadFile("resources/obj", objFilename);
     assert(!objModel_.meshes.empty() && "objModel has no mesh");
     const auto& mesh = objModel_.meshes.front();
 
@@ -30,11 +31,11 @@ void Region::Initialize(
     CreateMeshBuffers(mesh);
 
     // マテリアル/ライト/カメラ
-    CreateMaterialResources(mesh);
+    CreateMaterialResources(objModel_.GetMaterial(mesh));
     EnsureLightAndCamera();
 
     // テクスチャ共有（SRV 再利用）
-    EnsureSharedTexture(mesh);
+    EnsureSharedTexture(objModel_.GetMaterial(mesh));
 
     // インスタンシングバッファは必要になった時に作成（最低1で良ければここで CreateOrResizeInstanceBuffer(1) でもOK）
 }
@@ -55,19 +56,35 @@ void Region::CreateMeshBuffers(const ObjMesh& mesh) {
     assert(SUCCEEDED(hr));
     std::memcpy(vb, mesh.vertices.data(), vbSize);
     vertexResource_->Unmap(0, nullptr);
+
+    // IB（重複のない頂点を添字で参照）
+    indexCount_ = static_cast<UINT>(mesh.indices.size());
+    const size_t ibSize = sizeof(uint32_t) * mesh.indices.size();
+
+    indexResource_ = dx_->CreateBufferResource(ibSize);
+    indexBufferView_ = D3D12_INDEX_BUFFER_VIEW{};
+    indexBufferView_.BufferLocation = indexResource_->GetGPUVirtualAddress();
+    indexBufferView_.SizeInBytes = static_cast<UINT>(ibSize);
+    indexBufferView_.Format = DXGI_FORMAT_R32_UINT;
+
+    uint32_t* ib = nullptr;
+    hr = indexResource_->Map(0, nullptr, reinterpret_cast<void**>(&ib));
+    assert(SUCCEEDED(hr));
+    std::memcpy(ib, mesh.indices.data(), ibSize);
+    indexResource_->Unmap(0, nullptr);
 }
 
-void Region::CreateMaterialResources(const ObjMesh& mesh) {
+void Region::CreateMaterialResources(const ObjMaterial& material) {
     // マテリアル
     materialResource_ = dx_->CreateBufferResource(sizeof(Material));
     Material* mat = nullptr;
     materialResource_->Map(0, nullptr, reinterpret_cast<void**>(&mat));
-    mat->color = mesh.material.color;
-    mat->enableLighting = mesh.material.enableLighting;
-    mat->hasTexture = !mesh.material.textureFilePath.empty();
-    mat->lightingMode = mesh.material.enableLighting ? 2 : 0;
-    mat->uvTransform = mesh.material.uvTransform;
-    mat->shininess = mesh.material.shininess;
+    mat->color = material.color;
+    mat->enableLighting = material.enableLighting;
+    mat->hasTexture = !material.textureFilePath.empty();
+    mat->lightingMode = material.enableLighting ? 2 : 0;
+    mat->uvTransform = material.uvTransform;
+    mat->shininess = material.shininess;
 
     // ライト
     directionalLightResource_ = dx_->CreateBufferResource(sizeof(DirectionalLight));
@@ -88,9 +105,9 @@ void Region::EnsureLightAndCamera() {
     // 初期化済み。毎フレームのカメラ位置更新は Draw 内で行う
 }
 
-void Region::EnsureSharedTexture(const ObjMesh& mesh) {
-    if (!mesh.material.textureFilePath.empty()) {
-        textureHandle_ = textureManager_->GetTextureHandle(mesh.material.textureFilePath);
+void Region::EnsureSharedTexture(const ObjMaterial& material) {
+    if (!material.textureFilePath.empty()) {
+        textureHandle_ = textureManager_->GetTextureHandle(material.textureFilePath);
     } else {
         textureHandle_ = textureManager_->GetWhiteTextureHandle();
     }
@@ -181,7 +198,7 @@ void Region::BuildInstanceBuffer(bool force) {
 }
 
 void Region::Draw() {
-    if (vertexCount_ == 0 || instances_.empty()) { return; }
+    if (indexCount_ == 0 || instances_.empty()) { return; }
 
     // カメラ位置更新
     {
@@ -198,6 +215,7 @@ void Region::Draw() {
 
     cmd->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     cmd->IASetVertexBuffers(0, 1, &vertexBufferView_);
+    cmd->IASetIndexBuffer(&indexBufferView_);
 
     cmd->SetGraphicsRootConstantBufferView(0, materialResource_->GetGPUVirtualAddress());          // PS b0
     cmd->SetGraphicsRootConstantBufferView(3, directionalLightResource_->GetGPUVirtualAddress());  // PS b1
@@ -205,5 +223,5 @@ void Region::Draw() {
     cmd->SetGraphicsRootDescriptorTable(2, textureHandle_);                                        // PS t0
 
     cmd->SetGraphicsRootDescriptorTable(4, instancingSrvGPU_);                                     // VS t0
-    cmd->DrawInstanced(vertexCount_, static_cast<UINT>(instances_.size()), 0, 0);
+    cmd->DrawIndexedInstanced(indexCount_, static_cast<UINT>(instances_.size()), 0, 0, 0);
 }
\ No newline at end of file
@@ -46,8 +46,8 @@ private:
 
     // リソース生成ヘルパ
     void CreateMeshBuffers(const ObjMesh& mesh);
-    void CreateMaterialResources(const ObjMesh& mesh);
-    void EnsureSharedTexture(const ObjMesh& mesh);
+    void CreateMaterialResources(const ObjMaterial& material);
+    void EnsureSharedTexture(const ObjMaterial& material);
     void EnsureLightAndCamera();
     void CreateOrResizeInstanceBuffer(uint32_t instanceCount);
 
@@ -62,6 +62,9 @@ private:
     Microsoft::WRL::ComPtr<ID3D12Resource> vertexResource_;
     D3D12_VERTEX_BUFFER_VIEW               vertexBufferView_{};
     UINT                                   vertexCount_ = 0;
+    Microsoft::WRL::ComPtr<ID3D12Resource> indexResource_;
+    D3D12_INDEX_BUFFER_VIEW                indexBufferView_{};
+    UINT                                   indexCount_ = 0;
 
     // マテリアル/ライト/カメラ
     Microsoft::WRL::ComPtr<ID3D12Resource> materialResource_;
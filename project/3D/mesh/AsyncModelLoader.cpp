@@ -0,0 +1,91 @@
+#include "AsyncModelLoader.h"
+#include "../../engine/JobSystem.h"
+
+#include <chrono>
+
+void AsyncModelLoader::Request::Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [&] { return IsReady(); });
+}
+
+void AsyncModelLoader::Initialize(JobSystem* jobSystem, MeshAssetCache* assetCache) {
+    jobSystem_ = jobSystem;
+    assetCache_ = assetCache;
+    pendings_.clear();
+}
+
+std::shared_ptr<AsyncModelLoader::Request> AsyncModelLoader::Load(const std::string& directoryPath, const std::string& filename,
+    LoadedCallback onLoaded, WorkerCallback onWorker) {
+    auto request = std::make_shared<Request>();
+    request->directoryPath_ = directoryPath;
+    request->filename_ = filename;
+    pendings_.push_back({ request, std::move(onLoaded) });
+
+    // 仕事はRequestを共有で持つので、積んだ側が先に消えても安全
+    JobSystem* jobSystem = jobSystem_;
+    MeshAssetCache* assetCache = assetCache_;
+    auto job = [request, onWorker = std::move(onWorker), jobSystem, assetCache] {
+        const auto start = std::chrono::steady_clock::now();
+        if (assetCache) {
+            request->asset_ = assetCache->Load(request->directoryPath_, request->filename_, jobSystem, &request->isShared_);
+        } else {
+            request->asset_ = MeshAssetCache::LoadUncached(request->directoryPath_, request->filename_, jobSystem);
+        }
+        request->isCacheHit_ = request->asset_->isCacheHit;
+        // 共有したものは、読んだ側がもう追加の処理を済ませている
+        if (onWorker && !request->isShared_ && !request->IsCancelled()) {
+            onWorker(request->asset_->model);
+        }
+        request->loadTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        {
+            std::lock_guard<std::mutex> lock(request->mutex_);
+            request->isReady_.store(true, std::memory_order_release);
+        }
+        request->condition_.notify_all();
+    };
+    // 生きているものがあれば、ワーカーに積むまでもない
+    if (jobSystem_ && !(assetCache_ && assetCache_->Find(directoryPath, filename))) {
+        jobSystem_->Submit(std::move(job));
+    } else {
+        job();
+    }
+    return request;
+}
+
+size_t AsyncModelLoader::Poll(size_t maxCount) {
+    size_t calledCount = 0;
+    for (size_t i = 0; i < pendings_.size();) {
+        Pending& pending = pendings_[i];
+        if (pending.request->IsCancelled() && pending.request->IsReady()) {
+            pending.request->asset_.reset();
+            pendings_.erase(pendings_.begin() + i);
+            continue;
+        }
+        if (!pending.request->IsReady() || pending.request->IsCancelled() || calledCount >= maxCount) {
+            ++i;
+            continue;
+        }
+        // onLoadedの中でLoadが呼ばれても(pendings_が伸びても)大丈夫なよう、先に取り出す
+        Pending finished = std::move(pending);
+        pendings_.erase(pendings_.begin() + i);
+        if (finished.onLoaded) {
+            finished.onLoaded(*finished.request);
+        }
+        // 要るものはonLoadedでハンドルを取ったので、Requestの分は手放す
+        // (Requestはワーカーの仕事がまだ持っていることがあり、それを待たずにモデルを消せるように)
+        finished.request->asset_.reset();
+        ++calledCount;
+    }
+    return calledCount;
+}
+
+void AsyncModelLoader::WaitAll() {
+    while (!pendings_.empty()) {
+        // onLoadedで新しく積まれることもあるので、空になるまで繰り返す
+        const std::vector<Pending> snapshot = pendings_;
+        for (const Pending& pending : snapshot) {
+            pending.request->Wait();
+        }
+        Poll();
+    }
+}
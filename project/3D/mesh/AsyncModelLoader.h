@@ -0,0 +1,118 @@
+#pragma once
+
+#include "MeshAssetCache.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class JobSystem;
+
+/// <summary>
+/// モデルの読み込み(MeshCache::LoadFile: キャッシュの読み書き・解析・並べ替え)をワーカーで行い、
+/// 終わったものをメインスレッドのPollで知らせる(GPUへの転送はそこで行うので、1フレームに転送する数を絞れる)
+/// MeshAssetCacheを渡すと、同じファイルは1回だけ読んで共有する
+/// D3D12に依存しないので、ヘッドレスでも動く
+/// </summary>
+class AsyncModelLoader {
+public:
+
+    /// <summary>
+    /// 読み込み1件分。ワーカーが書き終えてIsReadyになってから、メインスレッドが読む
+    /// </summary>
+    class Request {
+        friend class AsyncModelLoader;
+
+        std::string directoryPath_;
+        std::string filename_;
+        MeshAssetCache::Handle asset_;
+        bool isCacheHit_ = false;
+        // 読み込み済み・読み込み中のものを共有したか(ファイルを読まずに済んだ)
+        bool isShared_ = false;
+        // ワーカーで読み込みにかかった時間(ms)
+        float loadTimeMs_ = 0.0f;
+
+        std::atomic<bool> isReady_ = false;
+        std::atomic<bool> isCancelled_ = false;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+
+    public:
+
+        // 読み込みが終わったか
+        bool IsReady() const { return isReady_.load(std::memory_order_acquire); }
+
+        /// <summary>
+        /// 読み込みが終わるまで待つ
+        /// </summary>
+        void Wait();
+
+        /// <summary>
+        /// 終わってもonLoadedを呼ばないようにする(呼び出し側が先に消える時)
+        /// 読み込み自体は止まらないが、結果は捨てられる
+        /// </summary>
+        void Cancel() { isCancelled_.store(true, std::memory_order_release); }
+        bool IsCancelled() const { return isCancelled_.load(std::memory_order_acquire); }
+
+        // ゲッター(IsReadyの後、onLoadedを呼び終わるまで使える。モデルは共有なので書き換えない。持ち続けるならハンドルを取っておく)
+        // onLoadedの後はハンドルを手放す(ワーカーの仕事がRequestを少し長く持っていても、モデルは残らない)
+        const ObjModel& GetModel() const { return asset_->model; }
+        const MeshAssetCache::Handle& GetAsset() const { return asset_; }
+        bool IsCacheHit() const { return isCacheHit_; }
+        bool IsShared() const { return isShared_; }
+        float GetLoadTimeMs() const { return loadTimeMs_; }
+        const std::string& GetDirectoryPath() const { return directoryPath_; }
+        const std::string& GetFilename() const { return filename_; }
+    };
+
+    // ワーカーで読み込みの直後に呼ばれる(テクスチャのデコードなど、GPUを使わない追加の処理)
+    using WorkerCallback = std::function<void(const ObjModel& model)>;
+    // Pollの中(メインスレッド)で呼ばれる
+    using LoadedCallback = std::function<void(Request& request)>;
+
+private: // メンバ変数
+
+    JobSystem* jobSystem_ = nullptr;
+    MeshAssetCache* assetCache_ = nullptr;
+
+    // 積んだ順の、まだonLoadedを呼んでいない読み込み(メインスレッドだけが触る)
+    struct Pending {
+        std::shared_ptr<Request> request;
+        LoadedCallback onLoaded;
+    };
+    std::vector<Pending> pendings_;
+
+public: // メンバ関数
+
+    /// <summary>
+    /// 初期化。jobSystemがnullならLoadの中で読み込む(結果は次のPollで知らせる)
+    /// assetCacheがnullなら毎回ファイルを読む
+    /// </summary>
+    void Initialize(JobSystem* jobSystem, MeshAssetCache* assetCache = nullptr);
+
+    /// <summary>
+    /// 読み込みを積む(すぐ戻る)
+    /// onWorkerはワーカーで読み込みの直後に、onLoadedは終わった後のPollで呼ばれる
+    /// 共有できるモデルが生きていれば読まずに終わり、onWorkerも呼ばない
+    /// </summary>
+    std::shared_ptr<Request> Load(const std::string& directoryPath, const std::string& filename,
+        LoadedCallback onLoaded = nullptr, WorkerCallback onWorker = nullptr);
+
+    /// <summary>
+    /// 終わった読み込みのonLoadedを積んだ順に呼ぶ(メインスレッドで毎フレーム呼ぶ)
+    /// maxCount件まで呼んだら残りは次に回す。呼んだ件数を返す(取り消したものは数えない)
+    /// </summary>
+    size_t Poll(size_t maxCount = SIZE_MAX);
+
+    /// <summary>
+    /// すべての読み込みが終わるまで待ち、onLoadedを呼ぶ(テスト・終了時用)
+    /// </summary>
+    void WaitAll();
+
+    // まだonLoadedを呼んでいない読み込みの数
+    size_t GetPendingCount() const { return pendings_.size(); }
+};
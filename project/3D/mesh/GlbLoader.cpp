@@ -0,0 +1,814 @@
+#include "GlbLoader.h"
+#include "MappedFile.h"
+#include "MeshBounds.h"
+#include "../../engine/JobSystem.h"
+#include "../../function/Math.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    // ヘッダとチャンクの種類
+    const uint32_t kMagic = 0x46546C67;      // "glTF"
+    const uint32_t kChunkJson = 0x4E4F534A;  // "JSON"
+    const uint32_t kChunkBin = 0x004E4942;   // "BIN\0"
+
+    // アクセサの成分の型
+    const uint32_t kByte = 5120;
+    const uint32_t kUnsignedByte = 5121;
+    const uint32_t kShort = 5122;
+    const uint32_t kUnsignedShort = 5123;
+    const uint32_t kUnsignedInt = 5125;
+    const uint32_t kFloat = 5126;
+
+    // 三角形リスト
+    const uint32_t kModeTriangles = 4;
+
+    uint32_t GetComponentSize(uint32_t componentType) {
+        switch (componentType) {
+        case kByte:
+        case kUnsignedByte:
+            return 1;
+        case kShort:
+        case kUnsignedShort:
+            return 2;
+        case kUnsignedInt:
+        case kFloat:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    uint32_t GetComponentCount(std::string_view type) {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        return 0;
+    }
+
+    /// <summary>
+    /// JSONの値1つ(glTFのJSONチャンクは小さいので、素直に木にする)
+    /// </summary>
+    struct JsonValue {
+        enum class Type { kNull, kBoolean, kNumber, kString, kArray, kObject };
+        Type type = Type::kNull;
+        bool boolean = false;
+        double number = 0.0;
+        std::string string;
+        std::vector<JsonValue> array;
+        std::vector<std::pair<std::string, JsonValue>> members;
+
+        // オブジェクトのメンバ(無ければnullptr)
+        const JsonValue* Find(std::string_view key) const {
+            for (const auto& [name, value] : members) {
+                if (name == key) {
+                    return &value;
+                }
+            }
+            return nullptr;
+        }
+
+        // 配列の要素(無ければnullptr)
+        const JsonValue* At(size_t index) const {
+            return index < array.size() ? &array[index] : nullptr;
+        }
+
+        // 数値のメンバ(無い・数値でなければdefaultValue)
+        double GetNumber(std::string_view key, double defaultValue) const {
+            const JsonValue* value = Find(key);
+            return value && value->type == Type::kNumber ? value->number : defaultValue;
+        }
+
+        // 添字としての値(数値でない・負・整数でなければ UINT32_MAX)
+        uint32_t AsIndex() const {
+            const double value = type == Type::kNumber ? number : -1.0;
+            return value >= 0.0 && value < static_cast<double>(UINT32_MAX) && std::floor(value) == value ? static_cast<uint32_t>(value) : UINT32_MAX;
+        }
+
+        // 添字のメンバ(無い・負・整数でなければ UINT32_MAX)
+        uint32_t GetIndex(std::string_view key) const {
+            const JsonValue* value = Find(key);
+            return value ? value->AsIndex() : UINT32_MAX;
+        }
+
+        // 大きさ・位置のメンバ(無ければdefaultValue)。数値でない・負・整数でない・maxValueより大きければfalse
+        // (範囲外のdoubleを整数にするのは未定義動作なので、比べてから変換する)
+        bool GetSize(std::string_view key, uint64_t defaultValue, uint64_t maxValue, uint64_t& out) const {
+            const JsonValue* value = Find(key);
+            if (!value) {
+                out = defaultValue;
+                return true;
+            }
+            const double number = value->number;
+            if (value->type != Type::kNumber || !(number >= 0.0) || number > static_cast<double>(maxValue) || std::floor(number) != number) {
+                return false;
+            }
+            out = static_cast<uint64_t>(number);
+            return true;
+        }
+    };
+
+    /// <summary>
+    /// JSONの解析(再帰下降。深すぎる入れ子は壊れているとみなす)
+    /// </summary>
+    class JsonParser {
+    private:
+        static inline const int kMaxDepth = 64;
+
+        const char* p_;
+        const char* end_;
+
+    public:
+        explicit JsonParser(std::string_view text) : p_(text.data()), end_(text.data() + text.size()) {}
+
+        bool Parse(JsonValue& out) {
+            if (!ParseValue(out, 0)) {
+                return false;
+            }
+            SkipSpace();
+            // 末尾はチャンクの4バイト揃えの空白か0
+            while (p_ < end_ && *p_ == '\0') {
+                ++p_;
+            }
+            return p_ == end_;
+        }
+
+    private:
+        void SkipSpace() {
+            while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\r' || *p_ == '\n')) {
+                ++p_;
+            }
+        }
+
+        bool Consume(std::string_view word) {
+            if (static_cast<size_t>(end_ - p_) < word.size() || std::memcmp(p_, word.data(), word.size()) != 0) {
+                return false;
+            }
+            p_ += word.size();
+            return true;
+        }
+
+        bool ParseValue(JsonValue& out, int depth) {
+            SkipSpace();
+            if (p_ >= end_ || depth > kMaxDepth) {
+                return false;
+            }
+            switch (*p_) {
+            case '{':
+                return ParseObject(out, depth);
+            case '[':
+                return ParseArray(out, depth);
+            case '"':
+                out.type = JsonValue::Type::kString;
+                return ParseString(out.string);
+            case 't':
+                out.type = JsonValue::Type::kBoolean;
+                out.boolean = true;
+                return Consume("true");
+            case 'f':
+                out.type = JsonValue::Type::kBoolean;
+                out.boolean = false;
+                return Consume("false");
+            case 'n':
+                out.type = JsonValue::Type::kNull;
+                return Consume("null");
+            default: {
+                out.type = JsonValue::Type::kNumber;
+                const std::from_chars_result result = std::from_chars(p_, end_, out.number);
+                if (result.ec != std::errc{}) {
+                    return false;
+                }
+                p_ = result.ptr;
+                return true;
+            }
+            }
+        }
+
+        bool ParseObject(JsonValue& out, int depth) {
+            out.type = JsonValue::Type::kObject;
+            ++p_;
+            SkipSpace();
+            if (p_ < end_ && *p_ == '}') {
+                ++p_;
+                return true;
+            }
+            while (true) {
+                SkipSpace();
+                std::pair<std::string, JsonValue> member;
+                if (p_ >= end_ || *p_ != '"' || !ParseString(member.first)) {
+                    return false;
+                }
+                SkipSpace();
+                if (p_ >= end_ || *p_ != ':') {
+                    return false;
+                }
+                ++p_;
+                if (!ParseValue(member.second, depth + 1)) {
+                    return false;
+                }
+                out.members.push_back(std::move(member));
+                SkipSpace();
+                if (p_ < end_ && *p_ == ',') {
+                    ++p_;
+                    continue;
+                }
+                if (p_ < end_ && *p_ == '}') {
+                    ++p_;
+                    return true;
+                }
+                return false;
+            }
+        }
+
+        bool ParseArray(JsonValue& out, int depth) {
+            out.type = JsonValue::Type::kArray;
+            ++p_;
+            SkipSpace();
+            if (p_ < end_ && *p_ == ']') {
+                ++p_;
+                return true;
+            }
+            while (true) {
+                out.array.emplace_back();
+                if (!ParseValue(out.array.back(), depth + 1)) {
+                    return false;
+                }
+                SkipSpace();
+                if (p_ < end_ && *p_ == ',') {
+                    ++p_;
+                    continue;
+                }
+                if (p_ < end_ && *p_ == ']') {
+                    ++p_;
+                    return true;
+                }
+                return false;
+            }
+        }
+
+        // 4桁の16進
+        bool ParseHex4(uint32_t& code) {
+            if (end_ - p_ < 4) {
+                return false;
+            }
+            const std::from_chars_result result = std::from_chars(p_, p_ + 4, code, 16);
+            if (result.ec != std::errc{} || result.ptr != p_ + 4) {
+                return false;
+            }
+            p_ += 4;
+            return true;
+        }
+
+        static void AppendUtf8(std::string& out, uint32_t code) {
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        bool ParseString(std::string& out) {
+            ++p_;
+            while (p_ < end_) {
+                const char c = *p_++;
+                if (c == '"') {
+                    return true;
+                }
+                if (c != '\\') {
+                    out += c;
+                    continue;
+                }
+                if (p_ >= end_) {
+                    return false;
+                }
+                const char escaped = *p_++;
+                switch (escaped) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    uint32_t code = 0;
+                    if (!ParseHex4(code)) {
+                        return false;
+                    }
+                    // サロゲートペア
+                    if (code >= 0xD800 && code < 0xDC00 && Consume("\\u")) {
+                        uint32_t low = 0;
+                        if (!ParseHex4(low) || low < 0xDC00 || low >= 0xE000) {
+                            return false;
+                        }
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    AppendUtf8(out, code);
+                    break;
+                }
+                default:
+                    return false;
+                }
+            }
+            return false;
+        }
+    };
+
+    // 32bitの値(リトルエンディアン)
+    uint32_t ReadU32(const uint8_t* p) {
+        uint32_t value = 0;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    // uriの %XX を戻す
+    std::string DecodeUri(std::string_view uri) {
+        std::string decoded;
+        decoded.reserve(uri.size());
+        for (size_t i = 0; i < uri.size(); ++i) {
+            uint32_t code = 0;
+            if (uri[i] == '%' && i + 2 < uri.size() &&
+                std::from_chars(uri.data() + i + 1, uri.data() + i + 3, code, 16).ptr == uri.data() + i + 3) {
+                decoded += static_cast<char>(code);
+                i += 2;
+                continue;
+            }
+            decoded += uri[i];
+        }
+        return decoded;
+    }
+
+    /// <summary>
+    /// glbの中身(JSONの木とBINチャンク)
+    /// </summary>
+    struct Document {
+        JsonValue root;
+        const uint8_t* bin = nullptr;
+        size_t binSize = 0;
+
+        // ルートの配列のindex番目(無ければnullptr)
+        const JsonValue* Get(std::string_view key, uint32_t index) const {
+            const JsonValue* array = root.Find(key);
+            return array ? array->At(index) : nullptr;
+        }
+
+        /// <summary>
+        /// アクセサの窓を作る。BINチャンクの外を指す・疎・外部バッファならfalse
+        /// </summary>
+        bool GetAccessor(uint32_t accessorIndex, GlbLoader::AccessorView& view) const {
+            const JsonValue* accessor = Get("accessors", accessorIndex);
+            if (!accessor || accessor->Find("sparse")) {
+                return false;
+            }
+            const JsonValue* bufferView = Get("bufferViews", accessor->GetIndex("bufferView"));
+            if (!bufferView) {
+                return false;
+            }
+            // BINチャンクはバッファ0で、uriを持たない
+            const JsonValue* buffer = Get("buffers", bufferView->GetIndex("buffer"));
+            if (!bin || bufferView->GetIndex("buffer") != 0 || !buffer || buffer->Find("uri")) {
+                return false;
+            }
+
+            const JsonValue* type = accessor->Find("type");
+            view.componentType = accessor->GetIndex("componentType");
+            view.componentCount = type ? GetComponentCount(type->string) : 0;
+            const JsonValue* normalized = accessor->Find("normalized");
+            view.isNormalized = normalized && normalized->boolean;
+            const uint64_t elementSize = static_cast<uint64_t>(GetComponentSize(view.componentType)) * view.componentCount;
+            // 数も位置も長さもBINチャンクの大きさを超えることはない
+            uint64_t count = 0, viewOffset = 0, viewLength = 0, stride = 0, accessorOffset = 0;
+            if (elementSize == 0 || !accessor->Find("count") || !accessor->GetSize("count", 0, binSize, count) ||
+                !bufferView->GetSize("byteOffset", 0, binSize, viewOffset) || !bufferView->GetSize("byteLength", 0, binSize, viewLength) ||
+                !bufferView->GetSize("byteStride", 0, binSize, stride) || !accessor->GetSize("byteOffset", 0, binSize, accessorOffset)) {
+                return false;
+            }
+            view.count = static_cast<size_t>(count);
+            view.stride = static_cast<size_t>(stride != 0 ? stride : elementSize);
+            // byteStrideは252まで
+            if (viewOffset + viewLength > binSize || view.stride < elementSize || view.stride > 252) {
+                return false;
+            }
+            if (view.count > 0 && accessorOffset + view.stride * (view.count - 1) + elementSize > viewLength) {
+                return false;
+            }
+            view.data = bin + viewOffset + accessorOffset;
+            return true;
+        }
+
+        // 画像のパス(埋め込み・data uriなら空)
+        std::string GetImagePath(uint32_t textureIndex, const std::string& directoryPath) const {
+            const JsonValue* texture = Get("textures", textureIndex);
+            const JsonValue* image = texture ? Get("images", texture->GetIndex("source")) : nullptr;
+            const JsonValue* uri = image ? image->Find("uri") : nullptr;
+            if (!uri || uri->type != JsonValue::Type::kString || uri->string.starts_with("data:")) {
+                return "";
+            }
+            return directoryPath + "/" + DecodeUri(uri->string);
+        }
+    };
+
+    // 数値の配列を読む(足りない分はそのまま)
+    void ReadNumbers(const JsonValue* array, float* out, size_t count) {
+        if (!array) {
+            return;
+        }
+        for (size_t i = 0; i < count && i < array->array.size(); ++i) {
+            out[i] = static_cast<float>(array->array[i].number);
+        }
+    }
+
+    /// <summary>
+    /// ノード自身の変換(matrix か TRS)
+    /// glTFは列ベクトル・列優先なので、matrixの16個をそのまま並べると行ベクトルの行列になる
+    /// </summary>
+    Matrix4x4 GetNodeMatrix(const JsonValue& node) {
+        Matrix4x4 result = Math::MakeIdentity4x4();
+        if (const JsonValue* matrix = node.Find("matrix")) {
+            ReadNumbers(matrix, &result.m[0][0], 16);
+            return result;
+        }
+        float translation[3] = { 0.0f, 0.0f, 0.0f };
+        float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        float scale[3] = { 1.0f, 1.0f, 1.0f };
+        ReadNumbers(node.Find("translation"), translation, 3);
+        ReadNumbers(node.Find("rotation"), rotation, 4);
+        ReadNumbers(node.Find("scale"), scale, 3);
+
+        // 四元数(x, y, z, w)の回転を行ベクトル用に並べ、拡縮 → 回転 → 移動 の順に掛けたもの
+        const float x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+        const float rotate[3][3] = {
+            { 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w) },
+            { 2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w) },
+            { 2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y) },
+        };
+        for (int row = 0; row < 3; ++row) {
+            for (int column = 0; column < 3; ++column) {
+                result.m[row][column] = scale[row] * rotate[row][column];
+            }
+            result.m[3][row] = translation[row];
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// メッシュを描くノード1つ分(どのメッシュを、どの変換で)
+    /// </summary>
+    struct MeshInstance {
+        uint32_t meshIndex = 0;
+        Matrix4x4 world;
+        bool isIdentity = true;
+    };
+
+    /// <summary>
+    /// シーンの根のノードから深さ優先で辿り、メッシュを持つノードを並べる(入れ子が深くてもよいようにスタックは自前で持つ)
+    /// glTFのノードは木なので、2回目に来たノード(輪・複数の親)は壊れているとみなして飛ばす
+    /// </summary>
+    std::vector<MeshInstance> CollectInstances(const Document& document, const JsonValue& rootNodes) {
+        const JsonValue* nodes = document.root.Find("nodes");
+        std::vector<uint8_t> isVisited(nodes ? nodes->array.size() : 0, 0);
+        const Matrix4x4 identity = Math::MakeIdentity4x4();
+
+        std::vector<MeshInstance> instances;
+        // 辿るノードと親までの変換(子は逆順に積み、並びの順に取り出す)
+        std::vector<std::pair<uint32_t, Matrix4x4>> stack;
+        for (auto root = rootNodes.array.rbegin(); root != rootNodes.array.rend(); ++root) {
+            stack.emplace_back(root->AsIndex(), identity);
+        }
+        while (!stack.empty()) {
+            const auto [nodeIndex, parent] = stack.back();
+            stack.pop_back();
+            const JsonValue* node = document.Get("nodes", nodeIndex);
+            if (!node || isVisited[nodeIndex]) {
+                continue;
+            }
+            isVisited[nodeIndex] = 1;
+            // 行ベクトルなので 子 → 親 の順に掛ける
+            const Matrix4x4 world = Math::Multiply(GetNodeMatrix(*node), parent);
+            const uint32_t meshIndex = node->GetIndex("mesh");
+            if (document.Get("meshes", meshIndex)) {
+                MeshInstance instance;
+                instance.meshIndex = meshIndex;
+                instance.world = world;
+                instance.isIdentity = std::memcmp(&world, &identity, sizeof(Matrix4x4)) == 0;
+                instances.push_back(instance);
+            }
+            if (const JsonValue* children = node->Find("children")) {
+                for (auto child = children->array.rbegin(); child != children->array.rend(); ++child) {
+                    stack.emplace_back(child->AsIndex(), world);
+                }
+            }
+        }
+        return instances;
+    }
+
+    ObjMaterial ConvertMaterial(const Document& document, const JsonValue& material, const std::string& directoryPath) {
+        ObjMaterial result;
+        if (const JsonValue* pbr = material.Find("pbrMetallicRoughness")) {
+            float baseColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+            ReadNumbers(pbr->Find("baseColorFactor"), baseColor, 4);
+            result.color = { baseColor[0], baseColor[1], baseColor[2], 1.0f };
+            result.alpha = baseColor[3];
+
+            if (const JsonValue* texture = pbr->Find("baseColorTexture")) {
+                result.textureFilePath = document.GetImagePath(texture->GetIndex("index"), directoryPath);
+                // KHR_texture_transform(回転は無視する)
+                const JsonValue* extensions = texture->Find("extensions");
+                if (const JsonValue* transform = extensions ? extensions->Find("KHR_texture_transform") : nullptr) {
+                    float offset[2] = { 0.0f, 0.0f };
+                    float scale[2] = { 1.0f, 1.0f };
+                    ReadNumbers(transform->Find("offset"), offset, 2);
+                    ReadNumbers(transform->Find("scale"), scale, 2);
+                    result.uvTransform.m[0][0] = scale[0];
+                    result.uvTransform.m[1][1] = scale[1];
+                    result.uvTransform.m[3][0] = offset[0];
+                    result.uvTransform.m[3][1] = offset[1];
+                }
+            }
+        }
+        const JsonValue* extensions = material.Find("extensions");
+        if (extensions && extensions->Find("KHR_materials_unlit")) {
+            result.enableLighting = false;
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// プリミティブ1つをメッシュにする(頂点は窓から直接読み、ノードの変換を掛けてからobjと同じ座標系にする)
+    /// 対応しない・壊れたプリミティブならfalse
+    /// </summary>
+    bool ConvertPrimitive(const Document& document, const JsonValue& primitive, const MeshInstance& instance, uint32_t materialCount, ObjMesh& mesh) {
+        if (primitive.GetNumber("mode", kModeTriangles) != kModeTriangles) {
+            return false;
+        }
+        const JsonValue* attributes = primitive.Find("attributes");
+        if (!attributes) {
+            return false;
+        }
+        GlbLoader::AccessorView positions, normals, texcoords, indices;
+        if (!document.GetAccessor(attributes->GetIndex("POSITION"), positions) || positions.componentCount < 3) {
+            return false;
+        }
+        const bool hasNormals = document.GetAccessor(attributes->GetIndex("NORMAL"), normals) &&
+            normals.componentCount >= 3 && normals.count == positions.count;
+        const bool hasTexcoords = document.GetAccessor(attributes->GetIndex("TEXCOORD_0"), texcoords) &&
+            texcoords.componentCount >= 2 && texcoords.count == positions.count;
+
+        // 法線には逆転置行列を掛ける。裏返す変換(行列式が負)なら回り順も逆になる
+        const Matrix4x4& world = instance.world;
+        const Matrix4x4 normalMatrix = instance.isIdentity ? world : Math::Transpose(Math::Inverse(world));
+        const float determinant =
+            world.m[0][0] * (world.m[1][1] * world.m[2][2] - world.m[1][2] * world.m[2][1]) -
+            world.m[0][1] * (world.m[1][0] * world.m[2][2] - world.m[1][2] * world.m[2][0]) +
+            world.m[0][2] * (world.m[1][0] * world.m[2][1] - world.m[1][1] * world.m[2][0]);
+        const bool isMirrored = determinant < 0.0f;
+
+        mesh.vertices.resize(positions.count);
+        for (size_t i = 0; i < positions.count; ++i) {
+            VertexData& vertex = mesh.vertices[i];
+            float raw[3] = {};
+            positions.ReadFloats(i, raw, 3);
+            Vector3 position = { raw[0], raw[1], raw[2] };
+            if (!instance.isIdentity) {
+                position = Math::Transform(position, world);
+            }
+            // 右手系からの変換はobjと同じくxを反転する
+            vertex.position = { -position.x, position.y, position.z, 1.0f };
+
+            Vector3 normal = {};
+            if (hasNormals) {
+                float rawNormal[3] = {};
+                normals.ReadFloats(i, rawNormal, 3);
+                normal = { rawNormal[0], rawNormal[1], rawNormal[2] };
+                if (!instance.isIdentity) {
+                    const Vector3 transformed = {
+                        normal.x * normalMatrix.m[0][0] + normal.y * normalMatrix.m[1][0] + normal.z * normalMatrix.m[2][0],
+                        normal.x * normalMatrix.m[0][1] + normal.y * normalMatrix.m[1][1] + normal.z * normalMatrix.m[2][1],
+                        normal.x * normalMatrix.m[0][2] + normal.y * normalMatrix.m[1][2] + normal.z * normalMatrix.m[2][2],
+                    };
+                    normal = Math::Length(transformed) > 0.0f ? Math::Normalize(transformed) : transformed;
+                }
+                normal.x = -normal.x;
+            }
+            vertex.normal = normal;
+
+            // glTFのUVは左上が原点なのでそのまま。無ければobjと同じく真ん中
+            float texcoord[2] = { 0.5f, 0.5f };
+            if (hasTexcoords) {
+                texcoords.ReadFloats(i, texcoord, 2);
+            }
+            vertex.texcoord = { texcoord[0], texcoord[1] };
+        }
+
+        // 添字(無ければ頂点の順)。xを反転したので回り順も逆にする(ノードの変換でも裏返っていれば元のまま)
+        const uint32_t indexAccessor = primitive.GetIndex("indices");
+        const bool hasIndices = indexAccessor != UINT32_MAX;
+        if (hasIndices && (!document.GetAccessor(indexAccessor, indices) || indices.componentCount != 1 ||
+            indices.componentType == kFloat || indices.componentType == kByte || indices.componentType == kShort)) {
+            return false;
+        }
+        const size_t triangleCount = (hasIndices ? indices.count : positions.count) / 3;
+        mesh.indices.resize(triangleCount * 3);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (size_t corner = 0; corner < 3; ++corner) {
+                const size_t source = isMirrored ? t * 3 + corner : t * 3 + 2 - corner;
+                const uint32_t index = hasIndices ? indices.ReadIndex(source) : static_cast<uint32_t>(source);
+                if (index >= positions.count) {
+                    return false;
+                }
+                mesh.indices[t * 3 + corner] = index;
+            }
+        }
+
+        const uint32_t materialIndex = primitive.GetIndex("material");
+        mesh.materialIndex = materialIndex < materialCount ? materialIndex : ObjMesh::kNoMaterial;
+        MeshBounds::Compute(mesh);
+        return true;
+    }
+}
+
+namespace GlbLoader {
+
+    void AccessorView::ReadFloats(size_t index, float* out, uint32_t maxComponents) const {
+        const uint8_t* element = data + stride * index;
+        const uint32_t count = (std::min)(componentCount, maxComponents);
+        if (componentType == kFloat) {
+            std::memcpy(out, element, count * sizeof(float));
+            return;
+        }
+        for (uint32_t c = 0; c < count; ++c) {
+            float value = 0.0f;
+            switch (componentType) {
+            case kByte: {
+                int8_t raw = 0;
+                std::memcpy(&raw, element + c, sizeof(raw));
+                value = isNormalized ? (std::max)(raw / 127.0f, -1.0f) : raw;
+                break;
+            }
+            case kUnsignedByte:
+                value = isNormalized ? element[c] / 255.0f : element[c];
+                break;
+            case kShort: {
+                int16_t raw = 0;
+                std::memcpy(&raw, element + c * sizeof(raw), sizeof(raw));
+                value = isNormalized ? (std::max)(raw / 32767.0f, -1.0f) : raw;
+                break;
+            }
+            case kUnsignedShort: {
+                uint16_t raw = 0;
+                std::memcpy(&raw, element + c * sizeof(raw), sizeof(raw));
+                value = isNormalized ? raw / 65535.0f : raw;
+                break;
+            }
+            case kUnsignedInt: {
+                uint32_t raw = 0;
+                std::memcpy(&raw, element + c * sizeof(raw), sizeof(raw));
+                value = static_cast<float>(raw);
+                break;
+            }
+            }
+            out[c] = value;
+        }
+    }
+
+    uint32_t AccessorView::ReadIndex(size_t index) const {
+        const uint8_t* element = data + stride * index;
+        switch (componentType) {
+        case kUnsignedByte:
+            return element[0];
+        case kUnsignedShort: {
+            uint16_t value = 0;
+            std::memcpy(&value, element, sizeof(value));
+            return value;
+        }
+        case kUnsignedInt:
+            return ReadU32(element);
+        default:
+            return UINT32_MAX;
+        }
+    }
+
+    bool IsGlbFile(std::string_view filename) {
+        if (filename.size() < 4) {
+            return false;
+        }
+        const std::string_view extension = filename.substr(filename.size() - 4);
+        for (size_t i = 0; i < 4; ++i) {
+            if (std::tolower(static_cast<unsigned char>(extension[i])) != ".glb"[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    ObjModel LoadFile(const std::string& directoryPath, const std::string& filename, JobSystem* jobSystem) {
+        MappedFile file;
+        const bool isOpened = file.Open(directoryPath + "/" + filename);
+        assert(isOpened); //とりあえず開けなかったら止める
+        (void)isOpened;
+        return Parse(file.GetData(), file.GetSize(), directoryPath, jobSystem);
+    }
+
+    ObjModel Parse(const uint8_t* data, size_t size, const std::string& directoryPath, JobSystem* jobSystem) {
+        ObjModel model;
+        // ヘッダ(magic, version, length)と最初のチャンク(JSON)
+        if (!data || size < 20 || ReadU32(data) != kMagic || ReadU32(data + 4) != 2 || ReadU32(data + 8) > size) {
+            return model;
+        }
+        const size_t totalSize = ReadU32(data + 8);
+        const size_t jsonSize = ReadU32(data + 12);
+        if (ReadU32(data + 16) != kChunkJson || 20 + jsonSize > totalSize) {
+            return model;
+        }
+        Document document;
+        JsonParser parser(std::string_view(reinterpret_cast<const char*>(data + 20), jsonSize));
+        if (!parser.Parse(document.root) || document.root.type != JsonValue::Type::kObject) {
+            return model;
+        }
+        // 次のチャンクがBINならバッファ0
+        const size_t binHeader = 20 + jsonSize;
+        if (binHeader + 8 <= totalSize && ReadU32(data + binHeader + 4) == kChunkBin) {
+            const size_t binSize = ReadU32(data + binHeader);
+            if (binHeader + 8 + binSize <= totalSize) {
+                document.bin = data + binHeader + 8;
+                document.binSize = binSize;
+            }
+        }
+
+        if (const JsonValue* materials = document.root.Find("materials")) {
+            model.materials.reserve(materials->array.size());
+            for (const JsonValue& material : materials->array) {
+                model.materials.push_back(ConvertMaterial(document, material, directoryPath));
+            }
+        }
+
+        // 描くメッシュを並べる(sceneのノードを深さ優先で。シーンが無ければメッシュの順に変換なしで1回ずつ)
+        std::vector<MeshInstance> instances;
+        const uint32_t sceneIndex = document.root.GetIndex("scene");
+        const JsonValue* scene = document.Get("scenes", sceneIndex != UINT32_MAX ? sceneIndex : 0);
+        const JsonValue* rootNodes = scene ? scene->Find("nodes") : nullptr;
+        if (rootNodes) {
+            instances = CollectInstances(document, *rootNodes);
+        } else if (const JsonValue* meshes = document.root.Find("meshes")) {
+            instances.resize(meshes->array.size());
+            for (size_t i = 0; i < instances.size(); ++i) {
+                instances[i].meshIndex = static_cast<uint32_t>(i);
+                instances[i].world = Math::MakeIdentity4x4();
+            }
+        }
+
+        // プリミティブを並べる(描くメッシュの順、その中のプリミティブの順。複数のノードが指すメッシュはその数だけ)
+        std::vector<std::pair<const JsonValue*, const MeshInstance*>> primitives;
+        for (const MeshInstance& instance : instances) {
+            if (const JsonValue* list = document.Get("meshes", instance.meshIndex)->Find("primitives")) {
+                for (const JsonValue& primitive : list->array) {
+                    primitives.emplace_back(&primitive, &instance);
+                }
+            }
+        }
+
+        model.meshes.resize(primitives.size());
+        std::vector<uint8_t> isConverted(primitives.size(), 0);
+        const uint32_t materialCount = static_cast<uint32_t>(model.materials.size());
+        ParallelFor(jobSystem, primitives.size(), 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                const auto& [primitive, instance] = primitives[i];
+                isConverted[i] = ConvertPrimitive(document, *primitive, *instance, materialCount, model.meshes[i]) ? 1 : 0;
+            }
+        });
+
+        // 変換できなかったものを外す(順は保つ)
+        size_t keep = 0;
+        for (size_t i = 0; i < model.meshes.size(); ++i) {
+            if (isConverted[i] && !model.meshes[i].indices.empty()) {
+                if (keep != i) {
+                    model.meshes[keep] = std::move(model.meshes[i]);
+                }
+                ++keep;
+            }
+        }
+        model.meshes.resize(keep);
+        return model;
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../../math/ObjModel.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class JobSystem;
+
+/// <summary>
+/// glTF 2.0 のバイナリ(.glb)の読み込み
+/// ファイルをMappedFileで割り当て、アクセサはBINチャンクを直接指す(数値の文字列解析も読み込みの複写もない)
+/// 結果は objと同じ座標系(xを反転・時計回りが表・UVは左上が原点)の、添字付きのObjModelになる
+/// 三角形リストのプリミティブ1つがメッシュ1つ、マテリアルはglTFの並びのまま ObjModel::materials に入る
+/// シーン(sceneか0番)のノードを辿り、親子を掛けたノードの変換(matrixかTRS)を頂点・法線に掛ける(裏返す変換なら回り順も直す)
+/// 複数のノードが指すメッシュはその数だけ複製する。シーンが無ければメッシュを変換なしで1回ずつ読む
+/// 外部の .bin・埋め込み画像・疎なアクセサには対応しない(そのプリミティブ・テクスチャは飛ばす)
+/// 法線が無ければ0のまま(MeshCache::PrepareMeshで作る)
+/// </summary>
+namespace GlbLoader {
+
+    /// <summary>
+    /// アクセサ1つ分の、バイナリの中を指す窓(複写しない)
+    /// 要素iの先頭は data + stride * i
+    /// </summary>
+    struct AccessorView {
+        const uint8_t* data = nullptr;
+        size_t count = 0;
+        size_t stride = 0;
+        // GL の型番号(5126 = float など)
+        uint32_t componentType = 0;
+        // SCALAR = 1, VEC2 = 2 ...
+        uint32_t componentCount = 0;
+        bool isNormalized = false;
+
+        /// <summary>
+        /// 要素indexの成分をfloatにしてoutへ(成分が足りなければ残りはそのまま)
+        /// </summary>
+        void ReadFloats(size_t index, float* out, uint32_t maxComponents) const;
+
+        /// <summary>
+        /// 要素indexを添字として読む(SCALARの整数)
+        /// </summary>
+        uint32_t ReadIndex(size_t index) const;
+    };
+
+    /// <summary>
+    /// 拡張子が .glb か(大文字小文字は区別しない)
+    /// </summary>
+    bool IsGlbFile(std::string_view filename);
+
+    /// <summary>
+    /// ファイルを読み込む
+    /// </summary>
+    ObjModel LoadFile(const std::string& directoryPath, const std::string& filename, JobSystem* jobSystem = nullptr);
+
+    /// <summary>
+    /// glbのバイト列を変換する(画像のuriはdirectoryPathから解決する)
+    /// 形式が壊れていれば空のモデル。jobSystemを渡すとメッシュごとに並列にする
+    /// </summary>
+    ObjModel Parse(const uint8_t* data, size_t size, const std::string& directoryPath, JobSystem* jobSystem = nullptr);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// <summary>
+/// ファイルを読み取り専用でメモリに割り当てる(読み込みの複写をせずに、中身を直接指せる)
+/// 割り当てた領域はCloseかデストラクタまで有効
+/// </summary>
+class MappedFile {
+private: // メンバ変数
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    // OSのハンドル(Windowsはファイルと割り当て。それ以外はファイル記述子を使わないので空)
+    void* fileHandle_ = nullptr;
+    void* mappingHandle_ = nullptr;
+
+public: // メンバ関数
+
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// <summary>
+    /// ファイルを割り当てる。開けない・空のファイルならfalse
+    /// </summary>
+    bool Open(const std::string& path);
+
+    /// <summary>
+    /// 割り当てを外す
+    /// </summary>
+    void Close();
+
+    // ゲッター
+    const uint8_t* GetData() const { return data_; }
+    size_t GetSize() const { return size_; }
+    bool IsOpen() const { return data_ != nullptr; }
+};
@@ -0,0 +1,225 @@
+#include "MaterialLibrary.h"
+
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <system_error>
+
+namespace {
+
+    inline bool IsSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // 次の空白までを1要素として切り出す(行の中だけを走査するので改行は来ない)
+    inline std::string_view NextToken(const char*& p, const char* end) {
+        while (p < end && IsSpace(*p)) {
+            ++p;
+        }
+        const char* begin = p;
+        while (p < end && !IsSpace(*p)) {
+            ++p;
+        }
+        return std::string_view(begin, static_cast<size_t>(p - begin));
+    }
+
+    // 数値の要素を1つ読む。数値でなければ読み進めずにfalse(valueはそのまま)
+    inline bool NextFloat(const char*& p, const char* end, float& value) {
+        const char* start = p;
+        std::string_view token = NextToken(p, end);
+        if (!token.empty() && token.front() == '+') {
+            token.remove_prefix(1);
+        }
+        float parsed = 0.0f;
+        const std::from_chars_result result = std::from_chars(token.data(), token.data() + token.size(), parsed);
+        if (token.empty() || result.ec != std::errc{} || result.ptr != token.data() + token.size()) {
+            p = start;
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+
+    // 覚えているライブラリ1つ分
+    struct CacheEntry {
+        std::shared_ptr<const MaterialLibrary> library;
+        uintmax_t size = 0;
+        std::filesystem::file_time_type writeTime{};
+    };
+
+    std::mutex cacheMutex;
+    std::unordered_map<std::string, CacheEntry> cacheEntries;
+    size_t parseCount = 0;
+    size_t hitCount = 0;
+}
+
+uint32_t MaterialLibrary::Find(const std::string& name) const {
+    auto it = indices.find(name);
+    return it != indices.end() ? it->second : kNotFound;
+}
+
+namespace MaterialLibraryCache {
+
+    std::shared_ptr<const MaterialLibrary> Load(const std::string& directoryPath, const std::string& filename) {
+        const std::string path = directoryPath + "/" + filename;
+        const std::string key = std::filesystem::path(path).lexically_normal().generic_string();
+
+        // 変わったかはサイズと更新時刻で見る(読んで比べるより安い)
+        std::error_code sizeError;
+        std::error_code timeError;
+        const uintmax_t size = std::filesystem::file_size(path, sizeError);
+        const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, timeError);
+        // 無い・読めないものはマテリアル無しで続ける(ワーカーの中でも止めない)
+        if (sizeError || timeError) {
+            return std::make_shared<const MaterialLibrary>();
+        }
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            auto it = cacheEntries.find(key);
+            if (it != cacheEntries.end() && it->second.size == size && it->second.writeTime == writeTime) {
+                ++hitCount;
+                return it->second.library;
+            }
+        }
+
+        // 解析はロックの外で行う(同時に頼まれたら2回解析することもあるが、結果は同じ)
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            return std::make_shared<const MaterialLibrary>();
+        }
+        std::string text(static_cast<size_t>(size), '\0');
+        file.read(text.data(), static_cast<std::streamsize>(text.size()));
+        text.resize(static_cast<size_t>(file.gcount()));
+        auto library = std::make_shared<const MaterialLibrary>(Parse(text, directoryPath));
+
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        ++parseCount;
+        cacheEntries[key] = { library, size, writeTime };
+        return library;
+    }
+
+    MaterialLibrary Parse(std::string_view text, const std::string& directoryPath) {
+        MaterialLibrary library;
+        // 今書いているマテリアル(newmtlより前の行は捨てる)
+        ObjMaterial* current = nullptr;
+        // テクスチャのパスを解決済みのものと共有する
+        std::unordered_map<std::string, uint32_t> texturePathIndices;
+
+        const char* cursor = text.data();
+        const char* const textEnd = cursor + text.size();
+        while (cursor < textEnd) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<size_t>(textEnd - cursor)));
+            if (!lineEnd) {
+                lineEnd = textEnd;
+            }
+            const char* p = cursor;
+            cursor = lineEnd + (lineEnd < textEnd ? 1 : 0);
+
+            const std::string_view id = NextToken(p, lineEnd);
+            if (id == "newmtl") {
+                std::string name(NextToken(p, lineEnd));
+                auto [it, isInserted] = library.indices.try_emplace(name, static_cast<uint32_t>(library.materials.size()));
+                if (isInserted) {
+                    library.names.push_back(std::move(name));
+                    library.materials.emplace_back();
+                } else {
+                    library.materials[it->second] = ObjMaterial();
+                }
+                current = &library.materials[it->second];
+                continue;
+            }
+            if (!current) {
+                continue;
+            }
+
+            if (id == "Kd") {
+                NextFloat(p, lineEnd, current->color.x);
+                NextFloat(p, lineEnd, current->color.y);
+                NextFloat(p, lineEnd, current->color.z);
+                current->color.w = 1.0f;
+            } else if (id == "Ka") {
+                NextFloat(p, lineEnd, current->ambient.x);
+                NextFloat(p, lineEnd, current->ambient.y);
+                NextFloat(p, lineEnd, current->ambient.z);
+            } else if (id == "Ks") {
+                NextFloat(p, lineEnd, current->specular.x);
+                NextFloat(p, lineEnd, current->specular.y);
+                NextFloat(p, lineEnd, current->specular.z);
+            } else if (id == "Ns") {
+                NextFloat(p, lineEnd, current->shininess);
+            } else if (id == "d" || id == "Tr") {
+                NextFloat(p, lineEnd, current->alpha);
+            } else if (id == "map_Kd") {
+                // テクスチャオプション(-o/-sは u [v [w]] の数値が続く)
+                current->uvTransform = Math::MakeIdentity4x4();
+                for (std::string_view token = NextToken(p, lineEnd); !token.empty(); token = NextToken(p, lineEnd)) {
+                    if (token == "-o" || token == "-s") {
+                        const bool isOffset = token == "-o";
+                        float values[3] = { isOffset ? 0.0f : 1.0f, isOffset ? 0.0f : 1.0f, isOffset ? 0.0f : 1.0f };
+                        for (float& value : values) {
+                            if (!NextFloat(p, lineEnd, value)) {
+                                break;
+                            }
+                        }
+                        if (isOffset) {
+                            current->uvTransform.m[3][0] = values[0];
+                            current->uvTransform.m[3][1] = values[1];
+                        } else {
+                            current->uvTransform.m[0][0] = values[0];
+                            current->uvTransform.m[1][1] = values[1];
+                        }
+                        continue;
+                    }
+                    // パスの解決はライブラリの中で1回だけ
+                    std::string path = directoryPath + "/" + std::string(token);
+                    auto [it, isInserted] = texturePathIndices.try_emplace(path, static_cast<uint32_t>(library.texturePaths.size()));
+                    if (isInserted) {
+                        library.texturePaths.push_back(std::move(path));
+                    }
+                    current->textureFilePath = library.texturePaths[it->second];
+                    break;
+                }
+            }
+        }
+        return library;
+    }
+
+    Stats GetStats() {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        return { cacheEntries.size(), parseCount, hitCount };
+    }
+
+    void Clear() {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        cacheEntries.clear();
+    }
+}
+
+MaterialTableBuilder::MaterialTableBuilder(std::vector<ObjMaterial>& materials, const std::string& directoryPath)
+    : materials_(materials), directoryPath_(directoryPath) {
+}
+
+void MaterialTableBuilder::AddLibrary(const std::string& filename) {
+    Library library;
+    library.library = MaterialLibraryCache::Load(directoryPath_, filename);
+    library.modelIndices.assign(library.library->materials.size(), ObjMesh::kNoMaterial);
+    libraries_.push_back(std::move(library));
+}
+
+uint32_t MaterialTableBuilder::Use(const std::string& name) {
+    for (auto it = libraries_.rbegin(); it != libraries_.rend(); ++it) {
+        const uint32_t index = it->library->Find(name);
+        if (index == MaterialLibrary::kNotFound) {
+            continue;
+        }
+        uint32_t& modelIndex = it->modelIndices[index];
+        if (modelIndex == ObjMesh::kNoMaterial) {
+            modelIndex = static_cast<uint32_t>(materials_.size());
+            materials_.push_back(it->library->materials[index]);
+        }
+        return modelIndex;
+    }
+    return ObjMesh::kNoMaterial;
+}
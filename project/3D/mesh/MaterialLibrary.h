@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../../math/ObjModel.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// mtlファイル1つ分のマテリアルの表(読み終わったら書き換えない)
+/// </summary>
+struct MaterialLibrary {
+    // 見つからない時の番号
+    static inline const uint32_t kNotFound = UINT32_MAX;
+
+    // newmtlの順(同じ名前が2回出たら、後の内容で最初の位置を上書きする)
+    std::vector<std::string> names;
+    std::vector<ObjMaterial> materials;
+    // 名前から表の番号
+    std::unordered_map<std::string, uint32_t> indices;
+    // 使っているテクスチャのパス(重複なし。パスはmtlのディレクトリから解決済み)
+    std::vector<std::string> texturePaths;
+
+    /// <summary>
+    /// 名前から表の番号を探す。無ければkNotFound
+    /// </summary>
+    uint32_t Find(const std::string& name) const;
+};
+
+/// <summary>
+/// mtlファイルをパスごとに1回だけ解析して使い回す(どのスレッドから呼んでもよい)
+/// ファイルのサイズか更新時刻が変わっていたら解析し直す
+/// </summary>
+namespace MaterialLibraryCache {
+
+    // 数(確認用)
+    struct Stats {
+        // 覚えているライブラリの数
+        size_t libraryCount = 0;
+        // 実際に解析した回数
+        size_t parseCount = 0;
+        // 解析せずに返した回数
+        size_t hitCount = 0;
+    };
+
+    /// <summary>
+    /// ライブラリを返す(覚えていなければ読んで解析する)
+    /// 読めなければ空のライブラリ(覚えないので、置かれたら次で読む)
+    /// </summary>
+    std::shared_ptr<const MaterialLibrary> Load(const std::string& directoryPath, const std::string& filename);
+
+    /// <summary>
+    /// mtlのテキストを1回なめて表を作る(map_Kdのパスは directoryPath + "/" + 名前)
+    /// </summary>
+    MaterialLibrary Parse(std::string_view text, const std::string& directoryPath);
+
+    Stats GetStats();
+
+    /// <summary>
+    /// 覚えているライブラリを捨てる(使っている側の持つものは消えない)
+    /// </summary>
+    void Clear();
+}
+
+/// <summary>
+/// objの読み込み中に、mtllibで読んだライブラリとusemtlの名前から、ObjModel::materialsを作る
+/// モデルの表には使われたマテリアルだけを、使われた順に1回ずつ入れる
+/// </summary>
+class MaterialTableBuilder {
+private: // メンバ変数
+
+    std::vector<ObjMaterial>& materials_;
+    std::string directoryPath_;
+
+    struct Library {
+        std::shared_ptr<const MaterialLibrary> library;
+        // ライブラリの表の番号 → モデルの表の番号(まだ使っていなければkNoMaterial)
+        std::vector<uint32_t> modelIndices;
+    };
+    std::vector<Library> libraries_;
+
+public: // メンバ関数
+
+    /// <summary>
+    /// materialsに書き足していく(mtllibはdirectoryPathから読む)
+    /// </summary>
+    MaterialTableBuilder(std::vector<ObjMaterial>& materials, const std::string& directoryPath);
+
+    /// <summary>
+    /// mtllibの行
+    /// </summary>
+    void AddLibrary(const std::string& filename);
+
+    /// <summary>
+    /// usemtlの行。モデルの表の番号を返す(どのライブラリにも無ければkNoMaterialで、既定のマテリアルになる)
+    /// 同じ名前が複数のライブラリにあれば、後から読んだものを使う
+    /// </summary>
+    uint32_t Use(const std::string& name);
+};
@@ -0,0 +1,94 @@
+#include "MeshAssetCache.h"
+#include "MeshCache.h"
+
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+
+MeshAssetCache::Handle MeshAssetCache::Load(const std::string& directoryPath, const std::string& filename, JobSystem* jobSystem, bool* isShared) {
+    const std::string key = MakeKey(directoryPath, filename);
+
+    std::promise<Handle> promise;
+    std::shared_future<Handle> loading;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!entries_.contains(key)) {
+            // 新しく足す時に、消えたものの項目を捨てる
+            std::erase_if(entries_, [](const auto& item) { return item.second.asset.expired() && !item.second.loading.valid(); });
+        }
+        Entry& entry = entries_[key];
+        if (Handle asset = entry.asset.lock()) {
+            ++shareCount_;
+            if (isShared) {
+                *isShared = true;
+            }
+            return asset;
+        }
+        if (entry.loading.valid()) {
+            loading = entry.loading;
+            ++shareCount_;
+        } else {
+            // 自分が読む。後から来たものはこれを待つ
+            entry.loading = promise.get_future().share();
+            ++loadCount_;
+        }
+    }
+    if (loading.valid()) {
+        // 読み込み中のものを待つ(ロックは外してから)
+        if (isShared) {
+            *isShared = true;
+        }
+        return loading.get();
+    }
+    if (isShared) {
+        *isShared = false;
+    }
+
+    Handle asset = LoadUncached(directoryPath, filename, jobSystem);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = entries_[key];
+        entry.asset = asset;
+        entry.loading = {};
+    }
+    promise.set_value(asset);
+    return asset;
+}
+
+MeshAssetCache::Handle MeshAssetCache::Find(const std::string& directoryPath, const std::string& filename) const {
+    const std::string key = MakeKey(directoryPath, filename);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    return it != entries_.end() ? it->second.asset.lock() : nullptr;
+}
+
+MeshAssetCache::Stats MeshAssetCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    for (const auto& [key, entry] : entries_) {
+        if (!entry.asset.expired()) {
+            ++stats.liveCount;
+        }
+    }
+    stats.loadCount = loadCount_;
+    stats.shareCount = shareCount_;
+    return stats;
+}
+
+MeshAssetCache::Handle MeshAssetCache::LoadUncached(const std::string& directoryPath, const std::string& filename, JobSystem* jobSystem) {
+    const auto start = std::chrono::steady_clock::now();
+    auto asset = std::make_shared<MeshAsset>();
+    asset->key = MakeKey(directoryPath, filename);
+    asset->model = MeshCache::LoadFile(directoryPath, filename, &asset->isCacheHit, jobSystem);
+    asset->loadTimeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return asset;
+}
+
+std::string MeshAssetCache::MakeKey(const std::string& directoryPath, const std::string& filename) {
+    std::string key = (std::filesystem::path(directoryPath) / filename).lexically_normal().generic_string();
+    // Windowsのファイル名は大文字と小文字を区別しないので揃える
+    for (char& c : key) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return key;
+}
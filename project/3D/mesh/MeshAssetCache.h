@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../../math/ObjModel.h"
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+class JobSystem;
+
+/// <summary>
+/// 読み込んだモデル1つ分(読み終わったら書き換えない。同じファイルを使うものがすべてこれを共有する)
+/// </summary>
+struct MeshAsset {
+    // MeshAssetCache::MakeKeyで作ったキー
+    std::string key;
+    ObjModel model;
+    // MeshCacheのバイナリキャッシュを使えたか
+    bool isCacheHit = false;
+    // 読み込みにかかった時間(ms)
+    float loadTimeMs = 0.0f;
+};
+
+/// <summary>
+/// 同じファイルのモデルを1回だけ読み、参照カウント付きのハンドルで配る
+/// キャッシュは弱い参照しか持たないので、ハンドルがすべて消えたらモデルも消える(項目は次に新しいものを読む時に捨てる)
+/// 別のスレッドが読み込み中のファイルを頼まれたら、読み終わるのを待って同じものを返す(解析は1回だけ)
+/// D3D12に依存しないので、ヘッドレスでも動く
+/// </summary>
+class MeshAssetCache {
+public:
+
+    using Handle = std::shared_ptr<const MeshAsset>;
+
+    // 数(デバッグ表示用)
+    struct Stats {
+        // 今生きている(ハンドルが残っている)モデルの数
+        size_t liveCount = 0;
+        // 実際にファイルを読んだ回数
+        size_t loadCount = 0;
+        // 読み込み済み・読み込み中のものを渡した回数
+        size_t shareCount = 0;
+    };
+
+private: // メンバ変数
+
+    struct Entry {
+        std::weak_ptr<const MeshAsset> asset;
+        // 読み込み中ならその結果(終わったら空にする)
+        std::shared_future<Handle> loading;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    size_t loadCount_ = 0;
+    size_t shareCount_ = 0;
+
+public: // メンバ関数
+
+    /// <summary>
+    /// モデルを返す。生きていればそれを、誰かが読み込み中なら終わるのを待ってそれを、どちらでもなければ読む
+    /// isSharedには読まずに済んだかが入る。どのスレッドから呼んでもよい
+    /// </summary>
+    Handle Load(const std::string& directoryPath, const std::string& filename, JobSystem* jobSystem = nullptr, bool* isShared = nullptr);
+
+    /// <summary>
+    /// 生きていればそれを返す(読まない・待たない)。無ければnullptr
+    /// </summary>
+    Handle Find(const std::string& directoryPath, const std::string& filename) const;
+
+    Stats GetStats() const;
+
+    /// <summary>
+    /// キャッシュを通さずに読む(キャッシュが無い時用)
+    /// </summary>
+    static Handle LoadUncached(const std::string& directoryPath, const std::string& filename, JobSystem* jobSystem = nullptr);
+
+    /// <summary>
+    /// キー(ディレクトリとファイル名をつないで . や .. を畳み、区切りを / にして小文字にする)
+    /// "resources/obj" + "teapot.obj" と "resources/obj/" + "./Teapot.obj" は同じキーになる
+    /// </summary>
+    static std::string MakeKey(const std::string& directoryPath, const std::string& filename);
+};
@@ -0,0 +1,330 @@
+#include "MeshBounds.h"
+#include "../../function/Math.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define MESH_BOUNDS_X64
+#include <immintrin.h>
+#endif
+
+namespace {
+
+    // floatで足す頂点の数(これごとにdoubleへ移して、大きいメッシュでも桁落ちしないようにする)
+    const size_t kFlushCount = 256;
+
+    // 1回目の走査の結果(和と積の和はpivotからの相対)
+    struct Moments {
+        Vector3 minimum = { FLT_MAX, FLT_MAX, FLT_MAX };
+        Vector3 maximum = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        double sum[3] = {};
+        // xx, xy, xz, yy, yz, zz
+        double products[6] = {};
+    };
+
+#ifndef MESH_BOUNDS_X64
+
+    void AccumulateScalar(const std::vector<VertexData>& vertices, const Vector3& pivot, Moments& moments) {
+        for (size_t begin = 0; begin < vertices.size(); begin += kFlushCount) {
+            const size_t end = (std::min)(begin + kFlushCount, vertices.size());
+            float sum[3] = {};
+            float products[6] = {};
+            for (size_t i = begin; i < end; ++i) {
+                const Vector4& p = vertices[i].position;
+                moments.minimum = { (std::min)(moments.minimum.x, p.x), (std::min)(moments.minimum.y, p.y), (std::min)(moments.minimum.z, p.z) };
+                moments.maximum = { (std::max)(moments.maximum.x, p.x), (std::max)(moments.maximum.y, p.y), (std::max)(moments.maximum.z, p.z) };
+                const float x = p.x - pivot.x;
+                const float y = p.y - pivot.y;
+                const float z = p.z - pivot.z;
+                sum[0] += x;
+                sum[1] += y;
+                sum[2] += z;
+                products[0] += x * x;
+                products[1] += x * y;
+                products[2] += x * z;
+                products[3] += y * y;
+                products[4] += y * z;
+                products[5] += z * z;
+            }
+            for (int k = 0; k < 3; ++k) {
+                moments.sum[k] += sum[k];
+            }
+            for (int k = 0; k < 6; ++k) {
+                moments.products[k] += products[k];
+            }
+        }
+    }
+
+#else
+
+    // 1頂点を1本のレジスタ(x, y, z, w)で扱う。箱はmin/max 1命令ずつ、
+    // 積の和は (x,y,z,1) に x,y,z を掛けた3本を足していく(wのレーンには和が溜まる)
+    void AccumulateSSE(const std::vector<VertexData>& vertices, const Vector3& pivot, Moments& moments) {
+        const __m128 pivotV = _mm_setr_ps(pivot.x, pivot.y, pivot.z, 0.0f);
+        const __m128 maskXYZ = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+        const __m128 oneW = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+        __m128 minimum = _mm_set1_ps(FLT_MAX);
+        __m128 maximum = _mm_set1_ps(-FLT_MAX);
+
+        for (size_t begin = 0; begin < vertices.size(); begin += kFlushCount) {
+            const size_t end = (std::min)(begin + kFlushCount, vertices.size());
+            // (xx, yx, zx, x) (xy, yy, zy, y) (xz, yz, zz, z)
+            __m128 sumX = _mm_setzero_ps();
+            __m128 sumY = _mm_setzero_ps();
+            __m128 sumZ = _mm_setzero_ps();
+            for (size_t i = begin; i < end; ++i) {
+                const __m128 p = _mm_loadu_ps(&vertices[i].position.x);
+                minimum = _mm_min_ps(minimum, p);
+                maximum = _mm_max_ps(maximum, p);
+                const __m128 q = _mm_or_ps(_mm_and_ps(_mm_sub_ps(p, pivotV), maskXYZ), oneW);
+                sumX = _mm_add_ps(sumX, _mm_mul_ps(q, _mm_shuffle_ps(q, q, _MM_SHUFFLE(0, 0, 0, 0))));
+                sumY = _mm_add_ps(sumY, _mm_mul_ps(q, _mm_shuffle_ps(q, q, _MM_SHUFFLE(1, 1, 1, 1))));
+                sumZ = _mm_add_ps(sumZ, _mm_mul_ps(q, _mm_shuffle_ps(q, q, _MM_SHUFFLE(2, 2, 2, 2))));
+            }
+            alignas(16) float x[4], y[4], z[4];
+            _mm_store_ps(x, sumX);
+            _mm_store_ps(y, sumY);
+            _mm_store_ps(z, sumZ);
+            moments.sum[0] += x[3];
+            moments.sum[1] += y[3];
+            moments.sum[2] += z[3];
+            moments.products[0] += x[0];
+            moments.products[1] += y[0];
+            moments.products[2] += z[0];
+            moments.products[3] += y[1];
+            moments.products[4] += z[1];
+            moments.products[5] += z[2];
+        }
+
+        alignas(16) float minValues[4], maxValues[4];
+        _mm_store_ps(minValues, minimum);
+        _mm_store_ps(maxValues, maximum);
+        moments.minimum = { minValues[0], minValues[1], minValues[2] };
+        moments.maximum = { maxValues[0], maxValues[1], maxValues[2] };
+    }
+
+#endif
+
+    /// <summary>
+    /// 対称行列の固有ベクトル(Jacobi法)。vectorsの列が固有ベクトル、aの対角が固有値になる
+    /// </summary>
+    void Jacobi(double a[3][3], double vectors[3][3]) {
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                vectors[i][j] = i == j ? 1.0 : 0.0;
+            }
+        }
+        const double scale = std::fabs(a[0][0]) + std::fabs(a[1][1]) + std::fabs(a[2][2]);
+        for (int sweep = 0; sweep < 32; ++sweep) {
+            const double offDiagonal = std::fabs(a[0][1]) + std::fabs(a[0][2]) + std::fabs(a[1][2]);
+            if (offDiagonal <= 1e-12 * scale) {
+                return;
+            }
+            for (int p = 0; p < 2; ++p) {
+                for (int q = p + 1; q < 3; ++q) {
+                    if (a[p][q] == 0.0) {
+                        continue;
+                    }
+                    // a[p][q]を0にする回転
+                    const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                    const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+                    const double c = 1.0 / std::sqrt(t * t + 1.0);
+                    const double s = t * c;
+                    for (int k = 0; k < 3; ++k) {
+                        const double akp = a[k][p], akq = a[k][q];
+                        a[k][p] = c * akp - s * akq;
+                        a[k][q] = s * akp + c * akq;
+                    }
+                    for (int k = 0; k < 3; ++k) {
+                        const double apk = a[p][k], aqk = a[q][k];
+                        a[p][k] = c * apk - s * aqk;
+                        a[q][k] = s * apk + c * aqk;
+                    }
+                    for (int k = 0; k < 3; ++k) {
+                        const double vkp = vectors[k][p], vkq = vectors[k][q];
+                        vectors[k][p] = c * vkp - s * vkq;
+                        vectors[k][q] = s * vkp + c * vkq;
+                    }
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// 共分散から主成分の軸を求める(固有値の大きい順。正規化して直交させる)
+    /// </summary>
+    void ComputePrincipalAxes(const Moments& moments, size_t count, Vector3 axes[3]) {
+        const double n = static_cast<double>(count);
+        const double mean[3] = { moments.sum[0] / n, moments.sum[1] / n, moments.sum[2] / n };
+        const double* m = moments.products;
+        double covariance[3][3] = {
+            { m[0] / n - mean[0] * mean[0], m[1] / n - mean[0] * mean[1], m[2] / n - mean[0] * mean[2] },
+            { m[1] / n - mean[0] * mean[1], m[3] / n - mean[1] * mean[1], m[4] / n - mean[1] * mean[2] },
+            { m[2] / n - mean[0] * mean[2], m[4] / n - mean[1] * mean[2], m[5] / n - mean[2] * mean[2] },
+        };
+        double vectors[3][3];
+        Jacobi(covariance, vectors);
+
+        int order[3] = { 0, 1, 2 };
+        std::sort(order, order + 3, [&](int a, int b) { return covariance[a][a] > covariance[b][b]; });
+        const Vector3 first = Math::Normalize({ static_cast<float>(vectors[0][order[0]]), static_cast<float>(vectors[1][order[0]]), static_cast<float>(vectors[2][order[0]]) });
+        Vector3 second = { static_cast<float>(vectors[0][order[1]]), static_cast<float>(vectors[1][order[1]]), static_cast<float>(vectors[2][order[1]]) };
+        second = Math::Normalize(Math::Subtract(second, Math::Multiply(Math::Dot(second, first), first)));
+        axes[0] = first;
+        axes[1] = second;
+        axes[2] = Math::Cross(first, second);
+    }
+
+    float LengthSquared(const Vector3& v) {
+        return v.x * v.x + v.y * v.y + v.z * v.z;
+    }
+}
+
+namespace MeshBounds {
+
+    void Compute(ObjMesh& mesh, bool isObbComputed) {
+        const std::vector<VertexData>& vertices = mesh.vertices;
+        if (vertices.empty()) {
+            mesh.boundsMin = mesh.boundsMax = { 0.0f, 0.0f, 0.0f };
+            mesh.boundingSphere = { { 0.0f, 0.0f, 0.0f }, 0.0f };
+            mesh.orientedBounds = OBB{ { 0.0f, 0.0f, 0.0f }, { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } }, { 0.0f, 0.0f, 0.0f } };
+            return;
+        }
+
+        // 1回目: 箱と共分散(最初の頂点からの相対で足して桁落ちを抑える)
+        const Vector3 pivot = { vertices[0].position.x, vertices[0].position.y, vertices[0].position.z };
+        Moments moments;
+#ifdef MESH_BOUNDS_X64
+        AccumulateSSE(vertices, pivot, moments);
+#else
+        AccumulateScalar(vertices, pivot, moments);
+#endif
+        mesh.boundsMin = moments.minimum;
+        mesh.boundsMax = moments.maximum;
+        const Vector3 aabbCenter = Math::Multiply(0.5f, Math::Add(moments.minimum, moments.maximum));
+        const Vector3 aabbHalf = Math::Multiply(0.5f, Math::Subtract(moments.maximum, moments.minimum));
+
+        // 2回目: 主成分の軸ごとの範囲と、主軸の両端の頂点、箱の中心からの最遠距離
+        Vector3 axes[3];
+        ComputePrincipalAxes(moments, vertices.size(), axes);
+        float axisMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float axisMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        size_t lowest = 0, highest = 0;
+        float aabbRadiusSquared = 0.0f;
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            const Vector3 p = { vertices[i].position.x, vertices[i].position.y, vertices[i].position.z };
+            const Vector3 relative = Math::Subtract(p, pivot);
+            for (int k = 0; k < 3; ++k) {
+                const float d = Math::Dot(relative, axes[k]);
+                if (d < axisMin[k]) {
+                    axisMin[k] = d;
+                    lowest = k == 0 ? i : lowest;
+                }
+                if (d > axisMax[k]) {
+                    axisMax[k] = d;
+                    highest = k == 0 ? i : highest;
+                }
+            }
+            aabbRadiusSquared = (std::max)(aabbRadiusSquared, LengthSquared(Math::Subtract(p, aabbCenter)));
+        }
+
+        // 3回目: 主軸の両端を直径とする球から、外の頂点を含むように広げる(Ritter法)
+        const Vector3 lowPoint = { vertices[lowest].position.x, vertices[lowest].position.y, vertices[lowest].position.z };
+        const Vector3 highPoint = { vertices[highest].position.x, vertices[highest].position.y, vertices[highest].position.z };
+        Vector3 center = Math::Multiply(0.5f, Math::Add(lowPoint, highPoint));
+        float radius = 0.5f * Math::Length(Math::Subtract(highPoint, lowPoint));
+        for (const VertexData& vertex : vertices) {
+            const Vector3 offset = Math::Subtract({ vertex.position.x, vertex.position.y, vertex.position.z }, center);
+            const float distanceSquared = LengthSquared(offset);
+            if (distanceSquared <= radius * radius) {
+                continue;
+            }
+            const float distance = std::sqrt(distanceSquared);
+            const float newRadius = 0.5f * (radius + distance);
+            center = Math::Add(center, Math::Multiply((newRadius - radius) / distance, offset));
+            radius = newRadius;
+        }
+        // 箱の中心からの球の方が小さければそちらにする
+        const float aabbRadius = std::sqrt(aabbRadiusSquared);
+        if (aabbRadius < radius) {
+            center = aabbCenter;
+            radius = aabbRadius;
+        }
+        // 丸め誤差で端の頂点が外に出ないよう、わずかに広げる
+        mesh.boundingSphere = { center, radius * (1.0f + 1e-5f) + 1e-7f };
+
+        // 向きを合わせた箱(体積が軸に沿った箱より小さくなければ使わない。平らな形でも比べられるよう、厚みに下限を付ける)
+        OBB aabbBox{ aabbCenter, { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } }, aabbHalf };
+        mesh.orientedBounds = aabbBox;
+        if (!isObbComputed) {
+            return;
+        }
+        OBB obb;
+        obb.center = pivot;
+        for (int k = 0; k < 3; ++k) {
+            obb.orientations[k] = axes[k];
+            obb.center = Math::Add(obb.center, Math::Multiply(0.5f * (axisMin[k] + axisMax[k]), axes[k]));
+            obb.size[k] = 0.5f * (axisMax[k] - axisMin[k]);
+        }
+        const float thickness = 1e-4f * (std::max)({ aabbHalf.x, aabbHalf.y, aabbHalf.z, FLT_MIN });
+        auto volume = [&](const Vector3& size) {
+            return ((std::max)(size.x, thickness)) * ((std::max)(size.y, thickness)) * ((std::max)(size.z, thickness));
+        };
+        if (volume(obb.size) < volume(aabbHalf)) {
+            mesh.orientedBounds = obb;
+        }
+    }
+
+    Sphere TransformSphere(const Sphere& sphere, const Matrix4x4& world) {
+        const float scaleX = Math::Length({ world.m[0][0], world.m[0][1], world.m[0][2] });
+        const float scaleY = Math::Length({ world.m[1][0], world.m[1][1], world.m[1][2] });
+        const float scaleZ = Math::Length({ world.m[2][0], world.m[2][1], world.m[2][2] });
+        return { Math::Transform(sphere.center, world), sphere.radius * (std::max)({ scaleX, scaleY, scaleZ }) };
+    }
+
+    AABB TransformAabb(const Vector3& boundsMin, const Vector3& boundsMax, const Matrix4x4& world) {
+        const Vector3 center = Math::Transform(Math::Multiply(0.5f, Math::Add(boundsMin, boundsMax)), world);
+        const Vector3 half = Math::Multiply(0.5f, Math::Subtract(boundsMax, boundsMin));
+        // 変換後の各軸の半分の大きさは、元の半分の大きさに行列の成分の絶対値を掛けた和
+        Vector3 extent;
+        for (int j = 0; j < 3; ++j) {
+            extent[j] = std::fabs(world.m[0][j]) * half.x + std::fabs(world.m[1][j]) * half.y + std::fabs(world.m[2][j]) * half.z;
+        }
+        return { Math::Subtract(center, extent), Math::Add(center, extent) };
+    }
+
+    OBB TransformObb(const OBB& obb, const Matrix4x4& world) {
+        // 軸を行列の回転・拡縮の部分で変換する(長さがその軸の拡大率)
+        Vector3 directions[3];
+        for (int k = 0; k < 3; ++k) {
+            const Vector3& axis = obb.orientations[k];
+            directions[k] = {
+                axis.x * world.m[0][0] + axis.y * world.m[1][0] + axis.z * world.m[2][0],
+                axis.x * world.m[0][1] + axis.y * world.m[1][1] + axis.z * world.m[2][1],
+                axis.x * world.m[0][2] + axis.y * world.m[1][2] + axis.z * world.m[2][2],
+            };
+        }
+        // 軸に沿わない拡縮では変換した軸が直交しないので、1本目を基準に直交させ直し、
+        // 平行六面体の広がりを新しい軸に射影して大きさにする(軸が直交したままなら変換しただけと同じ)
+        OBB result;
+        result.center = Math::Transform(obb.center, world);
+        const float firstLength = Math::Length(directions[0]);
+        result.orientations[0] = firstLength > 0.0f ? Math::Multiply(1.0f / firstLength, directions[0]) : obb.orientations[0];
+        Vector3 second = Math::Subtract(directions[1], Math::Multiply(Math::Dot(directions[1], result.orientations[0]), result.orientations[0]));
+        if (Math::Length(second) <= 1e-6f * (std::max)(Math::Length(directions[1]), FLT_MIN)) {
+            second = Math::Perpendicular(result.orientations[0]);
+        }
+        result.orientations[1] = Math::Normalize(second);
+        result.orientations[2] = Math::Cross(result.orientations[0], result.orientations[1]);
+        for (int j = 0; j < 3; ++j) {
+            result.size[j] = 0.0f;
+            for (int k = 0; k < 3; ++k) {
+                result.size[j] += std::fabs(Math::Dot(result.orientations[j], directions[k])) * obb.size[k];
+            }
+        }
+        return result;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../../math/ObjModel.h"
+#include "../../math/shape/AABB.h"
+#include "../../math/shape/Sphere.h"
+#include "../../math/shape/OBB.h"
+
+/// <summary>
+/// メッシュを包む形(箱・球・向きを合わせた箱)を読み込みの時に1回だけ求め、実行時はワールド行列で安く変換する
+/// 1回目の走査(x64ではSSEで1頂点ずつ4レーン)で箱・平均・共分散を集め、
+/// 共分散の固有ベクトル(主成分)を向きを合わせた箱の軸にし、2回目の走査で軸ごとの範囲と球の初期値(主軸の両端)を、
+/// 3回目で球を広げる(Ritter法)。箱の中心からの球の方が小さければそちらを使う
+/// </summary>
+namespace MeshBounds {
+
+    /// <summary>
+    /// meshのboundsMin/boundsMax・boundingSphere・orientedBoundsを頂点から求める
+    /// isObbComputedがfalseなら向きを合わせた箱は作らず、軸に沿った箱と同じにする
+    /// 向きを合わせた箱が軸に沿った箱より小さくならない時も、軸に沿った箱と同じにする
+    /// </summary>
+    void Compute(ObjMesh& mesh, bool isObbComputed = true);
+
+    /// <summary>
+    /// 球をワールド行列で変換する(半径は3軸の拡大率の最大で伸ばす。拡縮・回転・移動の行列なら包んだまま)
+    /// </summary>
+    Sphere TransformSphere(const Sphere& sphere, const Matrix4x4& world);
+
+    /// <summary>
+    /// 軸に沿った箱を変換し、それを囲む軸に沿った箱を返す(8頂点ではなく中心と半分の大きさで求める)
+    /// </summary>
+    AABB TransformAabb(const Vector3& boundsMin, const Vector3& boundsMax, const Matrix4x4& world);
+
+    /// <summary>
+    /// 向きを合わせた箱を変換する(軸は正規化し、拡大率はsizeに入れる)
+    /// 箱の軸に沿わない拡縮で軸が直交しなくなる時は、直交させ直した軸で包み直す
+    /// </summary>
+    OBB TransformObb(const OBB& obb, const Matrix4x4& world);
+}
@@ -0,0 +1,488 @@
+#include "MeshCache.h"
+#include "ObjParser.h"
+#include "GlbLoader.h"
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
+#include "MeshNormals.h"
+#include "../../engine/JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+namespace {
+
+    // "MSHC"
+    const uint32_t kMagic = 0x4348534D;
+
+    // 依存ファイル1つ分の記録
+    struct FileStamp {
+        std::string name;
+        uint64_t size = 0;
+        int64_t writeTime = 0;
+        uint64_t hash = 0;
+    };
+
+    // 三角形の並びで、添字がすべて頂点の数より小さいか(壊れたキャッシュでGPU・CPUが範囲外を読まないように)
+    bool IsTriangleListInRange(const std::vector<uint32_t>& indices, size_t vertexCount) {
+        if (indices.size() % 3 != 0) {
+            return false;
+        }
+        uint32_t maxIndex = 0;
+        for (uint32_t index : indices) {
+            maxIndex = (std::max)(maxIndex, index);
+        }
+        return indices.empty() || maxIndex < vertexCount;
+    }
+
+    // ファイル全体を読む。開けなければfalse
+    bool ReadWholeFile(const std::string& path, std::string& text) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.seekg(0, std::ios::end);
+        const std::streamoff size = file.tellg();
+        file.seekg(0, std::ios::beg);
+        text.resize(static_cast<size_t>(size));
+        file.read(text.data(), size);
+        return static_cast<bool>(file);
+    }
+
+    int64_t GetWriteTime(const std::string& path) {
+        std::error_code ec;
+        const auto time = std::filesystem::last_write_time(path, ec);
+        return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+    }
+
+    uint64_t GetFileSize(const std::string& path) {
+        std::error_code ec;
+        const uintmax_t size = std::filesystem::file_size(path, ec);
+        return ec ? UINT64_MAX : static_cast<uint64_t>(size);
+    }
+
+    // objの中の mtllib の名前を集める
+    std::vector<std::string> FindMaterialLibraries(std::string_view text) {
+        std::vector<std::string> names;
+        size_t lineBegin = 0;
+        while (lineBegin < text.size()) {
+            size_t lineEnd = text.find('\n', lineBegin);
+            if (lineEnd == std::string_view::npos) {
+                lineEnd = text.size();
+            }
+            std::string_view line = text.substr(lineBegin, lineEnd - lineBegin);
+            lineBegin = lineEnd + 1;
+
+            const size_t first = line.find_first_not_of(" \t");
+            if (first == std::string_view::npos || line.compare(first, 6, "mtllib") != 0) {
+                continue;
+            }
+            line.remove_prefix(first + 6);
+            const size_t nameBegin = line.find_first_not_of(" \t");
+            if (nameBegin == std::string_view::npos) {
+                continue;
+            }
+            line.remove_prefix(nameBegin);
+            names.emplace_back(line.substr(0, line.find_first_of(" \t\r")));
+        }
+        return names;
+    }
+
+    // 書き込み用
+    class Writer {
+    public:
+        template<typename T>
+        void Write(const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            WriteBytes(&value, sizeof(T));
+        }
+
+        void WriteBytes(const void* data, size_t size) {
+            const char* bytes = static_cast<const char*>(data);
+            buffer_.insert(buffer_.end(), bytes, bytes + size);
+        }
+
+        void WriteString(const std::string& text) {
+            Write(static_cast<uint32_t>(text.size()));
+            WriteBytes(text.data(), text.size());
+        }
+
+        const std::vector<char>& GetBuffer() const { return buffer_; }
+
+    private:
+        std::vector<char> buffer_;
+    };
+
+    // 読み込み用(範囲外を読もうとしたら以降は全部失敗にする)
+    class Reader {
+    public:
+        Reader(const char* data, size_t size) : cursor_(data), end_(data + size) {}
+
+        template<typename T>
+        bool Read(T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            return ReadBytes(&value, sizeof(T));
+        }
+
+        bool ReadBytes(void* data, size_t size) {
+            if (static_cast<size_t>(end_ - cursor_) < size) {
+                cursor_ = end_;
+                isValid_ = false;
+                return false;
+            }
+            if (size > 0) {
+                std::memcpy(data, cursor_, size);
+            }
+            cursor_ += size;
+            return true;
+        }
+
+        bool ReadString(std::string& text) {
+            uint32_t size = 0;
+            if (!Read(size) || static_cast<size_t>(end_ - cursor_) < size) {
+                isValid_ = false;
+                return false;
+            }
+            text.assign(cursor_, size);
+            cursor_ += size;
+            return true;
+        }
+
+        bool IsValid() const { return isValid_; }
+        bool IsEnd() const { return cursor_ == end_; }
+        size_t GetRemaining() const { return static_cast<size_t>(end_ - cursor_); }
+
+    private:
+        const char* cursor_;
+        const char* end_;
+        bool isValid_ = true;
+    };
+
+    // 記録と今のファイルが同じか。サイズと更新時刻が同じならそのまま信じ、時刻だけ違えば中身のハッシュで確かめる
+    bool IsUpToDate(const std::string& directoryPath, const FileStamp& stamp) {
+        const std::string path = directoryPath + "/" + stamp.name;
+        if (GetFileSize(path) != stamp.size) {
+            return false;
+        }
+        if (GetWriteTime(path) == stamp.writeTime) {
+            return true;
+        }
+        std::string text;
+        if (!ReadWholeFile(path, text)) {
+            return false;
+        }
+        return MeshCache::Hash(text.data(), text.size()) == stamp.hash;
+    }
+}
+
+namespace MeshCache {
+
+    ObjModel LoadFile(const std::string& directoryPath, const std::string& filename, bool* isCacheHit, JobSystem* jobSystem) {
+        ObjModel model;
+        if (Read(directoryPath, filename, model)) {
+            if (isCacheHit) {
+                *isCacheHit = true;
+            }
+            return model;
+        }
+        if (isCacheHit) {
+            *isCacheHit = false;
+        }
+
+        // キャッシュが使えないので元ファイルを解析する
+        std::string text;
+        MappedFile glbFile;
+        std::string_view source;
+        if (GlbLoader::IsGlbFile(filename)) {
+            // glbは割り当てたまま変換とハッシュに使う
+            const bool isOpened = glbFile.Open(directoryPath + "/" + filename);
+            assert(isOpened); //とりあえず開けなかったら止める
+            (void)isOpened;
+            model = GlbLoader::Parse(glbFile.GetData(), glbFile.GetSize(), directoryPath, jobSystem);
+            source = std::string_view(reinterpret_cast<const char*>(glbFile.GetData()), glbFile.GetSize());
+        } else {
+            const bool isOpened = ReadWholeFile(directoryPath + "/" + filename, text);
+            assert(isOpened); //とりあえず開けなかったら止める
+            (void)isOpened;
+            model = jobSystem ? ObjParser::ParseParallel(text, directoryPath, jobSystem) : ObjParser::Parse(text, directoryPath);
+            source = text;
+        }
+        // GPU向けの並べ替え・塊・詳細度の生成(メッシュごとに独立)
+        ParallelFor(jobSystem, model.meshes.size(), 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t m = begin; m < end; ++m) {
+                PrepareMesh(model.meshes[m], jobSystem);
+            }
+        });
+        // 書けなくても(読み取り専用など)読み込み自体は成功にする
+        Write(directoryPath, filename, source, model);
+        return model;
+    }
+
+    void PrepareMesh(ObjMesh& mesh, JobSystem* jobSystem) {
+        MeshNormals::GenerateNormals(mesh, jobSystem);
+        MeshOptimizer::Optimize(mesh);
+        MeshletBuilder::Build(mesh);
+        MeshOptimizer::OptimizeVertexFetch(mesh.vertices, mesh.indices);
+        MeshSimplifier::GenerateLods(mesh);
+        MeshNormals::GenerateTangents(mesh, jobSystem);
+    }
+
+    bool Read(const std::string& directoryPath, const std::string& filename, ObjModel& model) {
+        // 1回で全体を読む
+        std::string data;
+        if (!ReadWholeFile(GetCachePath(directoryPath, filename), data)) {
+            return false;
+        }
+        Reader reader(data.data(), data.size());
+
+        uint32_t magic = 0, version = 0, vertexSize = 0, stampCount = 0, meshCount = 0;
+        reader.Read(magic);
+        reader.Read(version);
+        reader.Read(vertexSize);
+        if (!reader.IsValid() || magic != kMagic || version != kVersion || vertexSize != sizeof(VertexData)) {
+            return false;
+        }
+
+        // 元ファイルが変わっていないか
+        reader.Read(stampCount);
+        for (uint32_t i = 0; i < stampCount && reader.IsValid(); ++i) {
+            FileStamp stamp;
+            reader.ReadString(stamp.name);
+            reader.Read(stamp.size);
+            reader.Read(stamp.writeTime);
+            reader.Read(stamp.hash);
+            if (!reader.IsValid() || !IsUpToDate(directoryPath, stamp)) {
+                return false;
+            }
+        }
+
+        // マテリアルの表(メッシュは番号で参照する)
+        uint32_t materialCount = 0;
+        reader.Read(materialCount);
+        if (!reader.IsValid() || materialCount > reader.GetRemaining()) {
+            return false;
+        }
+        ObjModel result;
+        result.materials.resize(materialCount);
+        for (ObjMaterial& material : result.materials) {
+            uint32_t enableLighting = 0;
+            reader.Read(material.color);
+            reader.Read(material.ambient);
+            reader.Read(material.specular);
+            reader.Read(material.shininess);
+            reader.Read(material.alpha);
+            reader.Read(enableLighting);
+            reader.Read(material.uvTransform);
+            reader.ReadString(material.textureFilePath);
+            material.enableLighting = enableLighting != 0;
+        }
+
+        reader.Read(meshCount);
+        if (!reader.IsValid() || meshCount > reader.GetRemaining()) {
+            return false;
+        }
+        result.meshes.resize(meshCount);
+        for (ObjMesh& mesh : result.meshes) {
+            uint32_t vertexCount = 0, indexCount = 0;
+            reader.Read(vertexCount);
+            reader.Read(indexCount);
+            reader.Read(mesh.boundsMin);
+            reader.Read(mesh.boundsMax);
+            reader.Read(mesh.boundingSphere);
+            reader.Read(mesh.orientedBounds);
+            reader.Read(mesh.materialIndex);
+            if (!reader.IsValid() || (mesh.materialIndex >= materialCount && mesh.materialIndex != ObjMesh::kNoMaterial)) {
+                return false;
+            }
+
+            // 頂点と添字はそのまま複写する(壊れた数で大きく確保しないよう先に残りと比べる)
+            if (sizeof(VertexData) * static_cast<uint64_t>(vertexCount) + sizeof(uint32_t) * static_cast<uint64_t>(indexCount) > reader.GetRemaining()) {
+                return false;
+            }
+            mesh.vertices.resize(vertexCount);
+            mesh.indices.resize(indexCount);
+            reader.ReadBytes(mesh.vertices.data(), sizeof(VertexData) * vertexCount);
+            reader.ReadBytes(mesh.indices.data(), sizeof(uint32_t) * indexCount);
+            if (!reader.IsValid() || !IsTriangleListInRange(mesh.indices, mesh.vertices.size())) {
+                return false;
+            }
+
+            // 詳細度
+            uint32_t lodCount = 0;
+            reader.Read(lodCount);
+            if (!reader.IsValid() || lodCount > reader.GetRemaining()) {
+                return false;
+            }
+            mesh.lods.resize(lodCount);
+            for (ObjMeshLod& lod : mesh.lods) {
+                uint32_t lodIndexCount = 0;
+                reader.Read(lod.error);
+                reader.Read(lodIndexCount);
+                if (!reader.IsValid() || sizeof(uint32_t) * static_cast<uint64_t>(lodIndexCount) > reader.GetRemaining()) {
+                    return false;
+                }
+                lod.indices.resize(lodIndexCount);
+                reader.ReadBytes(lod.indices.data(), sizeof(uint32_t) * lodIndexCount);
+                if (!reader.IsValid() || !IsTriangleListInRange(lod.indices, mesh.vertices.size())) {
+                    return false;
+                }
+            }
+
+            // 塊(そのまま複写できる形)
+            uint32_t meshletCount = 0;
+            uint32_t isClosed = 0;
+            reader.Read(isClosed);
+            reader.Read(meshletCount);
+            if (!reader.IsValid() || sizeof(ObjMeshlet) * static_cast<uint64_t>(meshletCount) > reader.GetRemaining()) {
+                return false;
+            }
+            mesh.isClosed = isClosed != 0;
+            mesh.meshlets.resize(meshletCount);
+            reader.ReadBytes(mesh.meshlets.data(), sizeof(ObjMeshlet) * meshletCount);
+            for (const ObjMeshlet& meshlet : mesh.meshlets) {
+                if (static_cast<uint64_t>(meshlet.indexOffset) + meshlet.indexCount > mesh.indices.size()) {
+                    return false;
+                }
+            }
+
+            // 接線(無ければ0個)
+            uint32_t tangentCount = 0;
+            reader.Read(tangentCount);
+            if (!reader.IsValid() || (tangentCount != 0 && tangentCount != vertexCount) ||
+                sizeof(Vector4) * static_cast<uint64_t>(tangentCount) > reader.GetRemaining()) {
+                return false;
+            }
+            mesh.tangents.resize(tangentCount);
+            reader.ReadBytes(mesh.tangents.data(), sizeof(Vector4) * tangentCount);
+            if (!reader.IsValid()) {
+                return false;
+            }
+        }
+        if (!reader.IsValid() || !reader.IsEnd()) {
+            return false;
+        }
+
+        model = std::move(result);
+        return true;
+    }
+
+    bool Write(const std::string& directoryPath, const std::string& filename, std::string_view sourceText, const ObjModel& model) {
+        // 依存するファイル(obj本体とmtl)
+        std::vector<FileStamp> stamps;
+        FileStamp source;
+        source.name = filename;
+        source.size = sourceText.size();
+        source.writeTime = GetWriteTime(directoryPath + "/" + filename);
+        source.hash = Hash(sourceText.data(), sourceText.size());
+        stamps.push_back(source);
+        // glbはmtlを使わない(バイナリの中を行として探さない)
+        const std::vector<std::string> libraries = GlbLoader::IsGlbFile(filename) ? std::vector<std::string>() : FindMaterialLibraries(sourceText);
+        for (const std::string& name : libraries) {
+            FileStamp stamp;
+            stamp.name = name;
+            const std::string path = directoryPath + "/" + name;
+            std::string text;
+            if (!ReadWholeFile(path, text)) {
+                return false;
+            }
+            stamp.size = text.size();
+            stamp.writeTime = GetWriteTime(path);
+            stamp.hash = Hash(text.data(), text.size());
+            stamps.push_back(stamp);
+        }
+
+        Writer writer;
+        writer.Write(kMagic);
+        writer.Write(kVersion);
+        writer.Write(static_cast<uint32_t>(sizeof(VertexData)));
+        writer.Write(static_cast<uint32_t>(stamps.size()));
+        for (const FileStamp& stamp : stamps) {
+            writer.WriteString(stamp.name);
+            writer.Write(stamp.size);
+            writer.Write(stamp.writeTime);
+            writer.Write(stamp.hash);
+        }
+        writer.Write(static_cast<uint32_t>(model.materials.size()));
+        for (const ObjMaterial& material : model.materials) {
+            writer.Write(material.color);
+            writer.Write(material.ambient);
+            writer.Write(material.specular);
+            writer.Write(material.shininess);
+            writer.Write(material.alpha);
+            writer.Write(static_cast<uint32_t>(material.enableLighting ? 1 : 0));
+            writer.Write(material.uvTransform);
+            writer.WriteString(material.textureFilePath);
+        }
+        writer.Write(static_cast<uint32_t>(model.meshes.size()));
+        for (const ObjMesh& mesh : model.meshes) {
+            writer.Write(static_cast<uint32_t>(mesh.vertices.size()));
+            writer.Write(static_cast<uint32_t>(mesh.indices.size()));
+            writer.Write(mesh.boundsMin);
+            writer.Write(mesh.boundsMax);
+            writer.Write(mesh.boundingSphere);
+            writer.Write(mesh.orientedBounds);
+            writer.Write(mesh.materialIndex);
+            writer.WriteBytes(mesh.vertices.data(), sizeof(VertexData) * mesh.vertices.size());
+            writer.WriteBytes(mesh.indices.data(), sizeof(uint32_t) * mesh.indices.size());
+            writer.Write(static_cast<uint32_t>(mesh.lods.size()));
+            for (const ObjMeshLod& lod : mesh.lods) {
+                writer.Write(lod.error);
+                writer.Write(static_cast<uint32_t>(lod.indices.size()));
+                writer.WriteBytes(lod.indices.data(), sizeof(uint32_t) * lod.indices.size());
+            }
+            writer.Write(static_cast<uint32_t>(mesh.isClosed ? 1 : 0));
+            writer.Write(static_cast<uint32_t>(mesh.meshlets.size()));
+            writer.WriteBytes(mesh.meshlets.data(), sizeof(ObjMeshlet) * mesh.meshlets.size());
+            writer.Write(static_cast<uint32_t>(mesh.tangents.size()));
+            writer.WriteBytes(mesh.tangents.data(), sizeof(Vector4) * mesh.tangents.size());
+        }
+
+        // 途中で止まっても壊れたキャッシュが残らないよう、一時ファイルから置き換える
+        // 同じファイルを別のスレッドが同時に書いても混ざらないよう、一時ファイルの名前は書くたびに変える
+        static std::atomic<uint32_t> temporaryCount = 0;
+        const std::string cachePath = GetCachePath(directoryPath, filename);
+        const std::string temporaryPath = cachePath + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) +
+            "." + std::to_string(temporaryCount.fetch_add(1)) + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                return false;
+            }
+            const std::vector<char>& buffer = writer.GetBuffer();
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            if (!file) {
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temporaryPath, cachePath, ec);
+        if (ec) {
+            std::filesystem::remove(temporaryPath, ec);
+            return false;
+        }
+        return true;
+    }
+
+    std::string GetCachePath(const std::string& directoryPath, const std::string& filename) {
+        return directoryPath + "/" + filename + kExtension;
+    }
+
+    uint64_t Hash(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        uint64_t hash = 1469598103934665603ull;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../../math/ObjModel.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class JobSystem;
+
+/// <summary>
+/// objを読んだ結果をバイナリにして元ファイルの横に置き、次回からはそれを読む(.glbならGlbLoaderで変換する)
+/// キャッシュには元のobj/mtlのサイズ・更新時刻・ハッシュを入れておき、どれかが変わっていたら作り直す
+/// </summary>
+namespace MeshCache {
+
+    // 形式を変えたら上げる
+    static inline const uint32_t kVersion = 7;
+
+    // キャッシュファイルの拡張子(元のファイル名の後ろに付ける)
+    static inline const char* const kExtension = ".meshcache";
+
+    /// <summary>
+    /// キャッシュが元ファイルと合っていればそれを読み、合っていなければobjを解析してキャッシュを書く
+    /// 解析した時はPrepareMeshで並べ替え・塊・詳細度を作ってから書くので、キャッシュにはすべて入る
+    /// isCacheHitにはキャッシュを使えたかが入る。jobSystemを渡すと解析を並列にする
+    /// </summary>
+    ObjModel LoadFile(const std::string& directoryPath, const std::string& filename, bool* isCacheHit = nullptr, JobSystem* jobSystem = nullptr);
+
+    /// <summary>
+    /// 解析直後のメッシュを描画向けに整える
+    /// 法線が無ければMeshNormalsで作り、MeshOptimizerで並べ替え、MeshletBuilderで塊にまとめ(塊の順に並び直すので頂点の順も付け直す)、
+    /// MeshSimplifierで詳細度を作り、最後に(頂点の順が決まってから)接線を作る
+    /// </summary>
+    void PrepareMesh(ObjMesh& mesh, JobSystem* jobSystem = nullptr);
+
+    /// <summary>
+    /// キャッシュを読む(1回の読み込みで全体を取り、そこから複写する)。元ファイルと合わなければfalse
+    /// 添字・詳細度・塊の範囲が頂点や添字の数を超えていてもfalse(作り直させる)
+    /// </summary>
+    bool Read(const std::string& directoryPath, const std::string& filename, ObjModel& model);
+
+    /// <summary>
+    /// キャッシュを書く(一時ファイルに書いてから置き換える)
+    /// sourceTextは元ファイルの中身(ハッシュと依存するmtlを調べるのに使う)
+    /// </summary>
+    bool Write(const std::string& directoryPath, const std::string& filename, std::string_view sourceText, const ObjModel& model);
+
+    /// <summary>
+    /// キャッシュファイルのパス
+    /// </summary>
+    std::string GetCachePath(const std::string& directoryPath, const std::string& filename);
+
+    /// <summary>
+    /// バイト列のハッシュ(FNV-1a 64bit)
+    /// </summary>
+    uint64_t Hash(const void* data, size_t size);
+}
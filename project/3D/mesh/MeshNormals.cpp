@@ -0,0 +1,220 @@
+#include "MeshNormals.h"
+#include "../../engine/JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+    // UVの面積がこれより小さい三角形からは接線を求めない(向きが決まらない)
+    const float kMinUvArea = 1e-12f;
+
+    Vector3 ToVector3(const Vector4& v) { return { v.x, v.y, v.z }; }
+
+    float Dot(const Vector3& a, const Vector3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Vector3 Cross(const Vector3& a, const Vector3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+    // 長さが0なら0のまま返す
+    Vector3 SafeNormalize(const Vector3& v) {
+        const float length = std::sqrt(Dot(v, v));
+        return length > 0.0f ? v / length : Vector3{ 0.0f, 0.0f, 0.0f };
+    }
+
+    // 2辺の間の角度
+    float GetAngle(const Vector3& e0, const Vector3& e1) {
+        const float lengths = std::sqrt(Dot(e0, e0) * Dot(e1, e1));
+        if (lengths <= 0.0f) {
+            return 0.0f;
+        }
+        return std::acos(std::clamp(Dot(e0, e1) / lengths, -1.0f, 1.0f));
+    }
+
+    // 三角形の3つの角の角度
+    void GetCornerAngles(const Vector3& a, const Vector3& b, const Vector3& c, float angles[3]) {
+        angles[0] = GetAngle(b - a, c - a);
+        angles[1] = GetAngle(c - b, a - b);
+        angles[2] = GetAngle(a - c, b - c);
+    }
+
+    // 同じ位置の頂点に、その位置を最初に使う頂点の番号を振る(開番地法のハッシュ表で1回なめる)
+    std::vector<uint32_t> WeldPositions(const std::vector<VertexData>& vertices) {
+        size_t capacity = 16;
+        while (capacity < vertices.size() * 2) {
+            capacity <<= 1;
+        }
+        const size_t mask = capacity - 1;
+        std::vector<uint32_t> table(capacity, UINT32_MAX);
+        std::vector<uint32_t> weld(vertices.size());
+        for (uint32_t v = 0; v < vertices.size(); ++v) {
+            const Vector4& p = vertices[v].position;
+            // -0と0を同じにしてからビット列でハッシュする
+            const float key[3] = { p.x + 0.0f, p.y + 0.0f, p.z + 0.0f };
+            uint32_t bits[3];
+            std::memcpy(bits, key, sizeof(bits));
+            size_t slot = ((bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u)) & mask;
+            while (true) {
+                const uint32_t other = table[slot];
+                if (other == UINT32_MAX) {
+                    table[slot] = v;
+                    weld[v] = v;
+                    break;
+                }
+                const Vector4& q = vertices[other].position;
+                if (q.x == p.x && q.y == p.y && q.z == p.z) {
+                    weld[v] = other;
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+        }
+        return weld;
+    }
+
+    // 頂点ごとに、その頂点を使う角(indicesの位置)の一覧を作る。weldがあればまとめた番号ごと
+    // 角は元の並び順に入るので、足す順番がいつも同じになる
+    void BuildCornerLists(const std::vector<uint32_t>& indices, const std::vector<uint32_t>* weld, size_t vertexCount,
+        std::vector<uint32_t>& offsets, std::vector<uint32_t>& corners) {
+        offsets.assign(vertexCount + 1, 0);
+        for (uint32_t index : indices) {
+            ++offsets[(weld ? (*weld)[index] : index) + 1];
+        }
+        for (size_t v = 0; v < vertexCount; ++v) {
+            offsets[v + 1] += offsets[v];
+        }
+        corners.resize(indices.size());
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i) {
+            corners[cursor[weld ? (*weld)[indices[i]] : indices[i]]++] = static_cast<uint32_t>(i);
+        }
+    }
+}
+
+namespace MeshNormals {
+
+    void GenerateNormals(ObjMesh& mesh, JobSystem* jobSystem, bool isOverwrite, uint32_t maxThreads) {
+        if (!isOverwrite && !HasMissingNormals(mesh)) {
+            return;
+        }
+        const std::vector<uint32_t>& indices = mesh.indices;
+        const size_t triangleCount = indices.size() / 3;
+        std::vector<VertexData>& vertices = mesh.vertices;
+
+        // 1. 角ごとの寄与(面の法線 × 面積 × 角度)。三角形ごとに自分の3つの角だけに書く
+        // 外積の長さが面積の2倍なので、正規化せずに角度を掛ければ面積で重み付けしたことになる
+        std::vector<Vector3> cornerNormals(indices.size());
+        ParallelFor(jobSystem, triangleCount, kChunkSize, [&](size_t begin, size_t end, size_t) {
+            for (size_t t = begin; t < end; ++t) {
+                const Vector3 a = ToVector3(vertices[indices[t * 3 + 0]].position);
+                const Vector3 b = ToVector3(vertices[indices[t * 3 + 1]].position);
+                const Vector3 c = ToVector3(vertices[indices[t * 3 + 2]].position);
+                const Vector3 faceNormal = Cross(b - a, c - a);
+                float angles[3];
+                GetCornerAngles(a, b, c, angles);
+                for (int k = 0; k < 3; ++k) {
+                    cornerNormals[t * 3 + k] = faceNormal * angles[k];
+                }
+            }
+        }, maxThreads);
+
+        // 2. 頂点ごとに、同じ位置の角の寄与を足して正規化する。頂点ごとに自分だけに書く
+        const std::vector<uint32_t> weld = WeldPositions(vertices);
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> corners;
+        BuildCornerLists(indices, &weld, vertices.size(), offsets, corners);
+        ParallelFor(jobSystem, vertices.size(), kChunkSize, [&](size_t begin, size_t end, size_t) {
+            for (size_t v = begin; v < end; ++v) {
+                if (!isOverwrite && Dot(vertices[v].normal, vertices[v].normal) > 0.0f) {
+                    continue;
+                }
+                Vector3 sum = { 0.0f, 0.0f, 0.0f };
+                for (uint32_t i = offsets[weld[v]]; i < offsets[weld[v] + 1]; ++i) {
+                    sum += cornerNormals[corners[i]];
+                }
+                const Vector3 normal = SafeNormalize(sum);
+                // どの三角形にも使われていない・潰れた三角形だけの頂点は上向きにしておく
+                vertices[v].normal = Dot(normal, normal) > 0.0f ? normal : Vector3{ 0.0f, 1.0f, 0.0f };
+            }
+        }, maxThreads);
+    }
+
+    void GenerateTangents(ObjMesh& mesh, JobSystem* jobSystem, uint32_t maxThreads) {
+        const std::vector<uint32_t>& indices = mesh.indices;
+        const std::vector<VertexData>& vertices = mesh.vertices;
+        const size_t triangleCount = indices.size() / 3;
+
+        // 1. 角ごとの寄与。UVの増える向きを頂点の法線に直交させて正規化し、角度を掛ける
+        std::vector<Vector3> cornerTangents(indices.size());
+        std::vector<Vector3> cornerBitangents(indices.size());
+        ParallelFor(jobSystem, triangleCount, kChunkSize, [&](size_t begin, size_t end, size_t) {
+            for (size_t t = begin; t < end; ++t) {
+                const VertexData* corner[3] = { &vertices[indices[t * 3 + 0]], &vertices[indices[t * 3 + 1]], &vertices[indices[t * 3 + 2]] };
+                const Vector3 p0 = ToVector3(corner[0]->position);
+                const Vector3 p1 = ToVector3(corner[1]->position);
+                const Vector3 p2 = ToVector3(corner[2]->position);
+                const Vector3 e1 = p1 - p0;
+                const Vector3 e2 = p2 - p0;
+                const float du1 = corner[1]->texcoord.x - corner[0]->texcoord.x;
+                const float dv1 = corner[1]->texcoord.y - corner[0]->texcoord.y;
+                const float du2 = corner[2]->texcoord.x - corner[0]->texcoord.x;
+                const float dv2 = corner[2]->texcoord.y - corner[0]->texcoord.y;
+                const float uvArea = du1 * dv2 - du2 * dv1;
+                if (std::fabs(uvArea) < kMinUvArea) {
+                    for (int k = 0; k < 3; ++k) {
+                        cornerTangents[t * 3 + k] = { 0.0f, 0.0f, 0.0f };
+                        cornerBitangents[t * 3 + k] = { 0.0f, 0.0f, 0.0f };
+                    }
+                    continue;
+                }
+                // 向きだけ使うので1/uvAreaの大きさは要らないが、符号で裏返ったUVを扱う
+                const float sign = uvArea > 0.0f ? 1.0f : -1.0f;
+                const Vector3 faceTangent = (e1 * dv2 - e2 * dv1) * sign;
+                const Vector3 faceBitangent = (e2 * du1 - e1 * du2) * sign;
+                float angles[3];
+                GetCornerAngles(p0, p1, p2, angles);
+                for (int k = 0; k < 3; ++k) {
+                    const Vector3& normal = corner[k]->normal;
+                    cornerTangents[t * 3 + k] = SafeNormalize(faceTangent - normal * Dot(normal, faceTangent)) * angles[k];
+                    cornerBitangents[t * 3 + k] = SafeNormalize(faceBitangent - normal * Dot(normal, faceBitangent)) * angles[k];
+                }
+            }
+        }, maxThreads);
+
+        // 2. 頂点ごとに足して法線に直交させる(UVの切れ目では頂点が分かれているので、頂点の番号ごとでよい)
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> corners;
+        BuildCornerLists(indices, nullptr, vertices.size(), offsets, corners);
+        mesh.tangents.resize(vertices.size());
+        ParallelFor(jobSystem, vertices.size(), kChunkSize, [&](size_t begin, size_t end, size_t) {
+            for (size_t v = begin; v < end; ++v) {
+                Vector3 tangentSum = { 0.0f, 0.0f, 0.0f };
+                Vector3 bitangentSum = { 0.0f, 0.0f, 0.0f };
+                for (uint32_t i = offsets[v]; i < offsets[v + 1]; ++i) {
+                    tangentSum += cornerTangents[corners[i]];
+                    bitangentSum += cornerBitangents[corners[i]];
+                }
+                const Vector3& normal = vertices[v].normal;
+                Vector3 tangent = SafeNormalize(tangentSum - normal * Dot(normal, tangentSum));
+                if (Dot(tangent, tangent) == 0.0f) {
+                    // UVが潰れている時は法線に直交する適当な向きにする
+                    const Vector3 axis = std::fabs(normal.x) < 0.9f ? Vector3{ 1.0f, 0.0f, 0.0f } : Vector3{ 0.0f, 1.0f, 0.0f };
+                    tangent = SafeNormalize(axis - normal * Dot(normal, axis));
+                    if (Dot(tangent, tangent) == 0.0f) {
+                        tangent = { 1.0f, 0.0f, 0.0f };
+                    }
+                }
+                const float handedness = Dot(Cross(normal, tangent), bitangentSum) < 0.0f ? -1.0f : 1.0f;
+                mesh.tangents[v] = { tangent.x, tangent.y, tangent.z, handedness };
+            }
+        }, maxThreads);
+    }
+
+    bool HasMissingNormals(const ObjMesh& mesh) {
+        for (const VertexData& vertex : mesh.vertices) {
+            if (Dot(vertex.normal, vertex.normal) == 0.0f) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
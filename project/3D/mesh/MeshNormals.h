@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../../math/ObjModel.h"
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+/// <summary>
+/// 法線の無いメッシュに滑らかな法線を作り、法線マップ用の接線(MikkTSpaceと同じ考え方)を作る
+/// どちらも 三角形ごとに角の寄与を求める → 頂点ごとに自分の角の寄与を集める の2段で並列にする
+/// (書き込み先が重ならないので原子操作が要らず、スレッド数によらず同じ結果になる)
+/// </summary>
+namespace MeshNormals {
+
+    // 1つの仕事で扱う三角形・頂点の数
+    static inline const size_t kChunkSize = 4096;
+
+    /// <summary>
+    /// 長さ0の法線(objにvnが無い等)を、周りの三角形の法線を面積×角度で重み付けした平均で埋める
+    /// 同じ位置の頂点はUVが違っても同じ法線にする(切れ目で陰影が割れないように)
+    /// isOverwriteなら元からある法線も作り直す
+    /// </summary>
+    void GenerateNormals(ObjMesh& mesh, JobSystem* jobSystem = nullptr, bool isOverwrite = false, uint32_t maxThreads = 0);
+
+    /// <summary>
+    /// mesh.tangentsを作る(verticesと同じ並び。xyzが接線、wが従法線の向き ±1)
+    /// 従法線は cross(normal, tangent.xyz) * tangent.w で求める
+    /// 角ごとにUVから求めた接線を頂点の法線に直交させ、角度で重み付けして足す(MikkTSpaceと同じ)
+    /// 頂点の並びを変えると合わなくなるので、並べ替えの後に呼ぶ
+    /// </summary>
+    void GenerateTangents(ObjMesh& mesh, JobSystem* jobSystem = nullptr, uint32_t maxThreads = 0);
+
+    /// <summary>
+    /// 法線が長さ0の頂点があるか
+    /// </summary>
+    bool HasMissingNormals(const ObjMesh& mesh);
+}
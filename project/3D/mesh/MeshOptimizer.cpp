@@ -0,0 +1,312 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+    // Forsyth法の定数
+    const int kCacheSize = 32;
+    const float kCacheDecayPower = 1.5f;
+    const float kLastTriangleScore = 0.75f;
+    const float kValenceBoostScale = 2.0f;
+    const float kValenceBoostPower = 0.5f;
+
+    // 頂点の点数(キャッシュ内の位置と残りの三角形数から)
+    float VertexScore(int cachePosition, uint32_t remainingValence) {
+        if (remainingValence == 0) {
+            return -1.0f;
+        }
+        float score = 0.0f;
+        if (cachePosition >= 0) {
+            if (cachePosition < 3) {
+                // 直前の三角形で使った頂点
+                score = kLastTriangleScore;
+            } else {
+                const float scaler = 1.0f / (kCacheSize - 3);
+                score = std::pow(1.0f - (cachePosition - 3) * scaler, kCacheDecayPower);
+            }
+        }
+        // 残りが少ない頂点を優先して、取り残しを減らす
+        score += kValenceBoostScale * std::pow(static_cast<float>(remainingValence), -kValenceBoostPower);
+        return score;
+    }
+}
+
+namespace MeshOptimizer {
+
+    void Optimize(ObjMesh& mesh, const Settings& settings) {
+        if (mesh.indices.empty()) {
+            return;
+        }
+        if (settings.isVertexCacheEnabled) {
+            OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+        }
+        if (settings.isOverdrawEnabled) {
+            OptimizeOverdraw(mesh.indices, mesh.vertices, settings.overdrawThreshold);
+        }
+        if (settings.isVertexFetchEnabled) {
+            OptimizeVertexFetch(mesh.vertices, mesh.indices);
+        }
+    }
+
+    void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+
+        // 1. 頂点ごとに使っている三角形の一覧を作る
+        std::vector<uint32_t> valence(vertexCount, 0);
+        for (uint32_t index : indices) {
+            ++valence[index];
+        }
+        std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; ++v) {
+            adjacencyOffset[v + 1] = adjacencyOffset[v] + valence[v];
+        }
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            std::vector<uint32_t> cursor(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+            for (size_t i = 0; i < indices.size(); ++i) {
+                adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        // 2. 点数の初期値
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v) {
+            vertexScore[v] = VertexScore(-1, valence[v]);
+        }
+        std::vector<float> triangleScore(triangleCount);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+        }
+        std::vector<bool> isEmitted(triangleCount, false);
+
+        // 3. 点数の高い三角形から順に出す
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        std::vector<uint32_t> cache;
+        std::vector<uint32_t> nextCache;
+        cache.reserve(kCacheSize + 3);
+        nextCache.reserve(kCacheSize + 3);
+        size_t scanCursor = 0;
+
+        int64_t bestTriangle = 0;
+        for (size_t t = 1; t < triangleCount; ++t) {
+            if (triangleScore[t] > triangleScore[bestTriangle]) {
+                bestTriangle = static_cast<int64_t>(t);
+            }
+        }
+
+        for (size_t emitted = 0; emitted < triangleCount; ++emitted) {
+            if (bestTriangle < 0) {
+                // キャッシュの中に候補が無ければ、まだ出していない三角形を先頭から探す
+                while (isEmitted[scanCursor]) {
+                    ++scanCursor;
+                }
+                bestTriangle = static_cast<int64_t>(scanCursor);
+            }
+            const size_t triangle = static_cast<size_t>(bestTriangle);
+            isEmitted[triangle] = true;
+
+            const uint32_t* corners = &indices[triangle * 3];
+            for (int k = 0; k < 3; ++k) {
+                const uint32_t vertex = corners[k];
+                result.push_back(vertex);
+
+                // 出した三角形を頂点の一覧から外す
+                uint32_t* begin = &adjacency[adjacencyOffset[vertex]];
+                uint32_t* end = begin + valence[vertex];
+                uint32_t* found = std::find(begin, end, static_cast<uint32_t>(triangle));
+                if (found != end) {
+                    std::swap(*found, *(end - 1));
+                    --valence[vertex];
+                }
+            }
+
+            // 使った頂点をキャッシュの先頭に入れる(LRU)
+            nextCache.clear();
+            for (int k = 0; k < 3; ++k) {
+                if (std::find(nextCache.begin(), nextCache.end(), corners[k]) == nextCache.end()) {
+                    nextCache.push_back(corners[k]);
+                }
+            }
+            for (uint32_t vertex : cache) {
+                if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2]) {
+                    nextCache.push_back(vertex);
+                }
+            }
+            // あふれた頂点はキャッシュ外にする
+            for (size_t i = kCacheSize; i < nextCache.size(); ++i) {
+                cachePosition[nextCache[i]] = -1;
+                vertexScore[nextCache[i]] = VertexScore(-1, valence[nextCache[i]]);
+            }
+            if (nextCache.size() > static_cast<size_t>(kCacheSize)) {
+                nextCache.resize(kCacheSize);
+            }
+            std::swap(cache, nextCache);
+
+            for (size_t i = 0; i < cache.size(); ++i) {
+                cachePosition[cache[i]] = static_cast<int>(i);
+                vertexScore[cache[i]] = VertexScore(static_cast<int>(i), valence[cache[i]]);
+            }
+
+            // キャッシュ内の頂点を使う三角形の点数を更新し、次を選ぶ
+            bestTriangle = -1;
+            float bestScore = -1.0f;
+            for (uint32_t vertex : cache) {
+                const uint32_t* begin = &adjacency[adjacencyOffset[vertex]];
+                for (uint32_t i = 0; i < valence[vertex]; ++i) {
+                    const uint32_t t = begin[i];
+                    const float score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                    triangleScore[t] = score;
+                    if (score > bestScore) {
+                        bestScore = score;
+                        bestTriangle = t;
+                    }
+                }
+            }
+        }
+
+        // 元から良い並び(書き出し側で最適化済みなど)なら悪くしない
+        if (AnalyzeVertexCache(result, vertexCount).missCount < AnalyzeVertexCache(indices, vertexCount).missCount) {
+            indices = std::move(result);
+        }
+    }
+
+    void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<VertexData>& vertices, float threshold) {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2) {
+            return;
+        }
+        const CacheStats before = AnalyzeVertexCache(indices, vertices.size());
+
+        // 1. 3頂点ともキャッシュミスになる三角形(キャッシュの切れ目)で塊に分ける
+        std::vector<size_t> clusterStarts;
+        {
+            std::vector<uint32_t> timestamp(vertices.size(), 0);
+            uint32_t time = kSimulatedCacheSize + 1;
+            for (size_t t = 0; t < triangleCount; ++t) {
+                int misses = 0;
+                for (int k = 0; k < 3; ++k) {
+                    const uint32_t vertex = indices[t * 3 + k];
+                    if (time - timestamp[vertex] > kSimulatedCacheSize) {
+                        timestamp[vertex] = time++;
+                        ++misses;
+                    }
+                }
+                if (t == 0 || misses == 3) {
+                    clusterStarts.push_back(t);
+                }
+            }
+            clusterStarts.push_back(triangleCount);
+        }
+        const size_t clusterCount = clusterStarts.size() - 1;
+        if (clusterCount < 2) {
+            return;
+        }
+
+        // 2. メッシュの中心から見て外を向いている塊ほど先に描く
+        auto position = [&](uint32_t index) {
+            const Vector4& p = vertices[index].position;
+            return Vector3{ p.x, p.y, p.z };
+        };
+        Vector3 meshCenter = { 0.0f, 0.0f, 0.0f };
+        for (const VertexData& vertex : vertices) {
+            meshCenter.x += vertex.position.x;
+            meshCenter.y += vertex.position.y;
+            meshCenter.z += vertex.position.z;
+        }
+        const float inverseCount = 1.0f / static_cast<float>(vertices.size());
+        meshCenter = { meshCenter.x * inverseCount, meshCenter.y * inverseCount, meshCenter.z * inverseCount };
+
+        std::vector<float> sortKey(clusterCount);
+        for (size_t c = 0; c < clusterCount; ++c) {
+            Vector3 center = { 0.0f, 0.0f, 0.0f };
+            Vector3 normal = { 0.0f, 0.0f, 0.0f };
+            float area = 0.0f;
+            for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t) {
+                const Vector3 a = position(indices[t * 3]);
+                const Vector3 b = position(indices[t * 3 + 1]);
+                const Vector3 d = position(indices[t * 3 + 2]);
+                const Vector3 ab = { b.x - a.x, b.y - a.y, b.z - a.z };
+                const Vector3 ad = { d.x - a.x, d.y - a.y, d.z - a.z };
+                // 時計回りが表なので ab x ad が外向き(長さは面積の2倍)
+                const Vector3 n = { ab.y * ad.z - ab.z * ad.y, ab.z * ad.x - ab.x * ad.z, ab.x * ad.y - ab.y * ad.x };
+                const float triangleArea = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+                normal = { normal.x + n.x, normal.y + n.y, normal.z + n.z };
+                center.x += (a.x + b.x + d.x) * triangleArea;
+                center.y += (a.y + b.y + d.y) * triangleArea;
+                center.z += (a.z + b.z + d.z) * triangleArea;
+                area += triangleArea;
+            }
+            const float normalLength = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+            if (area <= 0.0f || normalLength <= 0.0f) {
+                sortKey[c] = 0.0f;
+                continue;
+            }
+            const float inverseArea = 1.0f / (3.0f * area);
+            center = { center.x * inverseArea - meshCenter.x, center.y * inverseArea - meshCenter.y, center.z * inverseArea - meshCenter.z };
+            sortKey[c] = (center.x * normal.x + center.y * normal.y + center.z * normal.z) / normalLength;
+        }
+
+        std::vector<size_t> order(clusterCount);
+        std::iota(order.begin(), order.end(), size_t{ 0 });
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        for (size_t c : order) {
+            result.insert(result.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+        }
+
+        // 3. キャッシュ効率が落ちすぎるなら元のまま
+        const CacheStats after = AnalyzeVertexCache(result, vertices.size());
+        if (after.acmr <= before.acmr * threshold) {
+            indices = std::move(result);
+        }
+    }
+
+    void OptimizeVertexFetch(std::vector<VertexData>& vertices, std::vector<uint32_t>& indices) {
+        std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+        std::vector<VertexData> result;
+        result.reserve(vertices.size());
+        for (uint32_t& index : indices) {
+            if (remap[index] == UINT32_MAX) {
+                remap[index] = static_cast<uint32_t>(result.size());
+                result.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+        // 使われていない頂点は後ろに残す
+        for (size_t v = 0; v < vertices.size(); ++v) {
+            if (remap[v] == UINT32_MAX) {
+                result.push_back(vertices[v]);
+            }
+        }
+        vertices = std::move(result);
+    }
+
+    CacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+        CacheStats stats;
+        if (indices.empty() || vertexCount == 0) {
+            return stats;
+        }
+        // 入った時刻を覚えておき、cacheSize回の追加より前なら追い出されている(FIFO)
+        std::vector<uint32_t> timestamp(vertexCount, 0);
+        uint32_t time = cacheSize + 1;
+        for (uint32_t index : indices) {
+            if (time - timestamp[index] > cacheSize) {
+                timestamp[index] = time++;
+                ++stats.missCount;
+            }
+        }
+        stats.acmr = static_cast<float>(stats.missCount) / static_cast<float>(indices.size() / 3);
+        stats.atvr = static_cast<float>(stats.missCount) / static_cast<float>(vertexCount);
+        return stats;
+    }
+}
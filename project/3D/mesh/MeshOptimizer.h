@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../../math/ObjModel.h"
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// 添字化したメッシュの三角形・頂点の並びをGPU向けに並べ替える
+/// 1. 頂点キャッシュ(Forsyth法) 2. 重ね描き(外側を向いた塊を先に) 3. 頂点の取り出し順
+/// </summary>
+namespace MeshOptimizer {
+
+    // 頂点キャッシュの計測結果
+    struct CacheStats {
+        // 三角形あたりのキャッシュミス(小さいほど良い。0.5付近が下限)
+        float acmr = 0.0f;
+        // 頂点あたりの変換回数(1.0が下限)
+        float atvr = 0.0f;
+        size_t missCount = 0;
+    };
+
+    struct Settings {
+        bool isVertexCacheEnabled = true;
+        // 重ね描きを減らす並べ替え(キャッシュ効率が少し落ちるので任意)
+        bool isOverdrawEnabled = false;
+        // 重ね描きの並べ替えで許すACMRの悪化(1.05なら5%まで)
+        float overdrawThreshold = 1.05f;
+        bool isVertexFetchEnabled = true;
+    };
+
+    // キャッシュ計測の既定の大きさ(FIFO)
+    static inline const uint32_t kSimulatedCacheSize = 16;
+
+    /// <summary>
+    /// 設定に従ってメッシュを並べ替える(見た目は変わらない)
+    /// </summary>
+    void Optimize(ObjMesh& mesh, const Settings& settings = Settings());
+
+    /// <summary>
+    /// 三角形を頂点キャッシュに乗りやすい順に並べ替える(Forsyth法)
+    /// 元の並びの方がキャッシュミスが少なければそのままにする
+    /// </summary>
+    void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+    /// <summary>
+    /// キャッシュの切れ目で三角形を塊に分け、外側を向いた塊が先に来るように並べる
+    /// ACMRがthreshold倍より悪くなるなら元の順のままにする
+    /// </summary>
+    void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<VertexData>& vertices, float threshold);
+
+    /// <summary>
+    /// 頂点を初めて使われる順に並べ替え、添字を付け替える
+    /// </summary>
+    void OptimizeVertexFetch(std::vector<VertexData>& vertices, std::vector<uint32_t>& indices);
+
+    /// <summary>
+    /// FIFOの頂点キャッシュを真似てACMR/ATVRを求める
+    /// </summary>
+    CacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = kSimulatedCacheSize);
+}
@@ -0,0 +1,609 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+    // 境界・シームの辺に足す拘束の重み(面の二次誤差より強くして線の形を保つ)
+    const double kConstraintWeight = 10.0;
+
+    // 縮約で三角形の向きがこれより変わるなら裏返りとみなす(法線の内積)
+    const double kFlipThreshold = 1e-2;
+
+    // 1回の縮約で許す誤差(目標までに要る数番目の誤差に対する倍率)
+    const double kPassErrorScale = 1.5;
+
+    // 面積が最も長い辺の二乗のこれ倍より小さい三角形は、ほぼ一直線に潰れたものとみなす
+    const double kSliverThreshold = 1e-3;
+
+    struct Point {
+        double x = 0.0;
+        double y = 0.0;
+        double z = 0.0;
+    };
+
+    Point Sub(const Point& a, const Point& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    double Dot(const Point& a, const Point& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Point Cross(const Point& a, const Point& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+    // 平面までの距離の二乗和(重み付き)
+    struct Quadric {
+        double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+        double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+        double c = 0.0;
+        double weight = 0.0;
+
+        // 平面 dot(n, p) + d = 0 (nは単位ベクトル)
+        void AddPlane(const Point& n, double d, double w) {
+            a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z;
+            a11 += w * n.y * n.y; a12 += w * n.y * n.z; a22 += w * n.z * n.z;
+            b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+            c += w * d * d;
+            weight += w;
+        }
+
+        void Add(const Quadric& q) {
+            a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+            b0 += q.b0; b1 += q.b1; b2 += q.b2;
+            c += q.c;
+            weight += q.weight;
+        }
+
+        // 重みで割った距離の二乗
+        double Evaluate(const Point& p) const {
+            const double r =
+                a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z +
+                2.0 * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z) +
+                2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+            return weight > 0.0 ? (std::max)(r, 0.0) / weight : 0.0;
+        }
+    };
+
+    // 位置ごとの扱い
+    enum class VertexKind : uint8_t {
+        Manifold, // 内側。どこへでも縮約できる
+        Border,   // 穴の縁。縁に沿ってだけ縮約できる
+        Seam,     // UV・法線の切れ目。切れ目の両側がそろって動ける時だけ縮約できる
+        Locked,   // 動かさない(縁と切れ目が重なる、非多様体など)
+    };
+
+    // 有向辺(両端は位置の代表頂点)
+    struct HalfEdge {
+        uint64_t key = 0;
+        uint32_t triangle = 0;
+        // 三角形の中での実際の頂点
+        uint32_t from = 0;
+        uint32_t to = 0;
+    };
+
+    struct Collapse {
+        uint32_t source = 0;
+        uint32_t target = 0;
+        double cost = 0.0;
+    };
+
+    uint64_t EdgeKey(uint32_t a, uint32_t b) { return (static_cast<uint64_t>(a) << 32) | b; }
+
+    // 有向辺を集めて並べる
+    void BuildHalfEdges(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& remap, std::vector<HalfEdge>& edges) {
+        edges.resize(indices.size());
+        for (size_t i = 0; i < indices.size(); ++i) {
+            const uint32_t from = indices[i];
+            const uint32_t to = indices[i - i % 3 + (i + 1) % 3];
+            edges[i] = { EdgeKey(remap[from], remap[to]), static_cast<uint32_t>(i / 3), from, to };
+        }
+        std::sort(edges.begin(), edges.end(), [](const HalfEdge& a, const HalfEdge& b) { return a.key < b.key; });
+    }
+
+    const HalfEdge* FindHalfEdge(const std::vector<HalfEdge>& edges, uint32_t from, uint32_t to) {
+        const uint64_t key = EdgeKey(from, to);
+        auto it = std::lower_bound(edges.begin(), edges.end(), key, [](const HalfEdge& e, uint64_t k) { return e.key < k; });
+        return (it != edges.end() && it->key == key) ? &*it : nullptr;
+    }
+
+    // 点から三角形までの距離の二乗
+    double DistanceSquared(const Point& p, const Point& a, const Point& b, const Point& c) {
+        const Point ab = Sub(b, a);
+        const Point ac = Sub(c, a);
+        const Point ap = Sub(p, a);
+        auto distance = [&](const Point& q) { const Point d = Sub(p, q); return Dot(d, d); };
+        auto lerp = [](const Point& from, const Point& dir, double t) { return Point{ from.x + dir.x * t, from.y + dir.y * t, from.z + dir.z * t }; };
+
+        const double d1 = Dot(ab, ap);
+        const double d2 = Dot(ac, ap);
+        if (d1 <= 0.0 && d2 <= 0.0) {
+            return distance(a);
+        }
+        const Point bp = Sub(p, b);
+        const double d3 = Dot(ab, bp);
+        const double d4 = Dot(ac, bp);
+        if (d3 >= 0.0 && d4 <= d3) {
+            return distance(b);
+        }
+        const double vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+            return distance(lerp(a, ab, d1 / (d1 - d3)));
+        }
+        const Point cp = Sub(p, c);
+        const double d5 = Dot(ab, cp);
+        const double d6 = Dot(ac, cp);
+        if (d6 >= 0.0 && d5 <= d6) {
+            return distance(c);
+        }
+        const double vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+            return distance(lerp(a, ac, d2 / (d2 - d6)));
+        }
+        const double va = d3 * d6 - d5 * d4;
+        if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+            return distance(lerp(b, Sub(c, b), (d4 - d3) / ((d4 - d3) + (d5 - d6))));
+        }
+        const double denominator = 1.0 / (va + vb + vc);
+        const double v = vb * denominator;
+        const double w = vc * denominator;
+        return distance({ a.x + ab.x * v + ac.x * w, a.y + ab.y * v + ac.y * w, a.z + ab.z * v + ac.z * w });
+    }
+
+    // 頂点の位置を箱の最小点から測って大きさで割る(誤差がそのまま割合になる)
+    std::vector<Point> NormalizePositions(const std::vector<VertexData>& vertices, float extent) {
+        std::vector<Point> points(vertices.size());
+        if (vertices.empty()) {
+            return points;
+        }
+        Point minimum = { vertices[0].position.x, vertices[0].position.y, vertices[0].position.z };
+        for (const VertexData& vertex : vertices) {
+            minimum.x = (std::min)(minimum.x, static_cast<double>(vertex.position.x));
+            minimum.y = (std::min)(minimum.y, static_cast<double>(vertex.position.y));
+            minimum.z = (std::min)(minimum.z, static_cast<double>(vertex.position.z));
+        }
+        const double scale = extent > 0.0f ? 1.0 / extent : 0.0;
+        for (size_t v = 0; v < vertices.size(); ++v) {
+            points[v] = {
+                (vertices[v].position.x - minimum.x) * scale,
+                (vertices[v].position.y - minimum.y) * scale,
+                (vertices[v].position.z - minimum.z) * scale };
+        }
+        return points;
+    }
+}
+
+namespace MeshSimplifier {
+
+    std::vector<uint32_t> Simplify(const std::vector<VertexData>& vertices, const std::vector<uint32_t>& indices,
+        size_t targetIndexCount, float targetError, float* resultError) {
+
+        std::vector<uint32_t> result = indices;
+        if (resultError) {
+            *resultError = 0.0f;
+        }
+        const size_t vertexCount = vertices.size();
+        const float extent = GetExtent(vertices);
+        if (result.size() <= targetIndexCount || vertexCount == 0 || extent <= 0.0f) {
+            return result;
+        }
+        const std::vector<Point> points = NormalizePositions(vertices, extent);
+
+        // 1. 同じ位置の頂点(UVや法線だけ違うもの)をまとめる
+        // remapは位置の代表頂点、wedgeは同じ位置の次の頂点(輪になっている)
+        // uvGroupは位置とUVが同じ頂点の代表(法線だけ違う頂点は、縮約では一緒に動かす)
+        std::vector<uint32_t> remap(vertexCount);
+        std::vector<uint32_t> wedge(vertexCount);
+        std::vector<uint32_t> uvGroup(vertexCount);
+        {
+            std::vector<uint32_t> order(vertexCount);
+            std::iota(order.begin(), order.end(), 0u);
+            auto less = [&](uint32_t a, uint32_t b) {
+                const Vector4& pa = vertices[a].position;
+                const Vector4& pb = vertices[b].position;
+                if (pa.x != pb.x) return pa.x < pb.x;
+                if (pa.y != pb.y) return pa.y < pb.y;
+                if (pa.z != pb.z) return pa.z < pb.z;
+                const Vector2& ta = vertices[a].texcoord;
+                const Vector2& tb = vertices[b].texcoord;
+                if (ta.x != tb.x) return ta.x < tb.x;
+                if (ta.y != tb.y) return ta.y < tb.y;
+                return a < b;
+            };
+            std::sort(order.begin(), order.end(), less);
+            size_t begin = 0;
+            while (begin < vertexCount) {
+                size_t end = begin + 1;
+                const Vector4& p = vertices[order[begin]].position;
+                while (end < vertexCount && vertices[order[end]].position.x == p.x &&
+                    vertices[order[end]].position.y == p.y && vertices[order[end]].position.z == p.z) {
+                    ++end;
+                }
+                uint32_t group = order[begin];
+                for (size_t i = begin; i < end; ++i) {
+                    remap[order[i]] = order[begin];
+                    wedge[order[i]] = order[i + 1 < end ? i + 1 : begin];
+                    const Vector2& texcoord = vertices[order[i]].texcoord;
+                    if (texcoord.x != vertices[group].texcoord.x || texcoord.y != vertices[group].texcoord.y) {
+                        group = order[i];
+                    }
+                    uvGroup[order[i]] = group;
+                }
+                begin = end;
+            }
+        }
+
+        // 2. 位置の扱いを決める(縁の辺が1本ずつ出入りしていれば縁、同じ位置にUVの違う頂点があれば切れ目)
+        std::vector<HalfEdge> edges;
+        BuildHalfEdges(result, remap, edges);
+        std::vector<VertexKind> kinds(vertexCount, VertexKind::Manifold);
+        {
+            std::vector<uint8_t> borderOut(vertexCount, 0);
+            std::vector<uint8_t> borderIn(vertexCount, 0);
+            std::vector<uint8_t> isNonManifold(vertexCount, 0);
+            std::vector<uint8_t> isUvSeam(vertexCount, 0);
+            for (size_t i = 0; i < edges.size(); ++i) {
+                const uint32_t from = static_cast<uint32_t>(edges[i].key >> 32);
+                const uint32_t to = static_cast<uint32_t>(edges[i].key);
+                if (i + 1 < edges.size() && edges[i + 1].key == edges[i].key) {
+                    // 同じ向きの辺が2本以上ある
+                    isNonManifold[from] = isNonManifold[to] = 1;
+                }
+                if (!FindHalfEdge(edges, to, from)) {
+                    borderOut[from] = static_cast<uint8_t>((std::min)(borderOut[from] + 1, 255));
+                    borderIn[to] = static_cast<uint8_t>((std::min)(borderIn[to] + 1, 255));
+                }
+            }
+            for (uint32_t v = 0; v < vertexCount; ++v) {
+                if (uvGroup[v] != remap[v]) {
+                    // 同じ位置に別のUVがある
+                    isUvSeam[remap[v]] = 1;
+                }
+            }
+            for (uint32_t v = 0; v < vertexCount; ++v) {
+                if (remap[v] != v) {
+                    continue;
+                }
+                const bool isBorder = borderOut[v] != 0 || borderIn[v] != 0;
+                if (isNonManifold[v] || (isBorder && (borderOut[v] != 1 || borderIn[v] != 1))) {
+                    kinds[v] = VertexKind::Locked;
+                } else if (isUvSeam[v]) {
+                    kinds[v] = isBorder ? VertexKind::Locked : VertexKind::Seam;
+                } else if (isBorder) {
+                    kinds[v] = VertexKind::Border;
+                }
+            }
+        }
+
+        // 3. 位置ごとの二次誤差(面の平面と、縁・切れ目の辺に立てた垂直な平面)
+        std::vector<Quadric> quadrics(vertexCount);
+        std::vector<Point> triangleNormals(result.size() / 3);
+        for (size_t t = 0; t < result.size() / 3; ++t) {
+            const Point& p0 = points[result[t * 3 + 0]];
+            const Point& p1 = points[result[t * 3 + 1]];
+            const Point& p2 = points[result[t * 3 + 2]];
+            Point normal = Cross(Sub(p1, p0), Sub(p2, p0));
+            const double length = std::sqrt(Dot(normal, normal));
+            if (length <= 0.0) {
+                continue;
+            }
+            normal = { normal.x / length, normal.y / length, normal.z / length };
+            triangleNormals[t] = normal;
+            const double area = length * 0.5;
+            for (int k = 0; k < 3; ++k) {
+                quadrics[remap[result[t * 3 + k]]].AddPlane(normal, -Dot(normal, p0), area);
+            }
+        }
+        for (const HalfEdge& edge : edges) {
+            const HalfEdge* reverse = FindHalfEdge(edges, remap[edge.to], remap[edge.from]);
+            const bool isSeam = reverse && (uvGroup[reverse->from] != uvGroup[edge.to] || uvGroup[reverse->to] != uvGroup[edge.from]);
+            if (reverse && !isSeam) {
+                continue;
+            }
+            const Point& a = points[edge.from];
+            const Point& b = points[edge.to];
+            const Point direction = Sub(b, a);
+            Point normal = Cross(direction, triangleNormals[edge.triangle]);
+            const double length = std::sqrt(Dot(normal, normal));
+            if (length <= 0.0) {
+                continue;
+            }
+            normal = { normal.x / length, normal.y / length, normal.z / length };
+            const double weight = Dot(direction, direction) * kConstraintWeight;
+            quadrics[remap[edge.from]].AddPlane(normal, -Dot(normal, a), weight);
+            quadrics[remap[edge.to]].AddPlane(normal, -Dot(normal, a), weight);
+        }
+
+        // 4. 誤差の小さい辺から縮約する。1回の中では周りが重ならないものだけを選び、終わったら添字を書き換える
+        const double costLimit = static_cast<double>(targetError) * targetError;
+        double maxCost = 0.0;
+        std::vector<uint32_t> collapseRemap(vertexCount);
+        std::iota(collapseRemap.begin(), collapseRemap.end(), 0u);
+        std::vector<uint8_t> isTouched(vertexCount);
+        std::vector<uint32_t> adjacencyOffset(vertexCount + 1);
+        std::vector<uint32_t> adjacency;
+        std::vector<Collapse> collapses;
+        std::vector<std::pair<uint32_t, uint32_t>> groupTargets;
+        std::vector<std::pair<uint32_t, uint32_t>> wedgeTargets;
+
+        while (result.size() > targetIndexCount) {
+            const size_t triangleCount = result.size() / 3;
+            if (edges.empty()) {
+                BuildHalfEdges(result, remap, edges);
+            }
+
+            // 位置ごとに周りの三角形
+            std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0u);
+            for (uint32_t index : result) {
+                ++adjacencyOffset[remap[index] + 1];
+            }
+            for (size_t v = 0; v < vertexCount; ++v) {
+                adjacencyOffset[v + 1] += adjacencyOffset[v];
+            }
+            adjacency.resize(result.size());
+            {
+                std::vector<uint32_t> cursor(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+                for (size_t i = 0; i < result.size(); ++i) {
+                    adjacency[cursor[remap[result[i]]]++] = static_cast<uint32_t>(i / 3);
+                }
+            }
+
+            // 縮約の候補(辺ごとに安い向きを1つ。両向きある辺は a < b の側で見る)
+            collapses.clear();
+            for (size_t e = 0; e < edges.size(); ++e) {
+                if (e > 0 && edges[e - 1].key == edges[e].key) {
+                    continue;
+                }
+                const uint32_t a = static_cast<uint32_t>(edges[e].key >> 32);
+                const uint32_t b = static_cast<uint32_t>(edges[e].key);
+                const bool isBorderEdge = !FindHalfEdge(edges, b, a);
+                if (!isBorderEdge && a > b) {
+                    continue;
+                }
+                auto canCollapse = [&](uint32_t source) {
+                    switch (kinds[source]) {
+                    case VertexKind::Manifold:
+                    case VertexKind::Seam:
+                        return !isBorderEdge;
+                    case VertexKind::Border:
+                        return isBorderEdge;
+                    default:
+                        return false;
+                    }
+                };
+                const double costAB = canCollapse(a) ? quadrics[a].Evaluate(points[b]) : -1.0;
+                const double costBA = canCollapse(b) ? quadrics[b].Evaluate(points[a]) : -1.0;
+                if (costAB < 0.0 && costBA < 0.0) {
+                    continue;
+                }
+                if (costBA < 0.0 || (costAB >= 0.0 && costAB <= costBA)) {
+                    collapses.push_back({ a, b, costAB });
+                } else {
+                    collapses.push_back({ b, a, costBA });
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+            std::fill(isTouched.begin(), isTouched.end(), uint8_t(0));
+            const size_t goal = triangleCount - targetIndexCount / 3;
+            // 1回の縮約でおよそ2枚減るので、目標に要る数番目の誤差の少し上までにとどめる(安い辺から少しずつ進める)
+            const size_t collapseGoal = (std::max)(goal / 2, size_t(1));
+            double passLimit = costLimit;
+            if (collapseGoal < collapses.size()) {
+                passLimit = (std::min)(costLimit, collapses[collapseGoal].cost * kPassErrorScale);
+            }
+            size_t removed = 0;
+            size_t appliedCount = 0;
+            for (const Collapse& collapse : collapses) {
+                if (collapse.cost > passLimit || removed >= goal) {
+                    break;
+                }
+                const uint32_t source = collapse.source;
+                const uint32_t target = collapse.target;
+                if (isTouched[source] || isTouched[target]) {
+                    continue;
+                }
+
+                // 裏返る三角形がないか、切れ目の頂点ごとの行き先が決まるか
+                bool isValid = true;
+                size_t removedTriangles = 0;
+                for (uint32_t i = adjacencyOffset[source]; i < adjacencyOffset[source + 1] && isValid; ++i) {
+                    const uint32_t* triangle = &result[adjacency[i] * 3];
+                    int sourceCorner = -1;
+                    bool hasTarget = false;
+                    for (int k = 0; k < 3; ++k) {
+                        if (remap[triangle[k]] == source) {
+                            sourceCorner = k;
+                        } else if (remap[triangle[k]] == target) {
+                            hasTarget = true;
+                        }
+                    }
+                    if (hasTarget) {
+                        ++removedTriangles;
+                        continue;
+                    }
+                    const Point& p0 = points[triangle[0]];
+                    const Point& p1 = points[triangle[1]];
+                    const Point& p2 = points[triangle[2]];
+                    const Point before = Cross(Sub(p1, p0), Sub(p2, p0));
+                    Point moved[3] = { p0, p1, p2 };
+                    moved[sourceCorner] = points[target];
+                    const Point after = Cross(Sub(moved[1], moved[0]), Sub(moved[2], moved[0]));
+                    const double beforeLength = std::sqrt(Dot(before, before));
+                    const double afterLength = std::sqrt(Dot(after, after));
+                    if (beforeLength > 0.0 && Dot(before, after) <= kFlipThreshold * beforeLength * afterLength) {
+                        isValid = false;
+                    }
+                    // 向きは同じでも一直線に近く潰れるなら縮約しない
+                    const Point e0 = Sub(moved[1], moved[0]);
+                    const Point e1 = Sub(moved[2], moved[1]);
+                    const Point e2 = Sub(moved[0], moved[2]);
+                    const double longest = (std::max)({ Dot(e0, e0), Dot(e1, e1), Dot(e2, e2) });
+                    if (afterLength < kSliverThreshold * longest && afterLength < beforeLength) {
+                        isValid = false;
+                    }
+                }
+                if (!isValid) {
+                    continue;
+                }
+
+                // sourceのUVの組ごとに、同じ三角形でつながっているtargetのUVの組を決める
+                groupTargets.clear();
+                for (uint32_t i = adjacencyOffset[source]; i < adjacencyOffset[source + 1] && isValid; ++i) {
+                    const uint32_t* triangle = &result[adjacency[i] * 3];
+                    uint32_t sourceGroup = UINT32_MAX;
+                    uint32_t targetGroup = UINT32_MAX;
+                    for (int k = 0; k < 3; ++k) {
+                        if (remap[triangle[k]] == source) {
+                            sourceGroup = uvGroup[triangle[k]];
+                        } else if (remap[triangle[k]] == target) {
+                            targetGroup = uvGroup[triangle[k]];
+                        }
+                    }
+                    auto it = std::find_if(groupTargets.begin(), groupTargets.end(), [&](const auto& pair) { return pair.first == sourceGroup; });
+                    if (it == groupTargets.end()) {
+                        groupTargets.push_back({ sourceGroup, targetGroup });
+                    } else if (targetGroup != UINT32_MAX) {
+                        if (it->second != UINT32_MAX && it->second != targetGroup) {
+                            // 両側でtargetのUVが違う(切れ目をまたぐ)
+                            isValid = false;
+                        }
+                        it->second = targetGroup;
+                    }
+                }
+                for (const auto& pair : groupTargets) {
+                    if (pair.second == UINT32_MAX) {
+                        // targetとつながらないUVの側がある(切れ目を崩す)
+                        isValid = false;
+                    }
+                }
+                if (!isValid) {
+                    continue;
+                }
+
+                // 頂点ごとに、行き先のUVの組の中から法線が最も近いtargetの頂点へ移す
+                wedgeTargets.clear();
+                uint32_t w = source;
+                do {
+                    uint32_t mapped = target;
+                    auto it = std::find_if(groupTargets.begin(), groupTargets.end(), [&](const auto& pair) { return pair.first == uvGroup[w]; });
+                    if (it != groupTargets.end()) {
+                        float bestDot = -(std::numeric_limits<float>::max)();
+                        uint32_t t = target;
+                        do {
+                            if (uvGroup[t] == it->second) {
+                                const Vector3& n0 = vertices[w].normal;
+                                const Vector3& n1 = vertices[t].normal;
+                                const float dot = n0.x * n1.x + n0.y * n1.y + n0.z * n1.z;
+                                if (dot > bestDot) {
+                                    bestDot = dot;
+                                    mapped = t;
+                                }
+                            }
+                            t = wedge[t];
+                        } while (t != target);
+                    }
+                    wedgeTargets.push_back({ w, mapped });
+                    w = wedge[w];
+                } while (w != source);
+
+                for (const auto& [from, to] : wedgeTargets) {
+                    collapseRemap[from] = to;
+                }
+                quadrics[target].Add(quadrics[source]);
+                // 周りの位置はこの回ではもう動かさない(裏返りの判定が古くならないように)
+                for (uint32_t i = adjacencyOffset[source]; i < adjacencyOffset[source + 1]; ++i) {
+                    const uint32_t* triangle = &result[adjacency[i] * 3];
+                    for (int k = 0; k < 3; ++k) {
+                        isTouched[remap[triangle[k]]] = 1;
+                    }
+                }
+                removed += removedTriangles;
+                maxCost = (std::max)(maxCost, collapse.cost);
+                ++appliedCount;
+            }
+            if (appliedCount == 0) {
+                break;
+            }
+
+            // 添字を書き換え、潰れた三角形を捨てる
+            size_t writeIndex = 0;
+            for (size_t i = 0; i < result.size(); i += 3) {
+                const uint32_t a = collapseRemap[result[i + 0]];
+                const uint32_t b = collapseRemap[result[i + 1]];
+                const uint32_t c = collapseRemap[result[i + 2]];
+                if (remap[a] == remap[b] || remap[b] == remap[c] || remap[c] == remap[a]) {
+                    continue;
+                }
+                result[writeIndex++] = a;
+                result[writeIndex++] = b;
+                result[writeIndex++] = c;
+            }
+            result.resize(writeIndex);
+            edges.clear();
+        }
+
+        if (resultError) {
+            *resultError = static_cast<float>(std::sqrt(maxCost));
+        }
+        return result;
+    }
+
+    void GenerateLods(ObjMesh& mesh, const float* ratios, size_t ratioCount, float maxError) {
+        mesh.lods.clear();
+        const size_t triangleCount = mesh.indices.size() / 3;
+        size_t previousCount = mesh.indices.size();
+        for (size_t i = 0; i < ratioCount; ++i) {
+            const size_t targetIndexCount = (std::max)(static_cast<size_t>(triangleCount * ratios[i]), size_t(1)) * 3;
+            ObjMeshLod lod;
+            lod.indices = Simplify(mesh.vertices, mesh.indices, targetIndexCount, maxError, &lod.error);
+            // 前の段から1割も減らないなら、誤差の上限か縁・切れ目でもう減らせない
+            if (lod.indices.empty() || lod.indices.size() * 10 > previousCount * 9) {
+                break;
+            }
+            MeshOptimizer::OptimizeVertexCache(lod.indices, mesh.vertices.size());
+            previousCount = lod.indices.size();
+            mesh.lods.push_back(std::move(lod));
+        }
+    }
+
+    float MeasureDistance(const std::vector<VertexData>& vertices, const std::vector<uint32_t>& referenceIndices, const std::vector<uint32_t>& lodIndices) {
+        const float extent = GetExtent(vertices);
+        if (lodIndices.empty() || extent <= 0.0f) {
+            return 0.0f;
+        }
+        const std::vector<Point> points = NormalizePositions(vertices, extent);
+
+        std::vector<uint8_t> isUsed(vertices.size(), 0);
+        for (uint32_t index : referenceIndices) {
+            isUsed[index] = 1;
+        }
+        double maxDistance = 0.0;
+        for (size_t v = 0; v < vertices.size(); ++v) {
+            if (!isUsed[v]) {
+                continue;
+            }
+            double nearest = (std::numeric_limits<double>::max)();
+            for (size_t i = 0; i + 2 < lodIndices.size() && nearest > maxDistance; i += 3) {
+                nearest = (std::min)(nearest, DistanceSquared(points[v], points[lodIndices[i]], points[lodIndices[i + 1]], points[lodIndices[i + 2]]));
+            }
+            maxDistance = (std::max)(maxDistance, nearest);
+        }
+        return static_cast<float>(std::sqrt(maxDistance));
+    }
+
+    float GetExtent(const std::vector<VertexData>& vertices) {
+        if (vertices.empty()) {
+            return 0.0f;
+        }
+        Vector3 minimum = { vertices[0].position.x, vertices[0].position.y, vertices[0].position.z };
+        Vector3 maximum = minimum;
+        for (const VertexData& vertex : vertices) {
+            minimum.x = (std::min)(minimum.x, vertex.position.x);
+            minimum.y = (std::min)(minimum.y, vertex.position.y);
+            minimum.z = (std::min)(minimum.z, vertex.position.z);
+            maximum.x = (std::max)(maximum.x, vertex.position.x);
+            maximum.y = (std::max)(maximum.y, vertex.position.y);
+            maximum.z = (std::max)(maximum.z, vertex.position.z);
+        }
+        return (std::max)({ maximum.x - minimum.x, maximum.y - minimum.y, maximum.z - minimum.z });
+    }
+}
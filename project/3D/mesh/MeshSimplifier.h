@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../../math/ObjModel.h"
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+/// <summary>
+/// 二次誤差(QEM)による辺の縮約で三角形を減らし、詳細度(LOD)の添字を作る
+/// 頂点は元のものをそのまま使うので、どの詳細度も同じ頂点バッファを共有できる
+/// 穴の縁(境界)とUV・法線の切れ目(シーム)は形が崩れないように縮約の向きを制限する
+/// </summary>
+namespace MeshSimplifier {
+
+    // 既定の詳細度(元の三角形数に対する割合。粗い順に並べる)
+    static inline const float kLodRatios[] = { 0.5f, 0.25f, 0.125f };
+
+    // 既定の誤差の上限(メッシュの大きさに対する割合)
+    static inline const float kMaxLodError = 0.05f;
+
+    /// <summary>
+    /// 三角形をtargetIndexCount(添字の数)まで減らした添字を返す
+    /// 誤差がtargetErrorを超える縮約はしないので、目標まで減らないこともある
+    /// resultErrorには最も大きかった誤差(メッシュの大きさに対する割合)が入る
+    /// </summary>
+    std::vector<uint32_t> Simplify(const std::vector<VertexData>& vertices, const std::vector<uint32_t>& indices,
+        size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+    /// <summary>
+    /// 割合ごとに簡略化してmesh.lodsに入れる(どの段も元の添字から作る)
+    /// 前の段からほとんど減らなくなったらそこで打ち切る
+    /// </summary>
+    void GenerateLods(ObjMesh& mesh, const float* ratios = kLodRatios, size_t ratioCount = std::size(kLodRatios), float maxError = kMaxLodError);
+
+    /// <summary>
+    /// 元の三角形が使う頂点から、簡略化した面までの最も遠い距離(メッシュの大きさに対する割合)
+    /// 総当たりなので重い(頂点数×三角形数)。確認・計測用
+    /// </summary>
+    float MeasureDistance(const std::vector<VertexData>& vertices, const std::vector<uint32_t>& referenceIndices, const std::vector<uint32_t>& lodIndices);
+
+    /// <summary>
+    /// 頂点を囲む箱の最も長い辺(誤差の割合の基準)
+    /// </summary>
+    float GetExtent(const std::vector<VertexData>& vertices);
+}
@@ -0,0 +1,349 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+    // これより法線が開いている塊は裏向きの判定をしない(円錐の軸との内積の最小)
+    const float kMinConeDot = 0.1f;
+
+    Vector3 ToVector3(const Vector4& v) { return { v.x, v.y, v.z }; }
+
+    float Dot(const Vector3& a, const Vector3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Vector3 Cross(const Vector3& a, const Vector3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+    // 長さが0なら0のまま返す
+    Vector3 SafeNormalize(const Vector3& v) {
+        const float length = std::sqrt(Dot(v, v));
+        return length > 0.0f ? v / length : Vector3{ 0.0f, 0.0f, 0.0f };
+    }
+
+    // 同じ位置の頂点に同じ番号を振る(UVや法線の切れ目をまたいでも隣の三角形を見つけるため)
+    std::vector<uint32_t> WeldPositions(const std::vector<VertexData>& vertices) {
+        std::vector<uint32_t> order(vertices.size());
+        std::iota(order.begin(), order.end(), 0u);
+        auto less = [&](uint32_t a, uint32_t b) {
+            const Vector4& pa = vertices[a].position;
+            const Vector4& pb = vertices[b].position;
+            if (pa.x != pb.x) return pa.x < pb.x;
+            if (pa.y != pb.y) return pa.y < pb.y;
+            return pa.z < pb.z;
+        };
+        std::sort(order.begin(), order.end(), less);
+        std::vector<uint32_t> weld(vertices.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            const bool isSame = i > 0 && !less(order[i - 1], order[i]);
+            weld[order[i]] = isSame ? weld[order[i - 1]] : order[i];
+        }
+        return weld;
+    }
+
+    // 位置で見たすべての辺に逆向きの辺があるか
+    bool IsClosed(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& weld) {
+        std::vector<uint64_t> edges(indices.size());
+        for (size_t i = 0; i < indices.size(); ++i) {
+            const uint32_t from = weld[indices[i]];
+            const uint32_t to = weld[indices[i - i % 3 + (i + 1) % 3]];
+            edges[i] = (static_cast<uint64_t>(from) << 32) | to;
+        }
+        std::sort(edges.begin(), edges.end());
+        for (uint64_t edge : edges) {
+            const uint64_t reverse = (edge << 32) | (edge >> 32);
+            if (!std::binary_search(edges.begin(), edges.end(), reverse)) {
+                return false;
+            }
+        }
+        return !edges.empty();
+    }
+
+    // Ritterの方法で点を包む球(最小ではないが数%大きい程度)
+    void ComputeSphere(const std::vector<Vector3>& points, Vector3& center, float& radius) {
+        // 1. 軸ごとに最も離れた2点のうち、一番遠い組を最初の直径にする
+        size_t minIndex[3] = { 0, 0, 0 };
+        size_t maxIndex[3] = { 0, 0, 0 };
+        for (size_t i = 0; i < points.size(); ++i) {
+            for (int axis = 0; axis < 3; ++axis) {
+                if (points[i][axis] < points[minIndex[axis]][axis]) {
+                    minIndex[axis] = i;
+                }
+                if (points[i][axis] > points[maxIndex[axis]][axis]) {
+                    maxIndex[axis] = i;
+                }
+            }
+        }
+        int bestAxis = 0;
+        float bestDistance = -1.0f;
+        for (int axis = 0; axis < 3; ++axis) {
+            const Vector3 d = points[maxIndex[axis]] - points[minIndex[axis]];
+            if (Dot(d, d) > bestDistance) {
+                bestDistance = Dot(d, d);
+                bestAxis = axis;
+            }
+        }
+        center = (points[minIndex[bestAxis]] + points[maxIndex[bestAxis]]) * 0.5f;
+        radius = std::sqrt(bestDistance) * 0.5f;
+
+        // 2. はみ出した点を含むように広げる
+        for (const Vector3& point : points) {
+            const Vector3 d = point - center;
+            const float distance = std::sqrt(Dot(d, d));
+            if (distance > radius) {
+                const float newRadius = (radius + distance) * 0.5f;
+                center += d * ((newRadius - radius) / distance);
+                radius = newRadius;
+            }
+        }
+    }
+}
+
+namespace MeshletBuilder {
+
+    void Build(ObjMesh& mesh, uint32_t maxVertices, uint32_t maxTriangles, float coneWeight) {
+        mesh.meshlets.clear();
+        mesh.isClosed = false;
+        const std::vector<uint32_t>& indices = mesh.indices;
+        const size_t triangleCount = indices.size() / 3;
+        const size_t vertexCount = mesh.vertices.size();
+        if (triangleCount == 0) {
+            return;
+        }
+        // 1つの塊に最低1枚は入るように
+        maxVertices = (std::max)(maxVertices, 3u);
+        maxTriangles = (std::max)(maxTriangles, 1u);
+
+        const std::vector<uint32_t> weld = WeldPositions(mesh.vertices);
+        mesh.isClosed = IsClosed(indices, weld);
+
+        // 1. 三角形の重心と単位法線
+        std::vector<Vector3> centroids(triangleCount);
+        std::vector<Vector3> normals(triangleCount);
+        double totalArea = 0.0;
+        for (size_t t = 0; t < triangleCount; ++t) {
+            const Vector3 a = ToVector3(mesh.vertices[indices[t * 3 + 0]].position);
+            const Vector3 b = ToVector3(mesh.vertices[indices[t * 3 + 1]].position);
+            const Vector3 c = ToVector3(mesh.vertices[indices[t * 3 + 2]].position);
+            const Vector3 normal = Cross(b - a, c - a);
+            totalArea += std::sqrt(Dot(normal, normal)) * 0.5;
+            normals[t] = SafeNormalize(normal);
+            centroids[t] = (a + b + c) / 3.0f;
+        }
+        // 塊が丸くまとまった時のおよその半径(距離の重み付けの基準)
+        float expectedRadius = static_cast<float>(std::sqrt(totalArea / triangleCount * maxTriangles) * 0.5);
+        if (!(expectedRadius > 0.0f)) {
+            expectedRadius = 1.0f;
+        }
+
+        // 2. 位置ごとに周りの三角形
+        std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+        for (uint32_t index : indices) {
+            ++adjacencyOffset[weld[index] + 1];
+        }
+        for (size_t v = 0; v < vertexCount; ++v) {
+            adjacencyOffset[v + 1] += adjacencyOffset[v];
+        }
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            std::vector<uint32_t> cursor(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+            for (size_t i = 0; i < indices.size(); ++i) {
+                adjacency[cursor[weld[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        // 3. 種の三角形から隣へ広げて塊を作る
+        std::vector<uint8_t> isUsed(triangleCount, 0);
+        // 頂点ごとの、まだ塊に入っていない三角形の数
+        std::vector<uint32_t> liveTriangles(vertexCount, 0);
+        for (uint32_t index : indices) {
+            ++liveTriangles[index];
+        }
+        // 頂点がどの塊に入っているか
+        std::vector<uint32_t> vertexMeshlet(vertexCount, UINT32_MAX);
+        std::vector<uint32_t> meshletVertices;
+        std::vector<uint32_t> meshletTriangles;
+        std::vector<Vector3> points;
+        std::vector<uint32_t> orderedIndices;
+        orderedIndices.reserve(indices.size());
+        meshletVertices.reserve(maxVertices);
+        meshletTriangles.reserve(maxTriangles);
+        size_t scanCursor = 0;
+        uint32_t nextSeed = UINT32_MAX;
+
+        while (true) {
+            // 前の塊の隣に残っていた三角形から始める(無ければ元の並びで次の未使用)
+            uint32_t triangle = nextSeed;
+            if (triangle == UINT32_MAX) {
+                while (scanCursor < triangleCount && isUsed[scanCursor]) {
+                    ++scanCursor;
+                }
+                if (scanCursor == triangleCount) {
+                    break;
+                }
+                triangle = static_cast<uint32_t>(scanCursor);
+            }
+
+            const uint32_t meshletIndex = static_cast<uint32_t>(mesh.meshlets.size());
+            meshletVertices.clear();
+            meshletTriangles.clear();
+            Vector3 centroidSum = { 0.0f, 0.0f, 0.0f };
+            Vector3 normalSum = { 0.0f, 0.0f, 0.0f };
+
+            while (true) {
+                isUsed[triangle] = 1;
+                meshletTriangles.push_back(triangle);
+                for (int k = 0; k < 3; ++k) {
+                    const uint32_t v = indices[triangle * 3 + k];
+                    --liveTriangles[v];
+                    if (vertexMeshlet[v] != meshletIndex) {
+                        vertexMeshlet[v] = meshletIndex;
+                        meshletVertices.push_back(v);
+                    }
+                }
+                centroidSum += centroids[triangle];
+                normalSum += normals[triangle];
+                if (meshletTriangles.size() >= maxTriangles) {
+                    break;
+                }
+
+                // 次の三角形: 増える頂点が少ないもの、同じなら近くて法線がそろっているもの
+                const Vector3 center = centroidSum / static_cast<float>(meshletTriangles.size());
+                const Vector3 axis = SafeNormalize(normalSum);
+                uint32_t best = UINT32_MAX;
+                uint32_t bestExtra = UINT32_MAX;
+                float bestScore = (std::numeric_limits<float>::max)();
+                for (uint32_t v : meshletVertices) {
+                    for (uint32_t i = adjacencyOffset[weld[v]]; i < adjacencyOffset[weld[v] + 1]; ++i) {
+                        const uint32_t candidate = adjacency[i];
+                        if (isUsed[candidate]) {
+                            continue;
+                        }
+                        uint32_t extra = 0;
+                        bool isDangling = false;
+                        for (int k = 0; k < 3; ++k) {
+                            const uint32_t corner = indices[candidate * 3 + k];
+                            extra += vertexMeshlet[corner] != meshletIndex ? 1 : 0;
+                            isDangling = isDangling || liveTriangles[corner] == 1;
+                        }
+                        if (meshletVertices.size() + extra > maxVertices) {
+                            continue;
+                        }
+                        // 頂点が増えないものが最優先。取り残されそうな三角形(その頂点を使う最後の1枚)は次に優先する
+                        // (後の塊でこれだけのために頂点を足すと埋まりが悪くなる)
+                        const uint32_t priority = extra == 0 ? 0 : (isDangling ? 1 : extra + 1);
+                        const Vector3 offset = centroids[candidate] - center;
+                        const float distance = std::sqrt(Dot(offset, offset)) / expectedRadius;
+                        const float spread = 1.0f - Dot(normals[candidate], axis);
+                        const float score = (1.0f - coneWeight) * distance + coneWeight * spread;
+                        if (priority < bestExtra || (priority == bestExtra && score < bestScore)) {
+                            best = candidate;
+                            bestExtra = priority;
+                            bestScore = score;
+                        }
+                    }
+                }
+                if (best == UINT32_MAX) {
+                    break;
+                }
+                triangle = best;
+            }
+
+            // 次の種は、この塊の隣に残った三角形のうち周りに残りが少ないもの(隅から埋めて取り残しを減らす)
+            nextSeed = UINT32_MAX;
+            uint32_t bestLive = UINT32_MAX;
+            for (uint32_t v : meshletVertices) {
+                for (uint32_t i = adjacencyOffset[weld[v]]; i < adjacencyOffset[weld[v] + 1]; ++i) {
+                    const uint32_t candidate = adjacency[i];
+                    if (isUsed[candidate]) {
+                        continue;
+                    }
+                    const uint32_t live = liveTriangles[indices[candidate * 3 + 0]] + liveTriangles[indices[candidate * 3 + 1]] + liveTriangles[indices[candidate * 3 + 2]];
+                    if (live < bestLive) {
+                        nextSeed = candidate;
+                        bestLive = live;
+                    }
+                }
+            }
+
+            // 塊の中は元の並び(頂点キャッシュ向けに並べ替えた順)に戻す
+            std::sort(meshletTriangles.begin(), meshletTriangles.end());
+
+            // 4. 塊を書き出し、包む球と法線の円錐を求める
+            ObjMeshlet meshlet;
+            meshlet.indexOffset = static_cast<uint32_t>(orderedIndices.size());
+            meshlet.indexCount = static_cast<uint32_t>(meshletTriangles.size() * 3);
+            meshlet.vertexCount = static_cast<uint32_t>(meshletVertices.size());
+            for (uint32_t t : meshletTriangles) {
+                orderedIndices.insert(orderedIndices.end(), indices.begin() + t * 3, indices.begin() + t * 3 + 3);
+            }
+            points.clear();
+            for (uint32_t v : meshletVertices) {
+                points.push_back(ToVector3(mesh.vertices[v].position));
+            }
+            ComputeSphere(points, meshlet.center, meshlet.radius);
+
+            meshlet.coneAxis = SafeNormalize(normalSum);
+            meshlet.coneApex = meshlet.center;
+            float minDot = 1.0f;
+            for (uint32_t t : meshletTriangles) {
+                if (Dot(normals[t], normals[t]) > 0.0f) {
+                    minDot = (std::min)(minDot, Dot(normals[t], meshlet.coneAxis));
+                }
+            }
+            if (Dot(meshlet.coneAxis, meshlet.coneAxis) > 0.0f && minDot > kMinConeDot) {
+                // 頂点を全部の三角形の平面より後ろまで軸に沿って下げる
+                float maxT = 0.0f;
+                for (uint32_t t : meshletTriangles) {
+                    if (Dot(normals[t], normals[t]) <= 0.0f) {
+                        continue;
+                    }
+                    const Vector3 corner = ToVector3(mesh.vertices[indices[t * 3]].position);
+                    const float dc = Dot(meshlet.center - corner, normals[t]);
+                    const float dn = Dot(meshlet.coneAxis, normals[t]);
+                    maxT = (std::max)(maxT, dc / dn);
+                }
+                meshlet.coneApex = meshlet.center - meshlet.coneAxis * maxT;
+                meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+            }
+            mesh.meshlets.push_back(meshlet);
+        }
+
+        mesh.indices.swap(orderedIndices);
+    }
+
+    BuildStats Analyze(const ObjMesh& mesh, uint32_t maxVertices, uint32_t maxTriangles) {
+        BuildStats stats;
+        stats.meshletCount = mesh.meshlets.size();
+        if (mesh.meshlets.empty() || mesh.vertices.empty()) {
+            return stats;
+        }
+        Vector3 minimum = ToVector3(mesh.vertices[0].position);
+        Vector3 maximum = minimum;
+        for (const VertexData& vertex : mesh.vertices) {
+            minimum = { (std::min)(minimum.x, vertex.position.x), (std::min)(minimum.y, vertex.position.y), (std::min)(minimum.z, vertex.position.z) };
+            maximum = { (std::max)(maximum.x, vertex.position.x), (std::max)(maximum.y, vertex.position.y), (std::max)(maximum.z, vertex.position.z) };
+        }
+        const float extent = (std::max)({ maximum.x - minimum.x, maximum.y - minimum.y, maximum.z - minimum.z });
+
+        double vertexSum = 0.0;
+        double triangleSum = 0.0;
+        double radiusSum = 0.0;
+        size_t coneCount = 0;
+        for (const ObjMeshlet& meshlet : mesh.meshlets) {
+            vertexSum += meshlet.vertexCount;
+            triangleSum += meshlet.indexCount / 3;
+            radiusSum += meshlet.radius;
+            coneCount += meshlet.coneCutoff < 1.0f ? 1 : 0;
+        }
+        const double count = static_cast<double>(mesh.meshlets.size());
+        stats.averageVertices = static_cast<float>(vertexSum / count);
+        stats.averageTriangles = static_cast<float>(triangleSum / count);
+        stats.vertexFill = stats.averageVertices / maxVertices;
+        stats.triangleFill = stats.averageTriangles / maxTriangles;
+        stats.averageRadius = extent > 0.0f ? static_cast<float>(radiusSum / count / extent) : 0.0f;
+        stats.coneRatio = static_cast<float>(coneCount / count);
+        stats.vertexDuplication = static_cast<float>(vertexSum / mesh.vertices.size());
+        return stats;
+    }
+}
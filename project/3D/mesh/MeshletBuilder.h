@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../../math/ObjModel.h"
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// 三角形を隣り合うものどうしで塊(meshlet)にまとめ、塊ごとに包む球と法線の円錐を求める
+/// 塊の三角形がindicesの中で続くように並べ替えるので、見える塊の範囲だけを描ける
+/// 上限はメッシュシェーダーでよく使う 64頂点・124三角形
+/// </summary>
+namespace MeshletBuilder {
+
+    static inline const uint32_t kMaxVertices = 64;
+    static inline const uint32_t kMaxTriangles = 124;
+
+    // 塊を育てる時に、法線のそろい具合をどれだけ重く見るか(0なら距離だけ)
+    static inline const float kConeWeight = 0.5f;
+
+    // 塊の出来の集計
+    struct BuildStats {
+        size_t meshletCount = 0;
+        // 塊あたりの頂点・三角形の平均と、上限に対する割合
+        float averageVertices = 0.0f;
+        float averageTriangles = 0.0f;
+        float vertexFill = 0.0f;
+        float triangleFill = 0.0f;
+        // 包む球の半径の平均(メッシュの大きさに対する割合。小さいほど視錐台で外しやすい)
+        float averageRadius = 0.0f;
+        // 法線の円錐が使える塊の割合
+        float coneRatio = 0.0f;
+        // 塊をまたいで重複する頂点(塊の頂点数の合計 / 頂点数)
+        float vertexDuplication = 0.0f;
+    };
+
+    /// <summary>
+    /// 塊を作ってmesh.meshletsに入れ、mesh.indicesを塊の順に並べ替える(三角形の集合は変わらない)
+    /// mesh.isClosedも求める
+    /// </summary>
+    void Build(ObjMesh& mesh, uint32_t maxVertices = kMaxVertices, uint32_t maxTriangles = kMaxTriangles, float coneWeight = kConeWeight);
+
+    /// <summary>
+    /// 塊の出来を集計する
+    /// </summary>
+    BuildStats Analyze(const ObjMesh& mesh, uint32_t maxVertices = kMaxVertices, uint32_t maxTriangles = kMaxTriangles);
+}
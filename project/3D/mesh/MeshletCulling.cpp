@@ -0,0 +1,107 @@
+#include "MeshletCulling.h"
+
+#include <cmath>
+
+namespace MeshletCulling {
+
+    Frustum MakeFrustum(const Matrix4x4& m) {
+        // クリップ座標は 行ベクトル×行列 なので、列を組み合わせると平面になる(D3Dのzは0~w)
+        auto column = [&](int j) { return Vector4{ m.m[0][j], m.m[1][j], m.m[2][j], m.m[3][j] }; };
+        auto add = [](const Vector4& a, const Vector4& b) { return Vector4{ a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w }; };
+        auto sub = [](const Vector4& a, const Vector4& b) { return Vector4{ a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w }; };
+        const Vector4 x = column(0);
+        const Vector4 y = column(1);
+        const Vector4 z = column(2);
+        const Vector4 w = column(3);
+
+        Frustum frustum;
+        frustum.planes[0] = add(w, x); // 左
+        frustum.planes[1] = sub(w, x); // 右
+        frustum.planes[2] = add(w, y); // 下
+        frustum.planes[3] = sub(w, y); // 上
+        frustum.planes[4] = z;         // 手前
+        frustum.planes[5] = sub(w, z); // 奥
+        for (Vector4& plane : frustum.planes) {
+            const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+            if (length > 0.0f) {
+                plane = { plane.x / length, plane.y / length, plane.z / length, plane.w / length };
+            }
+        }
+        return frustum;
+    }
+
+    bool IsOutside(const ObjMeshlet& meshlet, const Frustum& frustum) {
+        for (const Vector4& plane : frustum.planes) {
+            const float distance = plane.x * meshlet.center.x + plane.y * meshlet.center.y + plane.z * meshlet.center.z + plane.w;
+            if (distance < -meshlet.radius) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool IsOutside(const Sphere& sphere, const Frustum& frustum) {
+        for (const Vector4& plane : frustum.planes) {
+            const float distance = plane.x * sphere.center.x + plane.y * sphere.center.y + plane.z * sphere.center.z + plane.w;
+            if (distance < -sphere.radius) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool IsOutside(const OBB& obb, const Frustum& frustum) {
+        for (const Vector4& plane : frustum.planes) {
+            // 平面の法線方向に箱が広がっている長さ
+            float extent = 0.0f;
+            for (int k = 0; k < 3; ++k) {
+                const Vector3& axis = obb.orientations[k];
+                extent += std::fabs(plane.x * axis.x + plane.y * axis.y + plane.z * axis.z) * obb.size[k];
+            }
+            const float distance = plane.x * obb.center.x + plane.y * obb.center.y + plane.z * obb.center.z + plane.w;
+            if (distance < -extent) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool IsBackFacing(const ObjMeshlet& meshlet, const Vector3& cameraPosition) {
+        if (meshlet.coneCutoff >= 1.0f) {
+            return false;
+        }
+        const Vector3 view = { meshlet.coneApex.x - cameraPosition.x, meshlet.coneApex.y - cameraPosition.y, meshlet.coneApex.z - cameraPosition.z };
+        const float length = std::sqrt(view.x * view.x + view.y * view.y + view.z * view.z);
+        if (length <= 0.0f) {
+            return false;
+        }
+        // 正規化の割り算を避けて両辺にlengthを掛ける
+        const float dot = view.x * meshlet.coneAxis.x + view.y * meshlet.coneAxis.y + view.z * meshlet.coneAxis.z;
+        return dot >= meshlet.coneCutoff * length;
+    }
+
+    CullStats Cull(const std::vector<ObjMeshlet>& meshlets, const Frustum& frustum, const Vector3& cameraPosition,
+        bool isBackfaceCulling, std::vector<IndexRange>& visibleRanges) {
+        CullStats stats;
+        visibleRanges.clear();
+        for (const ObjMeshlet& meshlet : meshlets) {
+            if (IsOutside(meshlet, frustum)) {
+                ++stats.frustumCulledCount;
+                continue;
+            }
+            if (isBackfaceCulling && IsBackFacing(meshlet, cameraPosition)) {
+                ++stats.backfaceCulledCount;
+                continue;
+            }
+            ++stats.visibleCount;
+            stats.visibleIndexCount += meshlet.indexCount;
+            // 前の範囲のすぐ後ろなら伸ばす(描画の呼び出しを減らす)
+            if (!visibleRanges.empty() && visibleRanges.back().startIndex + visibleRanges.back().indexCount == meshlet.indexOffset) {
+                visibleRanges.back().indexCount += meshlet.indexCount;
+            } else {
+                visibleRanges.push_back({ meshlet.indexOffset, meshlet.indexCount });
+            }
+        }
+        return stats;
+    }
+}
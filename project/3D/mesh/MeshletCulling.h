@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../../math/ObjModel.h"
+#include "../../math/IndexRange.h"
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// 塊(meshlet)ごとに、視錐台の外にあるものと全部裏を向いているものをCPUで外す
+/// 判定はメッシュのローカル座標で行う(World*View*Projectionから平面を取り出す)
+/// </summary>
+namespace MeshletCulling {
+
+    // 視錐台の6枚の平面(xyzが内向きの単位法線、wが距離)
+    struct Frustum {
+        Vector4 planes[6];
+    };
+
+    struct CullStats {
+        size_t visibleCount = 0;
+        size_t frustumCulledCount = 0;
+        size_t backfaceCulledCount = 0;
+        // 描く添字の数
+        size_t visibleIndexCount = 0;
+    };
+
+    /// <summary>
+    /// 行列(行ベクトルに右から掛ける形。World*View*Projectionならローカル座標の平面になる)から視錐台を作る
+    /// </summary>
+    Frustum MakeFrustum(const Matrix4x4& worldViewProjection);
+
+    /// <summary>
+    /// 包む球が視錐台の外か
+    /// </summary>
+    bool IsOutside(const ObjMeshlet& meshlet, const Frustum& frustum);
+
+    /// <summary>
+    /// メッシュ全体を包む球・向きを合わせた箱が視錐台の外か(塊を調べる前にまとめて外す)
+    /// </summary>
+    bool IsOutside(const Sphere& sphere, const Frustum& frustum);
+    bool IsOutside(const OBB& obb, const Frustum& frustum);
+
+    /// <summary>
+    /// 塊の三角形がすべてカメラに裏を向けているか(cameraPositionはローカル座標)
+    /// </summary>
+    bool IsBackFacing(const ObjMeshlet& meshlet, const Vector3& cameraPosition);
+
+    /// <summary>
+    /// 見える塊の添字の範囲を集める(indicesの中で続いている範囲は1つにまとめる)
+    /// isBackfaceCullingがfalseなら視錐台だけで判定する
+    /// </summary>
+    CullStats Cull(const std::vector<ObjMeshlet>& meshlets, const Frustum& frustum, const Vector3& cameraPosition,
+        bool isBackfaceCulling, std::vector<IndexRange>& visibleRanges);
+}
@@ -0,0 +1,89 @@
+#include "ObjMeshIndexer.h"
+
+#include <algorithm>
+
+size_t ObjMeshIndexer::Hash(int position, int texcoord, int normal) {
+    uint64_t h = static_cast<uint32_t>(position) * 0x9E3779B97F4A7C15ull;
+    h ^= static_cast<uint32_t>(texcoord) * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+    h ^= static_cast<uint32_t>(normal) * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+    return static_cast<size_t>(h ^ (h >> 29));
+}
+
+void ObjMeshIndexer::Grow() {
+    std::vector<Slot> old = std::move(slots_);
+    slots_.assign(old.empty() ? 1024 : old.size() * 2, Slot{});
+    const size_t mask = slots_.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.vertex == 0) {
+            continue;
+        }
+        size_t i = Hash(slot.position, slot.texcoord, slot.normal) & mask;
+        while (slots_[i].vertex != 0) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = slot;
+    }
+}
+
+uint32_t ObjMeshIndexer::Find(int position, int texcoord, int normal, uint32_t newIndex, bool& isAdded) {
+    // 埋まりが半分を超えたら広げる
+    if ((count_ + 1) * 2 > slots_.size()) {
+        Grow();
+    }
+
+    const size_t mask = slots_.size() - 1;
+    size_t i = Hash(position, texcoord, normal) & mask;
+    while (slots_[i].vertex != 0) {
+        const Slot& slot = slots_[i];
+        if (slot.position == position && slot.texcoord == texcoord && slot.normal == normal) {
+            isAdded = false;
+            return slot.vertex - 1;
+        }
+        i = (i + 1) & mask;
+    }
+
+    slots_[i] = { position, texcoord, normal, newIndex + 1 };
+    ++count_;
+    isAdded = true;
+    return newIndex;
+}
+
+uint32_t ObjMeshIndexer::GetOrAdd(int position, int texcoord, int normal, const std::vector<Vector4>& positions, const std::vector<Vector2>& texcoords, const std::vector<Vector3>& normals, ObjMesh& mesh) {
+    bool isAdded = false;
+    const uint32_t index = Find(position, texcoord, normal, static_cast<uint32_t>(mesh.vertices.size()), isAdded);
+    if (isAdded) {
+        // 初めての組なので頂点を作る
+        VertexData vertex;
+        vertex.position = (position > 0) ? positions[position - 1] : Vector4{};
+        vertex.texcoord = (texcoord > 0) ? texcoords[texcoord - 1] : Vector2{ 0.5f, 0.5f };
+        vertex.normal = (normal > 0) ? normals[normal - 1] : Vector3{};
+        mesh.vertices.push_back(vertex);
+    }
+    return index;
+}
+
+uint32_t ObjMeshIndexer::GetOrAdd(const Corner& corner, std::vector<Corner>& corners) {
+    bool isAdded = false;
+    const uint32_t index = Find(corner.position, corner.texcoord, corner.normal, static_cast<uint32_t>(corners.size()), isAdded);
+    if (isAdded) {
+        corners.push_back(corner);
+    }
+    return index;
+}
+
+void ObjMeshIndexer::Clear() {
+    std::fill(slots_.begin(), slots_.end(), Slot{});
+    count_ = 0;
+}
+
+std::vector<VertexData> ObjMeshIndexer::Expand(const ObjMesh& mesh) {
+    if (mesh.indices.empty()) {
+        return mesh.vertices;
+    }
+    std::vector<VertexData> vertices;
+    vertices.reserve(mesh.indices.size());
+    for (uint32_t index : mesh.indices) {
+        vertices.push_back(mesh.vertices[index]);
+    }
+    return vertices;
+}
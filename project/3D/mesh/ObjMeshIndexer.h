@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../../math/ObjModel.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// f行の頂点(位置/UV/法線の添字の組)から重複のない頂点と添字を作る
+/// 組をハッシュで引き、同じ組が出てきたら既存の頂点番号を返す
+/// </summary>
+class ObjMeshIndexer {
+public:
+
+    // 頂点1つ分の添字の組
+    struct Corner {
+        int position = 0;
+        int texcoord = 0;
+        int normal = 0;
+    };
+
+private: // メンバ変数
+
+    struct Slot {
+        int position = 0;
+        int texcoord = 0;
+        int normal = 0;
+        // 頂点番号 + 1 (0なら空き)
+        uint32_t vertex = 0;
+    };
+
+    // オープンアドレス法のハッシュ表(要素数は2のべき)
+    std::vector<Slot> slots_;
+
+    size_t count_ = 0;
+
+private: // メンバ関数
+
+    static size_t Hash(int position, int texcoord, int normal);
+
+    // 表を倍にして入れ直す
+    void Grow();
+
+    // 組を探す。無ければnewIndexで登録してisAddedをtrueにする
+    uint32_t Find(int position, int texcoord, int normal, uint32_t newIndex, bool& isAdded);
+
+public: // メンバ関数
+
+    /// <summary>
+    /// 添字の組に対応する頂点番号を返す。初めての組ならmesh.verticesに頂点を追加する
+    /// 添字が0以下の要素は既定値(UVは0.5,0.5)にする
+    /// </summary>
+    uint32_t GetOrAdd(int position, int texcoord, int normal, const std::vector<Vector4>& positions, const std::vector<Vector2>& texcoords, const std::vector<Vector3>& normals, ObjMesh& mesh);
+
+    /// <summary>
+    /// 添字の組に対応する番号を返す。初めての組ならcornersに追加する(頂点は作らない。並列読み込みで後からまとめる用)
+    /// </summary>
+    uint32_t GetOrAdd(const Corner& corner, std::vector<Corner>& corners);
+
+    /// <summary>
+    /// 次のメッシュ用に空にする
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// 添字を展開して三角形ごとの頂点列にする(比較用)
+    /// </summary>
+    static std::vector<VertexData> Expand(const ObjMesh& mesh);
+};
@@ -0,0 +1,642 @@
+#include "ObjParser.h"
+#include "ObjMeshIndexer.h"
+#include "MaterialLibrary.h"
+#include "MeshBounds.h"
+#include "../../engine/JobSystem.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+    inline bool IsSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // 空白を飛ばす(行の中だけを走査するので改行は来ない)
+    inline const char* SkipSpaces(const char* p, const char* end) {
+        while (p < end && IsSpace(*p)) {
+            ++p;
+        }
+        return p;
+    }
+
+    // 次の空白までを1要素として切り出す
+    inline std::string_view NextToken(const char*& p, const char* end) {
+        p = SkipSpaces(p, end);
+        const char* begin = p;
+        while (p < end && !IsSpace(*p)) {
+            ++p;
+        }
+        return std::string_view(begin, static_cast<size_t>(p - begin));
+    }
+
+    // 数値を1つ読む。読めなければ0(istreamの失敗時と同じ)
+    inline float NextFloat(const char*& p, const char* end) {
+        p = SkipSpaces(p, end);
+        if (p < end && *p == '+') {
+            ++p;
+        }
+        float value = 0.0f;
+        const std::from_chars_result result = std::from_chars(p, end, value);
+        if (result.ec != std::errc{}) {
+            return 0.0f;
+        }
+        p = result.ptr;
+        return value;
+    }
+
+    // 添字を1つ読む。読めなければ0(無し)
+    inline int ToIndex(std::string_view text) {
+        const char* p = text.data();
+        const char* end = p + text.size();
+        p = SkipSpaces(p, end);
+        if (p < end && *p == '+') {
+            ++p;
+        }
+        int value = 0;
+        if (std::from_chars(p, end, value).ec != std::errc{}) {
+            return 0;
+        }
+        return value;
+    }
+
+    // 負の添字(末尾からの相対)を1始まりの絶対添字にする。範囲外は0(無し)
+    inline int ResolveIndex(int index, size_t count) {
+        if (index < 0) {
+            index += static_cast<int>(count) + 1;
+        }
+        return (index > 0 && index <= static_cast<int>(count)) ? index : 0;
+    }
+
+    // f行の1頂点
+    using FaceCorner = ObjMeshIndexer::Corner;
+
+    // 1行を切り出す。行が無ければfalse
+    inline bool NextLine(const char*& cursor, const char* textEnd, const char*& lineBegin, const char*& lineEnd) {
+        if (cursor >= textEnd) {
+            return false;
+        }
+        lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<size_t>(textEnd - cursor)));
+        if (!lineEnd) {
+            lineEnd = textEnd;
+        }
+        lineBegin = cursor;
+        cursor = lineEnd + (lineEnd < textEnd ? 1 : 0);
+        return true;
+    }
+
+    inline Vector4 ReadPosition(const char*& p, const char* end) {
+        Vector4 pos;
+        pos.x = NextFloat(p, end);
+        pos.y = NextFloat(p, end);
+        pos.z = NextFloat(p, end);
+        pos.w = 1.0f;
+        // 左手系変換はここだけ
+        pos.x *= -1.0f;
+        return pos;
+    }
+
+    inline Vector2 ReadTexcoord(const char*& p, const char* end) {
+        Vector2 uv;
+        uv.x = NextFloat(p, end);
+        uv.y = NextFloat(p, end);
+        // y反転のみここで
+        uv.y = 1.0f - uv.y;
+        return uv;
+    }
+
+    inline Vector3 ReadNormal(const char*& p, const char* end) {
+        Vector3 n;
+        n.x = NextFloat(p, end);
+        n.y = NextFloat(p, end);
+        n.z = NextFloat(p, end);
+        // 左手系変換はここだけ
+        n.x *= -1.0f;
+        return n;
+    }
+
+    // 2次元の外積(abとacの向き)
+    inline float Cross2(float ax, float ay, float bx, float by, float cx, float cy) {
+        return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    }
+
+    // f行の全頂点を読む(負の添字はその時点の個数から数える)
+    void ReadFace(const char*& p, const char* end, size_t positionCount, size_t texcoordCount, size_t normalCount, std::vector<FaceCorner>& corners) {
+        corners.clear();
+        for (std::string_view token = NextToken(p, end); !token.empty(); token = NextToken(p, end)) {
+            FaceCorner corner{};
+            ObjParser::ParseFaceToken(token, corner.position, corner.texcoord, corner.normal);
+            corner.position = ResolveIndex(corner.position, positionCount);
+            corner.texcoord = ResolveIndex(corner.texcoord, texcoordCount);
+            corner.normal = ResolveIndex(corner.normal, normalCount);
+            corners.push_back(corner);
+        }
+    }
+
+    // 面を三角形に分ける。trianglesにはcornersの番号が3つ1組で入る
+    void TriangulateFace(const std::vector<FaceCorner>& corners, const std::vector<Vector4>& positions, std::vector<Vector4>& polygon, std::vector<uint32_t>& triangles) {
+        if (corners.size() == 3) {
+            triangles.assign({ 0, 1, 2 });
+            return;
+        }
+        // 四角形以上は三角形に分割する
+        polygon.clear();
+        for (const FaceCorner& corner : corners) {
+            polygon.push_back(corner.position > 0 ? positions[corner.position - 1] : Vector4{});
+        }
+        ObjParser::TriangulatePolygon(polygon.data(), polygon.size(), triangles);
+    }
+
+    // 並列読み込みで1つの塊を分けた区間(usemtl/mtllibで区切る)
+    struct ChunkSegment {
+        // 区間の面より前にある mtllib(true) / usemtl(false) の並び
+        std::vector<std::pair<bool, std::string>> events;
+        // 区間の中で重複を除いた添字の組(初出順)
+        std::vector<FaceCorner> corners;
+        // cornersへの添字(回り順反転済み)
+        std::vector<uint32_t> indices;
+
+        // まとめる時に決まる書き込み先
+        size_t meshIndex = 0;
+        size_t indexOffset = 0;
+        std::vector<uint32_t> remap;
+    };
+
+    // 並列読み込みの1つの塊(行の境目で切る)
+    struct Chunk {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+
+        // 1回目: v/vt/vn だけを読む
+        std::vector<Vector4> positions;
+        std::vector<Vector2> texcoords;
+        std::vector<Vector3> normals;
+        size_t positionOffset = 0;
+        size_t texcoordOffset = 0;
+        size_t normalOffset = 0;
+
+        // 2回目: f/usemtl/mtllib を読む
+        std::vector<ChunkSegment> segments;
+    };
+
+    // 配列をバイト単位で比べる(空のdata()はnullになりうるので、memcmpに渡す前に数で判定する)
+    template<typename T>
+    bool IsSameBytes(const std::vector<T>& a, const std::vector<T>& b) {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), sizeof(T) * a.size()) == 0);
+    }
+}
+
+namespace ObjParser {
+
+    ObjModel LoadFile(const std::string& directoryPath, const std::string& filename) {
+        // 1. ファイル全体を一括で読む
+        std::ifstream file(directoryPath + "/" + filename, std::ios::binary);
+        assert(file.is_open()); //とりあえず開けなかったら止める
+
+        file.seekg(0, std::ios::end);
+        const std::streamoff size = file.tellg();
+        file.seekg(0, std::ios::beg);
+        std::string text(static_cast<size_t>(size), '\0');
+        file.read(text.data(), size);
+
+        // 2. 解析する
+        return Parse(text, directoryPath);
+    }
+
+    ObjModel Parse(std::string_view text, const std::string& directoryPath) {
+        ObjModel objModel;
+        std::vector<Vector4> positions;
+        std::vector<Vector3> normals;
+        std::vector<Vector2> texcoords;
+        MaterialTableBuilder materialTable(objModel.materials, directoryPath);
+
+        ObjMesh currentMesh;
+        ObjMeshIndexer indexer;
+
+        // f行の作業用(行ごとに確保し直さない)
+        std::vector<FaceCorner> corners;
+        std::vector<uint32_t> cornerVertices;
+        std::vector<Vector4> polygon;
+        std::vector<uint32_t> triangles;
+
+        const char* cursor = text.data();
+        const char* const textEnd = cursor + text.size();
+        const char* p = nullptr;
+        const char* lineEnd = nullptr;
+        while (NextLine(cursor, textEnd, p, lineEnd)) {
+            const std::string_view id = NextToken(p, lineEnd);
+
+            if (id == "v") {
+                positions.push_back(ReadPosition(p, lineEnd));
+            } else if (id == "vt") {
+                texcoords.push_back(ReadTexcoord(p, lineEnd));
+            } else if (id == "vn") {
+                normals.push_back(ReadNormal(p, lineEnd));
+            } else if (id == "f") {
+                ReadFace(p, lineEnd, positions.size(), texcoords.size(), normals.size(), corners);
+                if (corners.size() < 3) {
+                    continue;
+                }
+
+                cornerVertices.clear();
+                for (const FaceCorner& corner : corners) {
+                    cornerVertices.push_back(indexer.GetOrAdd(corner.position, corner.texcoord, corner.normal, positions, texcoords, normals, currentMesh));
+                }
+                TriangulateFace(corners, positions, polygon, triangles);
+                // 三角形の回り順は逆にしている
+                for (size_t t = 0; t + 2 < triangles.size(); t += 3) {
+                    currentMesh.indices.push_back(cornerVertices[triangles[t + 2]]);
+                    currentMesh.indices.push_back(cornerVertices[triangles[t + 1]]);
+                    currentMesh.indices.push_back(cornerVertices[triangles[t]]);
+                }
+            } else if (id == "usemtl") {
+                if (!currentMesh.indices.empty()) {
+                    MeshBounds::Compute(currentMesh);
+                    objModel.meshes.push_back(std::move(currentMesh));
+                    currentMesh = ObjMesh();
+                    indexer.Clear();
+                }
+                currentMesh.materialIndex = materialTable.Use(std::string(NextToken(p, lineEnd)));
+            } else if (id == "mtllib") {
+                materialTable.AddLibrary(std::string(NextToken(p, lineEnd)));
+            }
+        }
+
+        if (!currentMesh.indices.empty()) {
+            MeshBounds::Compute(currentMesh);
+            objModel.meshes.push_back(std::move(currentMesh));
+        }
+
+        return objModel;
+    }
+
+    ObjModel LoadFileParallel(const std::string& directoryPath, const std::string& filename, JobSystem* jobSystem, uint32_t maxThreads) {
+        std::ifstream file(directoryPath + "/" + filename, std::ios::binary);
+        assert(file.is_open()); //とりあえず開けなかったら止める
+
+        file.seekg(0, std::ios::end);
+        const std::streamoff size = file.tellg();
+        file.seekg(0, std::ios::beg);
+        std::string text(static_cast<size_t>(size), '\0');
+        file.read(text.data(), size);
+
+        return ParseParallel(text, directoryPath, jobSystem, maxThreads);
+    }
+
+    ObjModel ParseParallel(std::string_view text, const std::string& directoryPath, JobSystem* jobSystem, uint32_t maxThreads) {
+        // 1. 行の境目で塊に分ける(塊の大きさはスレッド数によらず一定にして、結果が変わらないようにする)
+        std::vector<Chunk> chunks;
+        const char* const textBegin = text.data();
+        const char* const textEnd = textBegin + text.size();
+        for (const char* begin = textBegin; begin < textEnd;) {
+            const char* end = begin + (std::min)(kChunkBytes, static_cast<size_t>(textEnd - begin));
+            if (end < textEnd) {
+                const char* newline = static_cast<const char*>(std::memchr(end, '\n', static_cast<size_t>(textEnd - end)));
+                end = newline ? newline + 1 : textEnd;
+            }
+            Chunk chunk;
+            chunk.begin = begin;
+            chunk.end = end;
+            chunks.push_back(std::move(chunk));
+            begin = end;
+        }
+
+        // 2. 塊ごとに v/vt/vn を読む
+        ParallelFor(jobSystem, chunks.size(), 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t c = begin; c < end; ++c) {
+                Chunk& chunk = chunks[c];
+                const char* cursor = chunk.begin;
+                const char* p = nullptr;
+                const char* lineEnd = nullptr;
+                while (NextLine(cursor, chunk.end, p, lineEnd)) {
+                    const std::string_view id = NextToken(p, lineEnd);
+                    if (id == "v") {
+                        chunk.positions.push_back(ReadPosition(p, lineEnd));
+                    } else if (id == "vt") {
+                        chunk.texcoords.push_back(ReadTexcoord(p, lineEnd));
+                    } else if (id == "vn") {
+                        chunk.normals.push_back(ReadNormal(p, lineEnd));
+                    }
+                }
+            }
+        }, maxThreads);
+
+        // 3. 各塊の先頭までの個数を数え、1つの配列にまとめる
+        size_t positionCount = 0, texcoordCount = 0, normalCount = 0;
+        for (Chunk& chunk : chunks) {
+            chunk.positionOffset = positionCount;
+            chunk.texcoordOffset = texcoordCount;
+            chunk.normalOffset = normalCount;
+            positionCount += chunk.positions.size();
+            texcoordCount += chunk.texcoords.size();
+            normalCount += chunk.normals.size();
+        }
+        std::vector<Vector4> positions(positionCount);
+        std::vector<Vector2> texcoords(texcoordCount);
+        std::vector<Vector3> normals(normalCount);
+        ParallelFor(jobSystem, chunks.size(), 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t c = begin; c < end; ++c) {
+                Chunk& chunk = chunks[c];
+                std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionOffset);
+                std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), texcoords.begin() + chunk.texcoordOffset);
+                std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalOffset);
+                chunk.positions = {};
+                chunk.texcoords = {};
+                chunk.normals = {};
+            }
+        }, maxThreads);
+
+        // 4. 塊ごとに面を読み、塊の中だけで重複を除く
+        ParallelFor(jobSystem, chunks.size(), 1, [&](size_t begin, size_t end, size_t) {
+            ObjMeshIndexer indexer;
+            std::vector<FaceCorner> corners;
+            std::vector<uint32_t> cornerVertices;
+            std::vector<Vector4> polygon;
+            std::vector<uint32_t> triangles;
+            for (size_t c = begin; c < end; ++c) {
+                Chunk& chunk = chunks[c];
+                indexer.Clear();
+                chunk.segments.emplace_back();
+                // その行の時点での個数(負の添字に使う)
+                size_t localPositionCount = chunk.positionOffset;
+                size_t localTexcoordCount = chunk.texcoordOffset;
+                size_t localNormalCount = chunk.normalOffset;
+
+                const char* cursor = chunk.begin;
+                const char* p = nullptr;
+                const char* lineEnd = nullptr;
+                while (NextLine(cursor, chunk.end, p, lineEnd)) {
+                    const std::string_view id = NextToken(p, lineEnd);
+                    if (id == "v") {
+                        ++localPositionCount;
+                    } else if (id == "vt") {
+                        ++localTexcoordCount;
+                    } else if (id == "vn") {
+                        ++localNormalCount;
+                    } else if (id == "f") {
+                        ReadFace(p, lineEnd, localPositionCount, localTexcoordCount, localNormalCount, corners);
+                        if (corners.size() < 3) {
+                            continue;
+                        }
+                        ChunkSegment& segment = chunk.segments.back();
+                        cornerVertices.clear();
+                        for (const FaceCorner& corner : corners) {
+                            cornerVertices.push_back(indexer.GetOrAdd(corner, segment.corners));
+                        }
+                        TriangulateFace(corners, positions, polygon, triangles);
+                        // 三角形の回り順は逆にしている
+                        for (size_t t = 0; t + 2 < triangles.size(); t += 3) {
+                            segment.indices.push_back(cornerVertices[triangles[t + 2]]);
+                            segment.indices.push_back(cornerVertices[triangles[t + 1]]);
+                            segment.indices.push_back(cornerVertices[triangles[t]]);
+                        }
+                    } else if (id == "usemtl" || id == "mtllib") {
+                        // 面の後に来たら区間を分ける
+                        if (!chunk.segments.back().indices.empty()) {
+                            chunk.segments.emplace_back();
+                            indexer.Clear();
+                        }
+                        chunk.segments.back().events.emplace_back(id == "mtllib", std::string(NextToken(p, lineEnd)));
+                    }
+                }
+            }
+        }, maxThreads);
+
+        // 5. ファイルの順に区間をたどり、メッシュ単位で重複を除いて添字の付け替え表を作る
+        ObjModel objModel;
+        MaterialTableBuilder materialTable(objModel.materials, directoryPath);
+        ObjMesh currentMesh;
+        size_t currentIndexCount = 0;
+        ObjMeshIndexer indexer;
+        std::vector<ChunkSegment*> segments;
+        auto finishMesh = [&]() {
+            currentMesh.indices.resize(currentIndexCount);
+            objModel.meshes.push_back(std::move(currentMesh));
+            currentMesh = ObjMesh();
+            currentIndexCount = 0;
+            indexer.Clear();
+        };
+        for (Chunk& chunk : chunks) {
+            for (ChunkSegment& segment : chunk.segments) {
+                for (const auto& [isLibrary, name] : segment.events) {
+                    if (isLibrary) {
+                        materialTable.AddLibrary(name);
+                        continue;
+                    }
+                    if (currentIndexCount > 0) {
+                        finishMesh();
+                    }
+                    currentMesh.materialIndex = materialTable.Use(name);
+                }
+                if (segment.indices.empty()) {
+                    continue;
+                }
+                segment.meshIndex = objModel.meshes.size();
+                segment.indexOffset = currentIndexCount;
+                currentIndexCount += segment.indices.size();
+                segment.remap.resize(segment.corners.size());
+                for (size_t i = 0; i < segment.corners.size(); ++i) {
+                    const FaceCorner& corner = segment.corners[i];
+                    segment.remap[i] = indexer.GetOrAdd(corner.position, corner.texcoord, corner.normal, positions, texcoords, normals, currentMesh);
+                }
+                segments.push_back(&segment);
+            }
+        }
+        if (currentIndexCount > 0) {
+            finishMesh();
+        }
+
+        // 6. 添字を付け替えて書き込む(区間ごとに書く場所が分かれているので並列にできる)
+        ParallelFor(jobSystem, segments.size(), 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t s = begin; s < end; ++s) {
+                const ChunkSegment& segment = *segments[s];
+                uint32_t* out = objModel.meshes[segment.meshIndex].indices.data() + segment.indexOffset;
+                for (size_t i = 0; i < segment.indices.size(); ++i) {
+                    out[i] = segment.remap[segment.indices[i]];
+                }
+            }
+        }, maxThreads);
+
+        ParallelFor(jobSystem, objModel.meshes.size(), 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t m = begin; m < end; ++m) {
+                MeshBounds::Compute(objModel.meshes[m]);
+            }
+        }, maxThreads);
+
+        return objModel;
+    }
+
+    void TriangulatePolygon(const Vector4* points, size_t count, std::vector<uint32_t>& triangles) {
+        triangles.clear();
+        if (count < 3) {
+            return;
+        }
+        if (count == 3) {
+            triangles.assign({ 0, 1, 2 });
+            return;
+        }
+
+        // Newell法で面の法線を求め、一番大きい軸を落として2次元にする
+        float nx = 0.0f, ny = 0.0f, nz = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            const Vector4& a = points[i];
+            const Vector4& b = points[(i + 1) % count];
+            nx += (a.y - b.y) * (a.z + b.z);
+            ny += (a.z - b.z) * (a.x + b.x);
+            nz += (a.x - b.x) * (a.y + b.y);
+        }
+        const float ax = std::fabs(nx), ay = std::fabs(ny), az = std::fabs(nz);
+
+        // 潰れている面は扇形にする
+        auto fan = [&](const std::vector<uint32_t>& order) {
+            for (size_t i = 1; i + 1 < order.size(); ++i) {
+                triangles.push_back(order[0]);
+                triangles.push_back(order[i]);
+                triangles.push_back(order[i + 1]);
+            }
+        };
+        std::vector<uint32_t> remaining(count);
+        for (size_t i = 0; i < count; ++i) {
+            remaining[i] = static_cast<uint32_t>(i);
+        }
+        if (ax + ay + az <= 0.0f) {
+            fan(remaining);
+            return;
+        }
+
+        std::vector<float> us(count), vs(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (az >= ax && az >= ay) {
+                us[i] = points[i].x; vs[i] = points[i].y;
+            } else if (ax >= ay) {
+                us[i] = points[i].y; vs[i] = points[i].z;
+            } else {
+                us[i] = points[i].z; vs[i] = points[i].x;
+            }
+        }
+        // 2次元での回り方向(凸の判定に使う)
+        float area = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            const size_t j = (i + 1) % count;
+            area += us[i] * vs[j] - us[j] * vs[i];
+        }
+        const float orientation = area >= 0.0f ? 1.0f : -1.0f;
+
+        // 耳を切り取っていく
+        while (remaining.size() > 3) {
+            const size_t size = remaining.size();
+            bool isClipped = false;
+            for (size_t i = 0; i < size; ++i) {
+                const uint32_t prev = remaining[(i + size - 1) % size];
+                const uint32_t cur = remaining[i];
+                const uint32_t next = remaining[(i + 1) % size];
+
+                // 凹んでいる頂点は耳にならない
+                if (Cross2(us[prev], vs[prev], us[cur], vs[cur], us[next], vs[next]) * orientation <= 0.0f) {
+                    continue;
+                }
+                // 他の頂点が三角形の中にあれば耳にならない
+                bool isEar = true;
+                for (uint32_t other : remaining) {
+                    if (other == prev || other == cur || other == next) {
+                        continue;
+                    }
+                    if (Cross2(us[prev], vs[prev], us[cur], vs[cur], us[other], vs[other]) * orientation >= 0.0f &&
+                        Cross2(us[cur], vs[cur], us[next], vs[next], us[other], vs[other]) * orientation >= 0.0f &&
+                        Cross2(us[next], vs[next], us[prev], vs[prev], us[other], vs[other]) * orientation >= 0.0f) {
+                        isEar = false;
+                        break;
+                    }
+                }
+                if (!isEar) {
+                    continue;
+                }
+
+                triangles.push_back(prev);
+                triangles.push_back(cur);
+                triangles.push_back(next);
+                remaining.erase(remaining.begin() + i);
+                isClipped = true;
+                break;
+            }
+            // 自己交差などで耳が見つからなければ残りを扇形にする
+            if (!isClipped) {
+                fan(remaining);
+                return;
+            }
+        }
+        fan(remaining);
+    }
+
+    void ParseFaceToken(std::string_view token, int& posIdx, int& uvIdx, int& normIdx) {
+        posIdx = uvIdx = normIdx = 0;
+
+        const size_t firstSlash = token.find('/');
+        if (firstSlash == std::string_view::npos) {
+            // 例: "1"
+            if (!token.empty()) posIdx = ToIndex(token);
+            return;
+        }
+        // 例: "1/2/3", "1//3", "1/2"
+        if (firstSlash > 0) posIdx = ToIndex(token.substr(0, firstSlash));
+        const size_t secondSlash = token.find('/', firstSlash + 1);
+        if (secondSlash != std::string_view::npos) {
+            if (secondSlash > firstSlash + 1) uvIdx = ToIndex(token.substr(firstSlash + 1, secondSlash - firstSlash - 1));
+            if (token.size() > secondSlash + 1) normIdx = ToIndex(token.substr(secondSlash + 1));
+        } else {
+            if (token.size() > firstSlash + 1) uvIdx = ToIndex(token.substr(firstSlash + 1));
+        }
+    }
+
+    bool IsSame(const ObjModel& a, const ObjModel& b) {
+        if (a.meshes.size() != b.meshes.size()) {
+            return false;
+        }
+        for (size_t m = 0; m < a.meshes.size(); ++m) {
+            const ObjMesh& meshA = a.meshes[m];
+            const ObjMesh& meshB = b.meshes[m];
+            // 添字の振り方が違っても、展開した三角形が同じなら同じとみなす(まず展開せずに比べる)
+            const bool isSameBuffer = meshA.indices == meshB.indices && IsSameBytes(meshA.vertices, meshB.vertices);
+            if (!isSameBuffer) {
+                const std::vector<VertexData> cornersA = ObjMeshIndexer::Expand(meshA);
+                const std::vector<VertexData> cornersB = ObjMeshIndexer::Expand(meshB);
+                if (!IsSameBytes(cornersA, cornersB)) {
+                    return false;
+                }
+            }
+            // 詳細度(解析しただけのものには無い)
+            if (meshA.lods.size() != meshB.lods.size()) {
+                return false;
+            }
+            for (size_t l = 0; l < meshA.lods.size(); ++l) {
+                if (meshA.lods[l].indices != meshB.lods[l].indices || meshA.lods[l].error != meshB.lods[l].error) {
+                    return false;
+                }
+            }
+            // 接線・塊(これも解析しただけのものには無い)
+            if (!IsSameBytes(meshA.tangents, meshB.tangents)) {
+                return false;
+            }
+            if (meshA.isClosed != meshB.isClosed || !IsSameBytes(meshA.meshlets, meshB.meshlets)) {
+                return false;
+            }
+            // マテリアルは表の番号ではなく中身で比べる
+            const ObjMaterial& matA = a.GetMaterial(meshA);
+            const ObjMaterial& matB = b.GetMaterial(meshB);
+            if (std::memcmp(&matA.color, &matB.color, sizeof(Vector4)) != 0 ||
+                std::memcmp(&matA.ambient, &matB.ambient, sizeof(Vector3)) != 0 ||
+                std::memcmp(&matA.specular, &matB.specular, sizeof(Vector3)) != 0 ||
+                std::memcmp(&matA.uvTransform, &matB.uvTransform, sizeof(Matrix4x4)) != 0 ||
+                matA.shininess != matB.shininess || matA.alpha != matB.alpha ||
+                matA.enableLighting != matB.enableLighting || matA.textureFilePath != matB.textureFilePath) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
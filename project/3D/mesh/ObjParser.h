@@ -0,0 +1,59 @@
+#pragma once
+
+#include "../../math/ObjModel.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+class JobSystem;
+
+/// <summary>
+/// objファイルの高速な読み込み
+/// ファイルを一括で読み、行や要素を文字列にコピーせずに std::from_chars で数値へ変換する
+/// 結果は LoadObjFileM と同じになる(同じ座標系変換・同じ三角形の並び)
+/// LoadObjFileM と違い、四角形以上の面は三角形に分割し、負の添字(末尾からの相対)も読める
+/// </summary>
+namespace ObjParser {
+
+    /// <summary>
+    /// ファイルを読み込む
+    /// </summary>
+    ObjModel LoadFile(const std::string& directoryPath, const std::string& filename);
+
+    /// <summary>
+    /// objのテキストを解析する(mtllibはdirectoryPathから、MaterialLibraryCacheを通して読む)
+    /// </summary>
+    ObjModel Parse(std::string_view text, const std::string& directoryPath);
+
+    // 並列読み込みで1つの塊にする大きさ(バイト)
+    static inline const size_t kChunkBytes = 1 << 20;
+
+    /// <summary>
+    /// ファイルを並列に読み込む
+    /// </summary>
+    ObjModel LoadFileParallel(const std::string& directoryPath, const std::string& filename, JobSystem* jobSystem, uint32_t maxThreads = 0);
+
+    /// <summary>
+    /// objのテキストを行の境目で塊に分け、並列に解析する(結果はParseと同じ)
+    /// 塊ごとに v/vt/vn と面を読み、usemtlの区切りと面の順を保ったまま添字を付け替えてまとめる
+    /// jobSystemがnullなら順に処理する
+    /// </summary>
+    ObjModel ParseParallel(std::string_view text, const std::string& directoryPath, JobSystem* jobSystem, uint32_t maxThreads = 0);
+
+    /// <summary>
+    /// 多角形を三角形に分割する(耳切り法。潰れた面や自己交差は扇形)
+    /// trianglesには3つ1組で元の頂点番号が入り、回り順は元の多角形と同じ
+    /// </summary>
+    void TriangulatePolygon(const Vector4* points, size_t count, std::vector<uint32_t>& triangles);
+
+    /// <summary>
+    /// f行の1要素("位置/UV/法線")を添字に分ける。無い要素は0、負の添字はそのまま返す
+    /// </summary>
+    void ParseFaceToken(std::string_view token, int& posIdx, int& uvIdx, int& normIdx);
+
+    /// <summary>
+    /// 2つのモデルが同じか(頂点はビット単位で比べる。詳細度も比べる。確認用)
+    /// </summary>
+    bool IsSame(const ObjModel& a, const ObjModel& b);
+}
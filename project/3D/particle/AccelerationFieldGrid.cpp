@@ -0,0 +1,223 @@
+#include "AccelerationFieldGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+uint64_t AccelerationFieldGrid::MakeKey(int32_t x, int32_t y, int32_t z) {
+    // 各軸21bitに詰める
+    const uint64_t mask = (1ull << 21) - 1;
+    return (static_cast<uint64_t>(x) & mask) | ((static_cast<uint64_t>(y) & mask) << 21) | ((static_cast<uint64_t>(z) & mask) << 42);
+}
+
+int32_t AccelerationFieldGrid::ToCell(float value) const {
+    // 整数にする前に浮動小数のまま寄せる(範囲外のキャストは未定義動作)
+    const float cell = std::floor(value / cellSize_);
+    if (!(cell > static_cast<float>(-kCellLimit_))) {
+        return -kCellLimit_;
+    }
+    if (!(cell < static_cast<float>(kCellLimit_))) {
+        return kCellLimit_;
+    }
+    return static_cast<int32_t>(cell);
+}
+
+bool AccelerationFieldGrid::ToCellRange(float minValue, float maxValue, int32_t& minCell, int32_t& maxCell) const {
+    const float minFloor = std::floor(minValue / cellSize_);
+    const float maxFloor = std::floor(maxValue / cellSize_);
+    // NaNはどちらの比較もfalseになるので表せない側に入る
+    if (!(static_cast<float>(-kCellLimit_) <= minFloor && maxFloor <= static_cast<float>(kCellLimit_))) {
+        return false;
+    }
+    minCell = static_cast<int32_t>(minFloor);
+    maxCell = static_cast<int32_t>(maxFloor);
+    return true;
+}
+
+void AccelerationFieldGrid::AddField(const AccelerationField& field) {
+    fields_.push_back(field);
+    isDirty_ = true;
+}
+
+void AccelerationFieldGrid::RemoveField(size_t index) {
+    if (index < fields_.size()) {
+        fields_.erase(fields_.begin() + index);
+        isDirty_ = true;
+    }
+}
+
+void AccelerationFieldGrid::Clear() {
+    fields_.clear();
+    isDirty_ = true;
+}
+
+void AccelerationFieldGrid::RebuildIfDirty() {
+    if (!isDirty_) {
+        return;
+    }
+    isDirty_ = false;
+
+    cells_.clear();
+    cellFieldIndices_.clear();
+    globalFieldIndices_.clear();
+
+    // 1. 場ごとに重なるセルへ登録する
+    std::unordered_map<uint64_t, std::vector<uint32_t>> lists;
+    for (uint32_t index = 0; index < static_cast<uint32_t>(fields_.size()); ++index) {
+        const AABB& area = fields_[index].area;
+        int32_t minX = 0, maxX = 0, minY = 0, maxY = 0, minZ = 0, maxZ = 0;
+        // セル座標で表せない(果てしなく広い・NaN)ものは、セル数を数える前に全体共通へ
+        if (!ToCellRange(area.min.x, area.max.x, minX, maxX) ||
+            !ToCellRange(area.min.y, area.max.y, minY, maxY) ||
+            !ToCellRange(area.min.z, area.max.z, minZ, maxZ)) {
+            globalFieldIndices_.push_back(index);
+            continue;
+        }
+        // 掛け算があふれないようdoubleで数える(範囲が逆転していれば0以下で、どのセルにも入らない)
+        const double cellCount = double(maxX - minX + 1) * double(maxY - minY + 1) * double(maxZ - minZ + 1);
+        if (cellCount > static_cast<double>(kMaxCellsPerField_)) {
+            globalFieldIndices_.push_back(index);
+            continue;
+        }
+        for (int32_t z = minZ; z <= maxZ; ++z) {
+            for (int32_t y = minY; y <= maxY; ++y) {
+                for (int32_t x = minX; x <= maxX; ++x) {
+                    lists[MakeKey(x, y, z)].push_back(index);
+                }
+            }
+        }
+    }
+
+    // 2. 全体共通の場も混ぜ、添字順に並べて連結する(評価順を総当たりと揃える)
+    cells_.reserve(lists.size());
+    for (auto& [key, indices] : lists) {
+        indices.insert(indices.end(), globalFieldIndices_.begin(), globalFieldIndices_.end());
+        std::sort(indices.begin(), indices.end());
+        CellRange range;
+        range.begin = static_cast<uint32_t>(cellFieldIndices_.size());
+        range.count = static_cast<uint32_t>(indices.size());
+        cellFieldIndices_.insert(cellFieldIndices_.end(), indices.begin(), indices.end());
+        cells_.emplace(key, range);
+    }
+}
+
+void AccelerationFieldGrid::Accumulate(const AccelerationField& field, float px, float py, float pz, float vx, float vy, float vz, float& ax, float& ay, float& az) {
+    const AABB& area = field.area;
+    if (!(area.min.x <= px && px <= area.max.x &&
+        area.min.y <= py && py <= area.max.y &&
+        area.min.z <= pz && pz <= area.max.z)) {
+        return;
+    }
+
+    switch (field.type) {
+    case AccelerationFieldType::kAccelerationFieldConstant:
+        ax += field.acceleration.x;
+        ay += field.acceleration.y;
+        az += field.acceleration.z;
+        break;
+
+    case AccelerationFieldType::kAccelerationFieldRadial: {
+        const float dx = px - field.center.x;
+        const float dy = py - field.center.y;
+        const float dz = pz - field.center.z;
+        const float length = std::sqrt(dx * dx + dy * dy + dz * dz);
+        if (length > 0.0f) {
+            const float scale = field.strength / length;
+            ax += dx * scale;
+            ay += dy * scale;
+            az += dz * scale;
+        }
+        break;
+    }
+
+    case AccelerationFieldType::kAccelerationFieldVortex: {
+        // 軸 × (中心からの位置) の向きに回す
+        const float dx = px - field.center.x;
+        const float dy = py - field.center.y;
+        const float dz = pz - field.center.z;
+        const float cx = field.axis.y * dz - field.axis.z * dy;
+        const float cy = field.axis.z * dx - field.axis.x * dz;
+        const float cz = field.axis.x * dy - field.axis.y * dx;
+        const float length = std::sqrt(cx * cx + cy * cy + cz * cz);
+        if (length > 0.0f) {
+            const float scale = field.strength / length;
+            ax += cx * scale;
+            ay += cy * scale;
+            az += cz * scale;
+        }
+        break;
+    }
+
+    case AccelerationFieldType::kAccelerationFieldDrag:
+        ax -= vx * field.strength;
+        ay -= vy * field.strength;
+        az -= vz * field.strength;
+        break;
+
+    default:
+        break;
+    }
+}
+
+void AccelerationFieldGrid::Apply(ParticleSoA& particles, size_t begin, size_t end, float deltaTime) const {
+    if (fields_.empty()) {
+        return;
+    }
+
+    // 隣り合うパーティクルは同じセルにいることが多いので、直前のセルを覚えておく
+    uint64_t lastKey = ~0ull;
+    const uint32_t* list = globalFieldIndices_.data();
+    size_t listCount = globalFieldIndices_.size();
+
+    end = (std::min)(end, particles.count);
+    for (size_t i = begin; i < end; ++i) {
+        const float px = particles.translateX[i];
+        const float py = particles.translateY[i];
+        const float pz = particles.translateZ[i];
+
+        const uint64_t key = MakeKey(ToCell(px), ToCell(py), ToCell(pz));
+        if (key != lastKey) {
+            lastKey = key;
+            auto it = cells_.find(key);
+            if (it != cells_.end()) {
+                list = cellFieldIndices_.data() + it->second.begin;
+                listCount = it->second.count;
+            } else {
+                list = globalFieldIndices_.data();
+                listCount = globalFieldIndices_.size();
+            }
+        }
+        if (listCount == 0) {
+            continue;
+        }
+
+        const float vx = particles.velocityX[i];
+        const float vy = particles.velocityY[i];
+        const float vz = particles.velocityZ[i];
+        float ax = 0.0f, ay = 0.0f, az = 0.0f;
+        for (size_t k = 0; k < listCount; ++k) {
+            Accumulate(fields_[list[k]], px, py, pz, vx, vy, vz, ax, ay, az);
+        }
+        particles.velocityX[i] = vx + ax * deltaTime;
+        particles.velocityY[i] = vy + ay * deltaTime;
+        particles.velocityZ[i] = vz + az * deltaTime;
+    }
+}
+
+void AccelerationFieldGrid::ApplyBruteForce(ParticleSoA& particles, size_t begin, size_t end, float deltaTime) const {
+    end = (std::min)(end, particles.count);
+    for (size_t i = begin; i < end; ++i) {
+        const float px = particles.translateX[i];
+        const float py = particles.translateY[i];
+        const float pz = particles.translateZ[i];
+        const float vx = particles.velocityX[i];
+        const float vy = particles.velocityY[i];
+        const float vz = particles.velocityZ[i];
+        float ax = 0.0f, ay = 0.0f, az = 0.0f;
+        for (const AccelerationField& field : fields_) {
+            Accumulate(field, px, py, pz, vx, vy, vz, ax, ay, az);
+        }
+        particles.velocityX[i] = vx + ax * deltaTime;
+        particles.velocityY[i] = vy + ay * deltaTime;
+        particles.velocityZ[i] = vz + az * deltaTime;
+    }
+}
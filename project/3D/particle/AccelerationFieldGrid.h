@@ -0,0 +1,105 @@
+#pragma once
+
+#include "ParticleSoA.h"
+#include "../../math/AccelerationField.h"
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// 複数の加速度場を一様グリッドで管理する
+/// セルごとに「範囲が重なっている場」の一覧を作っておき、
+/// パーティクルは自分のセルの一覧だけを評価する
+/// 一覧は場が変更されたときだけ作り直す(フレームをまたいで再利用する)
+/// </summary>
+class AccelerationFieldGrid {
+private: // メンバ変数
+
+    // セル1辺の長さ
+    float cellSize_ = 4.0f;
+
+    // 1つの場が覆ってよいセル数の上限(超えたものは全体共通の一覧に入れる)
+    static inline const size_t kMaxCellsPerField_ = 4096;
+
+    // セル座標の範囲(キーは各軸21bitなので±2^20未満)
+    static inline const int32_t kCellLimit_ = (1 << 20) - 1;
+
+    std::vector<AccelerationField> fields_;
+
+    // セル → cellFieldIndices_ の範囲
+    struct CellRange {
+        uint32_t begin = 0;
+        uint32_t count = 0;
+    };
+    std::unordered_map<uint64_t, CellRange> cells_;
+
+    // 各セルの場の添字を連結したもの
+    std::vector<uint32_t> cellFieldIndices_;
+
+    // どのセルにいても評価する場(範囲が広すぎるもの)
+    std::vector<uint32_t> globalFieldIndices_;
+
+    bool isDirty_ = true;
+
+private: // メンバ関数
+
+    // セル座標からキーを作る
+    static uint64_t MakeKey(int32_t x, int32_t y, int32_t z);
+
+    // 座標からセル座標へ(範囲外・NaNは端のセルに寄せる)
+    int32_t ToCell(float value) const;
+
+    // 範囲が覆うセル座標を求める(セル座標で表せない・NaNならfalse)
+    bool ToCellRange(float minValue, float maxValue, int32_t& minCell, int32_t& maxCell) const;
+
+    // 1つの場の加速度を足す
+    static void Accumulate(const AccelerationField& field, float px, float py, float pz, float vx, float vy, float vz, float& ax, float& ay, float& az);
+
+public: // メンバ関数
+
+    /// <summary>
+    /// 場を追加
+    /// </summary>
+    void AddField(const AccelerationField& field);
+
+    /// <summary>
+    /// 場を削除
+    /// </summary>
+    void RemoveField(size_t index);
+
+    /// <summary>
+    /// 全削除
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// 場を書き換えたら呼ぶ(次のRebuildIfDirtyで一覧を作り直す)
+    /// </summary>
+    void MarkDirty() { isDirty_ = true; }
+
+    /// <summary>
+    /// 変更があればセルごとの一覧を作り直す
+    /// </summary>
+    void RebuildIfDirty();
+
+    /// <summary>
+    /// [begin, end) の速度に場の加速度を加える(読み取りのみなので並列に呼んでよい)
+    /// </summary>
+    void Apply(ParticleSoA& particles, size_t begin, size_t end, float deltaTime) const;
+
+    /// <summary>
+    /// 全部の場を総当たりで評価する(比較用)
+    /// </summary>
+    void ApplyBruteForce(ParticleSoA& particles, size_t begin, size_t end, float deltaTime) const;
+
+    // ゲッター
+    std::vector<AccelerationField>& GetFields() { return fields_; }
+    const std::vector<AccelerationField>& GetFields() const { return fields_; }
+    size_t GetCellCount() const { return cells_.size(); }
+    size_t GetGlobalFieldCount() const { return globalFieldIndices_.size(); }
+    float GetCellSize() const { return cellSize_; }
+
+    // セッター
+    void SetCellSize(float cellSize) { cellSize_ = cellSize; isDirty_ = true; }
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+/// <summary>
+/// カウンタベースの乱数(Squares RNG)
+/// 内部状態を持たず「キー + 何番目か」から直接値を決めるので、
+/// どのスレッドがどの順で呼んでも同じカウンタには同じ値が返る
+/// </summary>
+namespace CounterRandom {
+
+    /// <summary>
+    /// 64bitの値をかき混ぜる(SplitMix64)。シードからキーを作るのに使う
+    /// </summary>
+    inline uint64_t Mix(uint64_t value) {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    /// <summary>
+    /// シードからキーを作る(Squaresのキーは奇数である必要がある)
+    /// </summary>
+    inline uint64_t MakeKey(uint64_t seed) {
+        return Mix(seed) | 1ull;
+    }
+
+    /// <summary>
+    /// counter番目の32bit乱数
+    /// </summary>
+    inline uint32_t Squares32(uint64_t counter, uint64_t key) {
+        uint64_t x = counter * key;
+        const uint64_t y = x;
+        const uint64_t z = y + key;
+        x = x * x + y; x = (x >> 32) | (x << 32);
+        x = x * x + z; x = (x >> 32) | (x << 32);
+        x = x * x + y; x = (x >> 32) | (x << 32);
+        return static_cast<uint32_t>((x * x + z) >> 32);
+    }
+
+    /// <summary>
+    /// [0, 1) の乱数(上位24bitを使う)
+    /// </summary>
+    inline float ToFloat01(uint32_t value) {
+        return static_cast<float>(value >> 8) * (1.0f / 16777216.0f);
+    }
+
+    /// <summary>
+    /// 1つの要素(パーティクル1個など)が使う乱数列
+    /// 要素ごとにkDimension_個のカウンタを割り当てる
+    /// </summary>
+    struct Stream {
+        // 1要素あたりに使える乱数の数
+        static inline const uint64_t kDimension_ = 16;
+
+        uint64_t key = 1;
+        uint64_t base = 0;
+        uint32_t dimension = 0;
+
+        Stream(uint64_t streamKey, uint64_t index) : key(streamKey), base(index * kDimension_) {}
+
+        uint32_t NextUint() { return Squares32(base + dimension++, key); }
+
+        float NextFloat() { return ToFloat01(NextUint()); }
+
+        float Range(float min, float max) { return min + (max - min) * NextFloat(); }
+    };
+}
@@ -0,0 +1,101 @@
+#include "ParticleBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace ParticleBenchmark {
+
+    ParticleSystem::View MakeView() {
+        // カメラのきまりに合わせた透視投影(左手系・行ベクトル)
+        static const float kFovY = 0.45f;
+        static const float kAspect = 16.0f / 9.0f;
+        static const float kNear = 0.1f;
+        static const float kFar = 100.0f;
+        static const float kDistance = 50.0f;
+
+        ParticleSystem::View view;
+        view.viewMatrix = {};
+        view.viewMatrix.m[0][0] = 1.0f;
+        view.viewMatrix.m[1][1] = 1.0f;
+        view.viewMatrix.m[2][2] = 1.0f;
+        view.viewMatrix.m[3][3] = 1.0f;
+        view.viewMatrix.m[3][2] = kDistance;
+
+        const float cot = 1.0f / std::tan(kFovY * 0.5f);
+        Matrix4x4 projection{};
+        projection.m[0][0] = cot / kAspect;
+        projection.m[1][1] = cot;
+        projection.m[2][2] = kFar / (kFar - kNear);
+        projection.m[2][3] = 1.0f;
+        projection.m[3][2] = -kNear * kFar / (kFar - kNear);
+
+        // ビュー行列は平行移動だけなので、掛けた結果は4行目だけが変わる
+        view.viewProjection = projection;
+        view.viewProjection.m[3][2] = kDistance * projection.m[2][2] + projection.m[3][2];
+        view.viewProjection.m[3][3] = kDistance;
+        view.viewportHeight = 720.0f;
+        return view;
+    }
+
+    Result Run(const Settings& settings, JobSystem* jobSystem) {
+        // 1. 固定シードで初期化する
+        ParticleSystem system;
+        system.SetJobSystem(jobSystem);
+        system.SetUseSimd(settings.useSimd);
+        system.GetEmitterManager().SetBaseSeed(settings.seed);
+        system.Initialize(settings.effectFilePath, settings.maxInstance);
+
+        const ParticleSystem::View view = MakeView();
+        std::vector<ParticleForGPU> instances(settings.maxInstance);
+
+        Result result;
+        result.frameCount = settings.frameCount;
+        result.frameChecksums.reserve(settings.recordFrameChecksums ? settings.frameCount : 0);
+
+        // 2. 指定フレーム数だけ回す
+        double totalMs = 0.0;
+        double spawnMs = 0.0;
+        double simulateMs = 0.0;
+        const uint64_t allocationStart = settings.allocationCounter ? settings.allocationCounter() : 0;
+        uint64_t warmupAllocationEnd = allocationStart;
+        for (uint32_t frame = 0; frame < settings.frameCount; ++frame) {
+            if (frame == settings.warmupFrameCount && settings.allocationCounter) {
+                warmupAllocationEnd = settings.allocationCounter();
+            }
+            const auto start = std::chrono::steady_clock::now();
+            result.lastDrawCount = system.Update(view, instances.data(), settings.maxInstance, true, settings.maxThreads);
+            const float frameMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            totalMs += frameMs;
+            spawnMs += system.GetSpawnTimeMs();
+            simulateMs += system.GetSimulateTimeMs();
+            result.maxFrameMs = (std::max)(result.maxFrameMs, frameMs);
+            result.spawnedCount += system.GetEmitterManager().GetLastSpawnCount();
+            result.peakAliveCount = (std::max)(result.peakAliveCount, system.GetParticles().count);
+            if (settings.recordFrameChecksums) {
+                result.frameChecksums.push_back(system.GetParticles().Checksum());
+            }
+        }
+        if (settings.allocationCounter) {
+            // チェックサム用の確保は先に済ませているので含まれない
+            const uint64_t allocationEnd = settings.allocationCounter();
+            if (settings.frameCount <= settings.warmupFrameCount) {
+                warmupAllocationEnd = allocationEnd;
+            }
+            result.warmupAllocationCount = warmupAllocationEnd - allocationStart;
+            result.allocationCount = allocationEnd - warmupAllocationEnd;
+        }
+
+        // 3. まとめる
+        if (settings.frameCount > 0) {
+            result.averageFrameMs = static_cast<float>(totalMs / settings.frameCount);
+            result.averageSpawnMs = static_cast<float>(spawnMs / settings.frameCount);
+            result.averageSimulateMs = static_cast<float>(simulateMs / settings.frameCount);
+            result.spawnPerSecond = static_cast<float>(result.spawnedCount) / (settings.frameCount * ParticleSystem::kDeltaTime_);
+        }
+        result.memoryBytes = system.GetMemoryBytes();
+        result.checksum = system.GetParticles().Checksum();
+        return result;
+    }
+}
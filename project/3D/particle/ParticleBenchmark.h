@@ -0,0 +1,73 @@
+#pragma once
+
+#include "ParticleSystem.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+// 前方宣言
+class JobSystem;
+
+/// <summary>
+/// デバイスなしでParticleSystemを固定シード・固定フレーム数で回す計測
+/// 最後の状態のチェックサムを比べれば、最適化で挙動が変わっていないかを確かめられる
+/// </summary>
+namespace ParticleBenchmark {
+
+    struct Settings {
+        // エフェクト定義ファイル(空なら既定のエミッタ)
+        std::string effectFilePath;
+        // 計測するフレーム数
+        uint32_t frameCount = 600;
+        // エミッタのシードの元
+        uint64_t seed = 12345;
+        // 書き込むインスタンス数の上限(初期化時の確保数も兼ねる)
+        uint32_t maxInstance = 100000;
+        // 使うスレッド数(0なら全スレッド)
+        uint32_t maxThreads = 0;
+        // SIMD版を使うか
+        bool useSimd = true;
+        // フレームごとのチェックサムを残すか(どのフレームでずれたかを調べる用。計測時間には含めない)
+        bool recordFrameChecksums = false;
+        // これまでのヒープ確保回数を返す関数(なければ確保回数は数えない)
+        std::function<uint64_t()> allocationCounter;
+        // 作業用バッファが育ち切るまでのフレーム数(この間の確保は別に数える)
+        uint32_t warmupFrameCount = 120;
+    };
+
+    struct Result {
+        uint32_t frameCount = 0;
+        // 1フレームあたりの更新時間(ms)
+        float averageFrameMs = 0.0f;
+        float maxFrameMs = 0.0f;
+        // 内訳の平均(ms)
+        float averageSpawnMs = 0.0f;
+        float averageSimulateMs = 0.0f;
+        // 発生させた数と、シミュレーション時間1秒あたりの発生数
+        uint64_t spawnedCount = 0;
+        float spawnPerSecond = 0.0f;
+        // 最大生存数と最後の描画数
+        size_t peakAliveCount = 0;
+        size_t lastDrawCount = 0;
+        // ウォームアップ後のフレーム中のヒープ確保回数と、ウォームアップ中の回数(allocationCounterがあるときだけ)
+        uint64_t allocationCount = 0;
+        uint64_t warmupAllocationCount = 0;
+        // 作業用バッファを含めた確保量(バイト)
+        size_t memoryBytes = 0;
+        // 最後の状態のチェックサム
+        uint64_t checksum = 0;
+        std::vector<uint64_t> frameChecksums;
+    };
+
+    /// <summary>
+    /// 固定のカメラ(原点から-50の位置で+Zを向く)
+    /// </summary>
+    ParticleSystem::View MakeView();
+
+    /// <summary>
+    /// 計測する
+    /// </summary>
+    Result Run(const Settings& settings, JobSystem* jobSystem);
+}
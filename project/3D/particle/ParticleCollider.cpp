@@ -0,0 +1,233 @@
+#include "ParticleCollider.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define PARTICLE_COLLIDER_X64
+#include <immintrin.h>
+#endif
+
+namespace {
+
+    // 長さ0で割らないための下限
+    const float kMinLength = 1.0e-6f;
+
+    struct Response {
+        bool kill;
+        float keep;        // 1 - 摩擦
+        float restitution; // 反発係数
+    };
+
+    // 1パーティクル分の反応。nは外向きの法線、penetrationは負ならめり込み量。SIMD版と同じ順序で計算する
+    inline void RespondOne(ParticleSoA& p, size_t i, float nx, float ny, float nz, float penetration, const Response& response) {
+        if (!(penetration < 0.0f)) {
+            return;
+        }
+        if (response.kill) {
+            // 次のRemoveDeadで取り除かれる。このフレームも描かない
+            p.currentTime[i] = p.lifeTime[i];
+            p.alpha[i] = 0.0f;
+            return;
+        }
+        // 面の外へ押し戻す
+        p.translateX[i] = p.translateX[i] - nx * penetration;
+        p.translateY[i] = p.translateY[i] - ny * penetration;
+        p.translateZ[i] = p.translateZ[i] - nz * penetration;
+        // 面に向かう速度なら、法線成分を反転・接線成分を減衰
+        const float vx = p.velocityX[i];
+        const float vy = p.velocityY[i];
+        const float vz = p.velocityZ[i];
+        const float vn = vx * nx + vy * ny + vz * nz;
+        if (vn < 0.0f) {
+            const float bounce = vn * response.restitution;
+            p.velocityX[i] = (vx - nx * vn) * response.keep - nx * bounce;
+            p.velocityY[i] = (vy - ny * vn) * response.keep - ny * bounce;
+            p.velocityZ[i] = (vz - nz * vn) * response.keep - nz * bounce;
+        }
+    }
+
+    inline void CollidePlaneOne(ParticleSoA& p, size_t i, const Plane& plane, const Response& response) {
+        const float penetration = plane.normal.x * p.translateX[i] + plane.normal.y * p.translateY[i] + plane.normal.z * p.translateZ[i] - plane.distance;
+        RespondOne(p, i, plane.normal.x, plane.normal.y, plane.normal.z, penetration, response);
+    }
+
+    inline void CollideSphereOne(ParticleSoA& p, size_t i, const Sphere& sphere, const Response& response) {
+        const float dx = p.translateX[i] - sphere.center.x;
+        const float dy = p.translateY[i] - sphere.center.y;
+        const float dz = p.translateZ[i] - sphere.center.z;
+        const float distanceSq = dx * dx + dy * dy + dz * dz;
+        if (!(distanceSq < sphere.radius * sphere.radius)) {
+            return;
+        }
+        const float length = std::sqrt(distanceSq);
+        const float inv = 1.0f / (std::max)(length, kMinLength);
+        RespondOne(p, i, dx * inv, dy * inv, dz * inv, length - sphere.radius, response);
+    }
+
+    // 高さ格子はセルの参照先がパーティクルごとにばらばらなので、SIMD版でもスカラーで処理する
+    inline void CollideHeightFieldOne(ParticleSoA& p, size_t i, const HeightField& heightField, const Response& response) {
+        float height;
+        Vector3 normal;
+        if (!heightField.Sample(p.translateX[i], p.translateZ[i], height, normal)) {
+            return;
+        }
+        RespondOne(p, i, normal.x, normal.y, normal.z, (p.translateY[i] - height) * normal.y, response);
+    }
+
+#ifdef PARTICLE_COLLIDER_X64
+
+    // maskが立っているレーンはa、それ以外はb
+    inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    struct Lanes {
+        __m128 px, py, pz;
+        __m128 vx, vy, vz;
+        __m128 t;
+        __m128 life;
+        __m128 alpha;
+    };
+
+    inline void RespondSSE(Lanes& l, __m128 nx, __m128 ny, __m128 nz, __m128 penetration, __m128 hit, const Response& response) {
+        hit = _mm_and_ps(hit, _mm_cmplt_ps(penetration, _mm_setzero_ps()));
+        if (_mm_movemask_ps(hit) == 0) {
+            return;
+        }
+        if (response.kill) {
+            l.t = Select(hit, l.life, l.t);
+            l.alpha = _mm_andnot_ps(hit, l.alpha);
+            return;
+        }
+        l.px = Select(hit, _mm_sub_ps(l.px, _mm_mul_ps(nx, penetration)), l.px);
+        l.py = Select(hit, _mm_sub_ps(l.py, _mm_mul_ps(ny, penetration)), l.py);
+        l.pz = Select(hit, _mm_sub_ps(l.pz, _mm_mul_ps(nz, penetration)), l.pz);
+
+        const __m128 vn = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l.vx, nx), _mm_mul_ps(l.vy, ny)), _mm_mul_ps(l.vz, nz));
+        const __m128 approaching = _mm_and_ps(hit, _mm_cmplt_ps(vn, _mm_setzero_ps()));
+        const __m128 keep = _mm_set1_ps(response.keep);
+        const __m128 bounce = _mm_mul_ps(vn, _mm_set1_ps(response.restitution));
+        l.vx = Select(approaching, _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(l.vx, _mm_mul_ps(nx, vn)), keep), _mm_mul_ps(nx, bounce)), l.vx);
+        l.vy = Select(approaching, _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(l.vy, _mm_mul_ps(ny, vn)), keep), _mm_mul_ps(ny, bounce)), l.vy);
+        l.vz = Select(approaching, _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(l.vz, _mm_mul_ps(nz, vn)), keep), _mm_mul_ps(nz, bounce)), l.vz);
+    }
+
+    void CollideSSE(ParticleSoA& p, size_t begin, size_t end, const std::vector<Plane>& planes, const std::vector<Sphere>& spheres, const Response& response) {
+        const __m128 minLength = _mm_set1_ps(kMinLength);
+        const __m128 one = _mm_set1_ps(1.0f);
+        for (size_t i = begin; i < end; i += 4) {
+            Lanes l;
+            l.px = _mm_loadu_ps(&p.translateX[i]);
+            l.py = _mm_loadu_ps(&p.translateY[i]);
+            l.pz = _mm_loadu_ps(&p.translateZ[i]);
+            l.vx = _mm_loadu_ps(&p.velocityX[i]);
+            l.vy = _mm_loadu_ps(&p.velocityY[i]);
+            l.vz = _mm_loadu_ps(&p.velocityZ[i]);
+            l.t = _mm_loadu_ps(&p.currentTime[i]);
+            l.life = _mm_loadu_ps(&p.lifeTime[i]);
+            l.alpha = _mm_loadu_ps(&p.alpha[i]);
+
+            for (const Plane& plane : planes) {
+                const __m128 nx = _mm_set1_ps(plane.normal.x);
+                const __m128 ny = _mm_set1_ps(plane.normal.y);
+                const __m128 nz = _mm_set1_ps(plane.normal.z);
+                __m128 penetration = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, l.px), _mm_mul_ps(ny, l.py)), _mm_mul_ps(nz, l.pz));
+                penetration = _mm_sub_ps(penetration, _mm_set1_ps(plane.distance));
+                RespondSSE(l, nx, ny, nz, penetration, _mm_castsi128_ps(_mm_set1_epi32(-1)), response);
+            }
+
+            for (const Sphere& sphere : spheres) {
+                const __m128 dx = _mm_sub_ps(l.px, _mm_set1_ps(sphere.center.x));
+                const __m128 dy = _mm_sub_ps(l.py, _mm_set1_ps(sphere.center.y));
+                const __m128 dz = _mm_sub_ps(l.pz, _mm_set1_ps(sphere.center.z));
+                const __m128 distanceSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                const __m128 hit = _mm_cmplt_ps(distanceSq, _mm_set1_ps(sphere.radius * sphere.radius));
+                if (_mm_movemask_ps(hit) == 0) {
+                    continue;
+                }
+                const __m128 length = _mm_sqrt_ps(distanceSq);
+                const __m128 inv = _mm_div_ps(one, _mm_max_ps(length, minLength));
+                RespondSSE(l, _mm_mul_ps(dx, inv), _mm_mul_ps(dy, inv), _mm_mul_ps(dz, inv), _mm_sub_ps(length, _mm_set1_ps(sphere.radius)), hit, response);
+            }
+
+            _mm_storeu_ps(&p.translateX[i], l.px);
+            _mm_storeu_ps(&p.translateY[i], l.py);
+            _mm_storeu_ps(&p.translateZ[i], l.pz);
+            _mm_storeu_ps(&p.velocityX[i], l.vx);
+            _mm_storeu_ps(&p.velocityY[i], l.vy);
+            _mm_storeu_ps(&p.velocityZ[i], l.vz);
+            _mm_storeu_ps(&p.currentTime[i], l.t);
+            _mm_storeu_ps(&p.alpha[i], l.alpha);
+        }
+    }
+
+#endif // PARTICLE_COLLIDER_X64
+}
+
+bool HeightField::Sample(float x, float z, float& height, Vector3& normal) const {
+    if (width < 2 || depth < 2) {
+        return false;
+    }
+    const float gx = (x - origin.x) / cellSize;
+    const float gz = (z - origin.z) / cellSize;
+    if (!(0.0f <= gx && gx < static_cast<float>(width - 1) && 0.0f <= gz && gz < static_cast<float>(depth - 1))) {
+        return false;
+    }
+    const uint32_t ix = static_cast<uint32_t>(gx);
+    const uint32_t iz = static_cast<uint32_t>(gz);
+    const float fx = gx - static_cast<float>(ix);
+    const float fz = gz - static_cast<float>(iz);
+    const float h00 = heights[iz * width + ix];
+    const float h10 = heights[iz * width + ix + 1];
+    const float h01 = heights[(iz + 1) * width + ix];
+    const float h11 = heights[(iz + 1) * width + ix + 1];
+
+    height = origin.y + (h00 * (1.0f - fx) + h10 * fx) * (1.0f - fz) + (h01 * (1.0f - fx) + h11 * fx) * fz;
+
+    // 傾きから法線を求める
+    const float slopeX = ((h10 - h00) * (1.0f - fz) + (h11 - h01) * fz) / cellSize;
+    const float slopeZ = ((h01 - h00) * (1.0f - fx) + (h11 - h10) * fx) / cellSize;
+    const float inv = 1.0f / std::sqrt(slopeX * slopeX + 1.0f + slopeZ * slopeZ);
+    normal = { -slopeX * inv, inv, -slopeZ * inv };
+    return true;
+}
+
+void ParticleCollider::Collide(ParticleSoA& particles, size_t begin, size_t end) const {
+    const Response response{ response_ == CollisionResponse::kCollisionResponseKill, 1.0f - friction_, restitution_ };
+    size_t i = begin;
+#ifdef PARTICLE_COLLIDER_X64
+    const size_t sseEnd = begin + (end - begin) / 4 * 4;
+    CollideSSE(particles, i, sseEnd, planes_, spheres_, response);
+    i = sseEnd;
+#endif
+    // 端数はスカラーで処理
+    for (; i < end; ++i) {
+        for (const Plane& plane : planes_) {
+            CollidePlaneOne(particles, i, plane, response);
+        }
+        for (const Sphere& sphere : spheres_) {
+            CollideSphereOne(particles, i, sphere, response);
+        }
+    }
+    if (heightField_) {
+        for (size_t index = begin; index < end; ++index) {
+            CollideHeightFieldOne(particles, index, *heightField_, response);
+        }
+    }
+}
+
+void ParticleCollider::CollideScalar(ParticleSoA& particles, size_t begin, size_t end) const {
+    const Response response{ response_ == CollisionResponse::kCollisionResponseKill, 1.0f - friction_, restitution_ };
+    for (size_t i = begin; i < end; ++i) {
+        for (const Plane& plane : planes_) {
+            CollidePlaneOne(particles, i, plane, response);
+        }
+        for (const Sphere& sphere : spheres_) {
+            CollideSphereOne(particles, i, sphere, response);
+        }
+        if (heightField_) {
+            CollideHeightFieldOne(particles, i, *heightField_, response);
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ParticleSoA.h"
+#include "../../math/shape/Plane.h"
+#include "../../math/shape/Sphere.h"
+#include "../../math/Vector3.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// 衝突したときの反応
+enum class CollisionResponse {
+    kCollisionResponseBounce, //!< 跳ね返る(反発係数と摩擦を適用)
+    kCollisionResponseKill,   //!< その場で寿命を終える
+    kCountOfCollisionResponse,
+};
+
+/// <summary>
+/// 格子状の高さ(地形の簡易表現)。x-z平面上にwidth × depth個の高さを持つ
+/// </summary>
+struct HeightField {
+    //!< 格子の(0, 0)の位置(yは高さの基準)
+    Vector3 origin{ 0.0f,0.0f,0.0f };
+    //!< 格子の間隔
+    float cellSize = 1.0f;
+    //!< 格子点の数
+    uint32_t width = 0;
+    uint32_t depth = 0;
+    //!< 高さ(z * width + x)
+    std::vector<float> heights;
+
+    /// <summary>
+    /// (x, z)の高さを双線形補間で求める。範囲外ならfalse
+    /// </summary>
+    bool Sample(float x, float z, float& height, Vector3& normal) const;
+};
+
+/// <summary>
+/// パーティクルと平面・球・高さ格子の衝突をまとめて処理する
+/// 平面と球はSSEで4つずつ判定し、当たったレーンだけ位置と速度をマスクで差し替える
+/// </summary>
+class ParticleCollider {
+private: // メンバ変数
+
+    std::vector<Plane> planes_;
+
+    std::vector<Sphere> spheres_;
+
+    // 高さ格子(nullptrなら使わない)
+    const HeightField* heightField_ = nullptr;
+
+    CollisionResponse response_ = CollisionResponse::kCollisionResponseBounce;
+
+    // 反発係数(法線方向の速度に掛ける)
+    float restitution_ = 0.5f;
+
+    // 摩擦(接線方向の速度をこの割合だけ減らす)
+    float friction_ = 0.2f;
+
+public: // メンバ関数
+
+    /// <summary>
+    /// [begin, end) を衝突させる(SIMD版)。beginはレーン幅の倍数であること
+    /// </summary>
+    void Collide(ParticleSoA& particles, size_t begin, size_t end) const;
+
+    /// <summary>
+    /// [begin, end) を衝突させる(スカラー参照実装)
+    /// </summary>
+    void CollideScalar(ParticleSoA& particles, size_t begin, size_t end) const;
+
+    /// <summary>
+    /// 衝突させるものがあるか
+    /// </summary>
+    bool IsEmpty() const { return planes_.empty() && spheres_.empty() && !heightField_; }
+
+    // ゲッター
+    std::vector<Plane>& GetPlanes() { return planes_; }
+    std::vector<Sphere>& GetSpheres() { return spheres_; }
+    const HeightField* GetHeightField() const { return heightField_; }
+    CollisionResponse GetResponse() const { return response_; }
+    float GetRestitution() const { return restitution_; }
+    float GetFriction() const { return friction_; }
+
+    // セッター
+    void SetHeightField(const HeightField* heightField) { heightField_ = heightField; }
+    void SetResponse(CollisionResponse response) { response_ = response; }
+    void SetRestitution(float restitution) { restitution_ = restitution; }
+    void SetFriction(float friction) { friction_ = friction; }
+};
@@ -0,0 +1,380 @@
+#include "ParticleEffect.h"
+
+#include "ParticleEmitterManager.h"
+#include "ParticleCollider.h"
+#include "ParticleKernel.h"
+
+#include <fstream>
+#include <sstream>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+#pragma region ノイズ
+
+    inline uint32_t Hash(int32_t x, int32_t y, int32_t z) {
+        uint32_t h = static_cast<uint32_t>(x) * 0x8DA6B343u ^ static_cast<uint32_t>(y) * 0xD8163841u ^ static_cast<uint32_t>(z) * 0xCB1AB31Fu;
+        h ^= h >> 13;
+        h *= 0x5BD1E995u;
+        return h ^ (h >> 15);
+    }
+
+    // 格子点の値(-1～1)
+    inline float Lattice(int32_t x, int32_t y, int32_t z) {
+        return static_cast<float>(Hash(x, y, z) >> 8) * (2.0f / 16777216.0f) - 1.0f;
+    }
+
+    inline float Smooth(float t) {
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    // 3次元のバリューノイズ(-1～1)
+    inline float ValueNoise(float x, float y, float z) {
+        const float fx = std::floor(x), fy = std::floor(y), fz = std::floor(z);
+        const int32_t ix = static_cast<int32_t>(fx), iy = static_cast<int32_t>(fy), iz = static_cast<int32_t>(fz);
+        const float tx = Smooth(x - fx), ty = Smooth(y - fy), tz = Smooth(z - fz);
+        auto lerp = [](float a, float b, float t) { return a + (b - a) * t; };
+        const float x00 = lerp(Lattice(ix, iy, iz), Lattice(ix + 1, iy, iz), tx);
+        const float x10 = lerp(Lattice(ix, iy + 1, iz), Lattice(ix + 1, iy + 1, iz), tx);
+        const float x01 = lerp(Lattice(ix, iy, iz + 1), Lattice(ix + 1, iy, iz + 1), tx);
+        const float x11 = lerp(Lattice(ix, iy + 1, iz + 1), Lattice(ix + 1, iy + 1, iz + 1), tx);
+        return lerp(lerp(x00, x10, ty), lerp(x01, x11, ty), tz);
+    }
+
+#pragma endregion
+
+#pragma region ループ
+
+    // updateモジュールをまとめた1回のループ
+    template <bool kHasDrag, bool kHasNoise>
+    void UpdateLoop(const ParticleEffect& effect, ParticleSoA& p, size_t begin, size_t end, float deltaTime) {
+        const Vector3& acceleration = effect.GetAcceleration();
+        const float ax = acceleration.x * deltaTime;
+        const float ay = acceleration.y * deltaTime;
+        const float az = acceleration.z * deltaTime;
+        // 陰的に解いておくと係数が大きくても発散しない
+        const float dragFactor = 1.0f / (1.0f + effect.GetDragCoefficient() * deltaTime);
+        const float noiseScale = effect.GetNoiseStrength() * deltaTime;
+        const float frequency = effect.GetNoiseFrequency();
+        const float time = effect.GetTime();
+
+        float* vx = p.velocityX.data();
+        float* vy = p.velocityY.data();
+        float* vz = p.velocityZ.data();
+        const float* px = p.translateX.data();
+        const float* py = p.translateY.data();
+        const float* pz = p.translateZ.data();
+        for (size_t i = begin; i < end; ++i) {
+            float x = vx[i] + ax;
+            float y = vy[i] + ay;
+            float z = vz[i] + az;
+            if constexpr (kHasDrag) {
+                x *= dragFactor;
+                y *= dragFactor;
+                z *= dragFactor;
+            }
+            if constexpr (kHasNoise) {
+                // 成分ごとにずらした位置で引く
+                const float sx = px[i] * frequency, sy = py[i] * frequency, sz = pz[i] * frequency;
+                x += ValueNoise(sx + time, sy, sz) * noiseScale;
+                y += ValueNoise(sx, sy + time + 31.7f, sz) * noiseScale;
+                z += ValueNoise(sx, sy, sz + time + 67.3f) * noiseScale;
+            }
+            vx[i] = x;
+            vy[i] = y;
+            vz[i] = z;
+        }
+    }
+
+    // 0～1にクランプして8bitに量子化
+    inline uint32_t ToByte(float value) {
+        value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+        return static_cast<uint32_t>(value * 255.0f + 0.5f);
+    }
+
+    // renderモジュールを適用しながら詰める1回のループ
+    template <bool kHasColor, bool kHasSize>
+    void PackLoop(const ParticleEffect& effect, const ParticleSoA& p, const uint32_t* indices, size_t begin, size_t end, ParticleForGPU* dst) {
+        for (size_t k = begin; k < end; ++k) {
+            const size_t i = indices ? indices[k] : k;
+            const float age = p.currentTime[i] / p.lifeTime[i];
+            float r = p.colorR[i], g = p.colorG[i], b = p.colorB[i], a = p.alpha[i];
+            float sx = p.scaleX[i], sy = p.scaleY[i];
+            if constexpr (kHasColor) {
+                // 寿命によるalphaの代わりにカーブの色を掛ける
+                const Vector4& color = effect.SampleColor(age);
+                r *= color.x;
+                g *= color.y;
+                b *= color.z;
+                a = color.w;
+            }
+            if constexpr (kHasSize) {
+                const float size = effect.SampleSize(age);
+                sx *= size;
+                sy *= size;
+            }
+            ParticleForGPU& instance = dst[k - begin];
+            instance.translate = { p.translateX[i], p.translateY[i], p.translateZ[i] };
+            instance.color = ToByte(r) | (ToByte(g) << 8) | (ToByte(b) << 16) | (ToByte(a) << 24);
+            instance.scale = { sx, sy };
+            instance.rotate = p.rotateZ[i];
+            instance.padding = 0.0f;
+        }
+    }
+
+    const ParticleEffect::UpdateFunction kUpdateFunctions[2][2] = {
+        { UpdateLoop<false, false>, UpdateLoop<false, true> },
+        { UpdateLoop<true, false>, UpdateLoop<true, true> },
+    };
+
+    const ParticleEffect::PackFunction kPackFunctions[2][2] = {
+        { nullptr, PackLoop<false, true> },
+        { PackLoop<true, false>, PackLoop<true, true> },
+    };
+
+#pragma endregion
+
+    // キー(t, 値...)の並びを区分線形で評価する
+    float EvaluateCurve(const std::vector<float>& keys, size_t stride, size_t component, float t) {
+        const size_t keyCount = keys.size() / stride;
+        if (keyCount == 0) {
+            return 1.0f;
+        }
+        if (t <= keys[0]) {
+            return keys[1 + component];
+        }
+        for (size_t k = 1; k < keyCount; ++k) {
+            const float t0 = keys[(k - 1) * stride];
+            const float t1 = keys[k * stride];
+            if (t <= t1) {
+                const float v0 = keys[(k - 1) * stride + 1 + component];
+                const float v1 = keys[k * stride + 1 + component];
+                const float rate = t1 > t0 ? (t - t0) / (t1 - t0) : 1.0f;
+                return v0 + (v1 - v0) * rate;
+            }
+        }
+        return keys[(keyCount - 1) * stride + 1 + component];
+    }
+
+    // キーをtの順に並べる
+    std::vector<float> SortKeys(const std::vector<float>& keys, size_t stride) {
+        std::vector<size_t> order(keys.size() / stride);
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return keys[a * stride] < keys[b * stride]; });
+        std::vector<float> sorted;
+        sorted.reserve(order.size() * stride);
+        for (size_t i : order) {
+            sorted.insert(sorted.end(), keys.begin() + i * stride, keys.begin() + (i + 1) * stride);
+        }
+        return sorted;
+    }
+}
+
+void ParticleEffect::LoadFromFile(const std::string& filePath, ParticleEmitterManager* emitters, ParticleCollider* collider) {
+    // 1. ファイルを開く
+    // 2. "emitter" ブロックはエミッタとして、"update"/"render" の行はモジュールとして、"collide" の行は衝突として読む
+    // 3. モジュールをまとめる
+
+    std::ifstream file(filePath);
+    assert(file.is_open()); //とりあえず開けなかったら止める
+
+    modules_.clear();
+
+    // カーブは同じ種類の行をキーとしてまとめる
+    auto findOrAdd = [&](ParticleModuleType type) -> ParticleModule& {
+        for (ParticleModule& module : modules_) {
+            if (module.type == type) {
+                return module;
+            }
+        }
+        ParticleModule module;
+        module.type = type;
+        modules_.push_back(module);
+        return modules_.back();
+    };
+
+    Emitter emitter{};
+    std::string emitterName;
+    bool hasEmitter = false;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::string identifier;
+        std::istringstream s(line);
+        s >> identifier;
+
+        // identifierに応じた処理
+        if (identifier.empty() || identifier[0] == '#') {
+            continue;
+        } else if (identifier == "effect") {
+            s >> name_;
+        } else if (identifier == "emitter") {
+            if (hasEmitter && emitters) {
+                emitters->AddEmitter(emitter, emitterName);
+            }
+            emitter = Emitter{};
+            emitterName.clear();
+            s >> emitterName;
+            hasEmitter = true;
+        } else if (identifier == "update" || identifier == "render") {
+            std::string moduleName;
+            s >> moduleName;
+            std::vector<float> values;
+            float value;
+            while (s >> value) {
+                values.push_back(value);
+            }
+            if (moduleName == "force") {
+                ParticleModule module;
+                module.type = ParticleModuleType::kParticleModuleForce;
+                module.values = values;
+                modules_.push_back(module);
+            } else if (moduleName == "drag") {
+                ParticleModule module;
+                module.type = ParticleModuleType::kParticleModuleDrag;
+                module.values = values;
+                modules_.push_back(module);
+            } else if (moduleName == "noise") {
+                ParticleModule module;
+                module.type = ParticleModuleType::kParticleModuleNoise;
+                module.values = values;
+                modules_.push_back(module);
+            } else if (moduleName == "color") {
+                std::vector<float>& keys = findOrAdd(ParticleModuleType::kParticleModuleColorOverLife).values;
+                keys.insert(keys.end(), values.begin(), values.end());
+            } else if (moduleName == "size") {
+                std::vector<float>& keys = findOrAdd(ParticleModuleType::kParticleModuleSizeOverLife).values;
+                keys.insert(keys.end(), values.begin(), values.end());
+            }
+        } else if (identifier == "collide") {
+            if (!collider) {
+                continue;
+            }
+            std::string kind;
+            s >> kind;
+            if (kind == "plane") {
+                Plane plane{};
+                s >> plane.normal.x >> plane.normal.y >> plane.normal.z >> plane.distance;
+                collider->GetPlanes().push_back(plane);
+            } else if (kind == "sphere") {
+                Sphere sphere{};
+                s >> sphere.center.x >> sphere.center.y >> sphere.center.z >> sphere.radius;
+                collider->GetSpheres().push_back(sphere);
+            } else if (kind == "response") {
+                std::string response;
+                s >> response;
+                collider->SetResponse(response == "kill" ? CollisionResponse::kCollisionResponseKill : CollisionResponse::kCollisionResponseBounce);
+            } else if (kind == "restitution") {
+                float restitution = collider->GetRestitution();
+                s >> restitution;
+                collider->SetRestitution(restitution);
+            } else if (kind == "friction") {
+                float friction = collider->GetFriction();
+                s >> friction;
+                collider->SetFriction(friction);
+            }
+        } else if (hasEmitter) {
+            ParticleEmitterManager::ParseEmitterLine(identifier, s, emitter);
+        }
+    }
+    if (hasEmitter && emitters) {
+        emitters->AddEmitter(emitter, emitterName);
+    }
+
+    Compile();
+}
+
+void ParticleEffect::AddModule(const ParticleModule& module) {
+    modules_.push_back(module);
+}
+
+void ParticleEffect::Compile() {
+    acceleration_ = { 0.0f,0.0f,0.0f };
+    dragCoefficient_ = 0.0f;
+    noiseStrength_ = 0.0f;
+    noiseFrequency_ = 1.0f;
+
+    bool hasForce = false;
+    bool hasDrag = false;
+    bool hasNoise = false;
+    bool hasColor = false;
+    bool hasSize = false;
+
+    // 1. 同じ種類のモジュールは1つの値にまとめる
+    for (const ParticleModule& module : modules_) {
+        if (!module.isEnabled) {
+            continue;
+        }
+        const std::vector<float>& v = module.values;
+        switch (module.type) {
+        case ParticleModuleType::kParticleModuleForce:
+            if (v.size() >= 3) {
+                acceleration_.x += v[0];
+                acceleration_.y += v[1];
+                acceleration_.z += v[2];
+                hasForce = true;
+            }
+            break;
+        case ParticleModuleType::kParticleModuleDrag:
+            if (!v.empty()) {
+                dragCoefficient_ += v[0];
+                hasDrag = true;
+            }
+            break;
+        case ParticleModuleType::kParticleModuleNoise:
+            if (!v.empty()) {
+                noiseStrength_ += v[0];
+                noiseFrequency_ = v.size() >= 2 ? v[1] : noiseFrequency_;
+                hasNoise = true;
+            }
+            break;
+        case ParticleModuleType::kParticleModuleColorOverLife:
+            if (v.size() >= 5) {
+                // 2. カーブはテーブルに焼き込む
+                const std::vector<float> keys = SortKeys(v, 5);
+                for (size_t i = 0; i < kCurveResolution_; ++i) {
+                    const float t = static_cast<float>(i) / static_cast<float>(kCurveResolution_ - 1);
+                    colorTable_[i] = { EvaluateCurve(keys, 5, 0, t), EvaluateCurve(keys, 5, 1, t), EvaluateCurve(keys, 5, 2, t), EvaluateCurve(keys, 5, 3, t) };
+                }
+                hasColor = true;
+            }
+            break;
+        case ParticleModuleType::kParticleModuleSizeOverLife:
+            if (v.size() >= 2) {
+                const std::vector<float> keys = SortKeys(v, 2);
+                for (size_t i = 0; i < kCurveResolution_; ++i) {
+                    sizeTable_[i] = EvaluateCurve(keys, 2, 0, static_cast<float>(i) / static_cast<float>(kCurveResolution_ - 1));
+                }
+                hasSize = true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    // 3. 有効な機能の組み合わせに合ったループを選ぶ
+    update_ = (hasForce || hasDrag || hasNoise) ? kUpdateFunctions[hasDrag][hasNoise] : nullptr;
+    pack_ = kPackFunctions[hasColor][hasSize];
+    passCount_ = (update_ ? 1u : 0u) + 1u;
+}
+
+void ParticleEffect::Update(ParticleSoA& particles, size_t begin, size_t end, float deltaTime) const {
+    end = (std::min)(end, particles.count);
+    if (update_ && begin < end) {
+        update_(*this, particles, begin, end, deltaTime);
+    }
+}
+
+void ParticleEffect::Pack(const ParticleSoA& particles, const uint32_t* indices, size_t begin, size_t end, ParticleForGPU* dst) const {
+    if (pack_) {
+        pack_(*this, particles, indices, begin, end, dst);
+    } else if (indices) {
+        ParticleKernel::PackInstancesIndexed(particles, indices, begin, end, dst);
+    } else {
+        ParticleKernel::PackInstances(particles, begin, end, dst);
+    }
+}
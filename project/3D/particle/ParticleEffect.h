@@ -0,0 +1,136 @@
+#pragma once
+
+#include "ParticleSoA.h"
+#include "../../math/Vector3.h"
+#include "../../math/Vector4.h"
+#include "../../math/shape/ParticleForGPU.h"
+#include <vector>
+#include <string>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+class ParticleEmitterManager;
+class ParticleCollider;
+
+// エフェクトを構成するモジュールの種類
+enum class ParticleModuleType {
+    kParticleModuleForce,        //!< update: 一定の加速度(x y z)
+    kParticleModuleDrag,         //!< update: 速度に比例した抵抗(係数)
+    kParticleModuleNoise,        //!< update: 位置と時間によるゆらぎ(強さ 周波数)
+    kParticleModuleColorOverLife, //!< render: 寿命に対する色(t r g b a のキー)
+    kParticleModuleSizeOverLife,  //!< render: 寿命に対する大きさ(t s のキー)
+    kCountOfParticleModuleType,
+};
+
+struct ParticleModule {
+    //!< 種類
+    ParticleModuleType type = ParticleModuleType::kParticleModuleForce;
+    //!< 値(種類ごとに意味が異なる。カーブはキーを並べたもの)
+    std::vector<float> values;
+    //!< 有効か
+    bool isEnabled = true;
+};
+
+/// <summary>
+/// spawn/update/renderのモジュールで記述したパーティクルエフェクト
+/// 読み込み後にCompileで、力はまとめて1つの加速度に、抵抗は1つの係数に、
+/// カーブはテーブルに焼き込み、更新は1回・書き込みは1回のループにまとめる
+/// ループは有効な機能の組み合わせごとのテンプレートを選ぶので、パーティクルごとの分岐や仮想呼び出しはない
+/// </summary>
+class ParticleEffect {
+public:
+
+    // カーブを焼き込むテーブルの分割数
+    static inline const size_t kCurveResolution_ = 128;
+
+    // 更新ループ
+    using UpdateFunction = void (*)(const ParticleEffect& effect, ParticleSoA& particles, size_t begin, size_t end, float deltaTime);
+
+    // 書き込みループ(indicesがnullptrならbegin番目から順に)
+    using PackFunction = void (*)(const ParticleEffect& effect, const ParticleSoA& particles, const uint32_t* indices, size_t begin, size_t end, ParticleForGPU* dst);
+
+private: // メンバ変数
+
+    std::string name_;
+
+    std::vector<ParticleModule> modules_;
+
+    // 経過時間(ノイズ用)
+    float time_ = 0.0f;
+
+#pragma region Compileでまとめた値
+
+    Vector3 acceleration_{ 0.0f,0.0f,0.0f };
+    float dragCoefficient_ = 0.0f;
+    float noiseStrength_ = 0.0f;
+    float noiseFrequency_ = 1.0f;
+
+    std::array<Vector4, kCurveResolution_> colorTable_{};
+    std::array<float, kCurveResolution_> sizeTable_{};
+
+    UpdateFunction update_ = nullptr;
+    PackFunction pack_ = nullptr;
+
+    // まとめた後のループ数(デバッグ表示用)
+    uint32_t passCount_ = 0;
+
+#pragma endregion
+
+public: // メンバ関数
+
+    /// <summary>
+    /// ファイルから読み込む。エミッタの定義はemittersに、衝突させるもの(collideの行)はcolliderに追加する
+    /// </summary>
+    void LoadFromFile(const std::string& filePath, ParticleEmitterManager* emitters, ParticleCollider* collider = nullptr);
+
+    /// <summary>
+    /// モジュールを追加
+    /// </summary>
+    void AddModule(const ParticleModule& module);
+
+    /// <summary>
+    /// 有効なモジュールをまとめてループを選び直す(モジュールを変更したら呼ぶ)
+    /// </summary>
+    void Compile();
+
+    /// <summary>
+    /// [begin, end) にupdateモジュールを適用する(チャンクごとに並列に呼んでよい)
+    /// </summary>
+    void Update(ParticleSoA& particles, size_t begin, size_t end, float deltaTime) const;
+
+    /// <summary>
+    /// フレームの経過時間を進める
+    /// </summary>
+    void AdvanceTime(float deltaTime) { time_ += deltaTime; }
+
+    /// <summary>
+    /// renderモジュールを適用しながらGPU用のインスタンスに詰める(dst[0]がbegin番目に対応)
+    /// </summary>
+    void Pack(const ParticleSoA& particles, const uint32_t* indices, size_t begin, size_t end, ParticleForGPU* dst) const;
+
+    /// <summary>
+    /// updateモジュールがあるか
+    /// </summary>
+    bool HasUpdate() const { return update_ != nullptr; }
+
+    // ゲッター
+    const std::string& GetName() const { return name_; }
+    std::vector<ParticleModule>& GetModules() { return modules_; }
+    uint32_t GetPassCount() const { return passCount_; }
+    const Vector3& GetAcceleration() const { return acceleration_; }
+    float GetDragCoefficient() const { return dragCoefficient_; }
+    float GetNoiseStrength() const { return noiseStrength_; }
+    float GetNoiseFrequency() const { return noiseFrequency_; }
+    float GetTime() const { return time_; }
+    const Vector4& SampleColor(float age) const { return colorTable_[ToTableIndex(age)]; }
+    float SampleSize(float age) const { return sizeTable_[ToTableIndex(age)]; }
+
+    /// <summary>
+    /// 寿命の割合(0～1)からテーブルの添字へ
+    /// </summary>
+    static size_t ToTableIndex(float age) {
+        age = age < 0.0f ? 0.0f : (age > 1.0f ? 1.0f : age);
+        return static_cast<size_t>(age * static_cast<float>(kCurveResolution_ - 1) + 0.5f);
+    }
+};
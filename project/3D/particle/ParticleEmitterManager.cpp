@@ -0,0 +1,194 @@
+#include "ParticleEmitterManager.h"
+
+#include "CounterRandom.h"
+#include "ParticleUpdater.h"
+#include "../../engine/JobSystem.h"
+
+#include <algorithm>
+#include <sstream>
+#include <cmath>
+#include <numbers>
+
+uint32_t ParticleEmitterManager::AddEmitter(const Emitter& emitter, const std::string& name) {
+    const uint32_t index = static_cast<uint32_t>(emitters_.size());
+    emitters_.push_back(emitter);
+    if (emitters_.back().seed == 0) {
+        emitters_.back().seed = CounterRandom::Mix(baseSeed_ + index);
+    }
+    names_.push_back(name.empty() ? "emitter" + std::to_string(index) : name);
+    pendingBursts_.push_back(emitter.burstCount);
+    return index;
+}
+
+void ParticleEmitterManager::RemoveEmitter(uint32_t index) {
+    if (index < emitters_.size()) {
+        emitters_.erase(emitters_.begin() + index);
+        names_.erase(names_.begin() + index);
+        pendingBursts_.erase(pendingBursts_.begin() + index);
+    }
+}
+
+void ParticleEmitterManager::Clear() {
+    emitters_.clear();
+    names_.clear();
+    pendingBursts_.clear();
+}
+
+bool ParticleEmitterManager::ParseEmitterLine(const std::string& identifier, std::istringstream& s, Emitter& emitter) {
+    if (identifier == "shape") {
+        std::string shape;
+        s >> shape;
+        if (shape == "point") {
+            emitter.shape = EmitterShape::kEmitterShapePoint;
+        } else if (shape == "box") {
+            emitter.shape = EmitterShape::kEmitterShapeBox;
+        } else if (shape == "sphere") {
+            emitter.shape = EmitterShape::kEmitterShapeSphere;
+        }
+    } else if (identifier == "translate") {
+        s >> emitter.transform.translate.x >> emitter.transform.translate.y >> emitter.transform.translate.z;
+    } else if (identifier == "shapeSize") {
+        s >> emitter.shapeSize.x >> emitter.shapeSize.y >> emitter.shapeSize.z;
+    } else if (identifier == "count") {
+        s >> emitter.count;
+    } else if (identifier == "frequency") {
+        s >> emitter.frequency;
+    } else if (identifier == "burst") {
+        s >> emitter.burstCount;
+    } else if (identifier == "lifeTime") {
+        s >> emitter.lifeTimeMin >> emitter.lifeTimeMax;
+    } else if (identifier == "velocityMin") {
+        s >> emitter.velocityMin.x >> emitter.velocityMin.y >> emitter.velocityMin.z;
+    } else if (identifier == "velocityMax") {
+        s >> emitter.velocityMax.x >> emitter.velocityMax.y >> emitter.velocityMax.z;
+    } else if (identifier == "colorMin") {
+        s >> emitter.colorMin.x >> emitter.colorMin.y >> emitter.colorMin.z >> emitter.colorMin.w;
+    } else if (identifier == "colorMax") {
+        s >> emitter.colorMax.x >> emitter.colorMax.y >> emitter.colorMax.z >> emitter.colorMax.w;
+    } else if (identifier == "seed") {
+        s >> emitter.seed;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void ParticleEmitterManager::Burst(uint32_t index, uint32_t count) {
+    if (index < pendingBursts_.size()) {
+        pendingBursts_[index] += count;
+    }
+}
+
+void ParticleEmitterManager::Reset() {
+    for (size_t index = 0; index < emitters_.size(); ++index) {
+        emitters_[index].spawnedCount = 0;
+        emitters_[index].frequencyTime = 0.0f;
+        pendingBursts_[index] = emitters_[index].burstCount;
+    }
+}
+
+void ParticleEmitterManager::Update(float deltaTime, bool advance, ParticleSoA& particles, JobSystem* jobSystem, uint32_t maxThreads) {
+
+    // 1. エミッタごとの発生数を決める(ここは軽いので直列)
+    spawnRanges_.clear();
+    size_t total = 0;
+    for (uint32_t index = 0; index < static_cast<uint32_t>(emitters_.size()); ++index) {
+        Emitter& emitter = emitters_[index];
+        size_t spawnCount = pendingBursts_[index];
+        pendingBursts_[index] = 0;
+
+        if (advance && emitter.isActive) {
+            emitter.frequencyTime += deltaTime; // 時刻を進める
+            while (0.0f < emitter.frequency && emitter.frequency <= emitter.frequencyTime) { // 頻度より大きいなら発生
+                spawnCount += emitter.count;
+                emitter.frequencyTime -= emitter.frequency; // 余計に過ぎた時間も加味して頻度計算する
+            }
+        }
+        if (spawnCount == 0) {
+            continue;
+        }
+
+        SpawnRange range;
+        range.emitterIndex = index;
+        range.firstIndex = emitter.spawnedCount;
+        range.dstBegin = total;
+        range.count = spawnCount;
+        spawnRanges_.push_back(range);
+
+        emitter.spawnedCount += spawnCount;
+        total += spawnCount;
+    }
+    lastSpawnCount_ = total;
+    if (total == 0) {
+        return;
+    }
+
+    // 2. 末尾を広げ、新規分をチャンクに分けて並列に書き込む
+    const size_t offset = particles.count;
+    particles.Resize(offset + total);
+    ParallelFor(jobSystem, total, ParticleUpdater::kChunkSize_, [&](size_t begin, size_t end, size_t) {
+        for (const SpawnRange& range : spawnRanges_) {
+            const size_t rangeBegin = (std::max)(begin, range.dstBegin);
+            const size_t rangeEnd = (std::min)(end, range.dstBegin + range.count);
+            const Emitter& emitter = emitters_[range.emitterIndex];
+            for (size_t i = rangeBegin; i < rangeEnd; ++i) {
+                particles.Set(offset + i, MakeParticle(emitter, range.firstIndex + (i - range.dstBegin)));
+            }
+        }
+    }, maxThreads);
+}
+
+Particle ParticleEmitterManager::MakeParticle(const Emitter& emitter, uint64_t particleIndex) {
+    CounterRandom::Stream random(CounterRandom::MakeKey(emitter.seed), particleIndex);
+
+    // 発生位置(乱数の使い方は形によらず同じ数にしておく)
+    const float u = random.NextFloat();
+    const float v = random.NextFloat();
+    const float w = random.NextFloat();
+    Vector3 offset{ 0.0f,0.0f,0.0f };
+    switch (emitter.shape) {
+    case EmitterShape::kEmitterShapeBox:
+        offset = { (u * 2.0f - 1.0f) * emitter.shapeSize.x, (v * 2.0f - 1.0f) * emitter.shapeSize.y, (w * 2.0f - 1.0f) * emitter.shapeSize.z };
+        break;
+    case EmitterShape::kEmitterShapeSphere: {
+        // 球の中に一様に
+        const float cosTheta = u * 2.0f - 1.0f;
+        const float sinTheta = std::sqrt((std::max)(0.0f, 1.0f - cosTheta * cosTheta));
+        const float phi = v * 2.0f * std::numbers::pi_v<float>;
+        const float radius = emitter.shapeSize.x * std::cbrt(w);
+        offset = { radius * sinTheta * std::cos(phi), radius * cosTheta, radius * sinTheta * std::sin(phi) };
+        break;
+    }
+    default:
+        break;
+    }
+
+    Particle particle;
+    particle.transform.scale = { 1.0f,1.0f,1.0f };
+    particle.transform.rotate = { 0.0f,0.0f,0.0f };
+    particle.transform.translate = {
+        emitter.transform.translate.x + offset.x,
+        emitter.transform.translate.y + offset.y,
+        emitter.transform.translate.z + offset.z };
+    particle.velocity = {
+        random.Range(emitter.velocityMin.x, emitter.velocityMax.x),
+        random.Range(emitter.velocityMin.y, emitter.velocityMax.y),
+        random.Range(emitter.velocityMin.z, emitter.velocityMax.z) };
+    particle.color = {
+        random.Range(emitter.colorMin.x, emitter.colorMax.x),
+        random.Range(emitter.colorMin.y, emitter.colorMax.y),
+        random.Range(emitter.colorMin.z, emitter.colorMax.z),
+        random.Range(emitter.colorMin.w, emitter.colorMax.w) };
+    particle.lifeTime = random.Range(emitter.lifeTimeMin, emitter.lifeTimeMax);
+    particle.currentTime = 0.0f;
+
+    return particle;
+}
+
+void ParticleEmitterManager::Spawn(const Emitter& emitter, uint64_t firstIndex, size_t count, ParticleSoA& particles, size_t dstBegin, JobSystem* jobSystem, uint32_t maxThreads) {
+    ParallelFor(jobSystem, count, ParticleUpdater::kChunkSize_, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            particles.Set(dstBegin + i, MakeParticle(emitter, firstIndex + i));
+        }
+    }, maxThreads);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "ParticleSoA.h"
+#include "../../math/Emitter.h"
+#include "../../math/shape/Particle.h"
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cstdint>
+#include <cstddef>
+
+class JobSystem;
+
+/// <summary>
+/// 複数のエミッタをまとめて動かし、発生したパーティクルを並列に書き込む
+/// 乱数はカウンタベースなので、エミッタeのk番目のパーティクルはスレッド数によらず同じ値になる
+/// </summary>
+class ParticleEmitterManager {
+private: // メンバ変数
+
+    // シードを指定しなかったときの基準値
+    static inline const uint64_t kDefaultSeed_ = 0x2545F4914F6CDD1Dull;
+
+    uint64_t baseSeed_ = kDefaultSeed_;
+
+    std::vector<Emitter> emitters_;
+
+    std::vector<std::string> names_;
+
+    // 次のUpdateで追加で発生させる数
+    std::vector<uint32_t> pendingBursts_;
+
+    // 1フレーム分の発生要求
+    struct SpawnRange {
+        uint32_t emitterIndex = 0;
+        uint64_t firstIndex = 0; // エミッタ内で何番目から
+        size_t dstBegin = 0;     // 書き込み先(新規分の先頭からの位置)
+        size_t count = 0;
+    };
+    std::vector<SpawnRange> spawnRanges_;
+
+    // 直前のUpdateで発生させた数
+    size_t lastSpawnCount_ = 0;
+
+public: // メンバ関数
+
+    /// <summary>
+    /// エミッタを追加(seedが0なら基準シードと登録順から決める)
+    /// </summary>
+    /// <returns>エミッタ番号</returns>
+    uint32_t AddEmitter(const Emitter& emitter, const std::string& name = "");
+
+    /// <summary>
+    /// エミッタを削除
+    /// </summary>
+    void RemoveEmitter(uint32_t index);
+
+    /// <summary>
+    /// 全削除
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// エミッタ定義の1行を読む(ParticleEffect::LoadFromFileから使う)
+    /// </summary>
+    /// <returns>エミッタの項目だったか</returns>
+    static bool ParseEmitterLine(const std::string& identifier, std::istringstream& s, Emitter& emitter);
+
+    /// <summary>
+    /// 次のUpdateでcount個を追加で発生させる
+    /// </summary>
+    void Burst(uint32_t index, uint32_t count);
+
+    /// <summary>
+    /// 発生数のカウンタと時刻を巻き戻し、最初と同じ乱数列からやり直す
+    /// </summary>
+    void Reset();
+
+    /// <summary>
+    /// 時間を進めて発生させ、particlesの末尾に追加する
+    /// </summary>
+    /// <param name="advance">falseなら時間は進めずBurst分だけ発生させる</param>
+    void Update(float deltaTime, bool advance, ParticleSoA& particles, JobSystem* jobSystem, uint32_t maxThreads = 0);
+
+    /// <summary>
+    /// emitterのparticleIndex番目のパーティクルを作る
+    /// </summary>
+    static Particle MakeParticle(const Emitter& emitter, uint64_t particleIndex);
+
+    /// <summary>
+    /// emitterのfirstIndex番目からcount個をparticlesのdstBegin番目から並列に書き込む(Resize済みであること)
+    /// </summary>
+    static void Spawn(const Emitter& emitter, uint64_t firstIndex, size_t count, ParticleSoA& particles, size_t dstBegin, JobSystem* jobSystem, uint32_t maxThreads = 0);
+
+    // ゲッター
+    std::vector<Emitter>& GetEmitters() { return emitters_; }
+    const std::string& GetName(uint32_t index) const { return names_[index]; }
+    uint64_t GetBaseSeed() const { return baseSeed_; }
+    size_t GetLastSpawnCount() const { return lastSpawnCount_; }
+
+    // セッター
+    void SetBaseSeed(uint64_t seed) { baseSeed_ = seed; }
+};
@@ -0,0 +1,351 @@
+#include "ParticleKernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define PARTICLE_KERNEL_X64
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVCは/arch指定なしでもAVX2の組み込み関数を使える(実行時に分岐する)
+#define PARTICLE_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define PARTICLE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+#pragma region スカラー
+
+    // 1パーティクル分の積分。SIMD版と同じ順序・同じ演算で計算する
+    inline void IntegrateOne(ParticleSoA& p, size_t i, const ParticleKernel::IntegrateParams& params) {
+        const float dt = params.deltaTime;
+        if (params.advance) {
+            p.currentTime[i] += dt;
+            p.translateX[i] += p.velocityX[i] * dt;
+            p.translateY[i] += p.velocityY[i] * dt;
+            p.translateZ[i] += p.velocityZ[i] * dt;
+        }
+        p.alpha[i] = 1.0f - p.currentTime[i] / p.lifeTime[i];
+    }
+
+    // 0～1にクランプして8bitに量子化
+    inline uint32_t ToByte(float value) {
+        value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+        return static_cast<uint32_t>(value * 255.0f + 0.5f);
+    }
+
+    // 1パーティクル分をGPU用のインスタンスに詰める
+    inline void PackOne(const ParticleSoA& p, size_t i, ParticleForGPU& instance) {
+        instance.translate = { p.translateX[i], p.translateY[i], p.translateZ[i] };
+        instance.color = ToByte(p.colorR[i]) | (ToByte(p.colorG[i]) << 8) | (ToByte(p.colorB[i]) << 16) | (ToByte(p.alpha[i]) << 24);
+        instance.scale = { p.scaleX[i], p.scaleY[i] };
+        instance.rotate = p.rotateZ[i];
+        instance.padding = 0.0f;
+    }
+
+    // 1パーティクル分のカリング。0:視錐台の外 1:小さすぎる 2:見える
+    inline int CullOne(const ParticleSoA& p, size_t i, const ParticleKernel::CullParams& params) {
+        const float x = p.translateX[i];
+        const float y = p.translateY[i];
+        const float z = p.translateZ[i];
+        const float radius = (std::max)(std::fabs(p.scaleX[i]), std::fabs(p.scaleY[i])) * ParticleKernel::kQuadRadius_;
+        for (const float* plane : params.planes) {
+            if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < -radius) {
+                return 0;
+            }
+        }
+        const float w = params.w[0] * x + params.w[1] * y + params.w[2] * z + params.w[3];
+        return radius * params.pixelScale < params.minPixelSize * w ? 1 : 2;
+    }
+
+#pragma endregion
+
+#ifdef PARTICLE_KERNEL_X64
+
+#pragma region SSE(4レーン)
+
+    void IntegrateSSE(ParticleSoA& p, size_t begin, size_t end, const ParticleKernel::IntegrateParams& params) {
+        const __m128 dt = _mm_set1_ps(params.deltaTime);
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        for (size_t i = begin; i < end; i += 4) {
+            __m128 px = _mm_loadu_ps(&p.translateX[i]);
+            __m128 py = _mm_loadu_ps(&p.translateY[i]);
+            __m128 pz = _mm_loadu_ps(&p.translateZ[i]);
+            __m128 vx = _mm_loadu_ps(&p.velocityX[i]);
+            __m128 vy = _mm_loadu_ps(&p.velocityY[i]);
+            __m128 vz = _mm_loadu_ps(&p.velocityZ[i]);
+            __m128 t = _mm_loadu_ps(&p.currentTime[i]);
+            const __m128 life = _mm_loadu_ps(&p.lifeTime[i]);
+
+            if (params.advance) {
+                t = _mm_add_ps(t, dt);
+                px = _mm_add_ps(px, _mm_mul_ps(vx, dt));
+                py = _mm_add_ps(py, _mm_mul_ps(vy, dt));
+                pz = _mm_add_ps(pz, _mm_mul_ps(vz, dt));
+            }
+
+            _mm_storeu_ps(&p.translateX[i], px);
+            _mm_storeu_ps(&p.translateY[i], py);
+            _mm_storeu_ps(&p.translateZ[i], pz);
+            _mm_storeu_ps(&p.velocityX[i], vx);
+            _mm_storeu_ps(&p.velocityY[i], vy);
+            _mm_storeu_ps(&p.velocityZ[i], vz);
+            _mm_storeu_ps(&p.currentTime[i], t);
+            _mm_storeu_ps(&p.alpha[i], _mm_sub_ps(one, _mm_div_ps(t, life)));
+        }
+    }
+
+    size_t CullSSE(const ParticleSoA& p, size_t begin, size_t end, const ParticleKernel::CullParams& params, uint32_t* visible, size_t& sizeCulled) {
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        const __m128 quadRadius = _mm_set1_ps(ParticleKernel::kQuadRadius_);
+        const __m128 pixelScale = _mm_set1_ps(params.pixelScale);
+        const __m128 minPixelSize = _mm_set1_ps(params.minPixelSize);
+
+        size_t count = 0;
+        for (size_t i = begin; i < end; i += 4) {
+            const __m128 x = _mm_loadu_ps(&p.translateX[i]);
+            const __m128 y = _mm_loadu_ps(&p.translateY[i]);
+            const __m128 z = _mm_loadu_ps(&p.translateZ[i]);
+            const __m128 radius = _mm_mul_ps(_mm_max_ps(_mm_and_ps(_mm_loadu_ps(&p.scaleX[i]), absMask), _mm_and_ps(_mm_loadu_ps(&p.scaleY[i]), absMask)), quadRadius);
+            const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), radius);
+
+            // 6平面すべての内側(半径分の余裕込み)にあるか
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (const float* plane : params.planes) {
+                __m128 distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[0]), x), _mm_mul_ps(_mm_set1_ps(plane[1]), y));
+                distance = _mm_add_ps(_mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane[2]), z)), _mm_set1_ps(plane[3]));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+            }
+
+            // 画面上の大きさ(radius * pixelScale / w)が閾値以上か
+            __m128 w = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(params.w[0]), x), _mm_mul_ps(_mm_set1_ps(params.w[1]), y));
+            w = _mm_add_ps(_mm_add_ps(w, _mm_mul_ps(_mm_set1_ps(params.w[2]), z)), _mm_set1_ps(params.w[3]));
+            const __m128 large = _mm_cmpge_ps(_mm_mul_ps(radius, pixelScale), _mm_mul_ps(minPixelSize, w));
+
+            const int insideMask = _mm_movemask_ps(inside);
+            const int visibleMask = _mm_movemask_ps(_mm_and_ps(inside, large));
+
+            // 分岐せずに見えるものの添字だけ詰める
+            for (int lane = 0; lane < 4; ++lane) {
+                visible[count] = static_cast<uint32_t>(i + lane);
+                count += (visibleMask >> lane) & 1;
+                sizeCulled += ((insideMask & ~visibleMask) >> lane) & 1;
+            }
+        }
+        return count;
+    }
+
+#pragma endregion
+
+#pragma region AVX2(8レーン)
+
+    PARTICLE_TARGET_AVX2
+    void IntegrateAVX2(ParticleSoA& p, size_t begin, size_t end, const ParticleKernel::IntegrateParams& params) {
+        const __m256 dt = _mm256_set1_ps(params.deltaTime);
+        const __m256 one = _mm256_set1_ps(1.0f);
+
+        for (size_t i = begin; i < end; i += 8) {
+            __m256 px = _mm256_loadu_ps(&p.translateX[i]);
+            __m256 py = _mm256_loadu_ps(&p.translateY[i]);
+            __m256 pz = _mm256_loadu_ps(&p.translateZ[i]);
+            __m256 vx = _mm256_loadu_ps(&p.velocityX[i]);
+            __m256 vy = _mm256_loadu_ps(&p.velocityY[i]);
+            __m256 vz = _mm256_loadu_ps(&p.velocityZ[i]);
+            __m256 t = _mm256_loadu_ps(&p.currentTime[i]);
+            const __m256 life = _mm256_loadu_ps(&p.lifeTime[i]);
+
+            if (params.advance) {
+                t = _mm256_add_ps(t, dt);
+                px = _mm256_add_ps(px, _mm256_mul_ps(vx, dt));
+                py = _mm256_add_ps(py, _mm256_mul_ps(vy, dt));
+                pz = _mm256_add_ps(pz, _mm256_mul_ps(vz, dt));
+            }
+
+            _mm256_storeu_ps(&p.translateX[i], px);
+            _mm256_storeu_ps(&p.translateY[i], py);
+            _mm256_storeu_ps(&p.translateZ[i], pz);
+            _mm256_storeu_ps(&p.velocityX[i], vx);
+            _mm256_storeu_ps(&p.velocityY[i], vy);
+            _mm256_storeu_ps(&p.velocityZ[i], vz);
+            _mm256_storeu_ps(&p.currentTime[i], t);
+            _mm256_storeu_ps(&p.alpha[i], _mm256_sub_ps(one, _mm256_div_ps(t, life)));
+        }
+    }
+
+#pragma endregion
+
+    bool DetectAvx2() {
+#if defined(_MSC_VER)
+        int info[4]{};
+        __cpuid(info, 0);
+        if (info[0] < 7) { return false; }
+        __cpuid(info, 1);
+        // OSXSAVE と AVX
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx) { return false; }
+        // OSがYMMレジスタを退避するか
+        if ((_xgetbv(0) & 0x6) != 0x6) { return false; }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+#endif // PARTICLE_KERNEL_X64
+}
+
+namespace ParticleKernel {
+
+    void Integrate(ParticleSoA& particles, size_t begin, size_t end, const IntegrateParams& params) {
+        size_t i = begin;
+#ifdef PARTICLE_KERNEL_X64
+        if (IsAvx2Supported()) {
+            const size_t simdEnd = begin + (end - begin) / 8 * 8;
+            IntegrateAVX2(particles, i, simdEnd, params);
+            i = simdEnd;
+        }
+        const size_t sseEnd = i + (end - i) / 4 * 4;
+        IntegrateSSE(particles, i, sseEnd, params);
+        i = sseEnd;
+#endif
+        // 端数はスカラーで処理
+        for (; i < end; ++i) {
+            IntegrateOne(particles, i, params);
+        }
+    }
+
+    void IntegrateScalar(ParticleSoA& particles, size_t begin, size_t end, const IntegrateParams& params) {
+        for (size_t i = begin; i < end; ++i) {
+            IntegrateOne(particles, i, params);
+        }
+    }
+
+    void PackInstances(const ParticleSoA& particles, size_t begin, size_t end, ParticleForGPU* dst) {
+        for (size_t i = begin; i < end; ++i) {
+            PackOne(particles, i, dst[i - begin]);
+        }
+    }
+
+    void PackInstancesIndexed(const ParticleSoA& particles, const uint32_t* indices, size_t begin, size_t end, ParticleForGPU* dst) {
+        for (size_t i = begin; i < end; ++i) {
+            PackOne(particles, indices[i], dst[i - begin]);
+        }
+    }
+
+    CullParams MakeCullParams(const Matrix4x4& viewProjection, float viewportHeight, float minPixelSize) {
+        // 行ベクトル × 行列なので、クリップ座標の各成分は列との内積になる
+        auto column = [&](int j, float out[4]) {
+            for (int i = 0; i < 4; ++i) {
+                out[i] = viewProjection.m[i][j];
+            }
+        };
+        float x[4], y[4], z[4], w[4];
+        column(0, x);
+        column(1, y);
+        column(2, z);
+        column(3, w);
+
+        CullParams params{};
+        for (int i = 0; i < 4; ++i) {
+            params.planes[0][i] = w[i] + x[i]; // 左
+            params.planes[1][i] = w[i] - x[i]; // 右
+            params.planes[2][i] = w[i] + y[i]; // 下
+            params.planes[3][i] = w[i] - y[i]; // 上
+            params.planes[4][i] = z[i];        // 近(D3Dはz >= 0)
+            params.planes[5][i] = w[i] - z[i]; // 遠
+            params.w[i] = w[i];
+        }
+        // 距離と半径を比べられるよう法線を正規化する
+        for (float* plane : params.planes) {
+            const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+            if (0.0f < length) {
+                for (int i = 0; i < 4; ++i) {
+                    plane[i] /= length;
+                }
+            }
+        }
+        // 投影後のyの拡大率 × 画面の半分の高さ = ビュー空間で1の大きさが何ピクセルか(w = 1のとき)
+        params.pixelScale = std::sqrt(y[0] * y[0] + y[1] * y[1] + y[2] * y[2]) * viewportHeight * 0.5f;
+        params.minPixelSize = minPixelSize;
+        return params;
+    }
+
+    bool IsBoundsVisible(const Vector3& min, const Vector3& max, const CullParams& params) {
+        // 各平面について、法線方向に最も進んだ頂点が外側なら全体が外側
+        for (const float* plane : params.planes) {
+            const float x = plane[0] >= 0.0f ? max.x : min.x;
+            const float y = plane[1] >= 0.0f ? max.y : min.y;
+            const float z = plane[2] >= 0.0f ? max.z : min.z;
+            if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t Cull(const ParticleSoA& particles, size_t begin, size_t end, const CullParams& params, uint32_t* visible, size_t& sizeCulled) {
+        size_t i = begin;
+        size_t count = 0;
+#ifdef PARTICLE_KERNEL_X64
+        const size_t sseEnd = begin + (end - begin) / 4 * 4;
+        count = CullSSE(particles, i, sseEnd, params, visible, sizeCulled);
+        i = sseEnd;
+#endif
+        // 端数はスカラーで処理
+        for (; i < end; ++i) {
+            const int result = CullOne(particles, i, params);
+            visible[count] = static_cast<uint32_t>(i);
+            count += result == 2;
+            sizeCulled += result == 1;
+        }
+        return count;
+    }
+
+    size_t CullScalar(const ParticleSoA& particles, size_t begin, size_t end, const CullParams& params, uint32_t* visible, size_t& sizeCulled) {
+        size_t count = 0;
+        for (size_t i = begin; i < end; ++i) {
+            const int result = CullOne(particles, i, params);
+            visible[count] = static_cast<uint32_t>(i);
+            count += result == 2;
+            sizeCulled += result == 1;
+        }
+        return count;
+    }
+
+    bool IsAvx2Supported() {
+#ifdef PARTICLE_KERNEL_X64
+        static const bool supported = DetectAvx2();
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+    float MaxDifference(const ParticleSoA& a, const ParticleSoA& b) {
+        if (a.count != b.count) {
+            return INFINITY;
+        }
+        float maxDiff = 0.0f;
+        auto compare = [&](const std::vector<float>& x, const std::vector<float>& y) {
+            for (size_t i = 0; i < a.count; ++i) {
+                maxDiff = (std::max)(maxDiff, std::fabs(x[i] - y[i]));
+            }
+        };
+        compare(a.translateX, b.translateX);
+        compare(a.translateY, b.translateY);
+        compare(a.translateZ, b.translateZ);
+        compare(a.velocityX, b.velocityX);
+        compare(a.velocityY, b.velocityY);
+        compare(a.velocityZ, b.velocityZ);
+        compare(a.alpha, b.alpha);
+        compare(a.currentTime, b.currentTime);
+        return maxDiff;
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "ParticleSoA.h"
+#include "../../math/shape/ParticleForGPU.h"
+#include "../../math/Matrix4x4.h"
+#include "../../math/Vector3.h"
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// パーティクルの積分処理(速度/位置の更新・寿命からのalpha計算)
+/// 加速度場はAccelerationFieldGridが積分の前に速度へ加える
+/// Integrate はAVX2(8レーン)/SSE(4レーン)で処理し、
+/// IntegrateScalar は同じ計算を1つずつ行う参照実装(結果の比較用)
+/// </summary>
+namespace ParticleKernel {
+
+    struct IntegrateParams {
+        // デルタタイム
+        float deltaTime = 1.0f / 60.0f;
+        // 時間と位置を進めるか(falseならalphaの計算のみ)
+        bool advance = true;
+    };
+
+    // 板ポリ(±0.5の四角形)をZ回転させても収まる半径 / 拡縮
+    inline constexpr float kQuadRadius_ = 0.70710678f;
+
+    struct CullParams {
+        // 視錐台の6平面(法線は内向き・正規化済み)
+        float planes[6][4];
+        // クリップ座標のwを求める係数(= ビュー空間の深度)
+        float w[4];
+        // ビュー空間で大きさ1・深度1のものが画面上で何ピクセルになるか
+        float pixelScale;
+        // これより小さく映るものは描かない(ピクセル)
+        float minPixelSize;
+    };
+
+    /// <summary>
+    /// [begin, end) を積分する(SIMD版)
+    /// beginはレーン幅の倍数であること。endはPaddedCount()まで指定してよい
+    /// </summary>
+    void Integrate(ParticleSoA& particles, size_t begin, size_t end, const IntegrateParams& params);
+
+    /// <summary>
+    /// [begin, end) を積分する(スカラー参照実装)
+    /// </summary>
+    void IntegrateScalar(ParticleSoA& particles, size_t begin, size_t end, const IntegrateParams& params);
+
+    /// <summary>
+    /// [begin, end) をGPU用のインスタンスへ詰める(dst[0]がbegin番目に対応)
+    /// </summary>
+    void PackInstances(const ParticleSoA& particles, size_t begin, size_t end, ParticleForGPU* dst);
+
+    /// <summary>
+    /// indices[begin～end) の順にGPU用のインスタンスへ詰める(dst[0]がindices[begin]番目に対応)
+    /// </summary>
+    void PackInstancesIndexed(const ParticleSoA& particles, const uint32_t* indices, size_t begin, size_t end, ParticleForGPU* dst);
+
+    /// <summary>
+    /// ViewProjection行列からカリング用の値を作る
+    /// </summary>
+    CullParams MakeCullParams(const Matrix4x4& viewProjection, float viewportHeight, float minPixelSize);
+
+    /// <summary>
+    /// AABBが視錐台と重なるか(まとめて捨てられるかの判定用)
+    /// </summary>
+    bool IsBoundsVisible(const Vector3& min, const Vector3& max, const CullParams& params);
+
+    /// <summary>
+    /// [begin, end) のうち見えるものの添字をvisibleに詰める(SIMD版)
+    /// visibleにはend - begin個分の領域が必要
+    /// </summary>
+    /// <param name="sizeCulled">小さすぎて捨てた数を加算する</param>
+    /// <returns>見える数</returns>
+    size_t Cull(const ParticleSoA& particles, size_t begin, size_t end, const CullParams& params, uint32_t* visible, size_t& sizeCulled);
+
+    /// <summary>
+    /// Cullのスカラー参照実装
+    /// </summary>
+    size_t CullScalar(const ParticleSoA& particles, size_t begin, size_t end, const CullParams& params, uint32_t* visible, size_t& sizeCulled);
+
+    /// <summary>
+    /// 実行環境でAVX2が使えるか
+    /// </summary>
+    bool IsAvx2Supported();
+
+    /// <summary>
+    /// 2つのパーティクル列の成分ごとの最大誤差(等価性の確認用)
+    /// </summary>
+    float MaxDifference(const ParticleSoA& a, const ParticleSoA& b);
+}
@@ -0,0 +1,139 @@
+#include "ParticleSoA.h"
+
+namespace {
+
+    // 全成分配列へのメンバポインタ(まとめて確保・詰め直しするため)
+    using FloatArray = std::vector<float> ParticleSoA::*;
+
+    const FloatArray kArrays[] = {
+        &ParticleSoA::translateX, &ParticleSoA::translateY, &ParticleSoA::translateZ,
+        &ParticleSoA::velocityX, &ParticleSoA::velocityY, &ParticleSoA::velocityZ,
+        &ParticleSoA::scaleX, &ParticleSoA::scaleY, &ParticleSoA::scaleZ,
+        &ParticleSoA::rotateX, &ParticleSoA::rotateY, &ParticleSoA::rotateZ,
+        &ParticleSoA::colorR, &ParticleSoA::colorG, &ParticleSoA::colorB, &ParticleSoA::alpha,
+        &ParticleSoA::lifeTime, &ParticleSoA::currentTime,
+    };
+}
+
+void ParticleSoA::PushBack(const Particle& particle) {
+    const size_t index = count++;
+    ResizeArrays(PaddedCount());
+    Set(index, particle);
+}
+
+void ParticleSoA::Set(size_t index, const Particle& particle) {
+    translateX[index] = particle.transform.translate.x;
+    translateY[index] = particle.transform.translate.y;
+    translateZ[index] = particle.transform.translate.z;
+    velocityX[index] = particle.velocity.x;
+    velocityY[index] = particle.velocity.y;
+    velocityZ[index] = particle.velocity.z;
+    scaleX[index] = particle.transform.scale.x;
+    scaleY[index] = particle.transform.scale.y;
+    scaleZ[index] = particle.transform.scale.z;
+    rotateX[index] = particle.transform.rotate.x;
+    rotateY[index] = particle.transform.rotate.y;
+    rotateZ[index] = particle.transform.rotate.z;
+    colorR[index] = particle.color.x;
+    colorG[index] = particle.color.y;
+    colorB[index] = particle.color.z;
+    alpha[index] = particle.color.w;
+    lifeTime[index] = particle.lifeTime;
+    currentTime[index] = particle.currentTime;
+}
+
+void ParticleSoA::RemoveDead() {
+    // 生きているものを前に詰める(順序は保つ)
+    size_t write = 0;
+    for (size_t read = 0; read < count; ++read) {
+        if (lifeTime[read] <= currentTime[read]) {
+            continue;
+        }
+        if (write != read) {
+            CopyFrom(write, *this, read);
+        }
+        ++write;
+    }
+    count = write;
+    ResizeArrays(PaddedCount());
+}
+
+void ParticleSoA::Clear() {
+    count = 0;
+    ResizeArrays(0);
+}
+
+void ParticleSoA::Resize(size_t newCount) {
+    count = newCount;
+    ResizeArrays(PaddedCount());
+}
+
+void ParticleSoA::CopyFrom(size_t dstIndex, const ParticleSoA& src, size_t srcIndex) {
+    for (FloatArray array : kArrays) {
+        (this->*array)[dstIndex] = (src.*array)[srcIndex];
+    }
+}
+
+void ParticleSoA::GatherFrom(const ParticleSoA& src, const uint32_t* indices, size_t indexCount, size_t dstBegin) {
+    for (FloatArray array : kArrays) {
+        const float* from = (src.*array).data();
+        float* to = (this->*array).data() + dstBegin;
+        for (size_t k = 0; k < indexCount; ++k) {
+            to[k] = from[indices[k]];
+        }
+    }
+}
+
+void ParticleSoA::Reserve(size_t capacity) {
+    const size_t padded = (capacity + kLaneWidth_ - 1) / kLaneWidth_ * kLaneWidth_;
+    for (FloatArray array : kArrays) {
+        (this->*array).reserve(padded);
+    }
+}
+
+Particle ParticleSoA::Get(size_t index) const {
+    Particle particle;
+    particle.transform.translate = { translateX[index], translateY[index], translateZ[index] };
+    particle.transform.scale = { scaleX[index], scaleY[index], scaleZ[index] };
+    particle.transform.rotate = { rotateX[index], rotateY[index], rotateZ[index] };
+    particle.velocity = { velocityX[index], velocityY[index], velocityZ[index] };
+    particle.color = { colorR[index], colorG[index], colorB[index], alpha[index] };
+    particle.lifeTime = lifeTime[index];
+    particle.currentTime = currentTime[index];
+    return particle;
+}
+
+size_t ParticleSoA::CapacityBytes() const {
+    size_t bytes = 0;
+    for (FloatArray array : kArrays) {
+        bytes += (this->*array).capacity() * sizeof(float);
+    }
+    return bytes;
+}
+
+uint64_t ParticleSoA::Checksum() const {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    auto mix = [&](const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        }
+    };
+    const uint64_t countValue = count;
+    mix(&countValue, sizeof(countValue));
+    for (FloatArray array : kArrays) {
+        mix((this->*array).data(), count * sizeof(float));
+    }
+    return hash;
+}
+
+void ParticleSoA::ResizeArrays(size_t paddedCount) {
+    for (FloatArray array : kArrays) {
+        (this->*array).resize(paddedCount, 0.0f);
+    }
+    // 端数レーンは0除算しないよう寿命1、経過0のダミーにしておく
+    for (size_t i = count; i < paddedCount; ++i) {
+        lifeTime[i] = 1.0f;
+        currentTime[i] = 0.0f;
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "../../math/shape/Particle.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// パーティクルをSoA(Structure of Arrays)で保持するコンテナ
+/// SIMDでまとめて処理できるよう、各要素を成分ごとの配列に分けて持つ
+/// 配列の長さは常にkLaneWidth_の倍数に切り上げ、端数レーンはダミー値で埋める
+/// </summary>
+struct ParticleSoA {
+
+    // SIMDで一度に処理するレーン数(AVX2 = 8)
+    static inline const size_t kLaneWidth_ = 8;
+
+    // 位置
+    std::vector<float> translateX;
+    std::vector<float> translateY;
+    std::vector<float> translateZ;
+
+    // 速度
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> velocityZ;
+
+    // 拡縮
+    std::vector<float> scaleX;
+    std::vector<float> scaleY;
+    std::vector<float> scaleZ;
+
+    // 回転
+    std::vector<float> rotateX;
+    std::vector<float> rotateY;
+    std::vector<float> rotateZ;
+
+    // 色(alphaは寿命から毎フレーム計算する)
+    std::vector<float> colorR;
+    std::vector<float> colorG;
+    std::vector<float> colorB;
+    std::vector<float> alpha;
+
+    // 生存時間
+    std::vector<float> lifeTime;
+    // 経過時間
+    std::vector<float> currentTime;
+
+    // 有効なパーティクル数
+    size_t count = 0;
+
+    /// <summary>
+    /// 末尾に追加
+    /// </summary>
+    void PushBack(const Particle& particle);
+
+    /// <summary>
+    /// index番目を書き換える(Resize済みの範囲に並列に書き込んでよい)
+    /// </summary>
+    void Set(size_t index, const Particle& particle);
+
+    /// <summary>
+    /// 寿命が尽きたパーティクルを順序を保ったまま取り除く
+    /// </summary>
+    void RemoveDead();
+
+    /// <summary>
+    /// 全削除
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// 要素数を変更(増えた分の中身は未定義。CopyFromで埋める前提)
+    /// </summary>
+    void Resize(size_t newCount);
+
+    /// <summary>
+    /// srcのsrcIndex番目をdstIndex番目にコピー
+    /// </summary>
+    void CopyFrom(size_t dstIndex, const ParticleSoA& src, size_t srcIndex);
+
+    /// <summary>
+    /// srcのindices[k]番目をdstBegin + k番目にまとめてコピー(成分配列ごとに走査する)
+    /// </summary>
+    void GatherFrom(const ParticleSoA& src, const uint32_t* indices, size_t indexCount, size_t dstBegin);
+
+    /// <summary>
+    /// 指定数を格納できるよう確保(レーン幅に切り上げ)
+    /// </summary>
+    void Reserve(size_t capacity);
+
+    /// <summary>
+    /// index番目をParticleとして取り出す(デバッグ表示用)
+    /// </summary>
+    Particle Get(size_t index) const;
+
+    /// <summary>
+    /// 確保済みの容量(バイト)
+    /// </summary>
+    size_t CapacityBytes() const;
+
+    /// <summary>
+    /// 有効な範囲の全成分のハッシュ(FNV-1a。挙動が変わっていないかの確認用)
+    /// </summary>
+    uint64_t Checksum() const;
+
+    /// <summary>
+    /// SIMDで走査する長さ(countをレーン幅に切り上げたもの)
+    /// </summary>
+    size_t PaddedCount() const { return (count + kLaneWidth_ - 1) / kLaneWidth_ * kLaneWidth_; }
+
+private:
+
+    // 配列長をPaddedCount()に合わせる
+    void ResizeArrays(size_t paddedCount);
+};
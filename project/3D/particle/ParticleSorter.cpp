@@ -0,0 +1,164 @@
+#include "ParticleSorter.h"
+
+#include "../../engine/JobSystem.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cfloat>
+
+void ParticleSorter::Reserve(size_t count) {
+    const size_t chunkCount = (count + kChunkSize_ - 1) / kChunkSize_;
+    depths_.reserve(count);
+    keys_.reserve(count);
+    keysTemp_.reserve(count);
+    indices_.reserve(count);
+    indicesTemp_.reserve(count);
+    histograms_.reserve(chunkCount * kBucketCount_);
+    chunkMin_.reserve(chunkCount);
+    chunkMax_.reserve(chunkCount);
+}
+
+void ParticleSorter::Sort(const ParticleSoA& particles, const Matrix4x4& viewMatrix, uint32_t keyBits, JobSystem* jobSystem, uint32_t maxThreads) {
+    Sort(particles, nullptr, particles.count, viewMatrix, keyBits, jobSystem, maxThreads);
+}
+
+void ParticleSorter::Sort(const ParticleSoA& particles, const uint32_t* sourceIndices, size_t count, const Matrix4x4& viewMatrix, uint32_t keyBits, JobSystem* jobSystem, uint32_t maxThreads) {
+    count_ = count;
+    if (count_ == 0) {
+        return;
+    }
+    keyBits = keyBits <= 16 ? 16 : 32;
+
+    depths_.resize(count_);
+    keys_.resize(count_);
+    keysTemp_.resize(count_);
+    indices_.resize(count_);
+    indicesTemp_.resize(count_);
+
+    MakeKeys(particles, sourceIndices, viewMatrix, keyBits, jobSystem, maxThreads);
+
+    // 下位の桁から順に安定に並べる
+    for (uint32_t shift = 0; shift < keyBits; shift += kRadixBits_) {
+        SortPass(shift, jobSystem, maxThreads);
+    }
+}
+
+void ParticleSorter::MakeKeys(const ParticleSoA& particles, const uint32_t* sourceIndices, const Matrix4x4& viewMatrix, uint32_t keyBits, JobSystem* jobSystem, uint32_t maxThreads) {
+    const size_t chunkCount = (count_ + kChunkSize_ - 1) / kChunkSize_;
+
+    // 1. ビュー空間のz(行ベクトル × 行列の3列目)と、チャンクごとの範囲を求める
+    const float m02 = viewMatrix.m[0][2];
+    const float m12 = viewMatrix.m[1][2];
+    const float m22 = viewMatrix.m[2][2];
+    const float m32 = viewMatrix.m[3][2];
+    chunkMin_.assign(chunkCount, FLT_MAX);
+    chunkMax_.assign(chunkCount, -FLT_MAX);
+    ParallelFor(jobSystem, count_, kChunkSize_, [&](size_t begin, size_t end, size_t chunk) {
+        const float* x = particles.translateX.data();
+        const float* y = particles.translateY.data();
+        const float* z = particles.translateZ.data();
+        float* depth = depths_.data();
+        float minDepth = FLT_MAX;
+        float maxDepth = -FLT_MAX;
+        for (size_t i = begin; i < end; ++i) {
+            const size_t source = sourceIndices ? sourceIndices[i] : i;
+            depth[i] = x[source] * m02 + y[source] * m12 + z[source] * m22 + m32;
+            minDepth = (std::min)(minDepth, depth[i]);
+            maxDepth = (std::max)(maxDepth, depth[i]);
+        }
+        chunkMin_[chunk] = minDepth;
+        chunkMax_[chunk] = maxDepth;
+    }, maxThreads);
+
+    float minDepth = FLT_MAX;
+    float maxDepth = -FLT_MAX;
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        minDepth = (std::min)(minDepth, chunkMin_[chunk]);
+        maxDepth = (std::max)(maxDepth, chunkMax_[chunk]);
+    }
+    const float range = maxDepth - minDepth;
+    const float scale = 0.0f < range ? 65535.0f / range : 0.0f;
+
+    // 2. 奥(zが大きい)ほど小さいキーにする
+    ParallelFor(jobSystem, count_, kChunkSize_, [&](size_t begin, size_t end, size_t) {
+        const float* depth = depths_.data();
+        uint32_t* key = keys_.data();
+        uint32_t* index = indices_.data();
+        if (keyBits == 16) {
+            // 範囲を0～65535に量子化
+            for (size_t i = begin; i < end; ++i) {
+                key[i] = static_cast<uint32_t>((maxDepth - depth[i]) * scale);
+                index[i] = sourceIndices ? sourceIndices[i] : static_cast<uint32_t>(i);
+            }
+        } else {
+            // floatのbit列を大小関係が保たれる整数にし、反転して降順にする
+            for (size_t i = begin; i < end; ++i) {
+                uint32_t bits;
+                std::memcpy(&bits, &depth[i], sizeof(bits));
+                bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+                key[i] = ~bits;
+                index[i] = sourceIndices ? sourceIndices[i] : static_cast<uint32_t>(i);
+            }
+        }
+    }, maxThreads);
+}
+
+void ParticleSorter::SortPass(uint32_t shift, JobSystem* jobSystem, uint32_t maxThreads) {
+    const size_t chunkCount = (count_ + kChunkSize_ - 1) / kChunkSize_;
+    histograms_.assign(chunkCount * kBucketCount_, 0);
+
+    // 1. チャンクごとのヒストグラム
+    ParallelFor(jobSystem, count_, kChunkSize_, [&](size_t begin, size_t end, size_t chunk) {
+        uint32_t* histogram = histograms_.data() + chunk * kBucketCount_;
+        const uint32_t* key = keys_.data();
+        for (size_t i = begin; i < end; ++i) {
+            ++histogram[(key[i] >> shift) & (kBucketCount_ - 1)];
+        }
+    }, maxThreads);
+
+    // 全部同じバケットなら並べ替える必要はない
+    for (uint32_t bucket = 0; bucket < kBucketCount_; ++bucket) {
+        uint32_t total = 0;
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            total += histograms_[chunk * kBucketCount_ + bucket];
+        }
+        if (total == count_) {
+            return;
+        }
+        if (total != 0) {
+            break;
+        }
+    }
+
+    // 2. バケット→チャンクの順に累積して書き込み先の先頭にする(安定ソートになる)
+    uint32_t offset = 0;
+    for (uint32_t bucket = 0; bucket < kBucketCount_; ++bucket) {
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            uint32_t& slot = histograms_[chunk * kBucketCount_ + bucket];
+            const uint32_t num = slot;
+            slot = offset;
+            offset += num;
+        }
+    }
+
+    // 3. 各チャンクが自分の書き込み先へ並列に振り分ける
+    ParallelFor(jobSystem, count_, kChunkSize_, [&](size_t begin, size_t end, size_t chunk) {
+        uint32_t* destination = histograms_.data() + chunk * kBucketCount_;
+        const uint32_t* key = keys_.data();
+        const uint32_t* index = indices_.data();
+        uint32_t* keyOut = keysTemp_.data();
+        uint32_t* indexOut = indicesTemp_.data();
+        for (size_t i = begin; i < end; ++i) {
+            const uint32_t slot = destination[(key[i] >> shift) & (kBucketCount_ - 1)]++;
+            keyOut[slot] = key[i];
+            indexOut[slot] = index[i];
+        }
+    }, maxThreads);
+
+    keys_.swap(keysTemp_);
+    indices_.swap(indicesTemp_);
+}
+
+bool ParticleSorter::IsSorted() const {
+    return std::is_sorted(keys_.begin(), keys_.begin() + count_);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "ParticleSoA.h"
+#include "../../math/Matrix4x4.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class JobSystem;
+
+/// <summary>
+/// パーティクルをビュー空間の深度で奥から手前へ並べる(アルファブレンド用)
+/// 深度を16bitまたは32bitの整数キーにして、8bitずつのLSD基数ソートをチャンク並列で行う
+/// 並べた結果は添字の列として返し、インスタンスの書き込み時に参照する
+/// </summary>
+class ParticleSorter {
+private: // メンバ変数
+
+    // 1チャンクのキー数(チャンク分けは固定なのでスレッド数によらず結果は同じ)
+    static inline const size_t kChunkSize_ = 16384;
+
+    // 1パスで処理するbit数とバケット数
+    static inline const uint32_t kRadixBits_ = 8;
+    static inline const uint32_t kBucketCount_ = 1u << kRadixBits_;
+
+    std::vector<float> depths_;
+
+    std::vector<uint32_t> keys_;
+    std::vector<uint32_t> keysTemp_;
+
+    std::vector<uint32_t> indices_;
+    std::vector<uint32_t> indicesTemp_;
+
+    // チャンク × バケットのヒストグラム(累積後は書き込み先)
+    std::vector<uint32_t> histograms_;
+
+    // チャンクごとの深度の範囲
+    std::vector<float> chunkMin_;
+    std::vector<float> chunkMax_;
+
+    size_t count_ = 0;
+
+private: // メンバ関数
+
+    // 深度からキーを作る(奥ほど小さいキー)
+    void MakeKeys(const ParticleSoA& particles, const uint32_t* sourceIndices, const Matrix4x4& viewMatrix, uint32_t keyBits, JobSystem* jobSystem, uint32_t maxThreads);
+
+    // shiftから8bit分で1パス並べ替える
+    void SortPass(uint32_t shift, JobSystem* jobSystem, uint32_t maxThreads);
+
+public: // メンバ関数
+
+    /// <summary>
+    /// count個までは並べる時に確保しないよう、作業用バッファを先に確保しておく
+    /// </summary>
+    void Reserve(size_t count);
+
+    /// <summary>
+    /// 奥から手前の順に並べる
+    /// </summary>
+    /// <param name="keyBits">キーのbit数(16 か 32)</param>
+    void Sort(const ParticleSoA& particles, const Matrix4x4& viewMatrix, uint32_t keyBits, JobSystem* jobSystem, uint32_t maxThreads = 0);
+
+    /// <summary>
+    /// sourceIndicesのcount個だけを奥から手前の順に並べる(カリング後の添字など)
+    /// </summary>
+    void Sort(const ParticleSoA& particles, const uint32_t* sourceIndices, size_t count, const Matrix4x4& viewMatrix, uint32_t keyBits, JobSystem* jobSystem, uint32_t maxThreads = 0);
+
+    /// <summary>
+    /// キーが昇順(奥から手前)に並んでいるか(確認用)
+    /// </summary>
+    bool IsSorted() const;
+
+    // ゲッター
+    const uint32_t* GetIndices() const { return indices_.data(); }
+    size_t GetCount() const { return count_; }
+
+    /// <summary>
+    /// 作業用バッファの確保量(バイト)
+    /// </summary>
+    size_t GetMemoryBytes() const {
+        return (depths_.capacity() + chunkMin_.capacity() + chunkMax_.capacity()) * sizeof(float) + (keys_.capacity() + keysTemp_.capacity() + indices_.capacity() + indicesTemp_.capacity() + histograms_.capacity()) * sizeof(uint32_t);
+    }
+};
@@ -0,0 +1,120 @@
+#include "ParticleSystem.h"
+
+#include "../../engine/JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+
+void ParticleSystem::Initialize(const std::string& effectFilePath, uint32_t reserveCount) {
+
+    // エフェクト(エミッタとモジュール)をファイルから読む。なければcountが3コのemitterを作成しておく
+    // 衝突させるものもエフェクトに書いたものだけ(既定は何もない)
+    emitterManager_.Clear();
+    effect_ = ParticleEffect{};
+    collider_.GetPlanes().clear();
+    collider_.GetSpheres().clear();
+    if (!effectFilePath.empty()) {
+        effect_.LoadFromFile(effectFilePath, &emitterManager_, &collider_);
+    } else {
+        Emitter emitter{};
+        emitter.count = 3;
+        emitter.frequency = 0.5f; // 0.5秒ごとに発生
+        emitter.frequencyTime = 0.0f; // 発生頻度用の時刻、0で初期化
+        emitter.burstCount = reserveCount; // 最初に最大数まで出しておく
+        emitterManager_.AddEmitter(emitter, "default");
+        effect_.Compile();
+    }
+
+    AccelerationField accelerationField{};
+    accelerationField.acceleration = { 15.0f,0.0f,0.0f };
+    accelerationField.area.min = { -1.0f,-1.0f,-1.0f };
+    accelerationField.area.max = { 1.0f,1.0f,1.0f };
+    fieldGrid_.Clear();
+    fieldGrid_.AddField(accelerationField);
+
+    // 最初のburst分を発生させておく
+    // 作業用バッファもreserveCount個までは毎フレームの更新で確保しないよう、ここで確保しておく
+    particles_.Clear();
+    particles_.Reserve(reserveCount);
+    scratch_.Reserve(reserveCount);
+    chunkBuffers_.Reserve(reserveCount);
+    visibleIndices_.reserve(reserveCount);
+    sorter_.Reserve(reserveCount);
+    emitterManager_.Update(0.0f, false, particles_, jobSystem_);
+}
+
+size_t ParticleSystem::Update(const View& view, ParticleForGPU* instances, uint32_t maxInstance, bool advance, uint32_t maxThreads) {
+
+    // 全エミッタの発生処理(止めている間もEmitした分は出す)
+    const auto spawnStart = std::chrono::steady_clock::now();
+    emitterManager_.Update(kDeltaTime_, advance, particles_, jobSystem_, maxThreads);
+    spawnTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - spawnStart).count();
+
+    const auto simulateStart = std::chrono::steady_clock::now();
+    const size_t drawCount = Simulate(particles_, scratch_, view, instances, maxInstance, advance, maxThreads);
+    simulateTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - simulateStart).count();
+
+    if (advance) {
+        effect_.AdvanceTime(kDeltaTime_);
+    }
+    return drawCount;
+}
+
+size_t ParticleSystem::Simulate(ParticleSoA& particles, ParticleSoA& scratch, const View& view, ParticleForGPU* instances, uint32_t maxInstance, bool advance, uint32_t maxThreads) {
+
+    // 生存時間を過ぎたParticleは取り除く(順序は保つ)
+    ParticleUpdater::RemoveDead(particles, scratch, chunkBuffers_, jobSystem_, maxThreads);
+
+    // 場の一覧は変更があったときだけ作り直す
+    fieldGrid_.RebuildIfDirty();
+
+    // 場の加速度・速度/位置の更新・alphaの計算をチャンクごとに並列で行う
+    ParticleKernel::IntegrateParams params{};
+    params.deltaTime = kDeltaTime_;
+    params.advance = advance;
+    ParticleUpdater::Integrate(particles, params, useSimd_, jobSystem_, maxThreads, &fieldGrid_, &effect_);
+
+    // 動いた後の位置で衝突させる
+    ParticleUpdater::Collide(particles, collider_, useSimd_, jobSystem_, maxThreads);
+
+    // 視錐台の外と小さすぎるものを除いた添字を集める
+    const uint32_t* drawIndices = nullptr;
+    size_t visibleCount = particles.count;
+    if (useCulling_) {
+        const auto cullStart = std::chrono::steady_clock::now();
+        const ParticleKernel::CullParams cullParams = ParticleKernel::MakeCullParams(view.viewProjection, view.viewportHeight, minPixelSize_);
+        ParticleUpdater::Cull(particles, cullParams, useSimd_, visibleIndices_, chunkBuffers_, jobSystem_, maxThreads, &cullStats_);
+        cullTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - cullStart).count();
+        drawIndices = visibleIndices_.data();
+        visibleCount = visibleIndices_.size();
+    }
+
+    const size_t drawCount = (std::min)(visibleCount, static_cast<size_t>(maxInstance));
+    if (sortByDepth_) {
+        // 奥から手前の順に並べた添字で書き込む。入りきらない場合は手前側を残す
+        const auto sortStart = std::chrono::steady_clock::now();
+        sorter_.Sort(particles, drawIndices, visibleCount, view.viewMatrix, sortKeyBits_, jobSystem_, maxThreads);
+        sortTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - sortStart).count();
+        drawIndices = sorter_.GetIndices() + (visibleCount - drawCount);
+    }
+
+    const auto packStart = std::chrono::steady_clock::now();
+    if (drawIndices) {
+        ParallelFor(jobSystem_, drawCount, ParticleUpdater::kChunkSize_, [&](size_t begin, size_t end, size_t) {
+            effect_.Pack(particles, drawIndices, begin, end, instances + begin);
+        }, maxThreads);
+    } else {
+        // 詰め直し済みなのでi番目のパーティクルはi番目のインスタンスに書けばよい
+        ParallelFor(jobSystem_, drawCount, ParticleUpdater::kChunkSize_, [&](size_t begin, size_t end, size_t) {
+            effect_.Pack(particles, nullptr, begin, end, instances + begin);
+        }, maxThreads);
+    }
+    packTimeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - packStart).count();
+
+    return drawCount;
+}
+
+size_t ParticleSystem::GetMemoryBytes() const {
+    return particles_.CapacityBytes() + scratch_.CapacityBytes() + sorter_.GetMemoryBytes() +
+        visibleIndices_.capacity() * sizeof(uint32_t) + chunkBuffers_.GetMemoryBytes();
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "ParticleSoA.h"
+#include "ParticleKernel.h"
+#include "ParticleUpdater.h"
+#include "AccelerationFieldGrid.h"
+#include "ParticleEmitterManager.h"
+#include "ParticleEffect.h"
+#include "ParticleSorter.h"
+#include "ParticleCollider.h"
+#include "../../math/shape/ParticleForGPU.h"
+#include "../../math/Matrix4x4.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// 前方宣言
+class JobSystem;
+
+/// <summary>
+/// パーティクルのシミュレーション本体(発生・場・積分・衝突・カリング・ソート・書き込み)
+/// GPUのリソースやカメラには触らないので、デバイスなしでも動かせる(ベンチマーク用)
+/// </summary>
+class ParticleSystem {
+public:
+
+    // カリング・ソートに使うカメラの値
+    struct View {
+        Matrix4x4 viewMatrix{};
+        Matrix4x4 viewProjection{};
+        float viewportHeight = 720.0f;
+    };
+
+    // デルタタイム
+    static inline const float kDeltaTime_ = 1.0f / 60.0f;
+
+private: // メンバ変数
+
+    ParticleSoA particles_;
+
+    // 死んだパーティクルを詰め直すための作業バッファ
+    ParticleSoA scratch_;
+
+    // エミッタ(カウンタベースの乱数で発生させる)
+    ParticleEmitterManager emitterManager_;
+
+    // update/renderのモジュール(1回の更新ループと1回の書き込みループにまとめてある)
+    ParticleEffect effect_;
+
+    // 加速度場(セルごとの一覧で引く)
+    AccelerationFieldGrid fieldGrid_;
+
+    // 平面・球・高さ格子との衝突
+    ParticleCollider collider_;
+
+    ParticleSorter sorter_;
+
+    // 見えるパーティクルの添字
+    std::vector<uint32_t> visibleIndices_;
+
+    // 寿命の削除・カリングのチャンクごとの作業用バッファ(毎フレーム使い回す)
+    ParticleUpdater::ChunkBuffers chunkBuffers_;
+
+    ParticleUpdater::CullStats cullStats_{};
+
+    // SIMD版の積分を使うか(falseならスカラー参照実装)
+    bool useSimd_ = true;
+
+    // 見えないパーティクルを書き込まないか
+    bool useCulling_ = true;
+
+    // これより小さく映るものは描かない(ピクセル)
+    float minPixelSize_ = 0.5f;
+
+    // 奥から手前へ並べてから書き込むか(アルファブレンド用)
+    bool sortByDepth_ = true;
+
+    // ソートキーのbit数(16 か 32)
+    uint32_t sortKeyBits_ = 16;
+
+#pragma region 直前のフレームの処理時間(ms)
+
+    float spawnTimeMs_ = 0.0f;
+    float simulateTimeMs_ = 0.0f;
+    float cullTimeMs_ = 0.0f;
+    float sortTimeMs_ = 0.0f;
+    float packTimeMs_ = 0.0f;
+
+#pragma endregion
+
+    // ワーカースレッド(nullptrなら呼び出し元だけで処理)
+    JobSystem* jobSystem_ = nullptr;
+
+public: // メンバ関数
+
+    /// <summary>
+    /// 初期化
+    /// </summary>
+    /// <param name="effectFilePath">エフェクト定義ファイル(空なら既定のエミッタを1つ作る)</param>
+    /// <param name="reserveCount">確保しておくパーティクル数(既定のエミッタは最初にこの数を出す)</param>
+    void Initialize(const std::string& effectFilePath, uint32_t reserveCount);
+
+    /// <summary>
+    /// 1フレーム分の発生とシミュレーションを行い、時間を進める
+    /// </summary>
+    /// <returns>書き込んだインスタンス数</returns>
+    size_t Update(const View& view, ParticleForGPU* instances, uint32_t maxInstance, bool advance, uint32_t maxThreads = 0);
+
+    /// <summary>
+    /// 寿命の削除・積分・カリング・ソート・インスタンスの書き込みをまとめて行う
+    /// </summary>
+    /// <returns>書き込んだインスタンス数</returns>
+    size_t Simulate(ParticleSoA& particles, ParticleSoA& scratch, const View& view, ParticleForGPU* instances, uint32_t maxInstance, bool advance, uint32_t maxThreads = 0);
+
+    /// <summary>
+    /// 作業用バッファを含めた確保量(バイト)
+    /// </summary>
+    size_t GetMemoryBytes() const;
+
+    // ゲッター
+    ParticleSoA& GetParticles() { return particles_; }
+    const ParticleSoA& GetParticles() const { return particles_; }
+    ParticleEmitterManager& GetEmitterManager() { return emitterManager_; }
+    ParticleEffect& GetEffect() { return effect_; }
+    AccelerationFieldGrid& GetFieldGrid() { return fieldGrid_; }
+    ParticleCollider& GetCollider() { return collider_; }
+    const ParticleUpdater::CullStats& GetCullStats() const { return cullStats_; }
+    bool GetUseSimd() const { return useSimd_; }
+    bool GetUseCulling() const { return useCulling_; }
+    float GetMinPixelSize() const { return minPixelSize_; }
+    bool GetSortByDepth() const { return sortByDepth_; }
+    uint32_t GetSortKeyBits() const { return sortKeyBits_; }
+    float GetSpawnTimeMs() const { return spawnTimeMs_; }
+    float GetSimulateTimeMs() const { return simulateTimeMs_; }
+    float GetCullTimeMs() const { return cullTimeMs_; }
+    float GetSortTimeMs() const { return sortTimeMs_; }
+    float GetPackTimeMs() const { return packTimeMs_; }
+    JobSystem* GetJobSystem() const { return jobSystem_; }
+
+    // セッター
+    void SetUseSimd(bool useSimd) { useSimd_ = useSimd; }
+    void SetUseCulling(bool useCulling) { useCulling_ = useCulling; }
+    void SetMinPixelSize(float minPixelSize) { minPixelSize_ = minPixelSize; }
+    void SetSortByDepth(bool sortByDepth) { sortByDepth_ = sortByDepth; }
+    void SetSortKeyBits(uint32_t sortKeyBits) { sortKeyBits_ = sortKeyBits; }
+    void SetJobSystem(JobSystem* jobSystem) { jobSystem_ = jobSystem; }
+};
@@ -0,0 +1,166 @@
+#include "ParticleUpdater.h"
+
+#include "AccelerationFieldGrid.h"
+#include "ParticleCollider.h"
+#include "ParticleEffect.h"
+#include "../../engine/JobSystem.h"
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+namespace ParticleUpdater {
+
+    void ChunkBuffers::Reserve(size_t count) {
+        const size_t chunkCount = (count + kChunkSize_ - 1) / kChunkSize_;
+        indices.reserve(count);
+        counts.reserve(chunkCount);
+        offsets.reserve(chunkCount);
+        sizeCulled.reserve(chunkCount);
+        chunkCulled.reserve(chunkCount);
+    }
+
+    size_t ChunkBuffers::GetMemoryBytes() const {
+        return indices.capacity() * sizeof(uint32_t) + (counts.capacity() + offsets.capacity() + sizeCulled.capacity()) * sizeof(size_t) +
+            chunkCulled.capacity() * sizeof(uint8_t);
+    }
+
+    void RemoveDead(ParticleSoA& particles, ParticleSoA& scratch, ChunkBuffers& buffers, JobSystem* jobSystem, uint32_t maxThreads) {
+        const size_t count = particles.count;
+        if (count == 0) {
+            return;
+        }
+        const size_t chunkCount = (count + kChunkSize_ - 1) / kChunkSize_;
+        // 容量が足りていれば確保しない
+        buffers.indices.resize(count);
+        buffers.counts.resize(chunkCount);
+        buffers.offsets.resize(chunkCount);
+
+        // 1. チャンクごとに生存しているものの添字を集める
+        ParallelFor(jobSystem, count, kChunkSize_, [&](size_t begin, size_t end, size_t chunk) {
+            uint32_t* indices = buffers.indices.data() + begin;
+            size_t aliveCount = 0;
+            for (size_t i = begin; i < end; ++i) {
+                if (particles.currentTime[i] < particles.lifeTime[i]) {
+                    indices[aliveCount++] = static_cast<uint32_t>(i);
+                }
+            }
+            buffers.counts[chunk] = aliveCount;
+        }, maxThreads);
+
+        // 2. 累積和で書き込み先の先頭を決める
+        size_t total = 0;
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            buffers.offsets[chunk] = total;
+            total += buffers.counts[chunk];
+        }
+        if (total == count) {
+            return; // 死んだものがない
+        }
+
+        // 3. 各チャンクが自分の範囲に並列に書き込む
+        scratch.Resize(total);
+        ParallelFor(jobSystem, chunkCount, 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t chunk = begin; chunk < end; ++chunk) {
+                scratch.GatherFrom(particles, buffers.indices.data() + chunk * kChunkSize_, buffers.counts[chunk], buffers.offsets[chunk]);
+            }
+        }, maxThreads);
+
+        std::swap(particles, scratch);
+    }
+
+    void Collide(ParticleSoA& particles, const ParticleCollider& collider, bool useSimd, JobSystem* jobSystem, uint32_t maxThreads) {
+        if (collider.IsEmpty()) {
+            return;
+        }
+        ParallelFor(jobSystem, particles.PaddedCount(), kChunkSize_, [&](size_t begin, size_t end, size_t) {
+            if (useSimd) {
+                collider.Collide(particles, begin, end);
+            } else {
+                collider.CollideScalar(particles, begin, end);
+            }
+        }, maxThreads);
+    }
+
+    void Cull(const ParticleSoA& particles, const ParticleKernel::CullParams& params, bool useSimd, std::vector<uint32_t>& visible, ChunkBuffers& buffers, JobSystem* jobSystem, uint32_t maxThreads, CullStats* stats) {
+        const size_t count = particles.count;
+        const size_t chunkCount = (count + kChunkSize_ - 1) / kChunkSize_;
+        visible.clear();
+        // 容量が足りていれば確保しない
+        buffers.indices.resize(count);
+        buffers.counts.assign(chunkCount, 0);
+        buffers.offsets.resize(chunkCount);
+        buffers.sizeCulled.assign(chunkCount, 0);
+        buffers.chunkCulled.assign(chunkCount, 0);
+        std::vector<size_t>& visibleCounts = buffers.counts;
+        std::vector<size_t>& sizeCulled = buffers.sizeCulled;
+        std::vector<uint8_t>& chunkCulled = buffers.chunkCulled;
+        std::vector<size_t>& offsets = buffers.offsets;
+
+        // 1. チャンクごとに範囲で判定し、残ったものはパーティクルごとに判定して詰める
+        ParallelFor(jobSystem, count, kChunkSize_, [&](size_t begin, size_t end, size_t chunk) {
+            float minX = particles.translateX[begin], maxX = minX;
+            float minY = particles.translateY[begin], maxY = minY;
+            float minZ = particles.translateZ[begin], maxZ = minZ;
+            float maxScale = 0.0f;
+            for (size_t i = begin; i < end; ++i) {
+                minX = (std::min)(minX, particles.translateX[i]); maxX = (std::max)(maxX, particles.translateX[i]);
+                minY = (std::min)(minY, particles.translateY[i]); maxY = (std::max)(maxY, particles.translateY[i]);
+                minZ = (std::min)(minZ, particles.translateZ[i]); maxZ = (std::max)(maxZ, particles.translateZ[i]);
+                maxScale = (std::max)(maxScale, (std::max)(std::fabs(particles.scaleX[i]), std::fabs(particles.scaleY[i])));
+            }
+            const float radius = maxScale * ParticleKernel::kQuadRadius_;
+            if (!ParticleKernel::IsBoundsVisible({ minX - radius, minY - radius, minZ - radius }, { maxX + radius, maxY + radius, maxZ + radius }, params)) {
+                chunkCulled[chunk] = 1;
+                return;
+            }
+            uint32_t* out = buffers.indices.data() + begin;
+            visibleCounts[chunk] = useSimd
+                ? ParticleKernel::Cull(particles, begin, end, params, out, sizeCulled[chunk])
+                : ParticleKernel::CullScalar(particles, begin, end, params, out, sizeCulled[chunk]);
+        }, maxThreads);
+
+        // 2. 累積和で書き込み先を決めて並列に詰める
+        size_t total = 0;
+        CullStats result{};
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            offsets[chunk] = total;
+            total += visibleCounts[chunk];
+            const size_t chunkSize = (std::min)(kChunkSize_, count - chunk * kChunkSize_);
+            if (chunkCulled[chunk]) {
+                result.chunkCulled += chunkSize;
+                ++result.culledChunks;
+            } else {
+                result.sizeCulled += sizeCulled[chunk];
+                result.frustumCulled += chunkSize - visibleCounts[chunk] - sizeCulled[chunk];
+            }
+        }
+        visible.resize(total);
+        ParallelFor(jobSystem, chunkCount, 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t chunk = begin; chunk < end; ++chunk) {
+                std::copy_n(buffers.indices.data() + chunk * kChunkSize_, visibleCounts[chunk], visible.data() + offsets[chunk]);
+            }
+        }, maxThreads);
+
+        result.visible = total;
+        if (stats) {
+            *stats = result;
+        }
+    }
+
+    void Integrate(ParticleSoA& particles, const ParticleKernel::IntegrateParams& params, bool useSimd, JobSystem* jobSystem, uint32_t maxThreads, const AccelerationFieldGrid* fieldGrid, const ParticleEffect* effect) {
+        ParallelFor(jobSystem, particles.PaddedCount(), kChunkSize_, [&](size_t begin, size_t end, size_t) {
+            if (fieldGrid) {
+                fieldGrid->Apply(particles, begin, end, params.deltaTime);
+            }
+            if (effect && params.advance) {
+                effect->Update(particles, begin, end, params.deltaTime);
+            }
+            if (useSimd) {
+                ParticleKernel::Integrate(particles, begin, end, params);
+            } else {
+                ParticleKernel::IntegrateScalar(particles, begin, end, params);
+            }
+        }, maxThreads);
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "ParticleSoA.h"
+#include "ParticleKernel.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+class JobSystem;
+class AccelerationFieldGrid;
+class ParticleCollider;
+class ParticleEffect;
+
+/// <summary>
+/// パーティクル列をチャンクに分けてワーカースレッドで更新する
+/// jobSystemがnullptrなら呼び出し元スレッドだけで処理する
+/// </summary>
+namespace ParticleUpdater {
+
+    // 1チャンクのパーティクル数(SIMDのレーン幅の倍数)
+    inline constexpr size_t kChunkSize_ = 2048;
+
+    /// <summary>
+    /// RemoveDead・Cullがチャンクごとに使う作業用バッファ
+    /// 呼び出し側が持ち続けて毎フレーム使い回す(足りなくなった時だけ確保する)
+    /// </summary>
+    struct ChunkBuffers {
+        // チャンクごとに書き込む添字(チャンクcは c * kChunkSize_ から)
+        std::vector<uint32_t> indices;
+        // チャンクごとに書き込んだ数
+        std::vector<size_t> counts;
+        // チャンクごとの書き込み先の先頭(countsの累積和)
+        std::vector<size_t> offsets;
+        // チャンクごとの小さすぎて捨てた数
+        std::vector<size_t> sizeCulled;
+        // チャンクの範囲ごと捨てたか
+        std::vector<uint8_t> chunkCulled;
+
+        /// <summary>
+        /// count個のパーティクルまではフレーム中に確保しないよう、先に確保しておく
+        /// </summary>
+        void Reserve(size_t count);
+
+        /// <summary>
+        /// 確保量(バイト)
+        /// </summary>
+        size_t GetMemoryBytes() const;
+    };
+
+    /// <summary>
+    /// 寿命が尽きたパーティクルを取り除く
+    /// チャンクごとの生存数の累積和から書き込み先を決めるので、スレッド数によらず順序は同じ
+    /// </summary>
+    /// <param name="scratch">詰め直し先の作業用バッファ(処理後particlesと入れ替わる)</param>
+    /// <param name="buffers">チャンクごとの作業用バッファ</param>
+    void RemoveDead(ParticleSoA& particles, ParticleSoA& scratch, ChunkBuffers& buffers, JobSystem* jobSystem, uint32_t maxThreads = 0);
+
+    /// <summary>
+    /// 全パーティクルを平面・球・高さ格子と衝突させる
+    /// </summary>
+    void Collide(ParticleSoA& particles, const ParticleCollider& collider, bool useSimd, JobSystem* jobSystem, uint32_t maxThreads = 0);
+
+    // カリングの結果(デバッグ表示用)
+    struct CullStats {
+        size_t visible = 0;       // 見える数
+        size_t chunkCulled = 0;   // チャンクの範囲ごと捨てた数
+        size_t frustumCulled = 0; // 視錐台の外で捨てた数
+        size_t sizeCulled = 0;    // 小さすぎて捨てた数
+        size_t culledChunks = 0;  // 捨てたチャンク数
+    };
+
+    /// <summary>
+    /// 見えるパーティクルの添字をvisibleに集める(元の順序を保つ)
+    /// チャンクごとの範囲で先にまとめて捨て、残ったチャンクはパーティクルごとに判定する
+    /// </summary>
+    /// <param name="buffers">チャンクごとの一時書き込み先</param>
+    void Cull(const ParticleSoA& particles, const ParticleKernel::CullParams& params, bool useSimd, std::vector<uint32_t>& visible, ChunkBuffers& buffers, JobSystem* jobSystem, uint32_t maxThreads = 0, CullStats* stats = nullptr);
+
+    /// <summary>
+    /// 全パーティクルを積分する
+    /// fieldGridがあればチャンクごとに場の加速度を加えてから積分する
+    /// effectがあれば同じチャンクのうちにupdateモジュールも適用する
+    /// </summary>
+    void Integrate(ParticleSoA& particles, const ParticleKernel::IntegrateParams& params, bool useSimd, JobSystem* jobSystem, uint32_t maxThreads = 0, const AccelerationFieldGrid* fieldGrid = nullptr, const ParticleEffect* effect = nullptr);
+}
@@ -13,6 +13,7 @@
 #include "3D/PointLightClass.h"
 #include "3D/SpotLightClass.h"
 #include "3D/Region.h"
+#include "3D/ParticleClass.h"
 
 #include "scene/IScene.h"
 #include "scene/title/TitleScene.h"
@@ -46,6 +47,17 @@ void IrufemiEngine::Initialize(const std::wstring& title, const int32_t& clientW
     log_ = std::make_unique<Log>();
     log_->Initialize();
 
+    // ワーカースレッドを起動
+    jobSystem_ = std::make_unique<JobSystem>();
+    jobSystem_->Initialize();
+    ParticleClass::SetJobSystem(jobSystem_.get());
+    ObjClass::SetJobSystem(jobSystem_.get());
+    meshAssetCache_ = std::make_unique<MeshAssetCache>();
+    ObjClass::SetMeshAssetCache(meshAssetCache_.get());
+    modelLoader_ = std::make_unique<AsyncModelLoader>();
+    modelLoader_->Initialize(jobSystem_.get(), meshAssetCache_.get());
+    ObjClass::SetModelLoader(modelLoader_.get());
+
     // AudioManagerの生成・Media Foundationの初期化
     audioManager_ = std::make_unique<AudioManager>();
     audioManager_->StartUp();
@@ -137,6 +149,24 @@ void IrufemiEngine::Finalize() {
     if (winApp_) {
         winApp_.reset();
     }
+
+    // 読み込み中のものは結果を捨てる(ワーカーの仕事はjobSystemの終了で片付く)
+    ObjClass::SetModelLoader(nullptr);
+    if (modelLoader_) {
+        modelLoader_.reset();
+    }
+
+    // ワーカースレッドの停止
+    if (jobSystem_) {
+        jobSystem_->Finalize();
+        jobSystem_.reset();
+    }
+
+    // ワーカーが使い終わってから消す
+    ObjClass::SetMeshAssetCache(nullptr);
+    if (meshAssetCache_) {
+        meshAssetCache_.reset();
+    }
 }
 
 namespace {
@@ -184,6 +214,9 @@ void IrufemiEngine::Execute() {
 
 #endif // _DEBUG
 
+        // 読み込みが終わったモデルをGPUへ転送する
+        modelLoader_->Poll(kMaxModelUploadsPerFrame);
+
         // 更新
         sceneManager_->Update();
 
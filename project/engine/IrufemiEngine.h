@@ -9,6 +9,8 @@
 #include "../math/BlendMode.h"
 #include <memory>
 #include "Log.h"
+#include "JobSystem.h"
+#include "../3D/mesh/AsyncModelLoader.h"
 #include <Windows.h>
 #include <d3d12.h>
 #include <dxcapi.h>
@@ -36,6 +38,18 @@ private: // メンバ変数
     // ログ
     std::unique_ptr<Log> log_ = nullptr;
 
+    // ワーカースレッド
+    std::unique_ptr<JobSystem> jobSystem_ = nullptr;
+
+    // 同じファイルのモデルを共有する
+    std::unique_ptr<MeshAssetCache> meshAssetCache_ = nullptr;
+
+    // モデルの非同期読み込み
+    std::unique_ptr<AsyncModelLoader> modelLoader_ = nullptr;
+
+    // 1フレームにGPUへ転送するモデルの数(読み込みが重なってもフレームが止まらないように)
+    static inline const size_t kMaxModelUploadsPerFrame = 1;
+
     // WinApp
     std::unique_ptr<WinApp> winApp_ = nullptr;
 
@@ -126,6 +140,9 @@ public: // ゲッター
     DebugUI* GetDebugUI() { return this->ui.get(); }
     AudioManager* GetAudioManager() { return this->audioManager_.get(); }
     TextureManager* GetTextureManager() { return this->textureManager.get(); }
+    JobSystem* GetJobSystem() { return this->jobSystem_.get(); }
+    AsyncModelLoader* GetModelLoader() { return this->modelLoader_.get(); }
+    MeshAssetCache* GetMeshAssetCache() { return this->meshAssetCache_.get(); }
     int32_t& GetClientWidth() { return dxCommon_->GetClientWidth(); }
     int32_t& GetClientHeight() { return dxCommon_->GetClientHeight(); }
     D3D12_VIEWPORT& GetViewport() { return dxCommon_->GetViewport(); };
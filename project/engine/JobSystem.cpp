@@ -0,0 +1,197 @@
+#include "JobSystem.h"
+
+#include <atomic>
+#include <algorithm>
+
+namespace {
+
+    // ParallelFor 1回分の共有状態
+    // 呼び出し元のスタックに置き、手伝いがすべて抜けるまで呼び出し元は戻らない
+    struct ParallelForState {
+        std::atomic<size_t> nextChunk{ 0 };
+        size_t chunkCount = 0;
+        size_t chunkSize = 0;
+        size_t count = 0;
+        const ParallelForBody* func = nullptr;
+        // 積んだ手伝いのうち、まだ抜けていないものの数(mutexで守る)
+        size_t helperCount = 0;
+        std::mutex mutex;
+        std::condition_variable condition;
+
+        // チャンクが無くなるまで取り出して処理する
+        void Run() {
+            for (;;) {
+                const size_t chunk = nextChunk.fetch_add(1);
+                if (chunk >= chunkCount) {
+                    return;
+                }
+                const size_t begin = chunk * chunkSize;
+                const size_t end = (std::min)(begin + chunkSize, count);
+                (*func)(begin, end, chunk);
+            }
+        }
+
+        // 手伝い1つ分(ワーカーで実行する)
+        // 抜けたことはロックの中で知らせる(知らせた直後に呼び出し元が状態を捨ててもよいように)
+        static void RunHelper(void* context) {
+            ParallelForState* state = static_cast<ParallelForState*>(context);
+            state->Run();
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (--state->helperCount == 0) {
+                state->condition.notify_all();
+            }
+        }
+    };
+}
+
+void JobSystem::Initialize(uint32_t workerCount) {
+    Finalize();
+
+    if (workerCount == 0) {
+        const uint32_t hardware = std::thread::hardware_concurrency();
+        workerCount = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    isStop_ = false;
+    jobs_.resize(kInitialJobCapacity);
+    jobHead_ = 0;
+    jobCount_ = 0;
+    workers_.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+void JobSystem::Finalize() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isStop_ = true;
+    }
+    condition_.notify_all();
+    for (std::thread& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+}
+
+void JobSystem::PushJob(Job&& job) {
+    if (jobCount_ == jobs_.size()) {
+        // 溢れたら倍の配列に並べ直す(先頭を0番へ)
+        std::vector<Job> grown((std::max)(jobs_.size() * 2, kInitialJobCapacity));
+        for (size_t i = 0; i < jobCount_; ++i) {
+            grown[i] = std::move(jobs_[(jobHead_ + i) % jobs_.size()]);
+        }
+        jobs_ = std::move(grown);
+        jobHead_ = 0;
+    }
+    jobs_[(jobHead_ + jobCount_) % jobs_.size()] = std::move(job);
+    ++jobCount_;
+}
+
+void JobSystem::Submit(std::function<void()> job) {
+    if (workers_.empty()) {
+        // ワーカーがいなければその場で実行
+        job();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Job entry;
+        entry.function = std::move(job);
+        PushJob(std::move(entry));
+    }
+    condition_.notify_one();
+}
+
+void JobSystem::ParallelFor(size_t count, size_t chunkSize, ParallelForBody func, uint32_t maxThreads) {
+    if (count == 0) {
+        return;
+    }
+    chunkSize = (std::max)(chunkSize, size_t{ 1 });
+
+    ParallelForState state;
+    state.count = count;
+    state.chunkSize = chunkSize;
+    state.chunkCount = (count + chunkSize - 1) / chunkSize;
+    state.func = &func;
+
+    // 手伝ってもらうワーカー数(呼び出し元の分を引く)
+    uint32_t threads = maxThreads == 0 ? GetThreadCount() : (std::min)(maxThreads, GetThreadCount());
+    const size_t helpers = (std::min)(static_cast<size_t>(threads) - 1, state.chunkCount - 1);
+    if (helpers > 0) {
+        state.helperCount = helpers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < helpers; ++i) {
+                Job job;
+                job.run = &ParallelForState::RunHelper;
+                job.context = &state;
+                PushJob(std::move(job));
+            }
+        }
+        for (size_t i = 0; i < helpers; ++i) {
+            condition_.notify_one();
+        }
+    }
+
+    // 呼び出し元も処理する
+    state.Run();
+    if (helpers == 0) {
+        return;
+    }
+
+    // まだ取り出されていない手伝いは取り消す(ワーカーが他の仕事で埋まっていても待たない)
+    size_t canceledCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < jobCount_; ++i) {
+            Job& job = jobs_[(jobHead_ + i) % jobs_.size()];
+            if (job.context == &state) {
+                job.run = nullptr;
+                job.context = nullptr;
+                ++canceledCount;
+            }
+        }
+    }
+
+    // 取り出された手伝いが処理中のチャンクを終えて抜けるのを待つ
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.helperCount -= canceledCount;
+    state.condition.wait(lock, [&] { return state.helperCount == 0; });
+}
+
+void JobSystem::WorkerLoop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this] { return isStop_ || jobCount_ > 0; });
+            if (jobCount_ == 0) {
+                return; // 停止指示かつ仕事なし
+            }
+            job = std::move(jobs_[jobHead_]);
+            jobs_[jobHead_] = Job{};
+            jobHead_ = (jobHead_ + 1) % jobs_.size();
+            --jobCount_;
+        }
+        // 取り消された手伝いは何もしない
+        if (job.run) {
+            job.run(job.context);
+        } else if (job.function) {
+            job.function();
+        }
+    }
+}
+
+void ParallelFor(JobSystem* jobSystem, size_t count, size_t chunkSize, ParallelForBody func, uint32_t maxThreads) {
+    if (jobSystem) {
+        jobSystem->ParallelFor(count, chunkSize, func, maxThreads);
+        return;
+    }
+    chunkSize = (std::max)(chunkSize, size_t{ 1 });
+    for (size_t begin = 0, chunk = 0; begin < count; begin += chunkSize, ++chunk) {
+        func(begin, (std::min)(begin + chunkSize, count), chunk);
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// ParallelForに渡す処理func(begin, end, chunkIndex)への参照
+/// std::functionと違い複写も確保もしない(ParallelForは終わるまで戻らないので、呼び出しの間だけ指せればよい)
+/// </summary>
+class ParallelForBody {
+private: // メンバ変数
+
+    const void* object_ = nullptr;
+
+    void (*invoke_)(const void* object, size_t begin, size_t end, size_t chunkIndex) = nullptr;
+
+public: // メンバ関数
+
+    template<typename Func, typename = std::enable_if_t<
+        !std::is_same_v<std::decay_t<Func>, ParallelForBody> && std::is_invocable_v<const Func&, size_t, size_t, size_t>>>
+    ParallelForBody(const Func& func)
+        : object_(&func),
+        invoke_([](const void* object, size_t begin, size_t end, size_t chunkIndex) { (*static_cast<const Func*>(object))(begin, end, chunkIndex); }) {
+    }
+
+    void operator()(size_t begin, size_t end, size_t chunkIndex) const { invoke_(object_, begin, end, chunkIndex); }
+};
+
+/// <summary>
+/// ワーカースレッドを常駐させて仕事を分配する
+/// ParallelForは呼び出し元スレッドも処理に参加し、全チャンクが終わるまで戻らない
+/// 待ち行列は先に確保した環状の配列で、ParallelForは毎回の確保をしない
+/// </summary>
+class JobSystem {
+private: // サブクラス
+
+    /// <summary>
+    /// 待ち行列の仕事1つ
+    /// ParallelForの手伝いは関数と文脈のポインタだけ、Submitの仕事はstd::functionで持つ
+    /// </summary>
+    struct Job {
+        void (*run)(void* context) = nullptr;
+        void* context = nullptr;
+        std::function<void()> function;
+    };
+
+private: // メンバ変数
+
+    // 待ち行列の最初の容量(溢れた時だけ倍にする)
+    static inline const size_t kInitialJobCapacity = 256;
+
+    std::vector<std::thread> workers_;
+
+    // 環状の待ち行列(jobHead_から jobCount_ 個)
+    std::vector<Job> jobs_;
+    size_t jobHead_ = 0;
+    size_t jobCount_ = 0;
+
+    std::mutex mutex_;
+
+    std::condition_variable condition_;
+
+    bool isStop_ = false;
+
+private: // メンバ関数
+
+    // ワーカーの処理ループ
+    void WorkerLoop();
+
+    // 待ち行列の末尾に積む(mutex_を持って呼ぶ)
+    void PushJob(Job&& job);
+
+public: // メンバ関数
+
+    // デストラクタ
+    ~JobSystem() { Finalize(); }
+
+    /// <summary>
+    /// 初期化
+    /// </summary>
+    /// <param name="workerCount">ワーカー数(0ならコア数-1)</param>
+    void Initialize(uint32_t workerCount = 0);
+
+    /// <summary>
+    /// 終了処理(積まれている仕事を終えてからスレッドを止める)
+    /// </summary>
+    void Finalize();
+
+    /// <summary>
+    /// 仕事を積む(完了は待たない)
+    /// </summary>
+    void Submit(std::function<void()> job);
+
+    /// <summary>
+    /// [0, count)をchunkSizeごとに分けて並列に処理する
+    /// func(begin, end, chunkIndex)はチャンクごとに1回呼ばれる
+    /// </summary>
+    /// <param name="maxThreads">参加するスレッド数の上限(呼び出し元を含む。0なら全ワーカー)</param>
+    void ParallelFor(size_t count, size_t chunkSize, ParallelForBody func, uint32_t maxThreads = 0);
+
+    // ゲッター
+    // 呼び出し元を含めた最大並列数
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(workers_.size()) + 1; }
+};
+
+/// <summary>
+/// jobSystemがnullなら呼び出し元で順に処理するParallelFor
+/// </summary>
+void ParallelFor(JobSystem* jobSystem, size_t count, size_t chunkSize, ParallelForBody func, uint32_t maxThreads = 0);
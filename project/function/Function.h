@@ -54,7 +54,19 @@ ObjModel LoadObjFileM(const std::string& directoryPath, const std::string& filen
 
 ModelData LoadObjFileAssimp(const std::string& directoryPath, const std::string& filename);
 
-ObjModel LoadObjFileAssimpM(const std::string& directoryPath, const std::string& filename);
+// LoadObjFileAssimpMで足すassimpの後処理
+struct AssimpImportOptions {
+    // 同じ頂点をまとめる(objは角ごとに頂点が分かれて読まれるので大きく減る)
+    bool joinIdenticalVertices = true;
+    // 頂点キャッシュに合うように三角形を並べ替える
+    bool improveCacheLocality = true;
+    // 同じマテリアルの小さいメッシュをまとめる(メッシュの数と順が変わる)
+    bool optimizeMeshes = false;
+    // 面の種類ごとにメッシュを分け、点と線は捨てる
+    bool sortByPType = true;
+};
+
+ObjModel LoadObjFileAssimpM(const std::string& directoryPath, const std::string& filename, const AssimpImportOptions& options = {});
 
 // f行の頂点データを安全にパースする関数例
 bool ParseObjFaceToken(const std::string& token, int& posIdx, int& uvIdx, int& normIdx);
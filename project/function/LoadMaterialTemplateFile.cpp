@@ -1,40 +1,27 @@
 #include "Function.h"
 
-#include <fstream>
-#include <sstream>
-#include <cassert>
+#include "../3D/mesh/MaterialLibrary.h"
 
 /*objファイルを読んでみよう*/
 
 /// MaterialData構造体と読み込み関数
 
 MaterialData LoadMaterialTemplateFile(const std::string& directoryPath, const std::string filename) {
-    // 1. 中で必要となる変数の宣言
-    // 2. ファイルを開く
-    // 3. 実際にファイルを読み、MaterialDataを構築していく
-    // 4. MaterialDataを返す
+    // 1. mtlの表を受け取る(MaterialLibraryCacheがファイルごとに1回だけ解析したもの)
+    // 2. テクスチャを使う最後のマテリアルのパスをMaterialDataにする(map_Kdの行を順に上書きしていた時と同じ)
+    // 3. MaterialDataを返す
+
+    ///1. mtlの表を受け取る
 
-    ///1.2. 必要な宣言とファイルを開く
-    
     MaterialData materialData;
-    std::string line; //ファイルから読んだ1行を格納するもの
-    std::ifstream file(directoryPath + "/" + filename); //ファイルを開く
-    assert(file.is_open()); //とりあえず開けなかったら止める
-    
-    ///3. ファイルを読み、MaterialDataを構築
-    
-    while (std::getline(file, line)) {
-        std::string identifier;
-        std::istringstream s(line);
-        s >> identifier;
-
-        // identifierに応じた処理
-        if (identifier == "map_Kd") {
-            std::string textureFilename;
-            s >> textureFilename;
-            //連結してファイルパスにする
-            materialData.textureFilePath = directoryPath + "/" + textureFilename;
+    const std::shared_ptr<const MaterialLibrary> library = MaterialLibraryCache::Load(directoryPath, filename);
+
+    ///2. MaterialDataを構築
+
+    for (const ObjMaterial& material : library->materials) {
+        if (!material.textureFilePath.empty()) {
+            materialData.textureFilePath = material.textureFilePath;
         }
     }
     return materialData;
-}
\ No newline at end of file
+}
@@ -5,15 +5,19 @@
 #include "../math/Vector2.h"
 #include "../math/Matrix4x4.h"
 #include "../function/Math.h"
+#include "../3D/mesh/ObjMeshIndexer.h"
+#include "../3D/mesh/MeshNormals.h"
+#include "../3D/mesh/MaterialLibrary.h"
+#include "../3D/mesh/MeshBounds.h"
 #include <vector>
 #include <fstream>
 #include <sstream>
 #include <cassert>
-#include <map>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <assimp/config.h>
 #include <assimp/material.h>
 
 ModelData LoadObjFile(const std::string& directoryPath, const std::string& filename) {
@@ -124,13 +128,15 @@ ObjModel LoadObjFileM(const std::string& directoryPath, const std::string& filen
     std::vector<Vector4> positions;
     std::vector<Vector3> normals;
     std::vector<Vector2> texcoords;
-    std::map<std::string, ObjMaterial> materialMap;
+    // mtlは MaterialLibraryCache でファイルごとに1回だけ解析し、メッシュは表の番号で参照する
+    MaterialTableBuilder materialTable(objModel.materials, directoryPath);
 
     std::ifstream file(directoryPath + "/" + filename);
     assert(file.is_open());
 
     std::string line;
     ObjMesh currentMesh;
+    ObjMeshIndexer indexer;
 
     while (std::getline(file, line)) {
         std::istringstream s(line);
@@ -157,96 +163,38 @@ ObjModel LoadObjFileM(const std::string& directoryPath, const std::string& filen
             n.x *= -1.0f;
             normals.push_back(n);
         } else if (id == "f") {
-            VertexData tri[3];
+            uint32_t tri[3];
             for (int i = 0; i < 3; ++i) {
                 std::string def;
                 s >> def;
                 int pIdx = -1, tIdx = -1, nIdx = -1;
                 ParseObjFaceToken(def, pIdx, tIdx, nIdx);
 
-                Vector4 position = (pIdx > 0) ? positions[pIdx - 1] : Vector4{};
-                Vector2 texcoord = (tIdx > 0) ? texcoords[tIdx - 1] : Vector2{ 0.5f, 0.5f };
-                Vector3 normal = (nIdx > 0) ? normals[nIdx - 1] : Vector3{};
-
-                tri[i] = { position, texcoord, normal };
+                // 同じ(位置/UV/法線)の組は同じ頂点を使う
+                tri[i] = indexer.GetOrAdd(pIdx, tIdx, nIdx, positions, texcoords, normals, currentMesh);
             }
             // 三角形の回り順は逆にしている（必要な場合のみ）
-            currentMesh.vertices.push_back(tri[2]);
-            currentMesh.vertices.push_back(tri[1]);
-            currentMesh.vertices.push_back(tri[0]);
+            currentMesh.indices.push_back(tri[2]);
+            currentMesh.indices.push_back(tri[1]);
+            currentMesh.indices.push_back(tri[0]);
         } else if (id == "usemtl") {
-            if (!currentMesh.vertices.empty()) {
+            if (!currentMesh.indices.empty()) {
                 objModel.meshes.push_back(currentMesh);
                 currentMesh = ObjMesh();
+                indexer.Clear();
             }
             std::string matName;
             s >> matName;
-            if (materialMap.count(matName)) {
-                currentMesh.material = materialMap[matName];
-            } else {
-                currentMesh.material = ObjMaterial(); // デフォルト値
-            }
+            // 無ければデフォルト値
+            currentMesh.materialIndex = materialTable.Use(matName);
         } else if (id == "mtllib") {
             std::string mtlFilename;
             s >> mtlFilename;
-            std::ifstream mtlFile(directoryPath + "/" + mtlFilename);
-            assert(mtlFile.is_open());
-
-            std::string mtlLine, currentName;
-            while (std::getline(mtlFile, mtlLine)) {
-                std::istringstream ms(mtlLine);
-                std::string mtlId;
-                ms >> mtlId;
-
-                if (mtlId == "newmtl") {
-                    ms >> currentName;
-                    materialMap[currentName] = ObjMaterial();
-                } else if (mtlId == "Kd") {
-                    ms >> materialMap[currentName].color.x
-                        >> materialMap[currentName].color.y
-                        >> materialMap[currentName].color.z;
-                    materialMap[currentName].color.w = 1.0f;
-                } else if (mtlId == "Ka") {
-                    ms >> materialMap[currentName].ambient.x
-                        >> materialMap[currentName].ambient.y
-                        >> materialMap[currentName].ambient.z;
-                } else if (mtlId == "Ks") {
-                    ms >> materialMap[currentName].specular.x
-                        >> materialMap[currentName].specular.y
-                        >> materialMap[currentName].specular.z;
-                } else if (mtlId == "Ns") {
-                    ms >> materialMap[currentName].shininess;
-                } else if (mtlId == "d" || mtlId == "Tr") {
-                    ms >> materialMap[currentName].alpha;
-                } else if (mtlId == "map_Kd") {
-                    std::string token;
-                    bool hasTransform = false;
-                    // テクスチャオプション対応
-                    while (ms >> token) {
-                        if (token == "-o") {
-                            ms >> materialMap[currentName].uvTransform.m[3][0]
-                                >> materialMap[currentName].uvTransform.m[3][1];
-                            hasTransform = true;
-                        } else if (token == "-s") {
-                            ms >> materialMap[currentName].uvTransform.m[0][0]
-                                >> materialMap[currentName].uvTransform.m[1][1];
-                            hasTransform = true;
-                        } else {
-                            materialMap[currentName].textureFilePath = directoryPath + "/" + token;
-                            break;
-                        }
-                    }
-                    // デフォルト値セット
-                    if (!hasTransform) {
-                        materialMap[currentName].uvTransform = Math::MakeAffineMatrix(
-                            { 1.0f, 1.0f, 1.0f }, { 0,0,0 }, { 0,0,0 });
-                    }
-                }
-            }
+            materialTable.AddLibrary(mtlFilename);
         }
     }
 
-    if (!currentMesh.vertices.empty()) {
+    if (!currentMesh.indices.empty()) {
         objModel.meshes.push_back(currentMesh);
     }
 
@@ -322,23 +270,38 @@ ModelData LoadObjFileAssimp(const std::string& directoryPath, const std::string&
 }
 
 
-ObjModel LoadObjFileAssimpM(const std::string& directoryPath, const std::string& filename) {
+ObjModel LoadObjFileAssimpM(const std::string& directoryPath, const std::string& filename, const AssimpImportOptions& options) {
     ObjModel objModel;
 
     Assimp::Importer importer;
     const std::string filePath = directoryPath + "/" + filename;
 
     // 三角形化 + 回り順反転 + UV反転（左手系化は手動でx *= -1）
-    const unsigned int flags =
+    unsigned int flags =
         aiProcess_Triangulate |
         aiProcess_FlipWindingOrder |
         aiProcess_FlipUVs;
+    // 選んだ後処理を足す
+    if (options.joinIdenticalVertices) {
+        flags |= aiProcess_JoinIdenticalVertices;
+    }
+    if (options.improveCacheLocality) {
+        flags |= aiProcess_ImproveCacheLocality;
+    }
+    if (options.optimizeMeshes) {
+        flags |= aiProcess_OptimizeMeshes;
+    }
+    if (options.sortByPType) {
+        flags |= aiProcess_SortByPType;
+        // 点と線だけのメッシュは描かないので読み込みの時点で捨てる
+        importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+    }
 
     const aiScene* scene = importer.ReadFile(filePath.c_str(), flags);
     assert(scene && scene->HasMeshes());
 
     // マテリアルをObjMaterialに変換（テクスチャ/色/不透明度/光沢など）
-    std::vector<ObjMaterial> convertedMaterials;
+    std::vector<ObjMaterial>& convertedMaterials = objModel.materials;
     convertedMaterials.resize(scene->mNumMaterials);
 
     for (uint32_t i = 0; i < scene->mNumMaterials; ++i) {
@@ -397,45 +360,65 @@ ObjModel LoadObjFileAssimpM(const std::string& directoryPath, const std::string&
         convertedMaterials[i] = out;
     }
 
-    // メッシュを展開（頂点三角形ストリップ → 連続三角形リスト）
+    // メッシュを添字付きのまま移す(assimpの配列から直接書き込み、途中の配列は作らない)
+    objModel.meshes.reserve(scene->mNumMeshes);
     for (uint32_t meshIndex = 0; meshIndex < scene->mNumMeshes; ++meshIndex) {
-        aiMesh* mesh = scene->mMeshes[meshIndex];
+        const aiMesh* mesh = scene->mMeshes[meshIndex];
+        // 三角形を含まないメッシュ(SortByPTypeを使わない時の点・線)は描かない
+        if (!mesh->HasFaces() || !(mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE)) {
+            continue;
+        }
 
-        ObjMesh outMesh;
+        ObjMesh& outMesh = objModel.meshes.emplace_back();
         // マテリアル割り当て
         if (mesh->mMaterialIndex < convertedMaterials.size()) {
-            outMesh.material = convertedMaterials[mesh->mMaterialIndex];
+            outMesh.materialIndex = mesh->mMaterialIndex;
         }
 
-        // 頂点展開
-        assert(mesh->HasFaces());
-        // 法線がないモデルもあるため、生成済みでなくても安全に扱う
+        // 法線がないモデルは0にしておき、後で周りの三角形から作る
         const bool hasNormals = mesh->HasNormals();
         const bool hasUV0 = mesh->HasTextureCoords(0);
 
+        // assimpの頂点はそのまま使う(JoinIdenticalVerticesならまとめ済み)
+        outMesh.vertices.resize(mesh->mNumVertices);
+        VertexData* vertex = outMesh.vertices.data();
+        for (uint32_t idx = 0; idx < mesh->mNumVertices; ++idx, ++vertex) {
+            const aiVector3D& p = mesh->mVertices[idx];
+            // 左手系化（x反転のみ、回り順はフラグで反転済み）
+            vertex->position = { -p.x, p.y, p.z, 1.0f };
+            if (hasNormals) {
+                const aiVector3D& n = mesh->mNormals[idx];
+                vertex->normal = { -n.x, n.y, n.z };
+            } else {
+                vertex->normal = { 0.0f, 0.0f, 0.0f };
+            }
+            // UVは aiProcess_FlipUVs 済み。追加の反転は不要。
+            if (hasUV0) {
+                const aiVector3D& t = mesh->mTextureCoords[0][idx];
+                vertex->texcoord = { t.x, t.y };
+            } else {
+                vertex->texcoord = { 0.5f, 0.5f };
+            }
+        }
+
+        // 面は添字としてそのまま書く(Triangulate済み。SortByPTypeを使わない時に混じる点・線は飛ばす)
+        outMesh.indices.resize(static_cast<size_t>(mesh->mNumFaces) * 3);
+        uint32_t* index = outMesh.indices.data();
         for (uint32_t faceIndex = 0; faceIndex < mesh->mNumFaces; ++faceIndex) {
             const aiFace& face = mesh->mFaces[faceIndex];
-            assert(face.mNumIndices == 3); // Triangulate済み
-
-            for (uint32_t e = 0; e < 3; ++e) {
-                const uint32_t idx = face.mIndices[e];
-
-                const aiVector3D& p = mesh->mVertices[idx];
-                aiVector3D n = hasNormals ? mesh->mNormals[idx] : aiVector3D(0, 1, 0);
-                aiVector3D t = hasUV0 ? mesh->mTextureCoords[0][idx] : aiVector3D(0.5f, 0.5f, 0.0f);
-
-                VertexData v{};
-                // 左手系化（x反転のみ、回り順はフラグで反転済み）
-                v.position = { -p.x, p.y, p.z, 1.0f };
-                v.normal = { -n.x, n.y, n.z };
-                // UVは aiProcess_FlipUVs 済み。追加の反転は不要。
-                v.texcoord = { t.x, t.y };
-
-                outMesh.vertices.push_back(v);
+            if (face.mNumIndices != 3) {
+                continue;
             }
+            index[0] = face.mIndices[0];
+            index[1] = face.mIndices[1];
+            index[2] = face.mIndices[2];
+            index += 3;
         }
-
-        objModel.meshes.push_back(std::move(outMesh));
+        outMesh.indices.resize(static_cast<size_t>(index - outMesh.indices.data()));
+        if (!hasNormals) {
+            MeshNormals::GenerateNormals(outMesh);
+        }
+        MeshBounds::Compute(outMesh);
     }
 
     return objModel;
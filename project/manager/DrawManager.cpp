@@ -381,6 +381,9 @@ void DrawManager::DrawParticle(ParticleClass* resource) {
     //マテリアルCBufferの場所を設定(ここでの第一引数の0はRootParameter配列の0番目であり、registerの0ではない)
     dxCommon_->GetCommandList()->SetGraphicsRootConstantBufferView(0, resource->GetD3D12Resource()->materialResource_->GetGPUVirtualAddress());
 
+    // ViewProjection/ビルボード行列(VS b0)。描画ごとに1回だけ設定する
+    dxCommon_->GetCommandList()->SetGraphicsRootConstantBufferView(1, resource->GetViewResource()->GetGPUVirtualAddress());
+
     auto instancing = resource->GetInstancingSrvHandleGPU();
     assert(instancing.ptr != 0 && "Instancing SRV handle is null or invalid");
     dxCommon_->GetCommandList()->SetGraphicsRootDescriptorTable(4, resource->GetInstancingSrvHandleGPU());
@@ -399,7 +402,7 @@ void DrawManager::DrawParticle(ParticleClass* resource) {
 
 }
 
-void DrawManager::DrawByIndex(D3D12ResourceUtil* resource) {
+void DrawManager::DrawByIndex(D3D12ResourceUtil* resource, uint32_t indexCount, uint32_t startIndex) {
 
     /*三角形を表示しよう*/
     //RootSignatureを設定。PSOに設定しているけど別途指定が必要
@@ -441,7 +444,10 @@ void DrawManager::DrawByIndex(D3D12ResourceUtil* resource) {
     /*三角形を表示しよう*/
 
     //描画！(DrawCall/ドローコール)。3頂点で1つのインスタンス。インスタンスについては今後
-    dxCommon_->GetCommandList()->DrawIndexedInstanced(static_cast<UINT>(resource->indexDataList_.size()), 1, 0, 0, 0);
+    if (indexCount == 0) {
+        indexCount = static_cast<uint32_t>(resource->indexDataList_.size());
+    }
+    dxCommon_->GetCommandList()->DrawIndexedInstanced(indexCount, 1, startIndex, 0, 0);
 
 }
 
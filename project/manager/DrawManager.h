@@ -69,7 +69,8 @@ public: //メンバ関数
 
     void DrawParticle(ParticleClass* resource);
 
-    void DrawByIndex(D3D12ResourceUtil* resource);
+    // indexCountが0なら添字をすべて描く(詳細度などで一部だけ描く時は範囲を渡す)
+    void DrawByIndex(D3D12ResourceUtil* resource, uint32_t indexCount = 0, uint32_t startIndex = 0);
 
     void DrawByVertex(D3D12ResourceUtil* resource);
 
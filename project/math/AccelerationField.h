@@ -3,7 +3,20 @@
 #include "Vector3.h"
 #include "shape/AABB.h"
 
+// 場の種類
+enum class AccelerationFieldType {
+    kAccelerationFieldConstant, //!< 一定の加速度(風・重力)
+    kAccelerationFieldRadial,   //!< 中心から放射状(strength > 0で反発、< 0で吸引)
+    kAccelerationFieldVortex,   //!< 軸まわりの渦
+    kAccelerationFieldDrag,     //!< 速度に比例した抵抗
+    kCountOfAccelerationFieldType,
+};
+
 struct AccelerationField {
     Vector3 acceleration; //!< 加速度
     AABB area; //!< 範囲
-};
\ No newline at end of file
+    AccelerationFieldType type = AccelerationFieldType::kAccelerationFieldConstant; //!< 種類
+    Vector3 center{ 0.0f,0.0f,0.0f }; //!< 中心(Radial/Vortex)
+    Vector3 axis{ 0.0f,1.0f,0.0f }; //!< 回転軸(Vortex、正規化済み)
+    float strength = 0.0f; //!< 強さ(Radial/Vortexの加速度、Dragの抵抗係数)
+};
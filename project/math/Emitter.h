@@ -1,16 +1,48 @@
 #pragma once
 
 #include "Transform.h"
+#include "Vector3.h"
+#include "Vector4.h"
 #include <cstdint>
 
+// 発生範囲の形
+enum class EmitterShape {
+    kEmitterShapePoint,  //!< 中心から
+    kEmitterShapeBox,    //!< 箱の中(shapeSizeは半分の大きさ)
+    kEmitterShapeSphere, //!< 球の中(shapeSize.xが半径)
+    kCountOfEmitterShape,
+};
+
 struct Emitter {
     //!< エミッタのトランスフォーム
     Transform transform;
     //!< 発生数
-    uint32_t count; 
+    uint32_t count = 3;
     //!< 発生頻度
-    float frequency;
+    float frequency = 0.5f;
     //<! 頻度用時刻
-    float frequencyTime;
+    float frequencyTime = 0.0f;
+
+    //!< 発生範囲の形
+    EmitterShape shape = EmitterShape::kEmitterShapeBox;
+    //!< 発生範囲の大きさ
+    Vector3 shapeSize{ 1.0f,1.0f,1.0f };
+    //!< 初速の範囲
+    Vector3 velocityMin{ -1.0f,-1.0f,-1.0f };
+    Vector3 velocityMax{ 1.0f,1.0f,1.0f };
+    //!< 色の範囲
+    Vector4 colorMin{ 0.0f,0.0f,0.0f,1.0f };
+    Vector4 colorMax{ 1.0f,1.0f,1.0f,1.0f };
+    //!< 生存時間の範囲
+    float lifeTimeMin = 1.0f;
+    float lifeTimeMax = 3.0f;
+    //!< 開始時にまとめて発生させる数
+    uint32_t burstCount = 0;
+    //!< 発生させるか
+    bool isActive = true;
 
-};
\ No newline at end of file
+    //!< 乱数のシード(0ならマネージャが登録順から決める)
+    uint64_t seed = 0;
+    //!< これまでに発生させた数(k番目のパーティクルの乱数カウンタ)
+    uint64_t spawnedCount = 0;
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+// インデックスバッファの一部(DrawIndexedInstancedに渡す範囲)
+struct IndexRange {
+    uint32_t startIndex = 0;
+    uint32_t indexCount = 0;
+};
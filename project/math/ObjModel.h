@@ -6,7 +6,10 @@
 #include "Matrix4x4.h"
 #include "VertexData.h"
 #include "ModelData.h"
+#include "shape/Sphere.h"
+#include "shape/OBB.h"
 #include "../function/Math.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -29,11 +32,65 @@ struct ObjMaterial {
     std::string textureFilePath = "";
 };
 
+// 簡略化した形(頂点は元のメッシュのものを添字で参照する)
+struct ObjMeshLod {
+    std::vector<uint32_t> indices;
+    // 元の形からのずれ(メッシュの大きさに対する割合)
+    float error = 0.0f;
+};
+
+// 三角形の塊(meshlet)。indicesの中の続いた範囲で、塊ごとに見えるかを判定して描く範囲を減らす
+struct ObjMeshlet {
+    // indicesの中の範囲
+    uint32_t indexOffset = 0;
+    uint32_t indexCount = 0;
+    // 使っている頂点の数
+    uint32_t vertexCount = 0;
+    // 包む球(ローカル座標)
+    Vector3 center = { 0.0f, 0.0f, 0.0f };
+    float radius = 0.0f;
+    // 法線の円錐。カメラから頂点(apex)への向きと軸の内積がconeCutoff以上なら全部裏向き
+    Vector3 coneApex = { 0.0f, 0.0f, 0.0f };
+    Vector3 coneAxis = { 0.0f, 0.0f, 0.0f };
+    // 1なら法線がばらばらで裏向きの判定はできない
+    float coneCutoff = 1.0f;
+};
+
 struct ObjMesh {
+    // マテリアルが無い時の番号
+    static inline const uint32_t kNoMaterial = UINT32_MAX;
+
+    // 重複のない頂点
     std::vector<VertexData> vertices;
-    ObjMaterial material;
+    // 法線マップ用の接線(verticesと同じ並び。xyzが接線、wが従法線の向き ±1。作っていなければ空)
+    std::vector<Vector4> tangents;
+    // 三角形リストの添字(3つで1枚)
+    std::vector<uint32_t> indices;
+    // ObjModel::materialsの番号(kNoMaterialなら既定のマテリアル。ObjModel::GetMaterialで引く)
+    uint32_t materialIndex = kNoMaterial;
+    // 頂点を囲む箱(ローカル座標)
+    Vector3 boundsMin = { 0.0f, 0.0f, 0.0f };
+    Vector3 boundsMax = { 0.0f, 0.0f, 0.0f };
+    // 頂点を包む球(ローカル座標)
+    Sphere boundingSphere = { { 0.0f, 0.0f, 0.0f }, 0.0f };
+    // 頂点を囲む向きを合わせた箱(ローカル座標。作っていなければ上の箱と同じ)
+    OBB orientedBounds = { { 0.0f, 0.0f, 0.0f }, { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } }, { 0.0f, 0.0f, 0.0f } };
+    // 詳細度(粗い順。どれもverticesを共有する)
+    std::vector<ObjMeshLod> lods;
+    // 三角形の塊(indicesの並びに沿って続いている)
+    std::vector<ObjMeshlet> meshlets;
+    // 穴のない閉じた形か(表示用。裏面はパイプラインが描かないので、塊の裏向き判定は閉じていなくても使える)
+    bool isClosed = false;
 };
 
 struct ObjModel {
+    // メッシュが使うマテリアル(同じマテリアルのメッシュは同じ番号を指す)
+    std::vector<ObjMaterial> materials;
     std::vector<ObjMesh> meshes;
+
+    // メッシュのマテリアル
+    const ObjMaterial& GetMaterial(const ObjMesh& mesh) const {
+        static const ObjMaterial kDefaultMaterial{};
+        return mesh.materialIndex < materials.size() ? materials[mesh.materialIndex] : kDefaultMaterial;
+    }
 };
\ No newline at end of file
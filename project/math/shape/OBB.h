@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+#include "../Vector3.h"
+
+//OBB(Oriented Bounding Box)
+struct OBB {
+    //!< 中心点
+    Vector3 center{0.0f, 0.0f, 0.0f};
+    //!< 座標軸。正規化・直交必須
+    Vector3 orientations[3] = { {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f} };
+    //!< 座標軸方向の長さの半分。中心から面までの距離
+    Vector3 size{1.0f, 1.0f, 1.0f};
+};
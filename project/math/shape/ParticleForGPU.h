@@ -1,13 +1,32 @@
 #pragma once
 
+#include "../Vector2.h"
 #include "../Vector3.h"
 #include "../Vector4.h"
-#include "../Transform.h"
+#include "../Matrix4x4.h"
+#include <cstdint>
 
+// インスタンスごとにGPUへ送るデータ(32byte)
+// ビルボードとViewProjectionはParticle.VS.hlslで描画ごとに1回だけ適用する
 struct ParticleForGPU
 {
-    Matrix4x4 WVP;
-    Matrix4x4 world;
-    Vector4 color;
+    //!< 位置
+    Vector3 translate;
+    //!< 色(RGBA8。下位バイトからR,G,B,A)
+    uint32_t color;
+    //!< 拡縮(板ポリなのでxyのみ)
+    Vector2 scale;
+    //!< Z軸回転(ラジアン)
+    float rotate;
+    float padding;
+};
+
+// 描画ごとにGPUへ送るデータ
+struct ParticleViewForGPU
+{
+    //!< View * Projection
+    Matrix4x4 viewProjection;
+    //!< ビルボード行列(ビルボードしない場合は単位行列)
+    Matrix4x4 billboard;
 };
 
@@ -6,16 +6,34 @@
 
 struct ParticleForGPU
 {
-	float32_t4x4 WVP;
+	float32_t3 translate;
 	
-	/*LambertianReflectance*/
+	// RGBA8(下位バイトからR,G,B,A)
+	uint32_t color;
+	
+	float32_t2 scale;
 	
-	float32_t4x4 World;
+	// Z軸回転
+	float rotate;
 	
-	float32_t4 color;
+	float padding;
 };
 StructuredBuffer<ParticleForGPU> gParticle : register(t0);
 
+// 描画ごとに1回だけ送る行列
+struct ParticleView
+{
+	float32_t4x4 viewProjection;
+	
+	float32_t4x4 billboard;
+};
+ConstantBuffer<ParticleView> gParticleView : register(b0);
+
+float32_t4 UnpackColor(uint32_t color)
+{
+	return float32_t4(color & 0xFF, (color >> 8) & 0xFF, (color >> 16) & 0xFF, color >> 24) / 255.0f;
+}
+
 struct VertexShaderInput
 {
 	float32_t4 position : POSITION0;
@@ -41,7 +59,16 @@ VertexShaderOutput main(VertexShaderInput input, uint32_t instanced : SV_Instanc
 	
 	/*三角形を動かそう*/
 	
-	output.position = mul(input.position, gParticle[instanced].WVP);
+	ParticleForGPU particle = gParticle[instanced];
+	
+	// scale → Z軸回転 → ビルボード → 平行移動 の順にワールドへ
+	float32_t2 local = input.position.xy * particle.scale;
+	float s = sin(particle.rotate);
+	float c = cos(particle.rotate);
+	local = float32_t2(local.x * c - local.y * s, local.x * s + local.y * c);
+	float32_t3 world = mul(float32_t4(local, 0.0f, 0.0f), gParticleView.billboard).xyz + particle.translate;
+	
+	output.position = mul(float32_t4(world, 1.0f), gParticleView.viewProjection);
 	
 	/*テクスチャを貼ろう*/
 	
@@ -54,7 +81,7 @@ VertexShaderOutput main(VertexShaderInput input, uint32_t instanced : SV_Instanc
 	
 	///法線の座標系を変換してPixelShaderに送る
 	
-	output.color = gParticle[instanced].color;
+	output.color = UnpackColor(particle.color);
 	
 	/*三角形を表示しよう*/
 
@@ -47,7 +47,7 @@ void GameScene::Initialize(IrufemiEngine* engine) {
 
     if (isActiveObj_) {
         obj = std::make_unique <ObjClass>();
-        obj->Initialize(camera_.get());
+        obj->InitializeAsync(camera_.get());
     }
     if (isActiveSprite_) {
         sprite = std::make_unique <Sprite>();
@@ -63,35 +63,35 @@ void GameScene::Initialize(IrufemiEngine* engine) {
     }
     if (isActiveStanfordBunny_) {
         stanfordBunny = std::make_unique <ObjClass>();
-        stanfordBunny->Initialize(camera_.get(), "bunny.obj");
+        stanfordBunny->InitializeAsync(camera_.get(), "bunny.obj");
     }
     if (isActiveUtashTeapot_) {
         utashTeapot = std::make_unique <ObjClass>();
-        utashTeapot->Initialize(camera_.get(), "teapot.obj");
+        utashTeapot->InitializeAsync(camera_.get(), "teapot.obj");
     }
     if (isActiveMultiMesh_) {
         multiMesh = std::make_unique <ObjClass>();
-        multiMesh->Initialize(camera_.get(), "multiMesh.obj");
+        multiMesh->InitializeAsync(camera_.get(), "multiMesh.obj");
     }
     if (isActiveMultiMaterial_) {
         multiMaterial = std::make_unique <ObjClass>();
-        multiMaterial->Initialize(camera_.get(), "multiMaterial.obj");
+        multiMaterial->InitializeAsync(camera_.get(), "multiMaterial.obj");
     }
     if (isActiveSuzanne_) {
         suzanne = std::make_unique <ObjClass>();
-        suzanne->Initialize(camera_.get(), "suzanne.obj");
+        suzanne->InitializeAsync(camera_.get(), "suzanne.obj");
     }
     if (isActiveFence_) {
         fence_ = std::make_unique <ObjClass>();
-        fence_->Initialize(camera_.get(), "fence.obj");
+        fence_->InitializeAsync(camera_.get(), "fence.obj");
     }
     if (isActiveTerrain_) {
         terrain_ = std::make_unique <ObjClass>();
-        terrain_->Initialize(camera_.get(), "terrain.obj");
+        terrain_->InitializeAsync(camera_.get(), "terrain.obj");
     }
     if (isActiveParticle_) {
         particle = std::make_unique <ParticleClass>();
-        particle->Initialize(engine_->GetSrvDescriptorHeap(), camera_.get(), engine_->GetTextureManager(), engine_->GetDebugUI(), "resources/circle.png");
+        particle->Initialize(engine_->GetSrvDescriptorHeap(), camera_.get(), engine_->GetTextureManager(), engine_->GetDebugUI(), "resources/circle.png", "resources/particle/default.effect");
     }
 
     bgm = std::make_unique<Bgm>();
@@ -155,7 +155,7 @@ void GameScene::Update() {
     if (isActiveObj_) {
         if (!obj) {
             obj = std::make_unique<ObjClass>();
-            obj->Initialize(camera_.get());
+            obj->InitializeAsync(camera_.get());
         }
         obj->Update("Plane");
     }
@@ -176,49 +176,49 @@ void GameScene::Update() {
     if (isActiveUtashTeapot_) {
         if (!utashTeapot) {
             utashTeapot = std::make_unique<ObjClass>();
-            utashTeapot->Initialize(camera_.get(), "teapot.obj");
+            utashTeapot->InitializeAsync(camera_.get(), "teapot.obj");
         }
         utashTeapot->Update("Utash Teapot");
     }
     if (isActiveStanfordBunny_) {
         if (!stanfordBunny) {
             stanfordBunny = std::make_unique<ObjClass>();
-            stanfordBunny->Initialize(camera_.get(), "bunny.obj");
+            stanfordBunny->InitializeAsync(camera_.get(), "bunny.obj");
         }
         stanfordBunny->Update("Stanford Bunny");
     }
     if (isActiveMultiMesh_) {
         if (!multiMesh) {
             multiMesh = std::make_unique<ObjClass>();
-            multiMesh->Initialize(camera_.get(), "multiMesh.obj");
+            multiMesh->InitializeAsync(camera_.get(), "multiMesh.obj");
         }
         multiMesh->Update("MultiMesh");
     }
     if (isActiveMultiMaterial_) {
         if (!multiMaterial) {
             multiMaterial = std::make_unique<ObjClass>();
-            multiMaterial->Initialize(camera_.get(), "multiMaterial.obj");
+            multiMaterial->InitializeAsync(camera_.get(), "multiMaterial.obj");
         }
         multiMaterial->Update("MultiMaterial");
     }
     if (isActiveSuzanne_) {
         if (!suzanne) {
             suzanne = std::make_unique<ObjClass>();
-            suzanne->Initialize(camera_.get(), "suzanne.obj");
+            suzanne->InitializeAsync(camera_.get(), "suzanne.obj");
         }
         suzanne->Update("Suzanne");
     }
     if (isActiveFence_) {
         if (!fence_) {
             fence_ = std::make_unique<ObjClass>();
-            fence_->Initialize(camera_.get(), "fence.obj");
+            fence_->InitializeAsync(camera_.get(), "fence.obj");
         }
         fence_->Update("Fence");
     }
     if (isActiveTerrain_) {
         if (!terrain_) {
             terrain_ = std::make_unique<ObjClass>();
-            terrain_->Initialize(camera_.get(), "terrain.obj");
+            terrain_->InitializeAsync(camera_.get(), "terrain.obj");
         }
         terrain_->Update("Terrain");
     }
@@ -13,15 +13,20 @@ uint32_t Texture::index_ = 0;
 
 void Texture::Initialize(const std::string& filePath) {
 
-    index_ += 1;
-
-    this->filePath_ = filePath;
-
     /*テクスチャを貼ろう*/
 
     ///組み合わせて使う
     //textureを読んで転送する
-    DirectX::ScratchImage mipImages = dxCommon_->LoadTexture(filePath_);
+    const DirectX::ScratchImage mipImages = dxCommon_->LoadTexture(filePath);
+    Initialize(filePath, mipImages);
+}
+
+void Texture::Initialize(const std::string& filePath, const DirectX::ScratchImage& mipImages) {
+
+    index_ += 1;
+
+    this->filePath_ = filePath;
+
     const DirectX::TexMetadata& metadata = mipImages.GetMetadata();
 
     // メタデータから元サイズを保持
@@ -6,6 +6,7 @@
 
 // 前方宣言
 class DirectXCommon;
+namespace DirectX { class ScratchImage; }
 
 class Texture {
 protected:
@@ -39,6 +40,11 @@ public:
     //初期化
     void Initialize(const std::string& filePath);
 
+    /// <summary>
+    /// デコード済みの画像で初期化する(デコードはワーカーで済ませ、転送とSRVの生成だけをメインスレッドで行う時)
+    /// </summary>
+    void Initialize(const std::string& filePath, const DirectX::ScratchImage& mipImages);
+
     //ゲッター
 
     D3D12_GPU_DESCRIPTOR_HANDLE GetTextureSrvHandleGPU() { return textureSrvHandleGPU_; }
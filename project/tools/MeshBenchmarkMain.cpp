@@ -0,0 +1,1046 @@
+// メッシュ読み込みのヘッドレス計測・集計(D3D12のデバイスなしで動く)
+// ゲーム本体とは別の実行ファイルなのでTD2_01.vcxprojには含めない
+//
+// Linuxでのビルド例(projectディレクトリで):
+//   g++ -std=c++20 -O2 -pthread -I. tools/MeshBenchmarkMain.cpp 3D/mesh/*.cpp engine/JobSystem.cpp function/Math.cpp function/Ease.cpp "math/Vector3 .cpp" -o mesh_benchmark
+//
+// 使い方:
+//   mesh_benchmark [--dir path] [--cache] [--lod] [--meshlet] [--normals] [--bounds] [--async] [--glb] [--shared instances] [--scaling faces]
+//   --dir    objを探すディレクトリ(既定は resources/obj)。見つかった .obj をすべて読み、
+//            添字化による頂点数の削減とメモリの差と、MeshOptimizerの前後のACMR/ATVR(FIFO 16)を表示する
+//   --cache  バイナリキャッシュ(MeshCache)を作り直した時と、それを読んだ時の時間も表示する
+//            (objの横に .meshcache が書かれる)
+//            最後にmtlを解析した回数と、解析せずに使い回した回数(MaterialLibraryCache)も表示する
+//   --lod    MeshSimplifierで作った詳細度ごとの三角形数・二次誤差・元の頂点からの距離(大きさに対する割合)と作る時間を表示する
+//            (距離は総当たりなので、大きいメッシュでは省く)
+//   --meshlet MeshletBuilderで作った塊の数・埋まり具合・包む球の大きさ・円錐が使える割合と作る時間、
+//            周りに置いたカメラから見た時にMeshletCullingで外せた割合と判定の時間を表示する
+//            (外した塊が本当に見えないか=全頂点が同じ平面の外・全三角形が裏向き かも確かめる)
+//   --normals 法線を消してMeshNormalsで作り直す時間と接線を作る時間を、順に処理した時と並列(スレッド数を倍々)で比べる
+//            (並列でも結果が同じか、元の法線とのずれの平均角度、接線が法線に直交しているかも表示する)
+//   --bounds MeshBoundsで包む形(箱・球・向きを合わせた箱)を作る時間と、球・箱が軸に沿った箱に比べてどれだけ小さいかを表示する
+//            (すべての頂点が中に入っているかを、ワールド行列で変換した後も確かめる)
+//   --async  AsyncModelLoaderで全モデルを読み、メインスレッドが止まった時間(Loadを積む時間・Pollの最長)と
+//            フレーム数、結果が同期の読み込みと同じか、取り消したものが知らされないかを表示する
+//            (キャッシュを消して解析から行う時と、キャッシュを読む時の2回)
+//   --glb    objと同じ内容の .glb を横に書き、ObjParserで読んだ時とGlbLoaderで読んだ時の時間とファイルの大きさを比べる
+//            (結果が同じか、MeshCacheを通しても同じか、壊れたglbでも落ちないかも確かめる)
+//            LoadObjFileAssimpMとの比較はAssimpが要るので、ObjClassのデバッグ表示の Measure Load で行う
+//   --shared 全モデルをそれぞれ指定した数ずつAsyncModelLoaderで読み、MeshAssetCacheで共有した時としない時の
+//            ファイルを読んだ回数・時間・メッシュのメモリを比べる(キャッシュを消して解析から行う)
+//            (共有したものが同じモデルか、複数のスレッドから同時に同じファイルを読んでも1回で済み、キャッシュが壊れないかも確かめる)
+//   --scaling 指定した面数の合成objを一時ディレクトリに作り、順に読んだ時と並列(スレッド数を倍々)で読んだ時を比べる
+//             (例: --scaling 10000000)
+
+#include "../3D/mesh/ObjParser.h"
+#include "../3D/mesh/MeshCache.h"
+#include "../3D/mesh/MeshOptimizer.h"
+#include "../3D/mesh/MeshSimplifier.h"
+#include "../3D/mesh/MeshletBuilder.h"
+#include "../3D/mesh/MeshletCulling.h"
+#include "../3D/mesh/MeshNormals.h"
+#include "../3D/mesh/AsyncModelLoader.h"
+#include "../3D/mesh/MeshAssetCache.h"
+#include "../3D/mesh/MaterialLibrary.h"
+#include "../3D/mesh/GlbLoader.h"
+#include "../3D/mesh/MeshBounds.h"
+#include "../function/Math.h"
+#include "../engine/JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    // 格子状の合成objを書く(面数はfaceCount以上。64行ごとにusemtlを切り替える)
+    void WriteSyntheticObj(const std::string& path, size_t faceCount) {
+        size_t cells = 1;
+        while (cells * cells * 2 < faceCount) {
+            ++cells;
+        }
+        const size_t side = cells + 1;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        std::string line;
+        char buffer[128];
+        for (size_t z = 0; z < side; ++z) {
+            for (size_t x = 0; x < side; ++x) {
+                const float height = static_cast<float>((x * 7 + z * 13) % 17) * 0.05f;
+                std::snprintf(buffer, sizeof(buffer), "v %zu %.2f %zu\nvt %.4f %.4f\n", x, height, z,
+                    static_cast<float>(x) / cells, static_cast<float>(z) / cells);
+                line += buffer;
+            }
+            file << line;
+            line.clear();
+        }
+        file << "vn 0 1 0\n";
+
+        size_t written = 0;
+        for (size_t z = 0; z < cells && written < faceCount; ++z) {
+            if (z % 64 == 0) {
+                std::snprintf(buffer, sizeof(buffer), "usemtl ground%zu\n", (z / 64) % 4);
+                line += buffer;
+            }
+            for (size_t x = 0; x < cells && written < faceCount; ++x) {
+                const size_t a = z * side + x + 1;
+                const size_t b = a + 1;
+                const size_t c = a + side;
+                const size_t d = c + 1;
+                std::snprintf(buffer, sizeof(buffer), "f %zu/%zu/1 %zu/%zu/1 %zu/%zu/1\nf %zu/%zu/1 %zu/%zu/1 %zu/%zu/1\n",
+                    a, a, c, c, b, b, b, b, c, c, d, d);
+                line += buffer;
+                written += 2;
+            }
+            file << line;
+            line.clear();
+        }
+    }
+
+    // 合成objで順に読んだ時と並列で読んだ時を比べる
+    int RunScaling(size_t faceCount) {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path();
+        const std::string filename = "mesh_scaling.obj";
+        const std::string path = (directory / filename).string();
+
+        auto start = std::chrono::steady_clock::now();
+        WriteSyntheticObj(path, faceCount);
+        std::printf("generate      : %zu faces, %.1f MB, %.0f ms\n", faceCount,
+            std::filesystem::file_size(path) / (1024.0 * 1024.0),
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+        std::string text;
+        {
+            std::ifstream file(path, std::ios::binary);
+            text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+
+        start = std::chrono::steady_clock::now();
+        const ObjModel reference = ObjParser::Parse(text, directory.string());
+        const double sequentialMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::printf("sequential    : %.0f ms\n", sequentialMs);
+
+        std::unique_ptr<JobSystem> jobSystem = std::make_unique<JobSystem>();
+        jobSystem->Initialize();
+        int exitCode = 0;
+        for (uint32_t threads = 1;; threads *= 2) {
+            threads = (std::min)(threads, jobSystem->GetThreadCount());
+            start = std::chrono::steady_clock::now();
+            const ObjModel model = ObjParser::ParseParallel(text, directory.string(), jobSystem.get(), threads);
+            const double parallelMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            const bool isSame = ObjParser::IsSame(reference, model);
+            std::printf("parallel x%-3u: %.0f ms (x%.2f) %s\n", threads, parallelMs, sequentialMs / parallelMs, isSame ? "(same)" : "(DIFFERENT)");
+            if (!isSame) {
+                exitCode = 1;
+            }
+            if (threads >= jobSystem->GetThreadCount()) {
+                break;
+            }
+        }
+        jobSystem->Finalize();
+
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return exitCode;
+    }
+
+    // 総当たりの距離計測をする上限(元の頂点数×詳細度の三角形数)
+    const size_t kMaxDistanceWork = 200000000;
+
+    // 詳細度を作って三角形数とずれを表示する
+    void PrintLods(const ObjModel& model) {
+        for (size_t m = 0; m < model.meshes.size(); ++m) {
+            ObjMesh mesh = model.meshes[m];
+            const auto start = std::chrono::steady_clock::now();
+            MeshSimplifier::GenerateLods(mesh);
+            const double lodMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            std::printf("%-20s mesh[%zu] lod: %zu tris", "", m, mesh.indices.size() / 3);
+            for (const ObjMeshLod& lod : mesh.lods) {
+                std::printf(" -> %zu (error %.4f", lod.indices.size() / 3, lod.error);
+                if (mesh.vertices.size() * (lod.indices.size() / 3) <= kMaxDistanceWork) {
+                    std::printf(" distance %.4f", MeshSimplifier::MeasureDistance(mesh.vertices, mesh.indices, lod.indices));
+                }
+                std::printf(")");
+            }
+            std::printf(" %.2f ms\n", lodMs);
+        }
+    }
+
+    // 塊の判定を試すカメラの数(周りに散らばらせる)と、大きさに対する距離
+    const int kCullCameraCount = 64;
+    const float kCullCameraDistances[] = { 0.6f, 1.5f };
+
+    // 外した塊が本当に見えないか
+    bool IsCullConservative(const ObjMesh& mesh, const ObjMeshlet& meshlet, const Matrix4x4& worldViewProjection, const Vector3& cameraPosition, bool isBackface) {
+        const uint32_t end = meshlet.indexOffset + meshlet.indexCount;
+        if (isBackface) {
+            // 全三角形がカメラに裏を向けている(時計回りが表)
+            for (uint32_t i = meshlet.indexOffset; i < end; i += 3) {
+                const Vector4& pa = mesh.vertices[mesh.indices[i]].position;
+                const Vector4& pb = mesh.vertices[mesh.indices[i + 1]].position;
+                const Vector4& pc = mesh.vertices[mesh.indices[i + 2]].position;
+                const Vector3 a = { pa.x, pa.y, pa.z };
+                const Vector3 normal = Math::Cross(Vector3{ pb.x, pb.y, pb.z } - a, Vector3{ pc.x, pc.y, pc.z } - a);
+                if (Math::Dot(normal, cameraPosition - a) > 1e-4f * Math::Length(normal) * Math::Length(cameraPosition - a)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        // 全頂点が同じクリップ平面の外
+        for (int plane = 0; plane < 6; ++plane) {
+            bool isAllOutside = true;
+            for (uint32_t i = meshlet.indexOffset; i < end && isAllOutside; ++i) {
+                const Vector4& p = mesh.vertices[mesh.indices[i]].position;
+                float clip[4];
+                for (int j = 0; j < 4; ++j) {
+                    const Matrix4x4& m = worldViewProjection;
+                    clip[j] = p.x * m.m[0][j] + p.y * m.m[1][j] + p.z * m.m[2][j] + m.m[3][j];
+                }
+                const float distances[6] = { clip[3] + clip[0], clip[3] - clip[0], clip[3] + clip[1], clip[3] - clip[1], clip[2], clip[3] - clip[2] };
+                isAllOutside = distances[plane] < 0.0f;
+            }
+            if (isAllOutside) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 塊を作って出来を表示し、周りのカメラから外せた割合を測る
+    void PrintMeshlets(const ObjModel& model) {
+        for (size_t m = 0; m < model.meshes.size(); ++m) {
+            ObjMesh mesh = model.meshes[m];
+            MeshOptimizer::Optimize(mesh);
+            const float acmrBefore = MeshOptimizer::AnalyzeVertexCache(mesh.indices, mesh.vertices.size()).acmr;
+            const auto start = std::chrono::steady_clock::now();
+            MeshletBuilder::Build(mesh);
+            const double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            const float acmrAfter = MeshOptimizer::AnalyzeVertexCache(mesh.indices, mesh.vertices.size()).acmr;
+            const MeshletBuilder::BuildStats stats = MeshletBuilder::Analyze(mesh);
+            std::printf("%-20s mesh[%zu] meshlet: %zu (verts %.1f %.0f%%, tris %.1f %.0f%%) radius %.3f cone %.0f%% dup %.2f ACMR %.3f -> %.3f %s %.2f ms\n",
+                "", m, stats.meshletCount, stats.averageVertices, stats.vertexFill * 100.0f, stats.averageTriangles, stats.triangleFill * 100.0f,
+                stats.averageRadius, stats.coneRatio * 100.0f, stats.vertexDuplication, acmrBefore, acmrAfter, mesh.isClosed ? "closed" : "open", buildMs);
+            if (mesh.meshlets.empty()) {
+                continue;
+            }
+
+            // 包む箱の中心を見るカメラを球面上に散らばらせる(黄金角の螺旋)
+            const Vector3 center = (mesh.boundsMin + mesh.boundsMax) * 0.5f;
+            const float extent = (std::max)(Math::Length(mesh.boundsMax - mesh.boundsMin), 1e-3f);
+            const Matrix4x4 projection = Math::MakePerspectiveFovMatrix(0.45f, 16.0f / 9.0f, 0.1f * extent, 100.0f * extent);
+            std::vector<IndexRange> visibleRanges;
+            for (float distanceScale : kCullCameraDistances) {
+                size_t frustumCulled = 0;
+                size_t backfaceCulled = 0;
+                size_t visibleIndices = 0;
+                bool isConservative = true;
+                double cullMs = 0.0;
+                for (int c = 0; c < kCullCameraCount; ++c) {
+                    const float y = 1.0f - 2.0f * (c + 0.5f) / kCullCameraCount;
+                    const float pitch = std::asin(y);
+                    const float yaw = 2.39996323f * c;
+                    // 回転させた+Zが視線(中心を向く)
+                    const Matrix4x4 rotate = Math::MakeRotateXYZMatrix(pitch, yaw, 0.0f);
+                    const Vector3 forward = Math::Transform(Vector3{ 0.0f, 0.0f, 1.0f }, rotate);
+                    const Vector3 cameraPosition = center - forward * (extent * distanceScale);
+                    const Matrix4x4 view = Math::Inverse(Math::MakeAffineMatrix({ 1.0f, 1.0f, 1.0f }, { pitch, yaw, 0.0f }, cameraPosition));
+                    const Matrix4x4 worldViewProjection = Math::Multiply(view, projection);
+
+                    const auto cullStart = std::chrono::steady_clock::now();
+                    const MeshletCulling::Frustum frustum = MeshletCulling::MakeFrustum(worldViewProjection);
+                    const MeshletCulling::CullStats cull = MeshletCulling::Cull(mesh.meshlets, frustum, cameraPosition, true, visibleRanges);
+                    cullMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cullStart).count();
+                    frustumCulled += cull.frustumCulledCount;
+                    backfaceCulled += cull.backfaceCulledCount;
+                    visibleIndices += cull.visibleIndexCount;
+
+                    for (const ObjMeshlet& meshlet : mesh.meshlets) {
+                        if (MeshletCulling::IsOutside(meshlet, frustum)) {
+                            isConservative = isConservative && IsCullConservative(mesh, meshlet, worldViewProjection, cameraPosition, false);
+                        } else if (MeshletCulling::IsBackFacing(meshlet, cameraPosition)) {
+                            isConservative = isConservative && IsCullConservative(mesh, meshlet, worldViewProjection, cameraPosition, true);
+                        }
+                    }
+                }
+                const double total = static_cast<double>(mesh.meshlets.size()) * kCullCameraCount;
+                std::printf("%-20s   cull at %.1fx: frustum %.1f%% backface %.1f%% tris drawn %.1f%% %.4f ms/view %s\n", "", distanceScale,
+                    100.0 * frustumCulled / total, 100.0 * backfaceCulled / total,
+                    100.0 * visibleIndices / (static_cast<double>(mesh.indices.size()) * kCullCameraCount),
+                    cullMs / kCullCameraCount, isConservative ? "(conservative)" : "(WRONG)");
+            }
+        }
+    }
+
+    // 法線と接線を作る時間を、順に処理した時と並列の時で比べる
+    void PrintNormals(const ObjModel& model, JobSystem* jobSystem) {
+        for (size_t m = 0; m < model.meshes.size(); ++m) {
+            const ObjMesh& original = model.meshes[m];
+            const bool hasNormals = !MeshNormals::HasMissingNormals(original);
+            ObjMesh stripped = original;
+            for (VertexData& vertex : stripped.vertices) {
+                vertex.normal = { 0.0f, 0.0f, 0.0f };
+            }
+
+            // 順に処理したものを基準にする
+            ObjMesh reference = stripped;
+            auto start = std::chrono::steady_clock::now();
+            MeshNormals::GenerateNormals(reference);
+            const double normalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            start = std::chrono::steady_clock::now();
+            MeshNormals::GenerateTangents(reference);
+            const double tangentMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::printf("%-20s mesh[%zu] normals: serial %.2f ms + tangents %.2f ms", "", m, normalMs, tangentMs);
+
+            bool isSame = true;
+            for (uint32_t threads = 2;; threads *= 2) {
+                threads = (std::min)(threads, jobSystem->GetThreadCount());
+                ObjMesh mesh = stripped;
+                start = std::chrono::steady_clock::now();
+                MeshNormals::GenerateNormals(mesh, jobSystem, false, threads);
+                const double parallelNormalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                start = std::chrono::steady_clock::now();
+                MeshNormals::GenerateTangents(mesh, jobSystem, threads);
+                const double parallelTangentMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                std::printf(" | x%u %.2f + %.2f ms", threads, parallelNormalMs, parallelTangentMs);
+                isSame = isSame && std::memcmp(mesh.vertices.data(), reference.vertices.data(), sizeof(VertexData) * mesh.vertices.size()) == 0 &&
+                    std::memcmp(mesh.tangents.data(), reference.tangents.data(), sizeof(Vector4) * mesh.tangents.size()) == 0;
+                if (threads == jobSystem->GetThreadCount()) {
+                    break;
+                }
+            }
+            std::printf(" %s\n", isSame ? "(same)" : "(DIFFERENT)");
+
+            // 元の法線とのずれ(角の立ったメッシュは元が面ごとの法線なので大きくなる)と、接線の直交
+            double deviationSum = 0.0;
+            float maxTangentDot = 0.0f;
+            for (size_t v = 0; v < reference.vertices.size(); ++v) {
+                const Vector3& normal = reference.vertices[v].normal;
+                if (hasNormals) {
+                    const float dot = Math::Dot(normal, Math::Normalize(original.vertices[v].normal));
+                    deviationSum += std::acos((std::clamp)(dot, -1.0f, 1.0f));
+                }
+                const Vector4& tangent = reference.tangents[v];
+                maxTangentDot = (std::max)(maxTangentDot, std::fabs(Math::Dot(normal, Vector3{ tangent.x, tangent.y, tangent.z })));
+            }
+            std::printf("%-20s   ", "");
+            if (hasNormals && !reference.vertices.empty()) {
+                std::printf("deviation from authored %.2f deg, ", deviationSum / reference.vertices.size() * 180.0 / 3.14159265358979);
+            }
+            std::printf("max |dot(normal, tangent)| %.2e\n", maxTangentDot);
+        }
+    }
+
+    // 非同期で読む時にメインスレッドが止まる時間を測る(1フレームに1件ずつ知らせを受ける)
+    int RunAsync(const std::string& directoryPath, const std::vector<std::string>& filenames) {
+        std::unique_ptr<JobSystem> jobSystem = std::make_unique<JobSystem>();
+        jobSystem->Initialize();
+        int exitCode = 0;
+
+        for (int pass = 0; pass < 2; ++pass) {
+            const bool isCold = pass == 0;
+            if (isCold) {
+                for (const std::string& filename : filenames) {
+                    std::error_code ec;
+                    std::filesystem::remove(MeshCache::GetCachePath(directoryPath, filename), ec);
+                }
+            }
+
+            AsyncModelLoader loader;
+            loader.Initialize(jobSystem.get());
+            std::vector<MeshAssetCache::Handle> loaded(filenames.size());
+            size_t loadedCount = 0;
+
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < filenames.size(); ++i) {
+                loader.Load(directoryPath, filenames[i], [&, i](AsyncModelLoader::Request& request) {
+                    loaded[i] = request.GetAsset();
+                    ++loadedCount;
+                });
+            }
+            const double submitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            // 1ms待つのを1フレームとみなす
+            size_t frameCount = 0;
+            double maxPollMs = 0.0;
+            const auto loopStart = std::chrono::steady_clock::now();
+            while (loader.GetPendingCount() > 0) {
+                start = std::chrono::steady_clock::now();
+                loader.Poll(1);
+                maxPollMs = (std::max)(maxPollMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+                ++frameCount;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            const double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loopStart).count();
+
+            // 同期で読んだものと比べる(キャッシュは今の読み込みで書かれている)
+            bool isSame = loadedCount == filenames.size();
+            for (size_t i = 0; i < filenames.size() && isSame; ++i) {
+                isSame = ObjParser::IsSame(loaded[i]->model, MeshCache::LoadFile(directoryPath, filenames[i]));
+            }
+            std::printf("async %-5s: %zu models, submit %.3f ms, max poll %.3f ms, %zu frames, %.1f ms %s\n", isCold ? "cold" : "warm",
+                filenames.size(), submitMs, maxPollMs, frameCount, totalMs, isSame ? "(same)" : "(DIFFERENT)");
+            exitCode = isSame ? exitCode : 1;
+        }
+
+        // 取り消したものは知らされない
+        if (!filenames.empty()) {
+            AsyncModelLoader loader;
+            loader.Initialize(jobSystem.get());
+            bool isCalled = false;
+            const std::shared_ptr<AsyncModelLoader::Request> request = loader.Load(directoryPath, filenames[0], [&](AsyncModelLoader::Request&) { isCalled = true; });
+            request->Cancel();
+            loader.WaitAll();
+            std::printf("async cancel: %s\n", !isCalled && loader.GetPendingCount() == 0 ? "(ok)" : "(WRONG)");
+            exitCode = isCalled ? 1 : exitCode;
+        }
+
+        jobSystem->Finalize();
+        return exitCode;
+    }
+    // モデルのCPU側のメッシュのメモリ(頂点・添字・詳細度・塊・接線)
+    size_t GetModelBytes(const ObjModel& model) {
+        size_t bytes = 0;
+        for (const ObjMesh& mesh : model.meshes) {
+            bytes += sizeof(VertexData) * mesh.vertices.size() + sizeof(uint32_t) * mesh.indices.size();
+            bytes += sizeof(ObjMeshlet) * mesh.meshlets.size() + sizeof(Vector4) * mesh.tangents.size();
+            for (const ObjMeshLod& lod : mesh.lods) {
+                bytes += sizeof(uint32_t) * lod.indices.size();
+            }
+        }
+        return bytes;
+    }
+
+    int RunShared(const std::string& directoryPath, const std::vector<std::string>& filenames, size_t instanceCount) {
+        std::unique_ptr<JobSystem> jobSystem = std::make_unique<JobSystem>();
+        jobSystem->Initialize();
+        int exitCode = 0;
+
+        for (int pass = 0; pass < 2; ++pass) {
+            const bool isShared = pass == 1;
+            for (const std::string& filename : filenames) {
+                std::error_code ec;
+                std::filesystem::remove(MeshCache::GetCachePath(directoryPath, filename), ec);
+            }
+
+            MeshAssetCache assetCache;
+            AsyncModelLoader loader;
+            loader.Initialize(jobSystem.get(), isShared ? &assetCache : nullptr);
+            // インスタンスが持つハンドル(共有しなければそれぞれ別のモデル)
+            std::vector<MeshAssetCache::Handle> instances;
+            size_t loadCount = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t n = 0; n < instanceCount; ++n) {
+                for (const std::string& filename : filenames) {
+                    loader.Load(directoryPath, filename, [&](AsyncModelLoader::Request& request) {
+                        instances.push_back(request.GetAsset());
+                        loadCount += request.IsShared() ? 0 : 1;
+                    });
+                }
+            }
+            loader.WaitAll();
+            const double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            // 同じモデルを2回数えないよう、実体ごとにメモリを足す
+            std::set<const MeshAsset*> uniqueAssets;
+            size_t bytes = 0;
+            for (const MeshAssetCache::Handle& asset : instances) {
+                if (uniqueAssets.insert(asset.get()).second) {
+                    bytes += GetModelBytes(asset->model);
+                }
+            }
+            std::printf("shared %-3s: %zu instances, %zu loads, %zu models, %.1f ms, %.1f KB\n", isShared ? "on" : "off",
+                instances.size(), loadCount, uniqueAssets.size(), totalMs, bytes / 1024.0);
+
+            if (isShared) {
+                // 同じファイルのインスタンスはすべて同じモデルを指し、同期で読んだものと同じ
+                bool isSame = uniqueAssets.size() == filenames.size() && loadCount == filenames.size();
+                for (size_t i = 0; i < filenames.size() && isSame; ++i) {
+                    const MeshAssetCache::Handle asset = assetCache.Find(directoryPath, filenames[i]);
+                    isSame = asset && ObjParser::IsSame(asset->model, MeshCache::LoadFile(directoryPath, filenames[i]));
+                }
+                const MeshAssetCache::Stats stats = assetCache.GetStats();
+                std::printf("shared check: %zu alive, %zu loads, %zu shared %s\n", stats.liveCount, stats.loadCount, stats.shareCount, isSame ? "(same)" : "(DIFFERENT)");
+                exitCode = isSame ? exitCode : 1;
+
+                // ハンドルがすべて消えたらモデルも消える
+                instances.clear();
+                const bool isReleased = assetCache.GetStats().liveCount == 0;
+                std::printf("shared release: %s\n", isReleased ? "(ok)" : "(LEAKED)");
+                exitCode = isReleased ? exitCode : 1;
+            }
+        }
+
+        // 複数のスレッドから同時に同じファイルを(キャッシュを消してから)読んでも、解析は1回でキャッシュが壊れない
+        if (!filenames.empty()) {
+            const std::string& filename = filenames.back();
+            std::error_code ec;
+            std::filesystem::remove(MeshCache::GetCachePath(directoryPath, filename), ec);
+            MeshAssetCache assetCache;
+            const size_t threadCount = 4;
+            std::vector<MeshAssetCache::Handle> assets(threadCount);
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < threadCount; ++t) {
+                threads.emplace_back([&, t] { assets[t] = assetCache.Load(directoryPath, filename); });
+            }
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            // 共有しないで同時に読む(キャッシュの一時ファイルがぶつからないか)
+            threads.clear();
+            std::filesystem::remove(MeshCache::GetCachePath(directoryPath, filename), ec);
+            for (size_t t = 0; t < threadCount; ++t) {
+                threads.emplace_back([&] { MeshAssetCache::LoadUncached(directoryPath, filename); });
+            }
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            ObjModel cached;
+            const bool isCacheValid = MeshCache::Read(directoryPath, filename, cached) && ObjParser::IsSame(cached, assets[0]->model);
+            bool isOnce = assetCache.GetStats().loadCount == 1;
+            for (const MeshAssetCache::Handle& asset : assets) {
+                isOnce = isOnce && asset == assets[0];
+            }
+            size_t leftoverCount = 0;
+            for (const auto& entry : std::filesystem::directory_iterator(directoryPath)) {
+                leftoverCount += entry.path().extension() == ".tmp" ? 1 : 0;
+            }
+            std::printf("shared concurrent: %s, cache %s, %zu temporary files left\n", isOnce ? "(loaded once)" : "(LOADED TWICE)",
+                isCacheValid ? "(valid)" : "(BROKEN)", leftoverCount);
+            exitCode = isOnce && isCacheValid && leftoverCount == 0 ? exitCode : 1;
+        }
+
+        jobSystem->Finalize();
+        return exitCode;
+    }
+
+    // バイナリに値を足す
+    template<typename T>
+    void AppendBytes(std::string& bytes, const T& value) {
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // glbで持てる形のマテリアル(色・不透明度・テクスチャ・UVの拡大と移動・ライティングの有無)
+    ObjMaterial ToGltfMaterial(const ObjMaterial& material) {
+        ObjMaterial result;
+        result.color = { material.color.x, material.color.y, material.color.z, 1.0f };
+        result.alpha = material.alpha;
+        result.textureFilePath = material.textureFilePath;
+        result.enableLighting = material.enableLighting;
+        result.uvTransform.m[0][0] = material.uvTransform.m[0][0];
+        result.uvTransform.m[1][1] = material.uvTransform.m[1][1];
+        result.uvTransform.m[3][0] = material.uvTransform.m[3][0];
+        result.uvTransform.m[3][1] = material.uvTransform.m[3][1];
+        return result;
+    }
+
+    /// <summary>
+    /// モデルを同じ内容のglbにする(GlbLoaderで読むと元に戻るように、xと回り順を戻して書く)
+    /// メッシュ1つがプリミティブ1つ、画像はdirectoryPathからの相対パス
+    /// </summary>
+    bool WriteGlb(const std::string& path, const ObjModel& model, const std::string& directoryPath) {
+        std::string bin;
+        std::string bufferViews, accessors, primitives;
+        size_t viewCount = 0;
+        // バッファの区間と、それを指すアクセサを足す
+        auto addAccessor = [&](const std::string& data, const char* type, uint32_t componentType, size_t count, const std::string& bounds) {
+            char text[256];
+            std::snprintf(text, sizeof(text), "%s{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu}",
+                viewCount ? "," : "", bin.size(), data.size());
+            bufferViews += text;
+            std::snprintf(text, sizeof(text), "%s{\"bufferView\":%zu,\"componentType\":%u,\"count\":%zu,\"type\":\"%s\"",
+                viewCount ? "," : "", viewCount, componentType, count, type);
+            accessors += text;
+            accessors += bounds + "}";
+            bin += data;
+            bin.resize((bin.size() + 3) & ~size_t(3), '\0');
+            return viewCount++;
+        };
+
+        for (const ObjMesh& mesh : model.meshes) {
+            if (mesh.indices.empty()) {
+                continue;
+            }
+            std::string positions, normals, texcoords, indices;
+            for (const VertexData& vertex : mesh.vertices) {
+                AppendBytes(positions, -vertex.position.x);
+                AppendBytes(positions, vertex.position.y);
+                AppendBytes(positions, vertex.position.z);
+                AppendBytes(normals, -vertex.normal.x);
+                AppendBytes(normals, vertex.normal.y);
+                AppendBytes(normals, vertex.normal.z);
+                AppendBytes(texcoords, vertex.texcoord);
+            }
+            for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+                AppendBytes(indices, mesh.indices[i + 2]);
+                AppendBytes(indices, mesh.indices[i + 1]);
+                AppendBytes(indices, mesh.indices[i]);
+            }
+            char bounds[160];
+            std::snprintf(bounds, sizeof(bounds), ",\"min\":[%.9g,%.9g,%.9g],\"max\":[%.9g,%.9g,%.9g]",
+                -mesh.boundsMax.x, mesh.boundsMin.y, mesh.boundsMin.z, -mesh.boundsMin.x, mesh.boundsMax.y, mesh.boundsMax.z);
+            const size_t position = addAccessor(positions, "VEC3", 5126, mesh.vertices.size(), bounds);
+            const size_t normal = addAccessor(normals, "VEC3", 5126, mesh.vertices.size(), "");
+            const size_t texcoord = addAccessor(texcoords, "VEC2", 5126, mesh.vertices.size(), "");
+            const size_t index = addAccessor(indices, "SCALAR", 5125, mesh.indices.size(), "");
+
+            char text[256];
+            std::snprintf(text, sizeof(text), "%s{\"attributes\":{\"POSITION\":%zu,\"NORMAL\":%zu,\"TEXCOORD_0\":%zu},\"indices\":%zu",
+                primitives.empty() ? "" : ",", position, normal, texcoord, index);
+            primitives += text;
+            if (mesh.materialIndex < model.materials.size()) {
+                primitives += ",\"material\":" + std::to_string(mesh.materialIndex);
+            }
+            primitives += "}";
+        }
+
+        std::string materials, images, textures;
+        size_t imageCount = 0;
+        for (const ObjMaterial& material : model.materials) {
+            char text[512];
+            std::snprintf(text, sizeof(text), "%s{\"pbrMetallicRoughness\":{\"baseColorFactor\":[%.9g,%.9g,%.9g,%.9g],\"metallicFactor\":0",
+                materials.empty() ? "" : ",", material.color.x, material.color.y, material.color.z, material.alpha);
+            materials += text;
+            if (!material.textureFilePath.empty()) {
+                std::string uri = material.textureFilePath;
+                if (uri.rfind(directoryPath + "/", 0) == 0) {
+                    uri.erase(0, directoryPath.size() + 1);
+                }
+                images += std::string(imageCount ? "," : "") + "{\"uri\":\"" + uri + "\"}";
+                textures += std::string(imageCount ? "," : "") + "{\"source\":" + std::to_string(imageCount) + "}";
+                std::snprintf(text, sizeof(text),
+                    ",\"baseColorTexture\":{\"index\":%zu,\"extensions\":{\"KHR_texture_transform\":{\"offset\":[%.9g,%.9g],\"scale\":[%.9g,%.9g]}}}",
+                    imageCount++, material.uvTransform.m[3][0], material.uvTransform.m[3][1], material.uvTransform.m[0][0], material.uvTransform.m[1][1]);
+                materials += text;
+            }
+            materials += "}";
+            if (!material.enableLighting) {
+                materials += ",\"extensions\":{\"KHR_materials_unlit\":{}}";
+            }
+            materials += "}";
+        }
+
+        std::string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"mesh_benchmark\"},"
+            "\"extensionsUsed\":[\"KHR_texture_transform\",\"KHR_materials_unlit\"],"
+            "\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+            "\"meshes\":[{\"primitives\":[" + primitives + "]}],"
+            "\"materials\":[" + materials + "],\"textures\":[" + textures + "],\"images\":[" + images + "],"
+            "\"buffers\":[{\"byteLength\":" + std::to_string(bin.size()) + "}],"
+            "\"bufferViews\":[" + bufferViews + "],\"accessors\":[" + accessors + "]}";
+        json.resize((json.size() + 3) & ~size_t(3), ' ');
+
+        std::string glb;
+        AppendBytes(glb, uint32_t(0x46546C67));
+        AppendBytes(glb, uint32_t(2));
+        AppendBytes(glb, static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size()));
+        AppendBytes(glb, static_cast<uint32_t>(json.size()));
+        AppendBytes(glb, uint32_t(0x4E4F534A));
+        glb += json;
+        AppendBytes(glb, static_cast<uint32_t>(bin.size()));
+        AppendBytes(glb, uint32_t(0x004E4942));
+        glb += bin;
+
+        std::ofstream file(path, std::ios::binary);
+        file.write(glb.data(), static_cast<std::streamsize>(glb.size()));
+        return file.good();
+    }
+
+    // 同じ処理を何回か行い、いちばん速かった時間(ms)
+    template<typename Func>
+    double MeasureBestMs(int repeatCount, Func&& func) {
+        double best = 1e30;
+        for (int r = 0; r < repeatCount; ++r) {
+            const auto start = std::chrono::steady_clock::now();
+            func();
+            best = (std::min)(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    // 包む形を作る時間と大きさ、すべての頂点が中に入っているか(変換した後も)を表示する
+    bool PrintBounds(const ObjModel& model) {
+        bool isAllInside = true;
+        for (size_t m = 0; m < model.meshes.size(); ++m) {
+            ObjMesh mesh = model.meshes[m];
+            const int repeatCount = 5;
+            const double boundsMs = MeasureBestMs(repeatCount, [&] { MeshBounds::Compute(mesh); });
+            const double aabbOnlyMs = MeasureBestMs(repeatCount, [&] { ObjMesh copy; copy.vertices = mesh.vertices; MeshBounds::Compute(copy, false); });
+
+            const Vector3 aabbSize = mesh.boundsMax - mesh.boundsMin;
+            const float halfDiagonal = 0.5f * Math::Length(aabbSize);
+            const Vector3& obbHalf = mesh.orientedBounds.size;
+            const float aabbVolume = aabbSize.x * aabbSize.y * aabbSize.z;
+            const float obbVolume = 8.0f * obbHalf.x * obbHalf.y * obbHalf.z;
+
+            // ローカル座標と、回転・拡縮・移動したワールド座標の両方で、頂点が外に出ていないか
+            const Matrix4x4 worlds[] = {
+                Math::MakeIdentity4x4(),
+                Math::MakeAffineMatrix({ 2.0f, 0.5f, 1.5f }, { 0.3f, 1.1f, -0.7f }, { 10.0f, -3.0f, 5.0f }),
+                Math::MakeAffineMatrix({ -1.0f, 3.0f, 0.25f }, { -2.0f, 0.4f, 2.5f }, { -100.0f, 0.0f, 42.0f }),
+            };
+            size_t outsideCount = 0;
+            for (const Matrix4x4& world : worlds) {
+                const Sphere sphere = MeshBounds::TransformSphere(mesh.boundingSphere, world);
+                const AABB aabb = MeshBounds::TransformAabb(mesh.boundsMin, mesh.boundsMax, world);
+                const OBB obb = MeshBounds::TransformObb(mesh.orientedBounds, world);
+                const float scale = (std::max)(Math::Length(aabb.max - aabb.min), 1.0f);
+                const float tolerance = 1e-5f * scale;
+                for (const VertexData& vertex : mesh.vertices) {
+                    const Vector3 p = Math::Transform({ vertex.position.x, vertex.position.y, vertex.position.z }, world);
+                    bool isInside = Math::Length(p - sphere.center) <= sphere.radius + tolerance;
+                    isInside = isInside && p.x >= aabb.min.x - tolerance && p.y >= aabb.min.y - tolerance && p.z >= aabb.min.z - tolerance;
+                    isInside = isInside && p.x <= aabb.max.x + tolerance && p.y <= aabb.max.y + tolerance && p.z <= aabb.max.z + tolerance;
+                    for (int k = 0; k < 3; ++k) {
+                        isInside = isInside && std::fabs(Math::Dot(p - obb.center, obb.orientations[k])) <= obb.size[k] + tolerance;
+                    }
+                    outsideCount += isInside ? 0 : 1;
+                }
+            }
+            isAllInside = isAllInside && outsideCount == 0;
+
+            std::printf("%-20s bounds mesh %zu: %zu vertices, %.3f ms (aabb+sphere %.3f ms), sphere r %.4f (%.1f%% of AABB half diagonal), OBB %.1f%% of AABB volume %s\n",
+                "", m, mesh.vertices.size(), boundsMs, aabbOnlyMs, mesh.boundingSphere.radius,
+                halfDiagonal > 0.0f ? 100.0f * mesh.boundingSphere.radius / halfDiagonal : 100.0f,
+                aabbVolume > 0.0f ? 100.0f * obbVolume / aabbVolume : 100.0f, outsideCount == 0 ? "(inside)" : "(OUTSIDE)");
+        }
+        return isAllInside;
+    }
+
+    int RunGlb(const std::string& directoryPath, const std::vector<std::string>& filenames) {
+        int exitCode = 0;
+        std::printf("%-20s %10s %10s %10s %10s %9s %9s %8s\n", "model", "obj(KB)", "glb(KB)", "obj(ms)", "glb(ms)", "speedup", "build(ms)", "result");
+        for (const std::string& filename : filenames) {
+            // objと同じ内容のglbを横に書く
+            const ObjModel model = ObjParser::LoadFile(directoryPath, filename);
+            const std::string glbFilename = std::filesystem::path(filename).replace_extension(".glb").string();
+            if (!WriteGlb(directoryPath + "/" + glbFilename, model, directoryPath)) {
+                std::printf("%-20s write failed\n", glbFilename.c_str());
+                exitCode = 1;
+                continue;
+            }
+
+            const int repeatCount = 5;
+            const double objMs = MeasureBestMs(repeatCount, [&] { ObjParser::LoadFile(directoryPath, filename); });
+            ObjModel loaded;
+            const double glbMs = MeasureBestMs(repeatCount, [&] { loaded = GlbLoader::LoadFile(directoryPath, glbFilename); });
+
+            // glbで持てないマテリアルの値(Ka/Ks/Ns)は既定にして比べる
+            ObjModel expected = model;
+            std::erase_if(expected.meshes, [](const ObjMesh& mesh) { return mesh.indices.empty(); });
+            for (ObjMaterial& material : expected.materials) {
+                material = ToGltfMaterial(material);
+            }
+            const bool isSame = ObjParser::IsSame(expected, loaded);
+
+            // MeshCacheを通した時(作る時と読む時)もobjから作ったものと同じ
+            std::error_code ec;
+            std::filesystem::remove(MeshCache::GetCachePath(directoryPath, glbFilename), ec);
+            bool isCacheHit = false;
+            const auto buildStart = std::chrono::steady_clock::now();
+            MeshCache::LoadFile(directoryPath, glbFilename, &isCacheHit);
+            const double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+            const ObjModel cached = MeshCache::LoadFile(directoryPath, glbFilename, &isCacheHit);
+            for (ObjMesh& mesh : expected.meshes) {
+                MeshCache::PrepareMesh(mesh);
+            }
+            const bool isCacheSame = isCacheHit && ObjParser::IsSame(expected, cached);
+
+            std::printf("%-20s %10.1f %10.1f %10.3f %10.3f %8.1fx %9.2f %s\n", glbFilename.c_str(),
+                std::filesystem::file_size(directoryPath + "/" + filename, ec) / 1024.0,
+                std::filesystem::file_size(directoryPath + "/" + glbFilename, ec) / 1024.0,
+                objMs, glbMs, glbMs > 0.0 ? objMs / glbMs : 0.0, buildMs,
+                isSame && isCacheSame ? "(same)" : "(DIFFERENT)");
+            exitCode = isSame && isCacheSame ? exitCode : 1;
+        }
+
+        // 壊れたglb(途中で切れた・中身を書き換えた)でも落ちずに読めたところまでか空を返す
+        if (!filenames.empty()) {
+            const std::string glbFilename = std::filesystem::path(filenames.back()).replace_extension(".glb").string();
+            std::ifstream file(directoryPath + "/" + glbFilename, std::ios::binary);
+            const std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            size_t brokenMeshCount = 0;
+            for (size_t size = 0; size < bytes.size(); size += (std::max)(bytes.size() / 97, size_t(1))) {
+                // ヘッダの長さも切った所に合わせる(チャンクの途中で切れる)
+                std::string truncated = bytes.substr(0, size);
+                if (size >= 12) {
+                    const uint32_t length = static_cast<uint32_t>(size);
+                    std::memcpy(truncated.data() + 8, &length, sizeof(length));
+                }
+                brokenMeshCount += GlbLoader::Parse(reinterpret_cast<const uint8_t*>(truncated.data()), truncated.size(), directoryPath).meshes.size();
+            }
+            std::string corrupted = bytes;
+            for (size_t i = 20; i < corrupted.size(); i += 7) {
+                corrupted[i] = static_cast<char>(corrupted[i] ^ 0x5A);
+            }
+            brokenMeshCount += GlbLoader::Parse(reinterpret_cast<const uint8_t*>(corrupted.data()), corrupted.size(), directoryPath).meshes.size();
+
+            // JSONチャンクを書き換えたglbを作る
+            uint32_t jsonSize = 0;
+            if (bytes.size() >= 20) {
+                std::memcpy(&jsonSize, bytes.data() + 12, sizeof(jsonSize));
+            }
+            const bool hasJson = 20 + static_cast<size_t>(jsonSize) <= bytes.size();
+            const std::string json = hasJson ? bytes.substr(20, jsonSize) : std::string();
+            const std::string rest = hasJson ? bytes.substr(20 + jsonSize) : std::string();
+            auto parsePatched = [&](std::string patched) {
+                patched.resize((patched.size() + 3) & ~size_t(3), ' ');
+                std::string glb = bytes.substr(0, 20) + patched + rest;
+                const uint32_t length = static_cast<uint32_t>(glb.size());
+                const uint32_t chunkLength = static_cast<uint32_t>(patched.size());
+                std::memcpy(glb.data() + 8, &length, sizeof(length));
+                std::memcpy(glb.data() + 12, &chunkLength, sizeof(chunkLength));
+                return GlbLoader::Parse(reinterpret_cast<const uint8_t*>(glb.data()), glb.size(), directoryPath);
+            };
+
+            // JSONの位置・長さ・数を負・巨大・小数にしたもの(そのアクセサを使うプリミティブは読まれない)
+            size_t badNumberMeshCount = 0;
+            size_t badNumberCount = 0;
+            if (hasJson) {
+                for (const char* key : { "\"byteOffset\":", "\"byteLength\":", "\"byteStride\":", "\"count\":" }) {
+                    for (const char* value : { "-8", "1e300", "0.5" }) {
+                        for (size_t at = json.find(key); at != std::string::npos; at = json.find(key, at + 1)) {
+                            // bufferViews・accessorsの中のものだけ(buffersのbyteLengthは読まない)
+                            if (at < json.find("\"bufferViews\"")) {
+                                continue;
+                            }
+                            const size_t begin = at + std::strlen(key);
+                            const size_t end = json.find_first_of(",}", begin);
+                            badNumberMeshCount += parsePatched(json.substr(0, begin) + value + json.substr(end)).meshes.size();
+                            ++badNumberCount;
+                        }
+                    }
+                }
+            }
+            std::printf("glb broken input: %zu meshes read, bad numbers: %zu files, %zu meshes read (ok)\n", brokenMeshCount, badNumberCount, badNumberMeshCount);
+
+            // ノードの変換(親: y軸90度回転と移動、子: xを裏返す拡縮)を掛けたもの
+            // glTFの座標で (2z+1, 2y+2, 2x+3) になり、x反転後は変換なしの頂点bから (-2bz-1, 2by+2, -2bx+3)。裏返るので回り順も逆
+            const std::string identityNode = "\"nodes\":[{\"mesh\":0}]";
+            const size_t nodeAt = json.find(identityNode);
+            if (nodeAt != std::string::npos) {
+                const std::string movedNodes = "\"nodes\":[{\"children\":[1],\"translation\":[1,2,3],\"rotation\":[0,0.70710678,0,0.70710678]},"
+                    "{\"mesh\":0,\"scale\":[-2,2,2]}]";
+                const ObjModel base = parsePatched(json);
+                const ObjModel moved = parsePatched(json.substr(0, nodeAt) + movedNodes + json.substr(nodeAt + identityNode.size()));
+                bool isMovedSame = base.meshes.size() == moved.meshes.size() && !base.meshes.empty();
+                for (size_t m = 0; isMovedSame && m < base.meshes.size(); ++m) {
+                    const ObjMesh& meshA = base.meshes[m];
+                    const ObjMesh& meshB = moved.meshes[m];
+                    isMovedSame = meshA.vertices.size() == meshB.vertices.size() && meshA.indices.size() == meshB.indices.size();
+                    for (size_t i = 0; isMovedSame && i < meshA.vertices.size(); ++i) {
+                        const Vector4& b = meshA.vertices[i].position;
+                        const Vector3& bn = meshA.vertices[i].normal;
+                        const Vector3 position = { -2.0f * b.z - 1.0f, 2.0f * b.y + 2.0f, -2.0f * b.x + 3.0f };
+                        const Vector3 normal = Math::Length(bn) > 0.0f ? Math::Normalize({ -bn.z, bn.y, -bn.x }) : Vector3{};
+                        const Vector4& p = meshB.vertices[i].position;
+                        isMovedSame = Math::Length(Vector3{ p.x, p.y, p.z } - position) <= 1e-4f * (1.0f + Math::Length(position)) &&
+                            Math::Length(meshB.vertices[i].normal - normal) <= 1e-4f;
+                    }
+                    for (size_t t = 0; isMovedSame && t + 2 < meshA.indices.size(); t += 3) {
+                        isMovedSame = meshB.indices[t] == meshA.indices[t + 2] && meshB.indices[t + 1] == meshA.indices[t + 1] && meshB.indices[t + 2] == meshA.indices[t];
+                    }
+                }
+                std::printf("glb node transform: %s\n", isMovedSame ? "(same)" : "(DIFFERENT)");
+                exitCode = isMovedSame ? exitCode : 1;
+            }
+        }
+        std::printf("(LoadObjFileAssimpM needs Assimp: compare it in the ObjClass debug window \"Measure Load\")\n");
+        return exitCode;
+    }
+}
+
+int main(int argc, char** argv) {
+
+    std::string directoryPath = "resources/obj";
+    bool isCacheMeasured = false;
+    bool isLodPrinted = false;
+    bool isMeshletPrinted = false;
+    bool isNormalPrinted = false;
+    bool isBoundsPrinted = false;
+    bool isAsyncMeasured = false;
+    bool isGlbMeasured = false;
+    size_t sharedInstanceCount = 0;
+    size_t scalingFaceCount = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string option = argv[i];
+        if (option == "--cache") {
+            isCacheMeasured = true;
+            continue;
+        }
+        if (option == "--lod") {
+            isLodPrinted = true;
+            continue;
+        }
+        if (option == "--meshlet") {
+            isMeshletPrinted = true;
+            continue;
+        }
+        if (option == "--normals") {
+            isNormalPrinted = true;
+            continue;
+        }
+        if (option == "--bounds") {
+            isBoundsPrinted = true;
+            continue;
+        }
+        if (option == "--async") {
+            isAsyncMeasured = true;
+            continue;
+        }
+        if (option == "--glb") {
+            isGlbMeasured = true;
+            continue;
+        }
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "missing value for %s\n", option.c_str());
+            return 2;
+        }
+        ++i;
+        if (option == "--dir") {
+            directoryPath = value;
+        } else if (option == "--shared") {
+            sharedInstanceCount = static_cast<size_t>(std::strtoull(value, nullptr, 10));
+        } else if (option == "--scaling") {
+            scalingFaceCount = static_cast<size_t>(std::strtoull(value, nullptr, 10));
+        } else {
+            std::fprintf(stderr, "unknown option %s\n", option.c_str());
+            return 2;
+        }
+    }
+
+    if (scalingFaceCount > 0) {
+        return RunScaling(scalingFaceCount);
+    }
+
+    // 名前順に並べて毎回同じ順で表示する
+    std::vector<std::string> filenames;
+    for (const auto& entry : std::filesystem::directory_iterator(directoryPath)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".obj") {
+            filenames.push_back(entry.path().filename().string());
+        }
+    }
+    std::sort(filenames.begin(), filenames.end());
+
+    if (isAsyncMeasured) {
+        return RunAsync(directoryPath, filenames);
+    }
+    if (isGlbMeasured) {
+        return RunGlb(directoryPath, filenames);
+    }
+    if (sharedInstanceCount > 0) {
+        return RunShared(directoryPath, filenames, sharedInstanceCount);
+    }
+
+    std::printf("%-20s %6s %10s %10s %7s %12s %12s %12s %9s %15s %15s %8s\n",
+        "model", "meshes", "corners", "unique", "ratio", "before(KB)", "after(KB)", "saved(KB)", "load(ms)", "ACMR", "ATVR", "opt(ms)");
+
+    // 法線の計測で並列に使う
+    std::unique_ptr<JobSystem> normalJobSystem;
+    if (isNormalPrinted) {
+        normalJobSystem = std::make_unique<JobSystem>();
+        normalJobSystem->Initialize();
+    }
+
+    int exitCode = 0;
+    size_t totalBefore = 0;
+    size_t totalAfter = 0;
+    for (const std::string& filename : filenames) {
+        const auto start = std::chrono::steady_clock::now();
+        const ObjModel model = ObjParser::LoadFile(directoryPath, filename);
+        const double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        size_t cornerCount = 0;
+        size_t uniqueCount = 0;
+        for (const ObjMesh& mesh : model.meshes) {
+            cornerCount += mesh.indices.size();
+            uniqueCount += mesh.vertices.size();
+        }
+
+        // 並べ替えの前後でキャッシュミスを数える(メッシュをまとめて)
+        size_t missBefore = 0;
+        size_t missAfter = 0;
+        ObjModel optimized = model;
+        const auto optimizeStart = std::chrono::steady_clock::now();
+        for (ObjMesh& mesh : optimized.meshes) {
+            MeshOptimizer::Optimize(mesh);
+        }
+        const double optimizeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - optimizeStart).count();
+        for (size_t m = 0; m < model.meshes.size(); ++m) {
+            missBefore += MeshOptimizer::AnalyzeVertexCache(model.meshes[m].indices, model.meshes[m].vertices.size()).missCount;
+            missAfter += MeshOptimizer::AnalyzeVertexCache(optimized.meshes[m].indices, optimized.meshes[m].vertices.size()).missCount;
+        }
+        const double triangleCount = (std::max)(static_cast<double>(cornerCount / 3), 1.0);
+        const double vertexCount = (std::max)(static_cast<double>(uniqueCount), 1.0);
+        // 添字化前は三角形の角ごとに頂点を持っていた
+        const size_t beforeBytes = sizeof(VertexData) * cornerCount;
+        const size_t afterBytes = sizeof(VertexData) * uniqueCount + sizeof(uint32_t) * cornerCount;
+        totalBefore += beforeBytes;
+        totalAfter += afterBytes;
+
+        std::printf("%-20s %6zu %10zu %10zu %6.1f%% %12.1f %12.1f %12.1f %9.2f %6.3f -> %5.3f %6.3f -> %5.3f %8.2f\n",
+            filename.c_str(), model.meshes.size(), cornerCount, uniqueCount,
+            cornerCount ? 100.0 * uniqueCount / cornerCount : 0.0,
+            beforeBytes / 1024.0, afterBytes / 1024.0,
+            (static_cast<double>(beforeBytes) - static_cast<double>(afterBytes)) / 1024.0, loadMs,
+            missBefore / triangleCount, missAfter / triangleCount, missBefore / vertexCount, missAfter / vertexCount, optimizeMs);
+
+        if (isLodPrinted) {
+            PrintLods(optimized);
+        }
+
+        if (isMeshletPrinted) {
+            PrintMeshlets(model);
+        }
+
+        if (isNormalPrinted) {
+            PrintNormals(model, normalJobSystem.get());
+        }
+
+        if (isBoundsPrinted && !PrintBounds(model)) {
+            exitCode = 1;
+        }
+
+        if (isCacheMeasured) {
+            // 古いキャッシュを消して、作る時と読む時を測る
+            std::error_code ec;
+            std::filesystem::remove(MeshCache::GetCachePath(directoryPath, filename), ec);
+            bool isCacheHit = false;
+            auto cacheStart = std::chrono::steady_clock::now();
+            MeshCache::LoadFile(directoryPath, filename, &isCacheHit);
+            const double missMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cacheStart).count();
+            cacheStart = std::chrono::steady_clock::now();
+            const ObjModel cached = MeshCache::LoadFile(directoryPath, filename, &isCacheHit);
+            const double hitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cacheStart).count();
+            // キャッシュには塊と詳細度も入っている
+            ObjModel expected = model;
+            for (ObjMesh& mesh : expected.meshes) {
+                MeshCache::PrepareMesh(mesh);
+            }
+            std::printf("%-20s cache: build %.2f ms, load %.3f ms %s\n", "", missMs, hitMs,
+                isCacheHit && ObjParser::IsSame(expected, cached) ? "(same)" : "(DIFFERENT)");
+        }
+    }
+
+    std::printf("total: %.1f KB -> %.1f KB (saved %.1f KB)\n",
+        totalBefore / 1024.0, totalAfter / 1024.0, (static_cast<double>(totalBefore) - static_cast<double>(totalAfter)) / 1024.0);
+    if (isCacheMeasured) {
+        const MaterialLibraryCache::Stats materialStats = MaterialLibraryCache::GetStats();
+        std::printf("mtl: %zu libraries, %zu parsed, %zu reused\n", materialStats.libraryCount, materialStats.parseCount, materialStats.hitCount);
+    }
+    return exitCode;
+}
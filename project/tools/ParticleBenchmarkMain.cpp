@@ -0,0 +1,160 @@
+// パーティクルのヘッドレス計測(D3D12のデバイスなしで動く)
+// ゲーム本体とは別の実行ファイルなのでTD2_01.vcxprojには含めない
+//
+// Linuxでのビルド例(projectディレクトリで):
+//   g++ -std=c++20 -O2 -pthread -I. tools/ParticleBenchmarkMain.cpp 3D/particle/*.cpp engine/JobSystem.cpp -o particle_benchmark
+//
+// 使い方:
+//   particle_benchmark [--effect path] [--frames N] [--seed S] [--instances N] [--threads N] [--scalar]
+//                      [--warmup N] [--expect checksum] [--record file] [--replay file]
+//   --warmup  最初のNフレームの確保はウォームアップとして別に数える(既定120。その後は0になるはず)
+//   --expect  最後の状態のチェックサム(16進)と違えば終了コード1
+//   --record  フレームごとのチェックサムをファイルに書く
+//   --replay  --recordで書いたファイルと比べ、最初にずれたフレームを表示する(ずれている・フレーム数が違えば終了コード1)
+
+#include "../3D/particle/ParticleBenchmark.h"
+#include "../engine/JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+    // ヒープ確保回数
+    std::atomic<uint64_t> allocationCount{ 0 };
+}
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+int main(int argc, char** argv) {
+
+    ParticleBenchmark::Settings settings;
+    settings.effectFilePath = "resources/particle/default.effect";
+    settings.allocationCounter = [] { return allocationCount.load(std::memory_order_relaxed); };
+    uint64_t expectedChecksum = 0;
+    bool hasExpectedChecksum = false;
+    std::string recordPath;
+    std::string replayPath;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string option = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (option == "--scalar") {
+            settings.useSimd = false;
+            continue;
+        }
+        if (!value) {
+            std::fprintf(stderr, "missing value for %s\n", option.c_str());
+            return 2;
+        }
+        ++i;
+        if (option == "--effect") {
+            settings.effectFilePath = value;
+        } else if (option == "--frames") {
+            settings.frameCount = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (option == "--seed") {
+            settings.seed = std::strtoull(value, nullptr, 10);
+        } else if (option == "--instances") {
+            settings.maxInstance = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (option == "--threads") {
+            settings.maxThreads = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (option == "--warmup") {
+            settings.warmupFrameCount = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (option == "--expect") {
+            expectedChecksum = std::strtoull(value, nullptr, 16);
+            hasExpectedChecksum = true;
+        } else if (option == "--record") {
+            recordPath = value;
+        } else if (option == "--replay") {
+            replayPath = value;
+        } else {
+            std::fprintf(stderr, "unknown option %s\n", option.c_str());
+            return 2;
+        }
+    }
+    settings.recordFrameChecksums = !recordPath.empty() || !replayPath.empty();
+
+    std::unique_ptr<JobSystem> jobSystem = std::make_unique<JobSystem>();
+    jobSystem->Initialize();
+
+    const ParticleBenchmark::Result result = ParticleBenchmark::Run(settings, jobSystem.get());
+
+    std::printf("frames        : %u (threads %u / %u, %s)\n", result.frameCount, settings.maxThreads, jobSystem->GetThreadCount(), settings.useSimd ? "simd" : "scalar");
+    std::printf("frame         : avg %.3f ms max %.3f ms (spawn %.3f ms simulate %.3f ms)\n", result.averageFrameMs, result.maxFrameMs, result.averageSpawnMs, result.averageSimulateMs);
+    std::printf("spawned       : %llu (%.0f /s)\n", static_cast<unsigned long long>(result.spawnedCount), result.spawnPerSecond);
+    std::printf("alive         : peak %zu, last draw %zu\n", result.peakAliveCount, result.lastDrawCount);
+    std::printf("allocations   : %llu during frames after warm-up (%llu in the first %u frames)\n",
+        static_cast<unsigned long long>(result.allocationCount), static_cast<unsigned long long>(result.warmupAllocationCount),
+        (std::min)(settings.warmupFrameCount, settings.frameCount));
+    std::printf("memory        : %.2f MB\n", result.memoryBytes / (1024.0 * 1024.0));
+    std::printf("checksum      : %016llx\n", static_cast<unsigned long long>(result.checksum));
+
+    int exitCode = 0;
+    if (hasExpectedChecksum && expectedChecksum != result.checksum) {
+        std::printf("checksum MISMATCH (expected %016llx)\n", static_cast<unsigned long long>(expectedChecksum));
+        exitCode = 1;
+    }
+
+    if (!recordPath.empty()) {
+        std::ofstream file(recordPath);
+        for (uint64_t checksum : result.frameChecksums) {
+            file << std::hex << checksum << '\n';
+        }
+    }
+
+    if (!replayPath.empty()) {
+        std::ifstream file(replayPath);
+        if (!file.is_open()) {
+            std::fprintf(stderr, "cannot open %s\n", replayPath.c_str());
+            return 2;
+        }
+        std::vector<uint64_t> recorded;
+        uint64_t checksum = 0;
+        while (file >> std::hex >> checksum) {
+            recorded.push_back(checksum);
+        }
+        const size_t frameCount = (std::min)(recorded.size(), result.frameChecksums.size());
+        size_t mismatchFrame = frameCount;
+        for (size_t frame = 0; frame < frameCount; ++frame) {
+            if (recorded[frame] != result.frameChecksums[frame]) {
+                mismatchFrame = frame;
+                break;
+            }
+        }
+        if (mismatchFrame < frameCount) {
+            std::printf("replay        : first mismatch at frame %zu\n", mismatchFrame);
+            exitCode = 1;
+        } else if (recorded.size() != result.frameChecksums.size()) {
+            // 同じところまで合っていても、フレーム数が違えば再現できていない
+            std::printf("replay        : frame count differs (recorded %zu, ran %zu)\n", recorded.size(), result.frameChecksums.size());
+            exitCode = 1;
+        } else {
+            std::printf("replay        : %zu frames match\n", frameCount);
+        }
+    }
+
+    jobSystem->Finalize();
+    return exitCode;
+}